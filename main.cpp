@@ -40,6 +40,10 @@
 #	define SCROLL_BAR_SIZE 8
 #endif /* SCROLL_BAR_SIZE */
 
+#ifndef MINIMAP_WIDTH
+#	define MINIMAP_WIDTH 64
+#endif /* MINIMAP_WIDTH */
+
 template<typename T> T clamp(T v, T lo, T hi) {
 	assert(lo <= hi);
 	if (v < lo) v = lo;
@@ -185,7 +189,7 @@ public:
 						SDL_GetRendererOutputSize(_renderer, &_width, &_height);
 						setWidgetSize(
 							CodeEdit::Vec2(
-								(float)_width - WIDGET_BORDER_X * 2 - 2 - SCROLL_BAR_SIZE,
+								(float)_width - WIDGET_BORDER_X * 2 - 2 - SCROLL_BAR_SIZE - 2 - MINIMAP_WIDTH,
 								(float)_height - WIDGET_BORDER_Y * 2 - 2 - SCROLL_BAR_SIZE
 							)
 						);
@@ -232,6 +236,7 @@ public:
 
 		horizontalScrollBar();
 		verticalScrollBar();
+		minimap();
 	}
 
 private:
@@ -256,6 +261,20 @@ private:
 		);
 	}
 
+	void minimap(void) {
+		const CodeEdit::Vec2 &wndPos = getWidgetPos();
+		const CodeEdit::Vec2 &wndSize = getWidgetSize();
+		const CodeEdit::Vec4 rect(wndPos.x + wndSize.x + SCROLL_BAR_SIZE + 2, wndPos.y, MINIMAP_WIDTH, wndSize.y);
+
+		boxColor(
+			_renderer,
+			(Sint16)rect.x, (Sint16)rect.y,
+			(Sint16)(rect.x + rect.width - 1), (Sint16)(rect.y + rect.height - 1),
+			getPalette()[(int)CodeEdit::PaletteIndex::Background]
+		);
+		renderMinimap(_renderer, rect); // Also scrolls to where it's clicked.
+	}
+
 	void scrollBar(ScrollBar &bar, size_t comp, std::function<float (void)> getScroll, std::function<void (float)> setScroll) {
 		assert(comp == 0 || comp == 1);
 
@@ -401,8 +420,8 @@ int CALLBACK WinMain(_In_ HINSTANCE hInstance, _In_ HINSTANCE hPrevInstance, _In
 		boxColor(
 			rnd,
 			WIDGET_BORDER_X, WIDGET_BORDER_Y,
-			// Reserves space for scroll bars.
-			edit->width() - WIDGET_BORDER_X - 2 - SCROLL_BAR_SIZE, edit->height() - WIDGET_BORDER_Y - 2 - SCROLL_BAR_SIZE,
+			// Reserves space for scroll bars and the minimap.
+			edit->width() - WIDGET_BORDER_X - 2 - SCROLL_BAR_SIZE - 2 - MINIMAP_WIDTH, edit->height() - WIDGET_BORDER_Y - 2 - SCROLL_BAR_SIZE,
 			0xff2c2c2c
 		);
 		edit->render(); // Renders the widget and processes events.
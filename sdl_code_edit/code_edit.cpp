@@ -13,7 +13,12 @@
 #include "../sdl_gfx/SDL2_gfxPrimitives.h"
 #include <SDL.h>
 #include <algorithm>
+#include <atomic>
 #include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
 
 /*
 ** {========================================================
@@ -40,12 +45,87 @@
 #	define countof(A) (sizeof(A) / sizeof(*(A)))
 #endif /* countof */
 
+#ifndef CODE_EDIT_SSE2
+#	if defined __SSE2__ || defined _M_X64 || defined _M_AMD64 || (defined _M_IX86_FP && _M_IX86_FP >= 2)
+#		define CODE_EDIT_SSE2 1
+#	else
+#		define CODE_EDIT_SSE2 0
+#	endif
+#endif /* CODE_EDIT_SSE2 */
+
+#if CODE_EDIT_SSE2
+#	include <emmintrin.h>
+#endif /* CODE_EDIT_SSE2 */
+#if defined _MSC_VER
+#	include <intrin.h>
+#endif /* _MSC_VER */
+#if defined _WIN32
+#	ifndef WIN32_LEAN_AND_MEAN
+#		define WIN32_LEAN_AND_MEAN
+#	endif /* WIN32_LEAN_AND_MEAN */
+#	include <windows.h>
+#endif /* _WIN32 */
+
 static_assert(sizeof(CodeEdit::Keycode) == sizeof(SDL_Keycode), "Wrong type size.");
 
 static const int COLORIZE_DELAY_FRAME_COUNT = 60;
 
+static const int COLORIZE_LINES_PER_FRAME = 10;
+
+static const int COLORIZE_COMMENT_GLYPHS_PER_FRAME = 65536;
+
+static const int COLORIZE_CATCH_UP_LINE_COUNT = 1000; // Lines below the checked ones colorized in order rather than jumped over.
+
+static const int COLORIZE_CHECKPOINT_LINES = 1024; // Entry states kept for jumps far below the checked lines.
+
+static const int COLORIZE_PARALLEL_MIN_LINES = 20000; // Smaller texts are colorized in idle frames.
+
+static const int COLORIZE_PART_LINES = 4096; // Lexed by a job at once from an assumed entry state.
+
+static const int COLORIZE_ADOPT_GLYPHS_PER_FRAME = 1 << 19; // Applying spans and interning new words stays on this thread.
+
+static const int LINE_OFFSET_CHECKPOINT_COLUMNS = 64;
+
+static const int WRAP_LAYOUT_LINES_PER_FRAME = 20000; // Laid out again in idle frames after the row width changes.
+
+static const int FOLD_COLORIZE_LINE_COUNT = 1000;
+
+static const int MINIMAP_LINE_HEIGHT = 2;
+
+static const int NUMBER_SLOTS = 64; // Line numbers kept composed at least.
+
+static const int NUMBER_GLYPH_COUNT = 11; // ' ' and '0' to '9'.
+
+static const int SNAPSHOT_CHUNK_LINES = 256;
+
+static const int FILE_BLOCK_BYTES = 1 << 20;
+
+static const int GLYPH_POOL_BLOCK_BYTES = 1 << 20;
+
+static const int GLYPH_POOL_CLASSES = 12; // Of 8 bytes to 16 KB, larger ones are from the heap.
+
+static const int COMPLETION_MAX_ITEMS = 100;
+
+static const int COMPLETION_VISIBLE_ITEMS = 8;
+
+static const int COMPLETION_MAX_COLUMNS = 40;
+
+static const int COMPLETION_SCORE_MATCH = 16;
+
+static const int COMPLETION_SCORE_FIRST = 24; // Extra for matching the first character of a candidate.
+
+static const int COMPLETION_SCORE_BOUNDARY = 12; // Extra for matching at the beginning of a word part.
+
+static const int COMPLETION_SCORE_CONSECUTIVE = 12; // Extra for following the last matched character.
+
+static const int COMPLETION_SCORE_CASE = 1; // Extra for matching with the same case.
+
+static const int COMPLETION_PENALTY_GAP = 2; // Per skipped character, up to `COMPLETION_PENALTY_GAP_MAX` ones.
+
+static const int COMPLETION_PENALTY_GAP_MAX = 4;
+
 static bool isPrintable(int cp) {
-	if (cp > 255) return false;
+	if (cp < 0 || cp > 255) return false;
 
 	return !!::isprint(cp);
 }
@@ -304,2482 +384,7148 @@ static int appendUtf8ToStdStr(std::string &buf, CodeEdit::Char chr) {
 	return ret;
 }
 
-struct Clipper {
-private:
-	SDL_Renderer* renderer = nullptr;
-	SDL_Rect clip;
-
-public:
-	Clipper(SDL_Renderer* rnd, const SDL_Rect &rect) : renderer(rnd) {
-		SDL_RenderGetClipRect(renderer, &clip);
-		SDL_RenderSetClipRect(renderer, &rect);
-	}
-	~Clipper() {
-		if (clip.w == 0 || clip.h == 0)
-		SDL_RenderSetClipRect(renderer, nullptr);
-	else
-		SDL_RenderSetClipRect(renderer, &clip);
+#if CODE_EDIT_SSE2
+static bool packAsciiGlyphs(const CodeEdit::Glyph* glyphs, char* bytes) {
+	// Gathers the characters of 16 glyphs, fails if any is not ASCII.
+	static_assert(sizeof(CodeEdit::Glyph) == 8, "Glyphs are expected to pack into 8 bytes.");
+	const __m128i chars = _mm_set_epi32(0, -1, 0, -1);
+	__m128i v[8];
+	__m128i all = _mm_setzero_si128();
+	for (int i = 0; i < 8; ++i) {
+		v[i] = _mm_and_si128(_mm_loadu_si128((const __m128i*)(glyphs + i * 2)), chars);
+		all = _mm_or_si128(all, v[i]);
 	}
-};
+	if (_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_and_si128(all, _mm_set1_epi32(~0x7f)), _mm_setzero_si128())) != 0xffff)
+		return false;
 
-CodeEdit::LanguageDefinition CodeEdit::LanguageDefinition::AngelScript(void) {
-	static bool inited = false;
-	static LanguageDefinition langDef;
-	if (!inited) {
-		static const char* const keywords[] = {
-			"and", "abstract", "auto", "bool", "break", "case", "cast", "class", "const", "continue", "default", "do", "double", "else", "enum", "false", "final", "float", "for",
-			"from", "funcdef", "function", "get", "if", "import", "in", "inout", "int", "interface", "int8", "int16", "int32", "int64", "is", "mixin", "namespace", "not",
-			"null", "or", "out", "override", "private", "protected", "return", "set", "shared", "super", "switch", "this ", "true", "typedef", "uint", "uint8", "uint16", "uint32",
-			"uint64", "void", "while", "xor"
-		};
+	const __m128i lo = _mm_packs_epi32(_mm_packs_epi32(v[0], v[1]), _mm_packs_epi32(v[2], v[3]));
+	const __m128i hi = _mm_packs_epi32(_mm_packs_epi32(v[4], v[5]), _mm_packs_epi32(v[6], v[7]));
+	_mm_storeu_si128((__m128i*)bytes, _mm_packus_epi16(lo, hi));
 
-		for (const char* const k : keywords)
-			langDef.keys.insert(k);
+	return true;
+}
+#endif /* CODE_EDIT_SSE2 */
 
-		static const char* const identifiers[] = {
-			"cos", "sin", "tab", "acos", "asin", "atan", "atan2", "cosh", "sinh", "tanh", "log", "log10", "pow", "sqrt", "abs", "ceil", "floor", "fraction", "closeTo", "fpFromIEEE", "fpToIEEE",
-			"complex", "opEquals", "opAddAssign", "opSubAssign", "opMulAssign", "opDivAssign", "opAdd", "opSub", "opMul", "opDiv"
-		};
-		for (const char* const k : identifiers) {
-			Identifier id;
-			id.declaration = "Built-in function";
-			langDef.ids.insert(std::make_pair(std::string(k), id));
+static void appendGlyphsToStdStr(std::string &buf, const CodeEdit::Glyph* first, const CodeEdit::Glyph* last) {
+	// Takes 16 glyphs at once while they are ASCII if possible.
+	while (first < last) {
+		const CodeEdit::Glyph* stop = last;
+#if CODE_EDIT_SSE2
+		if (last - first >= 16) {
+			char bytes[16];
+			if (packAsciiGlyphs(first, bytes)) {
+				buf.append(bytes, 16);
+				first += 16;
+
+				continue;
+			}
+			stop = first + 16;
+		}
+#endif /* CODE_EDIT_SSE2 */
+		for (; first < stop; ++first) {
+			if (first->character < 0x80)
+				buf.push_back((char)first->character);
+			else
+				appendUtf8ToStdStr(buf, first->character);
 		}
+	}
+}
 
-		langDef.tokenRegexPatterns.push_back(std::make_pair<std::string, PaletteIndex>("//.*", PaletteIndex::Comment));
-		langDef.tokenRegexPatterns.push_back(std::make_pair<std::string, PaletteIndex>("L?\\\"(\\\\.|[^\\\"])*\\\"", PaletteIndex::String));
-		langDef.tokenRegexPatterns.push_back(std::make_pair<std::string, PaletteIndex>("\\'\\\\?[^\\']\\'", PaletteIndex::String));
-		langDef.tokenRegexPatterns.push_back(std::make_pair<std::string, PaletteIndex>("[+-]?([0-9]+([.][0-9]*)?|[.][0-9]+)([eE][+-]?[0-9]+)?[fF]?", PaletteIndex::Number));
-		langDef.tokenRegexPatterns.push_back(std::make_pair<std::string, PaletteIndex>("[+-]?[0-9]+[Uu]?[lL]?[lL]?", PaletteIndex::Number));
-		langDef.tokenRegexPatterns.push_back(std::make_pair<std::string, PaletteIndex>("0[0-7]+[Uu]?[lL]?[lL]?", PaletteIndex::Number));
-		langDef.tokenRegexPatterns.push_back(std::make_pair<std::string, PaletteIndex>("0[xX][0-9a-fA-F]+[uU]?[lL]?[lL]?", PaletteIndex::Number));
-		langDef.tokenRegexPatterns.push_back(std::make_pair<std::string, PaletteIndex>("[a-zA-Z_][a-zA-Z0-9_]*", PaletteIndex::Identifier));
-		langDef.tokenRegexPatterns.push_back(std::make_pair<std::string, PaletteIndex>("[\\[\\]\\{\\}\\!\\%\\^\\&\\*\\(\\)\\-\\+\\=\\~\\|\\<\\>\\?\\/\\;\\,\\.]", PaletteIndex::Punctuation));
+static void appendGlyphsToStdStr(std::string &buf, const CodeEdit::Line &line, int begin = 0, int end = -1) {
+	if (end < 0 || end > (int)line.size())
+		end = (int)line.size();
+	if (begin < end)
+		appendGlyphsToStdStr(buf, line.data() + begin, line.data() + end);
+}
 
-		langDef.commentStart = "/*";
-		langDef.commentEnd = "*/";
+static CodeEdit::Coordinates advanceUtf8Text(CodeEdit::Coordinates pos, const std::string &txt) {
+	// Skips '\r' as inserting does.
+	const char* str = txt.c_str();
+	while (*str != '\0') {
+		if (*str == '\n') {
+			++pos.line;
+			pos.column = 0;
+		} else if (*str != '\r') {
+			++pos.column;
+		}
+		str += std::max(expectUtf8Char(str), 1);
+	}
 
-		langDef.caseSensitive = true;
+	return pos;
+}
 
-		langDef.name = "AngelScript";
+static int countTrailingZeros(unsigned x) {
+#if defined _MSC_VER
+	unsigned long idx = 0;
+	_BitScanForward(&idx, x);
 
-		inited = true;
+	return (int)idx;
+#else /* _MSC_VER */
+	return __builtin_ctz(x);
+#endif /* _MSC_VER */
+}
+
+static const char* skipPlainAscii(const char* p, const char* end) {
+	// Stops at a line break or a non-ASCII byte, checks 16 bytes at once if possible.
+#if CODE_EDIT_SSE2
+	const __m128i lf = _mm_set1_epi8('\n');
+	const __m128i cr = _mm_set1_epi8('\r');
+	while (end - p >= 16) {
+		const __m128i v = _mm_loadu_si128((const __m128i*)p);
+		const int mask = _mm_movemask_epi8(_mm_or_si128(v, _mm_or_si128(_mm_cmpeq_epi8(v, lf), _mm_cmpeq_epi8(v, cr))));
+		if (mask)
+			return p + countTrailingZeros((unsigned)mask);
+		p += 16;
 	}
+#endif /* CODE_EDIT_SSE2 */
+	while (p < end && (unsigned char)*p < 0x80 && *p != '\n' && *p != '\r')
+		++p;
 
-	return langDef;
+	return p;
 }
 
-CodeEdit::LanguageDefinition CodeEdit::LanguageDefinition::C(void) {
-	static bool inited = false;
-	static LanguageDefinition langDef;
-	if (!inited) {
-		static const char* const keywords[] = {
-			"auto", "break", "case", "char", "const", "continue", "default", "do", "double", "else", "enum", "extern", "float", "for", "goto", "if", "inline", "int", "long", "register", "restrict", "return", "short",
-			"signed", "sizeof", "static", "struct", "switch", "typedef", "union", "unsigned", "void", "volatile", "while", "_Alignas", "_Alignof", "_Atomic", "_Bool", "_Complex", "_Generic", "_Imaginary",
-			"_Noreturn", "_Static_assert", "_Thread_local"
-		};
-		for (const char* const k : keywords)
-			langDef.keys.insert(k);
+static int measureUtf8Char(const char* str, const char* end) {
+	// Length of a well-formed sequence, 0 if malformed, -1 if cut off by the end.
+	const unsigned char* p = (const unsigned char*)str;
+	const unsigned char c = p[0];
+	int n = 0;
+	unsigned char lo = 0x80, hi = 0xbf; // Of the second byte, others are always within 0x80-0xbf.
+	if (c < 0x80) {
+		return 1;
+	} else if (c >= 0xc2 && c <= 0xdf) {
+		n = 2;
+	} else if (c == 0xe0) {
+		n = 3;
+		lo = 0xa0;
+	} else if (c == 0xed) {
+		n = 3;
+		hi = 0x9f;
+	} else if (c >= 0xe1 && c <= 0xef) {
+		n = 3;
+	} else if (c == 0xf0) {
+		n = 4;
+		lo = 0x90;
+	} else if (c == 0xf4) {
+		n = 4;
+		hi = 0x8f;
+	} else if (c >= 0xf1 && c <= 0xf3) {
+		n = 4;
+	} else {
+		return 0;
+	}
+	for (int i = 1; i < n; ++i) {
+		if ((const char*)p + i >= end)
+			return -1;
+		if (p[i] < (i == 1 ? lo : 0x80) || p[i] > (i == 1 ? hi : 0xbf))
+			return 0;
+	}
 
-		static const char* const identifiers[] = {
-			"abort", "abs", "acos", "asin", "atan", "atexit", "atof", "atoi", "atol", "ceil", "clock", "cosh", "ctime", "div", "exit", "fabs", "floor", "fmod", "getchar", "getenv", "isalnum", "isalpha", "isdigit", "isgraph",
-			"ispunct", "isspace", "isupper", "kbhit", "log10", "log2", "log", "memcmp", "modf", "pow", "putchar", "putenv", "puts", "rand", "remove", "rename", "sinh", "sqrt", "srand", "strcat", "strcmp", "strerror", "time", "tolower", "toupper"
-		};
-		for (const char* const k : identifiers) {
-			Identifier id;
-			id.declaration = "Built-in function";
-			langDef.ids.insert(std::make_pair(std::string(k), id));
+	return n;
+}
+
+static void appendUtf8CodePoint(std::string &buf, unsigned cp) {
+	if (cp < 0x80) {
+		buf.push_back((char)cp);
+	} else if (cp < 0x800) {
+		buf.push_back((char)(0xc0 | (cp >> 6)));
+		buf.push_back((char)(0x80 | (cp & 0x3f)));
+	} else if (cp < 0x10000) {
+		buf.push_back((char)(0xe0 | (cp >> 12)));
+		buf.push_back((char)(0x80 | ((cp >> 6) & 0x3f)));
+		buf.push_back((char)(0x80 | (cp & 0x3f)));
+	} else {
+		buf.push_back((char)(0xf0 | (cp >> 18)));
+		buf.push_back((char)(0x80 | ((cp >> 12) & 0x3f)));
+		buf.push_back((char)(0x80 | ((cp >> 6) & 0x3f)));
+		buf.push_back((char)(0x80 | (cp & 0x3f)));
+	}
+}
+
+static const char* transcodeUtf16ToUtf8(std::string &buf, const char* str, const char* end, bool bigEndian, bool last) {
+	// Unpaired surrogates become U+FFFD, returns where an incomplete unit or pair begins.
+	const unsigned char* p = (const unsigned char*)str;
+	const unsigned char* e = (const unsigned char*)end;
+	auto unit = [bigEndian] (const unsigned char* u) -> unsigned {
+		return bigEndian ? (unsigned)((u[0] << 8) | u[1]) : (unsigned)(u[0] | (u[1] << 8));
+	};
+	while (e - p >= 2) {
+		unsigned cp = unit(p);
+		int n = 2;
+		if (cp >= 0xd800 && cp <= 0xdbff) {
+			if (e - p < 4 && !last)
+				break;
+			const unsigned low = e - p >= 4 ? unit(p + 2) : 0;
+			if (low >= 0xdc00 && low <= 0xdfff) {
+				cp = 0x10000 + ((cp - 0xd800) << 10) + (low - 0xdc00);
+				n = 4;
+			} else {
+				cp = 0xfffd;
+			}
+		} else if (cp >= 0xdc00 && cp <= 0xdfff) {
+			cp = 0xfffd;
 		}
+		appendUtf8CodePoint(buf, cp);
+		p += n;
+	}
+	if (last)
+		p = e; // Drops an odd byte at the end.
 
-		langDef.tokenRegexPatterns.push_back(std::make_pair<std::string, PaletteIndex>("//.*", PaletteIndex::Comment));
-		langDef.tokenRegexPatterns.push_back(std::make_pair<std::string, PaletteIndex>("[ \t]*#[ \\t]*[a-zA-Z_]+", PaletteIndex::Preprocessor));
-		langDef.tokenRegexPatterns.push_back(std::make_pair<std::string, PaletteIndex>("L?\\\"(\\\\.|[^\\\"])*\\\"", PaletteIndex::String));
-		langDef.tokenRegexPatterns.push_back(std::make_pair<std::string, PaletteIndex>("\\'\\\\?[^\\']\\'", PaletteIndex::CharLiteral));
-		langDef.tokenRegexPatterns.push_back(std::make_pair<std::string, PaletteIndex>("[+-]?([0-9]+([.][0-9]*)?|[.][0-9]+)([eE][+-]?[0-9]+)?[fF]?", PaletteIndex::Number));
-		langDef.tokenRegexPatterns.push_back(std::make_pair<std::string, PaletteIndex>("[+-]?[0-9]+[Uu]?[lL]?[lL]?", PaletteIndex::Number));
-		langDef.tokenRegexPatterns.push_back(std::make_pair<std::string, PaletteIndex>("0[0-7]+[Uu]?[lL]?[lL]?", PaletteIndex::Number));
-		langDef.tokenRegexPatterns.push_back(std::make_pair<std::string, PaletteIndex>("0[xX][0-9a-fA-F]+[uU]?[lL]?[lL]?", PaletteIndex::Number));
-		langDef.tokenRegexPatterns.push_back(std::make_pair<std::string, PaletteIndex>("[a-zA-Z_][a-zA-Z0-9_]*", PaletteIndex::Identifier));
-		langDef.tokenRegexPatterns.push_back(std::make_pair<std::string, PaletteIndex>("[\\[\\]\\{\\}\\!\\%\\^\\&\\*\\(\\)\\-\\+\\=\\~\\|\\<\\>\\?\\/\\;\\,\\.]", PaletteIndex::Punctuation));
+	return (const char*)p;
+}
 
-		langDef.commentStart = "/*";
-		langDef.commentEnd = "*/";
+static void transcodeUtf8ToUtf16(std::string &buf, const char* str, const char* end, bool bigEndian) {
+	// Malformed bytes are taken as Latin-1, as they are shown.
+	auto unit = [&] (unsigned u) {
+		buf.push_back((char)(bigEndian ? u >> 8 : u & 0xff));
+		buf.push_back((char)(bigEndian ? u & 0xff : u >> 8));
+	};
+	while (str < end) {
+		const unsigned char* p = (const unsigned char*)str;
+		const int n = measureUtf8Char(str, end);
+		unsigned cp = p[0];
+		if (n == 2)
+			cp = ((p[0] & 0x1f) << 6) | (p[1] & 0x3f);
+		else if (n == 3)
+			cp = ((p[0] & 0x0f) << 12) | ((p[1] & 0x3f) << 6) | (p[2] & 0x3f);
+		else if (n == 4)
+			cp = ((p[0] & 0x07) << 18) | ((p[1] & 0x3f) << 12) | ((p[2] & 0x3f) << 6) | (p[3] & 0x3f);
+		if (cp >= 0x10000) {
+			unit(0xd800 + ((cp - 0x10000) >> 10));
+			unit(0xdc00 + ((cp - 0x10000) & 0x3ff));
+		} else {
+			unit(cp);
+		}
+		str += n > 0 ? n : 1;
+	}
+}
 
-		langDef.caseSensitive = true;
+struct TextDecoder {
+	CodeEdit::TextEncoding encoding = CodeEdit::TextEncoding::Utf8; // Told by the byte order mark.
+	const char* newLine = nullptr; // The first line break met, nullptr if none.
+	bool started = false;
+	std::string transcoded; // UTF-16 input converted to UTF-8, but not split yet.
+
+	// Appends the text to the last line, returns where it stopped, the rest is to be
+	// given again with more input unless it's the last part.
+	const char* decode(CodeEdit::Lines &lines, const char* begin, const char* end, bool last) {
+		if (!started) {
+			if (end - begin < 3 && !last)
+				return begin;
+
+			started = true;
+			const unsigned char* u = (const unsigned char*)begin;
+			if (end - begin >= 3 && u[0] == 0xef && u[1] == 0xbb && u[2] == 0xbf) {
+				encoding = CodeEdit::TextEncoding::Utf8Bom;
+				begin += 3;
+			} else if (end - begin >= 2 && u[0] == 0xff && u[1] == 0xfe) {
+				encoding = CodeEdit::TextEncoding::Utf16LE;
+				begin += 2;
+			} else if (end - begin >= 2 && u[0] == 0xfe && u[1] == 0xff) {
+				encoding = CodeEdit::TextEncoding::Utf16BE;
+				begin += 2;
+			}
+		}
+		if (encoding != CodeEdit::TextEncoding::Utf16LE && encoding != CodeEdit::TextEncoding::Utf16BE)
+			return split(lines, begin, end, last);
 
-		langDef.name = "C";
+		const char* stop = transcodeUtf16ToUtf8(transcoded, begin, end, encoding == CodeEdit::TextEncoding::Utf16BE, last);
+		const char* rest = split(lines, transcoded.c_str(), transcoded.c_str() + transcoded.length(), last);
+		transcoded.erase(0, rest - transcoded.c_str());
 
-		inited = true;
+		return stop;
 	}
 
-	return langDef;
-}
+	const char* split(CodeEdit::Lines &lines, const char* p, const char* end, bool last) {
+		// Breaks lines at "\r\n", '\n' or '\r', keeps malformed bytes as single glyphs.
+		while (p < end) {
+			const char* q = skipPlainAscii(p, end);
+			if (q != p) {
+				CodeEdit::Line &line = lines.back();
+				const size_t n = line.size() + (q - p);
+				if (line.capacity() < n)
+					line.reserve(std::max(n, line.capacity() * 2));
+				for (; p < q; ++p)
+					line.push_back(CodeEdit::Glyph((CodeEdit::Char)(unsigned char)*p, CodeEdit::PaletteIndex::Default));
+				if (p == end)
+					break;
+			}
 
-CodeEdit::LanguageDefinition CodeEdit::LanguageDefinition::CPlusPlus(void) {
-	static bool inited = false;
-	static LanguageDefinition langDef;
-	if (!inited) {
-		static const char* const cppKeywords[] = {
-			"alignas", "alignof", "and", "and_eq", "asm", "atomic_cancel", "atomic_commit", "atomic_noexcept", "auto", "bitand", "bitor", "bool", "break", "case", "catch", "char", "char16_t", "char32_t", "class",
-			"compl", "concept", "const", "constexpr", "const_cast", "continue", "decltype", "default", "delete", "do", "double", "dynamic_cast", "else", "enum", "explicit", "export", "extern", "false", "float",
-			"for", "friend", "goto", "if", "import", "inline", "int", "long", "module", "mutable", "namespace", "new", "noexcept", "not", "not_eq", "nullptr", "operator", "or", "or_eq", "private", "protected", "public",
-			"register", "reinterpret_cast", "requires", "return", "short", "signed", "sizeof", "static", "static_assert", "static_cast", "struct", "switch", "synchronized", "template", "this", "thread_local",
-			"throw", "true", "try", "typedef", "typeid", "typename", "union", "unsigned", "using", "virtual", "void", "volatile", "wchar_t", "while", "xor", "xor_eq"
-		};
-		for (const char* const k : cppKeywords)
-			langDef.keys.insert(k);
+			if (*p == '\n') {
+				breakLine(lines, "\n");
+				++p;
+			} else if (*p == '\r') {
+				if (p + 1 == end && !last)
+					break;
 
-		static const char* const identifiers[] = {
-			"abort", "abs", "acos", "asin", "atan", "atexit", "atof", "atoi", "atol", "ceil", "clock", "cosh", "ctime", "div", "exit", "fabs", "floor", "fmod", "getchar", "getenv", "isalnum", "isalpha", "isdigit", "isgraph",
-			"ispunct", "isspace", "isupper", "kbhit", "log10", "log2", "log", "memcmp", "modf", "pow", "printf", "sprintf", "snprintf", "putchar", "putenv", "puts", "rand", "remove", "rename", "sinh", "sqrt", "srand", "strcat", "strcmp", "strerror", "time", "tolower", "toupper",
-			"std", "string", "vector", "map", "unordered_map", "set", "unordered_set", "min", "max"
-		};
-		for (const char* const k : identifiers) {
-			Identifier id;
-			id.declaration = "Built-in function";
-			langDef.ids.insert(std::make_pair(std::string(k), id));
+				if (p + 1 < end && p[1] == '\n') {
+					breakLine(lines, "\r\n");
+					p += 2;
+				} else {
+					breakLine(lines, "\r");
+					++p;
+				}
+			} else {
+				int n = measureUtf8Char(p, end);
+				if (n < 0 && !last)
+					break;
+
+				if (n <= 0)
+					n = 1;
+				lines.back().push_back(CodeEdit::Glyph(takeUtf8Bytes(p, n), CodeEdit::PaletteIndex::Default));
+				p += n;
+			}
 		}
 
-		langDef.tokenRegexPatterns.push_back(std::make_pair<std::string, PaletteIndex>("//.*", PaletteIndex::Comment));
-		langDef.tokenRegexPatterns.push_back(std::make_pair<std::string, PaletteIndex>("[ \t]*#[ \\t]*[a-zA-Z_]+", PaletteIndex::Preprocessor));
-		langDef.tokenRegexPatterns.push_back(std::make_pair<std::string, PaletteIndex>("L?\\\"(\\\\.|[^\\\"])*\\\"", PaletteIndex::String));
-		langDef.tokenRegexPatterns.push_back(std::make_pair<std::string, PaletteIndex>("\\'\\\\?[^\\']\\'", PaletteIndex::CharLiteral));
-		langDef.tokenRegexPatterns.push_back(std::make_pair<std::string, PaletteIndex>("0[xX][0-9a-fA-F]+[uU]?[lL]?[lL]?", PaletteIndex::Number));
-		langDef.tokenRegexPatterns.push_back(std::make_pair<std::string, PaletteIndex>("[+-]?([0-9]+([.][0-9]*)?|[.][0-9]+)([eE][+-]?[0-9]+)?[fF]?", PaletteIndex::Number));
-		langDef.tokenRegexPatterns.push_back(std::make_pair<std::string, PaletteIndex>("0[0-7]+[Uu]?[lL]?[lL]?", PaletteIndex::Number));
-		langDef.tokenRegexPatterns.push_back(std::make_pair<std::string, PaletteIndex>("[+-]?[0-9]+[Uu]?[lL]?[lL]?", PaletteIndex::Number));
-		langDef.tokenRegexPatterns.push_back(std::make_pair<std::string, PaletteIndex>("[a-zA-Z_][a-zA-Z0-9_]*", PaletteIndex::Identifier));
-		langDef.tokenRegexPatterns.push_back(std::make_pair<std::string, PaletteIndex>("[\\[\\]\\{\\}\\!\\%\\^\\&\\*\\(\\)\\-\\+\\=\\~\\|\\<\\>\\?\\/\\;\\,\\.]", PaletteIndex::Punctuation));
+		return p;
+	}
 
-		langDef.commentStart = "/*";
-		langDef.commentEnd = "*/";
+	void breakLine(CodeEdit::Lines &lines, const char* nl) {
+		if (newLine == nullptr)
+			newLine = nl;
+		lines.push_back(CodeEdit::Line(lines.back().get_allocator()));
+	}
+};
 
-		langDef.caseSensitive = true;
+static void countLineWidth(std::map<int, int> &widths, int width, int diff) {
+	int &count = widths[width];
+	count += diff;
+	if (count <= 0)
+		widths.erase(width);
+}
 
-		langDef.name = "C++";
+static bool isCodeGlyph(const CodeEdit::Glyph &g) {
+	return !g.multiLineComment &&
+		g.colorIndex != CodeEdit::PaletteIndex::Comment && g.colorIndex != CodeEdit::PaletteIndex::String && g.colorIndex != CodeEdit::PaletteIndex::CharLiteral;
+}
 
-		inited = true;
-	}
+static bool isOpeningBracket(CodeEdit::Char c) {
+	return c == '(' || c == '[' || c == '{';
+}
 
-	return langDef;
+static bool isClosingBracket(CodeEdit::Char c) {
+	return c == ')' || c == ']' || c == '}';
 }
 
-CodeEdit::LanguageDefinition CodeEdit::LanguageDefinition::GLSL(void) {
-	static bool inited = false;
-	static LanguageDefinition langDef;
-	if (!inited) {
-		static const char* const keywords[] = {
-			"auto", "break", "case", "char", "const", "continue", "default", "do", "double", "else", "enum", "extern", "float", "for", "goto", "if", "inline", "int", "long", "register", "restrict", "return", "short",
-			"signed", "sizeof", "static", "struct", "switch", "typedef", "union", "unsigned", "void", "volatile", "while", "_Alignas", "_Alignof", "_Atomic", "_Bool", "_Complex", "_Generic", "_Imaginary",
-			"_Noreturn", "_Static_assert", "_Thread_local"
-		};
-		for (const char* const k : keywords)
-			langDef.keys.insert(k);
+static bool isBracketPair(CodeEdit::Char open, CodeEdit::Char close) {
+	return (open == '(' && close == ')') || (open == '[' && close == ']') || (open == '{' && close == '}');
+}
 
-		static const char* const identifiers[] = {
-			"abort", "abs", "acos", "asin", "atan", "atexit", "atof", "atoi", "atol", "ceil", "clock", "cosh", "ctime", "div", "exit", "fabs", "floor", "fmod", "getchar", "getenv", "isalnum", "isalpha", "isdigit", "isgraph",
-			"ispunct", "isspace", "isupper", "kbhit", "log10", "log2", "log", "memcmp", "modf", "pow", "putchar", "putenv", "puts", "rand", "remove", "rename", "sinh", "sqrt", "srand", "strcat", "strcmp", "strerror", "time", "tolower", "toupper"
-		};
-		for (const char* const k : identifiers) {
-			Identifier id;
-			id.declaration = "Built-in function";
-			langDef.ids.insert(std::make_pair(std::string(k), id));
-		}
+static std::pair<int, int> combineBrackets(const std::pair<int, int> &left, const std::pair<int, int> &right) {
+	// The opening brackets on the left are closed by the closing ones on the right.
+	const int matched = std::min(left.second, right.first);
 
-		langDef.tokenRegexPatterns.push_back(std::make_pair<std::string, PaletteIndex>("//.*", PaletteIndex::Comment));
-		langDef.tokenRegexPatterns.push_back(std::make_pair<std::string, PaletteIndex>("[ \t]*#[ \\t]*[a-zA-Z_]+", PaletteIndex::Preprocessor));
-		langDef.tokenRegexPatterns.push_back(std::make_pair<std::string, PaletteIndex>("L?\\\"(\\\\.|[^\\\"])*\\\"", PaletteIndex::String));
-		langDef.tokenRegexPatterns.push_back(std::make_pair<std::string, PaletteIndex>("\\'\\\\?[^\\']\\'", PaletteIndex::CharLiteral));
-		langDef.tokenRegexPatterns.push_back(std::make_pair<std::string, PaletteIndex>("[+-]?([0-9]+([.][0-9]*)?|[.][0-9]+)([eE][+-]?[0-9]+)?[fF]?", PaletteIndex::Number));
-		langDef.tokenRegexPatterns.push_back(std::make_pair<std::string, PaletteIndex>("[+-]?[0-9]+[Uu]?[lL]?[lL]?", PaletteIndex::Number));
-		langDef.tokenRegexPatterns.push_back(std::make_pair<std::string, PaletteIndex>("0[0-7]+[Uu]?[lL]?[lL]?", PaletteIndex::Number));
-		langDef.tokenRegexPatterns.push_back(std::make_pair<std::string, PaletteIndex>("0[xX][0-9a-fA-F]+[uU]?[lL]?[lL]?", PaletteIndex::Number));
-		langDef.tokenRegexPatterns.push_back(std::make_pair<std::string, PaletteIndex>("[a-zA-Z_][a-zA-Z0-9_]*", PaletteIndex::Identifier));
-		langDef.tokenRegexPatterns.push_back(std::make_pair<std::string, PaletteIndex>("[\\[\\]\\{\\}\\!\\%\\^\\&\\*\\(\\)\\-\\+\\=\\~\\|\\<\\>\\?\\/\\;\\,\\.]", PaletteIndex::Punctuation));
+	return std::make_pair(left.first + right.first - matched, left.second + right.second - matched);
+}
 
-		langDef.commentStart = "/*";
-		langDef.commentEnd = "*/";
+static int addCounts(const int &left, const int &right) {
+	return left + right;
+}
 
-		langDef.caseSensitive = true;
+template<typename T, T (*Combine)(const T &, const T &)> struct SequenceTree {
+	// Implicit treap, items are ordered by position instead of keys so that inserting
+	// or erasing some shifts the ones after them in logarithmic time. Each node holds
+	// the combination of its subtree, `T()` combines as identity.
+	struct Node {
+		T value;
+		T sum;
+		int size = 1;
+		int left = -1;
+		int right = -1;
+		unsigned priority = 0;
+	};
 
-		langDef.name = "GLSL";
+	std::vector<Node> nodes;
+	std::vector<int> freed; // Indices of released nodes.
+	int root = -1;
+	unsigned seed = 2463534242u;
 
-		inited = true;
+	int size(void) const {
+		return sizeOf(root);
 	}
 
-	return langDef;
-}
+	void clear(void) {
+		nodes.clear();
+		freed.clear();
+		root = -1;
+	}
 
-CodeEdit::LanguageDefinition CodeEdit::LanguageDefinition::HLSL(void) {
-	static bool inited = false;
-	static LanguageDefinition langDef;
-	if (!inited) {
-		static const char* const keywords[] = {
-			"AppendStructuredBuffer", "asm", "asm_fragment", "BlendState", "bool", "break", "Buffer", "ByteAddressBuffer", "case", "cbuffer", "centroid", "class", "column_major", "compile", "compile_fragment",
-			"CompileShader", "const", "continue", "ComputeShader", "ConsumeStructuredBuffer", "default", "DepthStencilState", "DepthStencilView", "discard", "do", "double", "DomainShader", "dword", "else",
-			"export", "extern", "false", "float", "for", "fxgroup", "GeometryShader", "groupshared", "half", "Hullshader", "if", "in", "inline", "inout", "InputPatch", "int", "interface", "line", "lineadj",
-			"linear", "LineStream", "matrix", "min16float", "min10float", "min16int", "min12int", "min16uint", "namespace", "nointerpolation", "noperspective", "NULL", "out", "OutputPatch", "packoffset",
-			"pass", "pixelfragment", "PixelShader", "point", "PointStream", "precise", "RasterizerState", "RenderTargetView", "return", "register", "row_major", "RWBuffer", "RWByteAddressBuffer", "RWStructuredBuffer",
-			"RWTexture1D", "RWTexture1DArray", "RWTexture2D", "RWTexture2DArray", "RWTexture3D", "sample", "sampler", "SamplerState", "SamplerComparisonState", "shared", "snorm", "stateblock", "stateblock_state",
-			"static", "string", "struct", "switch", "StructuredBuffer", "tbuffer", "technique", "technique10", "technique11", "texture", "Texture1D", "Texture1DArray", "Texture2D", "Texture2DArray", "Texture2DMS",
-			"Texture2DMSArray", "Texture3D", "TextureCube", "TextureCubeArray", "true", "typedef", "triangle", "triangleadj", "TriangleStream", "uint", "uniform", "unorm", "unsigned", "vector", "vertexfragment",
-			"VertexShader", "void", "volatile", "while",
-			"bool1","bool2","bool3","bool4","double1","double2","double3","double4", "float1", "float2", "float3", "float4", "int1", "int2", "int3", "int4", "in", "out", "inout",
-			"uint1", "uint2", "uint3", "uint4", "dword1", "dword2", "dword3", "dword4", "half1", "half2", "half3", "half4",
-			"float1x1","float2x1","float3x1","float4x1","float1x2","float2x2","float3x2","float4x2",
-			"float1x3","float2x3","float3x3","float4x3","float1x4","float2x4","float3x4","float4x4",
-			"half1x1","half2x1","half3x1","half4x1","half1x2","half2x2","half3x2","half4x2",
-			"half1x3","half2x3","half3x3","half4x3","half1x4","half2x4","half3x4","half4x4",
-		};
-		for (const char* const k : keywords)
-			langDef.keys.insert(k);
+	template<typename ValueAt> void assign(int count, ValueAt valueAt) {
+		// Builds balanced at once, priorities decrease with the depth.
+		clear();
+		nodes.reserve(count);
+		int levels = 1;
+		while ((1 << levels) <= count)
+			++levels;
+		root = build(0, count, 0, levels, valueAt);
+	}
 
-		static const char* const identifiers[] = {
-			"abort", "abs", "acos", "all", "AllMemoryBarrier", "AllMemoryBarrierWithGroupSync", "any", "asdouble", "asfloat", "asin", "asint", "asint", "asuint",
-			"asuint", "atan", "atan2", "ceil", "CheckAccessFullyMapped", "clamp", "clip", "cos", "cosh", "countbits", "cross", "D3DCOLORtoUBYTE4", "ddx",
-			"ddx_coarse", "ddx_fine", "ddy", "ddy_coarse", "ddy_fine", "degrees", "determinant", "DeviceMemoryBarrier", "DeviceMemoryBarrierWithGroupSync",
-			"distance", "dot", "dst", "errorf", "EvaluateAttributeAtCentroid", "EvaluateAttributeAtSample", "EvaluateAttributeSnapped", "exp", "exp2",
-			"f16tof32", "f32tof16", "faceforward", "firstbithigh", "firstbitlow", "floor", "fma", "fmod", "frac", "frexp", "fwidth", "GetRenderTargetSampleCount",
-			"GetRenderTargetSamplePosition", "GroupMemoryBarrier", "GroupMemoryBarrierWithGroupSync", "InterlockedAdd", "InterlockedAnd", "InterlockedCompareExchange",
-			"InterlockedCompareStore", "InterlockedExchange", "InterlockedMax", "InterlockedMin", "InterlockedOr", "InterlockedXor", "isfinite", "isinf", "isnan",
-			"ldexp", "length", "lerp", "lit", "log", "log10", "log2", "mad", "max", "min", "modf", "msad4", "mul", "noise", "normalize", "pow", "printf",
-			"Process2DQuadTessFactorsAvg", "Process2DQuadTessFactorsMax", "Process2DQuadTessFactorsMin", "ProcessIsolineTessFactors", "ProcessQuadTessFactorsAvg",
-			"ProcessQuadTessFactorsMax", "ProcessQuadTessFactorsMin", "ProcessTriTessFactorsAvg", "ProcessTriTessFactorsMax", "ProcessTriTessFactorsMin",
-			"radians", "rcp", "reflect", "refract", "reversebits", "round", "rsqrt", "saturate", "sign", "sin", "sincos", "sinh", "smoothstep", "sqrt", "step",
-			"tan", "tanh", "tex1D", "tex1D", "tex1Dbias", "tex1Dgrad", "tex1Dlod", "tex1Dproj", "tex2D", "tex2D", "tex2Dbias", "tex2Dgrad", "tex2Dlod", "tex2Dproj",
-			"tex3D", "tex3D", "tex3Dbias", "tex3Dgrad", "tex3Dlod", "tex3Dproj", "texCUBE", "texCUBE", "texCUBEbias", "texCUBEgrad", "texCUBElod", "texCUBEproj", "transpose", "trunc"
-		};
-		for (const char* const k : identifiers) {
-			Identifier id;
-			id.declaration = "Built-in function";
-			langDef.ids.insert(std::make_pair(std::string(k), id));
+	void insert(int pos, int count, const T &value) {
+		if (count <= 0)
+			return;
+
+		int chunk = -1;
+		for (int i = 0; i < count; ++i)
+			chunk = merge(chunk, allocate(value, random()));
+		int left = -1, right = -1;
+		split(root, pos, left, right);
+		root = merge(merge(left, chunk), right);
+	}
+
+	void erase(int pos, int count) {
+		if (count <= 0)
+			return;
+
+		int left = -1, middle = -1, right = -1;
+		split(root, pos, left, right);
+		split(right, count, middle, right);
+		release(middle);
+		root = merge(left, right);
+	}
+
+	const T &at(int pos) const {
+		int node = root;
+		for (;;) {
+			const Node &n = nodes[node];
+			const int left = sizeOf(n.left);
+			if (pos == left)
+				return n.value;
+			if (pos < left) {
+				node = n.left;
+			} else {
+				pos -= left + 1;
+				node = n.right;
+			}
 		}
+	}
 
-		langDef.tokenRegexPatterns.push_back(std::make_pair<std::string, PaletteIndex>("//.*", PaletteIndex::Comment));
-		langDef.tokenRegexPatterns.push_back(std::make_pair<std::string, PaletteIndex>("[ \t]*#[ \\t]*[a-zA-Z_]+", PaletteIndex::Preprocessor));
-		langDef.tokenRegexPatterns.push_back(std::make_pair<std::string, PaletteIndex>("L?\\\"(\\\\.|[^\\\"])*\\\"", PaletteIndex::String));
-		langDef.tokenRegexPatterns.push_back(std::make_pair<std::string, PaletteIndex>("\\'\\\\?[^\\']\\'", PaletteIndex::CharLiteral));
-		langDef.tokenRegexPatterns.push_back(std::make_pair<std::string, PaletteIndex>("[+-]?([0-9]+([.][0-9]*)?|[.][0-9]+)([eE][+-]?[0-9]+)?[fF]?", PaletteIndex::Number));
-		langDef.tokenRegexPatterns.push_back(std::make_pair<std::string, PaletteIndex>("[+-]?[0-9]+[Uu]?[lL]?[lL]?", PaletteIndex::Number));
-		langDef.tokenRegexPatterns.push_back(std::make_pair<std::string, PaletteIndex>("0[0-7]+[Uu]?[lL]?[lL]?", PaletteIndex::Number));
-		langDef.tokenRegexPatterns.push_back(std::make_pair<std::string, PaletteIndex>("0[xX][0-9a-fA-F]+[uU]?[lL]?[lL]?", PaletteIndex::Number));
-		langDef.tokenRegexPatterns.push_back(std::make_pair<std::string, PaletteIndex>("[a-zA-Z_][a-zA-Z0-9_]*", PaletteIndex::Identifier));
-		langDef.tokenRegexPatterns.push_back(std::make_pair<std::string, PaletteIndex>("[\\[\\]\\{\\}\\!\\%\\^\\&\\*\\(\\)\\-\\+\\=\\~\\|\\<\\>\\?\\/\\;\\,\\.]", PaletteIndex::Punctuation));
+	void set(int pos, const T &value) {
+		update(root, pos, value);
+	}
 
-		langDef.commentStart = "/*";
-		langDef.commentEnd = "*/";
+	T prefix(int count) const {
+		// Combination of the first `count` items.
+		T result = T();
+		int node = root;
+		while (node >= 0 && count > 0) {
+			const Node &n = nodes[node];
+			const int left = sizeOf(n.left);
+			if (count <= left) {
+				node = n.left;
+			} else {
+				if (n.left >= 0)
+					result = Combine(result, nodes[n.left].sum);
+				result = Combine(result, n.value);
+				count -= left + 1;
+				node = n.right;
+			}
+		}
 
-		langDef.caseSensitive = true;
+		return result;
+	}
 
-		langDef.name = "HLSL";
+	template<typename Pred> int find(int from, Pred pred, T &before) {
+		// First position from `from` where the items since `from` up to it satisfy the
+		// predicate, which stays satisfied once it is; the size if none. `before` is the
+		// combination of the items from `from` up to the result.
+		int left = -1, right = -1;
+		split(root, from, left, right);
+		T acc = T();
+		int pos = from;
+		int node = right;
+		while (node >= 0) {
+			const Node &n = nodes[node];
+			if (n.left >= 0) {
+				const T sum = Combine(acc, nodes[n.left].sum);
+				if (pred(sum)) {
+					node = n.left;
+
+					continue;
+				}
+				acc = sum;
+				pos += nodes[n.left].size;
+			}
+			const T sum = Combine(acc, n.value);
+			if (pred(sum))
+				break;
+			acc = sum;
+			++pos;
+			node = n.right;
+		}
+		root = merge(left, right);
+		before = acc;
 
-		inited = true;
+		return pos;
 	}
 
-	return langDef;
-}
+	template<typename Pred> int findBackward(int to, Pred pred, T &after) {
+		// Last position before `to` where the items from it up to `to` satisfy the
+		// predicate, which stays satisfied once it is; -1 if none. `after` is the
+		// combination of the items after the result up to `to`.
+		int left = -1, right = -1;
+		split(root, to, left, right);
+		T acc = T();
+		int result = -1;
+		int base = 0; // Position of the first item of the subtree.
+		int node = left;
+		while (node >= 0) {
+			const Node &n = nodes[node];
+			const int pos = base + sizeOf(n.left);
+			if (n.right >= 0) {
+				const T sum = Combine(nodes[n.right].sum, acc);
+				if (pred(sum)) {
+					base = pos + 1;
+					node = n.right;
+
+					continue;
+				}
+				acc = sum;
+			}
+			const T sum = Combine(n.value, acc);
+			if (pred(sum)) {
+				result = pos;
 
-CodeEdit::LanguageDefinition CodeEdit::LanguageDefinition::Lua(void) {
-	static bool inited = false;
-	static LanguageDefinition langDef;
-	if (!inited) {
-		static const char* const keywords[] = {
-			"and", "break", "do", "", "else", "elseif", "end", "false", "for", "function", "if", "in", "", "local", "nil", "not", "or", "repeat", "return", "then", "true", "until", "while"
-		};
+				break;
+			}
+			acc = sum;
+			node = n.left;
+		}
+		root = merge(left, right);
+		after = acc;
 
-		for (const char* const k : keywords)
-			langDef.keys.insert(k);
+		return result;
+	}
 
-		static const char* const identifiers[] = {
-			"assert", "collectgarbage", "dofile", "error", "getmetatable", "ipairs", "loadfile", "load", "loadstring",  "next",  "pairs",  "pcall",  "print",  "rawequal",  "rawlen",  "rawget",  "rawset",
-			"select",  "setmetatable",  "tonumber",  "tostring",  "type",  "xpcall",  "_G",  "_VERSION","arshift", "band", "bnot", "bor", "bxor", "btest", "extract", "lrotate", "lshift", "replace",
-			"rrotate", "rshift", "create", "resume", "running", "status", "wrap", "yield", "isyieldable", "debug","getuservalue", "gethook", "getinfo", "getlocal", "getregistry", "getmetatable",
-			"getupvalue", "upvaluejoin", "upvalueid", "setuservalue", "sethook", "setlocal", "setmetatable", "setupvalue", "traceback", "close", "flush", "input", "lines", "open", "output", "popen",
-			"read", "tmpfile", "type", "write", "close", "flush", "lines", "read", "seek", "setvbuf", "write", "__gc", "__tostring", "abs", "acos", "asin", "atan", "ceil", "cos", "deg", "exp", "tointeger",
-			"floor", "fmod", "ult", "log", "max", "min", "modf", "rad", "random", "randomseed", "sin", "sqrt", "string", "tan", "type", "atan2", "cosh", "sinh", "tanh",
-			"pow", "frexp", "ldexp", "log10", "pi", "huge", "maxinteger", "mininteger", "loadlib", "searchpath", "seeall", "preload", "cpath", "path", "searchers", "loaded", "module", "require", "clock",
-			"date", "difftime", "execute", "exit", "getenv", "remove", "rename", "setlocale", "time", "tmpname", "byte", "char", "dump", "find", "format", "gmatch", "gsub", "len", "lower", "match", "rep",
-			"reverse", "sub", "upper", "pack", "packsize", "unpack", "concat", "maxn", "insert", "pack", "unpack", "remove", "move", "sort", "offset", "codepoint", "char", "len", "codes", "charpattern",
-			"coroutine", "table", "io", "os", "string", "utf8", "bit32", "math", "debug", "package"
-		};
-		for (const char* const k : identifiers) {
-			Identifier id;
-			id.declaration = "Built-in function";
-			langDef.ids.insert(std::make_pair(std::string(k), id));
+	int sizeOf(int node) const {
+		return node < 0 ? 0 : nodes[node].size;
+	}
+
+	unsigned random(void) {
+		seed ^= seed << 13;
+		seed ^= seed >> 17;
+		seed ^= seed << 5;
+
+		return seed;
+	}
+
+	int allocate(const T &value, unsigned priority) {
+		int node = 0;
+		if (freed.empty()) {
+			node = (int)nodes.size();
+			nodes.push_back(Node());
+		} else {
+			node = freed.back();
+			freed.pop_back();
+			nodes[node] = Node();
 		}
+		Node &n = nodes[node];
+		n.value = value;
+		n.sum = value;
+		n.priority = priority;
 
-		langDef.tokenRegexPatterns.push_back(std::make_pair<std::string, PaletteIndex>("\\-\\-.*", PaletteIndex::Comment));
-		langDef.tokenRegexPatterns.push_back(std::make_pair<std::string, PaletteIndex>("L?\\\"(\\\\.|[^\\\"])*\\\"", PaletteIndex::String));
-		langDef.tokenRegexPatterns.push_back(std::make_pair<std::string, PaletteIndex>("\\\'[^\\\']*\\\'", PaletteIndex::String));
-		langDef.tokenRegexPatterns.push_back(std::make_pair<std::string, PaletteIndex>("0[xX][0-9a-fA-F]+[uU]?[lL]?[lL]?", PaletteIndex::Number));
-		langDef.tokenRegexPatterns.push_back(std::make_pair<std::string, PaletteIndex>("[+-]?([0-9]+([.][0-9]*)?|[.][0-9]+)([eE][+-]?[0-9]+)?[fF]?", PaletteIndex::Number));
-		langDef.tokenRegexPatterns.push_back(std::make_pair<std::string, PaletteIndex>("[+-]?[0-9]+[Uu]?[lL]?[lL]?", PaletteIndex::Number));
-		langDef.tokenRegexPatterns.push_back(std::make_pair<std::string, PaletteIndex>("[a-zA-Z_][a-zA-Z0-9_]*", PaletteIndex::Identifier));
-		langDef.tokenRegexPatterns.push_back(std::make_pair<std::string, PaletteIndex>("[\\[\\]\\{\\}\\!\\%\\^\\&\\*\\(\\)\\-\\+\\=\\~\\|\\<\\>\\?\\/\\;\\,\\.]", PaletteIndex::Punctuation));
+		return node;
+	}
+
+	void release(int node) {
+		if (node < 0)
+			return;
 
-		langDef.commentStart = "\\-\\-\\[\\[";
-		langDef.commentEnd = "\\]\\]";
+		release(nodes[node].left);
+		release(nodes[node].right);
+		freed.push_back(node);
+	}
 
-		langDef.caseSensitive = true;
+	void pull(int node) {
+		Node &n = nodes[node];
+		n.size = 1 + sizeOf(n.left) + sizeOf(n.right);
+		n.sum = n.left >= 0 ? Combine(nodes[n.left].sum, n.value) : n.value;
+		if (n.right >= 0)
+			n.sum = Combine(n.sum, nodes[n.right].sum);
+	}
 
-		langDef.name = "Lua";
+	template<typename ValueAt> int build(int first, int last, int depth, int levels, ValueAt &valueAt) {
+		if (first >= last)
+			return -1;
 
-		inited = true;
+		const unsigned band = 0xffffffffu / (unsigned)(levels + 1);
+		const int mid = first + (last - first) / 2;
+		const int node = allocate(valueAt(mid), (unsigned)(levels - depth) * band + random() % band);
+		const int left = build(first, mid, depth + 1, levels, valueAt);
+		const int right = build(mid + 1, last, depth + 1, levels, valueAt);
+		nodes[node].left = left;
+		nodes[node].right = right;
+		pull(node);
+
+		return node;
 	}
 
-	return langDef;
+	void split(int node, int pos, int &left, int &right) {
+		// The first `pos` items go to the left.
+		if (node < 0) {
+			left = right = -1;
+
+			return;
+		}
+
+		Node &n = nodes[node];
+		if (pos <= sizeOf(n.left)) {
+			split(n.left, pos, left, n.left);
+			right = node;
+		} else {
+			split(n.right, pos - sizeOf(n.left) - 1, n.right, right);
+			left = node;
+		}
+		pull(node);
+	}
+
+	int merge(int left, int right) {
+		if (left < 0)
+			return right;
+		if (right < 0)
+			return left;
+
+		if (nodes[left].priority > nodes[right].priority) {
+			const int node = merge(nodes[left].right, right);
+			nodes[left].right = node;
+			pull(left);
+
+			return left;
+		}
+
+		const int node = merge(left, nodes[right].left);
+		nodes[right].left = node;
+		pull(right);
+
+		return right;
+	}
+
+	void update(int node, int pos, const T &value) {
+		const int left = sizeOf(nodes[node].left);
+		if (pos < left)
+			update(nodes[node].left, pos, value);
+		else if (pos > left)
+			update(nodes[node].right, pos - left - 1, value);
+		else
+			nodes[node].value = value;
+		pull(node);
+	}
+};
+
+struct CodeEdit::RowTree : public SequenceTree<int, addCounts> {
+};
+
+struct CodeEdit::BracketTree : public SequenceTree<BracketBalance, combineBrackets> {
+};
+
+struct FoldSpan {
+	int header = 0; // Relative to the header of the previous fold.
+	int end = -1; // Furthest last hidden line, relative to the same.
+	int opens = -1; // Regions the header opens, of this fold alone, -1 if not known.
+	int depth = -1; // Regions still open at the closing line, of this fold alone, -1 if not known.
+};
+
+static FoldSpan combineFolds(const FoldSpan &left, const FoldSpan &right) {
+	FoldSpan result;
+	result.header = left.header + right.header;
+	result.end = std::max(left.end, left.header + right.end);
+
+	return result;
 }
 
-CodeEdit::LanguageDefinition CodeEdit::LanguageDefinition::SQL(void) {
-	static bool inited = false;
-	static LanguageDefinition langDef;
-	if (!inited) {
-		static const char* const keywords[] = {
-			"ADD", "EXCEPT", "PERCENT", "ALL", "EXEC", "PLAN", "ALTER", "EXECUTE", "PRECISION", "AND", "EXISTS", "PRIMARY", "ANY", "EXIT", "PRINT", "AS", "FETCH", "PROC", "ASC", "FILE", "PROCEDURE",
-			"AUTHORIZATION", "FILLFACTOR", "PUBLIC", "BACKUP", "FOR", "RAISERROR", "BEGIN", "FOREIGN", "READ", "BETWEEN", "FREETEXT", "READTEXT", "BREAK", "FREETEXTTABLE", "RECONFIGURE",
-			"BROWSE", "FROM", "REFERENCES", "BULK", "FULL", "REPLICATION", "BY", "FUNCTION", "RESTORE", "CASCADE", "GOTO", "RESTRICT", "CASE", "GRANT", "RETURN", "CHECK", "GROUP", "REVOKE",
-			"CHECKPOINT", "HAVING", "RIGHT", "CLOSE", "HOLDLOCK", "ROLLBACK", "CLUSTERED", "IDENTITY", "ROWCOUNT", "COALESCE", "IDENTITY_INSERT", "ROWGUIDCOL", "COLLATE", "IDENTITYCOL", "RULE",
-			"COLUMN", "IF", "SAVE", "COMMIT", "IN", "SCHEMA", "COMPUTE", "INDEX", "SELECT", "CONSTRAINT", "INNER", "SESSION_USER", "CONTAINS", "INSERT", "SET", "CONTAINSTABLE", "INTERSECT", "SETUSER",
-			"CONTINUE", "INTO", "SHUTDOWN", "CONVERT", "IS", "SOME", "CREATE", "JOIN", "STATISTICS", "CROSS", "KEY", "SYSTEM_USER", "CURRENT", "KILL", "TABLE", "CURRENT_DATE", "LEFT", "TEXTSIZE",
-			"CURRENT_TIME", "LIKE", "THEN", "CURRENT_TIMESTAMP", "LINENO", "TO", "CURRENT_USER", "LOAD", "TOP", "CURSOR", "NATIONAL", "TRAN", "DATABASE", "NOCHECK", "TRANSACTION",
-			"DBCC", "NONCLUSTERED", "TRIGGER", "DEALLOCATE", "NOT", "TRUNCATE", "DECLARE", "NULL", "TSEQUAL", "DEFAULT", "NULLIF", "UNION", "DELETE", "OF", "UNIQUE", "DENY", "OFF", "UPDATE",
-			"DESC", "OFFSETS", "UPDATETEXT", "DISK", "ON", "USE", "DISTINCT", "OPEN", "USER", "DISTRIBUTED", "OPENDATASOURCE", "VALUES", "DOUBLE", "OPENQUERY", "VARYING","DROP", "OPENROWSET", "VIEW",
-			"DUMMY", "OPENXML", "WAITFOR", "DUMP", "OPTION", "WHEN", "ELSE", "OR", "WHERE", "END", "ORDER", "WHILE", "ERRLVL", "OUTER", "WITH", "ESCAPE", "OVER", "WRITETEXT"
-		};
+struct CodeEdit::FoldTree : public SequenceTree<FoldSpan, combineFolds> {
+	// Folds ordered by their headers, each relative to the previous one so that
+	// inserting or removing lines only moves the first fold after them.
+	int lowerBound(int ln) {
+		// Index of the first fold whose header is at or after the line.
+		FoldSpan before;
 
-		for (const char* const k : keywords)
-			langDef.keys.insert(k);
+		return find(0, [ln] (const FoldSpan &span) -> bool { return span.header >= ln; }, before);
+	}
 
-		static const char* const identifiers[] = {
-			"ABS",  "ACOS",  "ADD_MONTHS",  "ASCII",  "ASCIISTR",  "ASIN",  "ATAN",  "ATAN2",  "AVG",  "BFILENAME",  "BIN_TO_NUM",  "BITAND",  "CARDINALITY",  "CASE",  "CAST",  "CEIL",
-			"CHARTOROWID",  "CHR",  "COALESCE",  "COMPOSE",  "CONCAT",  "CONVERT",  "CORR",  "COS",  "COSH",  "COUNT",  "COVAR_POP",  "COVAR_SAMP",  "CUME_DIST",  "CURRENT_DATE",
-			"CURRENT_TIMESTAMP",  "DBTIMEZONE",  "DECODE",  "DECOMPOSE",  "DENSE_RANK",  "DUMP",  "EMPTY_BLOB",  "EMPTY_CLOB",  "EXP",  "EXTRACT",  "FIRST_VALUE",  "FLOOR",  "FROM_TZ",  "GREATEST",
-			"GROUP_ID",  "HEXTORAW",  "INITCAP",  "INSTR",  "INSTR2",  "INSTR4",  "INSTRB",  "INSTRC",  "LAG",  "LAST_DAY",  "LAST_VALUE",  "LEAD",  "LEAST",  "LENGTH",  "LENGTH2",  "LENGTH4",
-			"LENGTHB",  "LENGTHC",  "LISTAGG",  "LN",  "LNNVL",  "LOCALTIMESTAMP",  "LOG",  "LOWER",  "LPAD",  "LTRIM",  "MAX",  "MEDIAN",  "MIN",  "MOD",  "MONTHS_BETWEEN",  "NANVL",  "NCHR",
-			"NEW_TIME",  "NEXT_DAY",  "NTH_VALUE",  "NULLIF",  "NUMTODSINTERVAL",  "NUMTOYMINTERVAL",  "NVL",  "NVL2",  "POWER",  "RANK",  "RAWTOHEX",  "REGEXP_COUNT",  "REGEXP_INSTR",
-			"REGEXP_REPLACE",  "REGEXP_SUBSTR",  "REMAINDER",  "REPLACE",  "ROUND",  "ROWNUM",  "RPAD",  "RTRIM",  "SESSIONTIMEZONE",  "SIGN",  "SIN",  "SINH",
-			"SOUNDEX",  "SQRT",  "STDDEV",  "SUBSTR",  "SUM",  "SYS_CONTEXT",  "SYSDATE",  "SYSTIMESTAMP",  "TAN",  "TANH",  "TO_CHAR",  "TO_CLOB",  "TO_DATE",  "TO_DSINTERVAL",  "TO_LOB",
-			"TO_MULTI_BYTE",  "TO_NCLOB",  "TO_NUMBER",  "TO_SINGLE_BYTE",  "TO_TIMESTAMP",  "TO_TIMESTAMP_TZ",  "TO_YMINTERVAL",  "TRANSLATE",  "TRIM",  "TRUNC", "TZ_OFFSET",  "UID",  "UPPER",
-			"USER",  "USERENV",  "VAR_POP",  "VAR_SAMP",  "VARIANCE",  "VSIZE "
-		};
-		for (const char* const k : identifiers) {
-			Identifier id;
-			id.declaration = "Built-in function";
-			langDef.ids.insert(std::make_pair(std::string(k), id));
+	int headerAt(int i) const {
+		return prefix(i + 1).header;
+	}
+
+	int lastAt(int i) const {
+		const FoldSpan &span = at(i);
+
+		return headerAt(i) - span.header + span.end;
+	}
+
+	void add(int header, int last, int opens, int depth) {
+		const int i = lowerBound(header);
+		const int previous = i > 0 ? headerAt(i - 1) : 0;
+		FoldSpan span;
+		span.header = header - previous;
+		span.end = last - previous;
+		span.opens = opens;
+		span.depth = depth;
+		if (i < size() && headerAt(i) == header) {
+			set(i, span);
+
+			return;
 		}
 
-		langDef.tokenRegexPatterns.push_back(std::make_pair<std::string, PaletteIndex>("\\-\\-.*", PaletteIndex::Comment));
-		langDef.tokenRegexPatterns.push_back(std::make_pair<std::string, PaletteIndex>("L?\\\"(\\\\.|[^\\\"])*\\\"", PaletteIndex::String));
-		langDef.tokenRegexPatterns.push_back(std::make_pair<std::string, PaletteIndex>("\\\'[^\\\']*\\\'", PaletteIndex::String));
-		langDef.tokenRegexPatterns.push_back(std::make_pair<std::string, PaletteIndex>("[+-]?([0-9]+([.][0-9]*)?|[.][0-9]+)([eE][+-]?[0-9]+)?[fF]?", PaletteIndex::Number));
-		langDef.tokenRegexPatterns.push_back(std::make_pair<std::string, PaletteIndex>("[+-]?[0-9]+[Uu]?[lL]?[lL]?", PaletteIndex::Number));
-		langDef.tokenRegexPatterns.push_back(std::make_pair<std::string, PaletteIndex>("0[0-7]+[Uu]?[lL]?[lL]?", PaletteIndex::Number));
-		langDef.tokenRegexPatterns.push_back(std::make_pair<std::string, PaletteIndex>("0[xX][0-9a-fA-F]+[uU]?[lL]?[lL]?", PaletteIndex::Number));
-		langDef.tokenRegexPatterns.push_back(std::make_pair<std::string, PaletteIndex>("[a-zA-Z_][a-zA-Z0-9_]*", PaletteIndex::Identifier));
-		langDef.tokenRegexPatterns.push_back(std::make_pair<std::string, PaletteIndex>("[\\[\\]\\{\\}\\!\\%\\^\\&\\*\\(\\)\\-\\+\\=\\~\\|\\<\\>\\?\\/\\;\\,\\.]", PaletteIndex::Punctuation));
+		move(i, previous - header); // The next one follows the new one.
+		insert(i, 1, span);
+	}
 
-		langDef.commentStart = "/*";
-		langDef.commentEnd = "*/";
+	void removeAt(int i) {
+		const FoldSpan span = at(i);
+		erase(i, 1);
+		move(i, span.header);
+	}
 
-		langDef.caseSensitive = false;
+	void setLast(int i, int last) {
+		// Lines of the region are added or removed, the depths are found again.
+		FoldSpan span = at(i);
+		span.end += last - lastAt(i);
+		span.opens = span.depth = -1;
+		set(i, span);
+	}
 
-		langDef.name = "SQL";
+	void setDepths(int i, int opens, int depth) {
+		FoldSpan span = at(i);
+		span.opens = opens;
+		span.depth = depth;
+		set(i, span);
+	}
 
-		inited = true;
+	void move(int i, int count) {
+		// Moves the fold at the index, and those after it along.
+		if (i >= size())
+			return;
+
+		FoldSpan span = at(i);
+		span.header += count;
+		span.end += count;
+		set(i, span);
 	}
 
-	return langDef;
-}
+	template<typename Fn> void visit(int count, int minLast, Fn fn) const {
+		// Calls `fn(index, header, last)` for the first `count` folds that hide lines
+		// from `minLast` on, skipping subtrees that end before it.
+		visitNode(root, 0, 0, count, minLast, fn);
+	}
 
-CodeEdit::LanguageDefinition CodeEdit::LanguageDefinition::BASIC8(void) {
-	static bool inited = false;
-	static LanguageDefinition langDef;
-	if (!inited) {
-		static const char* const keywords[] = {
-			/* Constants. */
-			"nil", "true", "false",
-			/* Operators. */
-			"mod", "and", "or", "not", "is", "...",
-			/* Keywords. */
-			"let", "dim", "if", "then", "elseif", "else", "endif",
-			"for", "in", "to", "step", "next", "while", "wend", "do", "until", "exit",
-			"goto", "gosub", "return", "call", "def", "enddef",
-			"class", "endclass", "new", "var", "reflect", "lambda",
-			"import", "type",
-			/* Extra keywords. */
-			"typeof"
-		};
+	template<typename Fn> void visitNode(int node, int index, int base, int count, int minLast, Fn &fn) const {
+		if (node < 0 || index >= count)
+			return;
 
-		for (const char* const k : keywords)
-			langDef.keys.insert(k);
+		const Node &n = nodes[node];
+		if (base + n.sum.end < minLast)
+			return;
 
-		static const char* const identifiers[] = {
-			/* Built-in basic. */
-			"abs", "sgn", "sqr", "floor", "ceil", "fix", "round", "srnd", "rnd", "sin", "cos", "tan", "asin", "acos", "atan", "exp", "log",
-			"asc", "chr", "left", "mid", "right", "str", "val",
-			"mem", "end", "len", "get", "set", "print", "input",
-			"list", "dict", "push", "pop", "back", "insert", "sort", "exists", "index_of", "remove", "clear", "clone", "to_array", "iterator", "move_next",
-			/* Built-in advanced. */
-			"ticks", "cpu_core_count", "now", "trace", "raise", "gc", "beep",
-			/* Common. */
-			"open", "close", "lock", "unlock", "read", "read_u8", "read_s8", "read_u16", "read_s16", "read_int", "read_real", "read_all", "end_of_stream",
-			"peek", "poke", "pack", "unpack", "parse", "serialize", "load", "save",
-			"send", "recv", "broadcast", "poll",
-			"start", "abort", "play", "stop", "parent", "children",
-			"create", "valid", "find", "resize", "copy_to",
-			/* Algorithm. */
-			"pather", "set_diagonal_cost",
-			/* Audio. */
-			"wave", "sfx", "use_sound_font", "set_volume",
-			/* Bytes. */
-			"bytes", "push_u8", "push_s8", "push_u16", "push_s16", "push_int", "push_real", "pop_u8", "pop_s8", "pop_u16", "pop_s16", "pop_int", "pop_real",
-			/* Coroutine. */
-			"coroutine", "yield", "get_error", "wait_for",
-			/* Complex. */
-			"rgba",
-			/* Database. */
-			"data", "restore",
-			"database", "has_table", "query", "exec",
-			/* Date time. */
-			"sleep",
-			/* Driver. */
-			"driver",
-			"set_clearer", "set_interpolator", "set_orderby",
-			"update_with",
-			"load_resource", "load_blank",
-			"flip_x", "flip_y", "set_flip_condition",
-			/* File. */
-			"file", "read_line", "write", "write_u8", "write_s8", "write_u16", "write_s16", "write_int", "write_real", "write_line",
-			/* GUI. */
-			"msgbox", "open_file_dialog", "save_file_dialog", "pick_directory_dialog",
-			/* Image. */
-			"image",
-			/* IO. */
-			"get_document_path", "combine_path",
-			"file_info", "directory_info", "get_files", "get_directories", "get_full_path", "get_parent_path", "get_file_name", "get_ext_name", "get_dir_name", "is_blank",
-			/* JSON. */
-			"json", "json_bool",
-			/* Math. */
-			"pi", "deg", "rad", "min", "max",
-			"vec2", "vec3", "vec4", "vec4_from_euler", "vec4_from_axis_angle", "mat4x4", "mat4x4_from_euler", "mat4x4_from_axis_angle", "mat4x4_from_scale", "mat4x4_from_translation",
-			"mat4x4_lookat", "mat4x4_ortho", "mat4x4_perspective", "mat4x4_perspective_fov",
-			"dot", "cross", "normalize", "length_square", "length", "distance_square", "distance", "lerp", "identity", "conjugate", "transpose", "inverse",
-			/* Network. */
-			"net",
-			/* Persistence. */
-			"persist",
-			/* System. */
-			"set_output_visible",
-			"get_app_directory", "get_current_directory",
-			"set_clipboard_text", "get_clipboard_text", "has_clipboard_text",
-			"os", "sys",
-			/* Text. */
-			"lcase", "ucase", "split", "starts_with", "ends_with", "like", "regex",
-			/* Utils. */
-			"assert", "swap", "iif",
-			"band", "bor", "bnot", "bxor", "shl", "shr",
-			/* Web. */
-			"web", "web_request",
-			/* Zip. */
-			"zip", "unpack_all",
-			"compress", "decompress",
-			/* Plugin primitives. */
-			"cls", "sync", "col", "clip", "camera", "font",
-			"text", "plot", "line", "circ", "circfill", "ellipse", "ellipsefill", "arc", "arcfill", "rect", "rectfill", "tri", "trifill", "tritex", "quad", "quadfill",
-			"spr", "sspr", "step_on", "map", "img", "simg",
-			"pget", "pset", "sget", "sset", "mget", "mset", "iget", "iset",
-			"key", "keyp", "touch", "btn", "btnp"
-		};
-		for (const char* const k : identifiers) {
-			Identifier id;
-			//id.declaration = "Library function";
-			langDef.ids.insert(std::make_pair(std::string(k), id));
-		}
+		visitNode(n.left, index, base, count, minLast, fn);
+		const int pos = index + sizeOf(n.left);
+		if (pos >= count)
+			return;
 
-		langDef.tokenRegexPatterns.push_back(std::make_pair<std::string, PaletteIndex>("'.*|rem$|rem[ \t](.*)?", PaletteIndex::Comment));
-		langDef.tokenRegexPatterns.push_back(std::make_pair<std::string, PaletteIndex>("L?\\\"(\\\\.|[^\\\"])*\\\"", PaletteIndex::String));
-		langDef.tokenRegexPatterns.push_back(std::make_pair<std::string, PaletteIndex>("0[x][0-9a-f]+", PaletteIndex::Number));
-		langDef.tokenRegexPatterns.push_back(std::make_pair<std::string, PaletteIndex>("[+-]?([0-9]+([.][0-9]*)?|[.][0-9]+)([e][+-]?[0-9]+)?", PaletteIndex::Number));
-		langDef.tokenRegexPatterns.push_back(std::make_pair<std::string, PaletteIndex>("[_]*[a-z_][a-z0-9_]*[$]?", PaletteIndex::Identifier));
-		langDef.tokenRegexPatterns.push_back(std::make_pair<std::string, PaletteIndex>("[\\~\\*\\/\\+\\-\\^\\(\\)\\=\\<\\>\\.]", PaletteIndex::Punctuation));
+		const int before = base + (n.left >= 0 ? nodes[n.left].sum.header : 0);
+		const int header = before + n.value.header;
+		const int last = before + n.value.end;
+		if (last >= minLast)
+			fn(pos, header, last);
+		visitNode(n.right, pos + 1, header, count, minLast, fn);
+	}
+};
 
-		langDef.commentStart = "'[";
-		langDef.commentEnd = "']";
-		langDef.commentException = '\'';
+static bool matchGlyphs(const std::string &str, const CodeEdit::Line &line, int col) {
+	if (str.empty() || col < 0 || col + str.size() > line.size())
+		return false;
 
-		langDef.caseSensitive = false;
+	for (size_t i = 0; i < str.size(); ++i) {
+		if (str[i] != (char)line[col + i].character)
+			return false;
+	}
 
-		langDef.name = "BASIC8";
+	return true;
+}
+
+static void applyTokenSpans(CodeEdit::Line &line, const CodeEdit::LanguageDefinition::TokenSpan* first, const CodeEdit::LanguageDefinition::TokenSpan* last, uint8_t enterState, uint8_t exitState) {
+	// Maps the spans in bytes to glyphs.
+	const int size = (int)line.size();
+	int col = 0;
+	int pos = 0; // Byte position of the glyph at `col`.
+	int spanEnd = 0;
+	for (; first != last; ++first) {
+		spanEnd += first->first;
+		const bool comment = first->second == CodeEdit::PaletteIndex::MultiLineComment;
+		for (; col < size && pos < spanEnd; ++col) {
+			CodeEdit::Glyph &g = line[col];
+			g.colorIndex = first->second;
+			g.multiLineComment = comment;
+			pos += countUtf8Bytes(g.character);
+		}
+	}
+	for (; col < size; ++col) {
+		CodeEdit::Glyph &g = line[col];
+		g.colorIndex = CodeEdit::PaletteIndex::Default;
+		g.multiLineComment = false;
+	}
 
-		inited = true;
+	line.colorized = true;
+	line.minimapDrawn = false;
+	line.commentsChecked = true;
+	line.enterState = enterState;
+	line.exitState = exitState;
+}
+
+static const uint8_t CHARACTER_IDENTIFIER = 1 << 0;
+static const uint8_t CHARACTER_DIGIT = 1 << 1;
+static const uint8_t CHARACTER_HEX = 1 << 2;
+static const uint8_t CHARACTER_PUNCTUATION = 1 << 3;
+static const uint8_t CHARACTER_SPACE = 1 << 4;
+
+struct CharacterClasses {
+	uint8_t table[256];
+
+	CharacterClasses() {
+		memset(table, 0, sizeof(table));
+		for (int c = 'a'; c <= 'z'; ++c)
+			table[c] |= CHARACTER_IDENTIFIER;
+		for (int c = 'A'; c <= 'Z'; ++c)
+			table[c] |= CHARACTER_IDENTIFIER;
+		table['_'] |= CHARACTER_IDENTIFIER;
+		for (int c = '0'; c <= '9'; ++c)
+			table[c] |= CHARACTER_DIGIT | CHARACTER_HEX;
+		for (int c = 'a'; c <= 'f'; ++c)
+			table[c] |= CHARACTER_HEX;
+		for (int c = 'A'; c <= 'F'; ++c)
+			table[c] |= CHARACTER_HEX;
+		for (const char* c = "[]{}!%^&*()-+=~|<>?/;,."; *c; ++c)
+			table[(unsigned char)*c] |= CHARACTER_PUNCTUATION;
+		for (const char* c = " \t\r\v\f"; *c; ++c)
+			table[(unsigned char)*c] |= CHARACTER_SPACE;
 	}
+	uint8_t operator [] (char c) const {
+		return table[(unsigned char)c];
+	}
+};
 
-	return langDef;
+static const CharacterClasses &characterClasses(void) {
+	static const CharacterClasses classes;
+
+	return classes;
 }
 
-bool CodeEdit::UndoRecord::similar(const UndoRecord* o) const {
-	if (o == nullptr)
-		return false;
-	if (type != o->type)
-		return false;
-	if (start.line != o->start.line || end.line != o->end.line)
-		return false;
+static void emitToken(CodeEdit::LanguageDefinition::TokenSpans &spans, const char* begin, const char* end, CodeEdit::PaletteIndex color) {
+	const int len = (int)(end - begin);
+	if (len <= 0)
+		return;
 
-	auto isalpha = [] (char ch) {
-		return (ch >= 'A' && ch <= 'Z') || (ch >= 'a' && ch <= 'z');
-	};
-	auto isnum = [] (char ch) {
-		return ch >= '0' && ch <= '9';
-	};
-	auto isblank = [] (char ch) {
-		return ch >= ' ' && ch <= '\t';
-	};
-	if ((content.length() == 1 && isalpha(*content.begin())) &&
-		(o->content.length() == 1 && isalpha(*o->content.begin()))) {
-		return true;
-	}
-	if ((content.length() == 1 && isnum(*content.begin())) &&
-		(o->content.length() == 1 && isnum(*o->content.begin()))) {
-		return true;
-	}
-	if ((content.length() == 1 && isblank(*content.begin())) &&
-		(o->content.length() == 1 && isblank(*o->content.begin()))) {
-		return true;
-	}
-	if (content.length() > 1 && content.length() <= 4 && o->content.length() > 1 && o->content.length() <= 4) {
-		int l = expectUtf8Char(content.c_str());
-		int r = expectUtf8Char(o->content.c_str());
-		if ((int)content.length() == l && (int)o->content.length() == r)
-			return true;
+	if (color != CodeEdit::PaletteIndex::Identifier && !spans.empty() && spans.back().second == color)
+		spans.back().first += len; // Merges with the previous span, except for identifiers which are classified later.
+	else
+		spans.push_back(std::make_pair(len, color));
+}
+
+static const char* findToken(const char* p, const char* end, const char* tk, int n) {
+	for (end -= n - 1; p < end; ++p) {
+		p = (const char*)memchr(p, *tk, end - p);
+		if (!p)
+			return nullptr;
+		if (memcmp(p, tk, n) == 0)
+			return p;
 	}
 
-	return false;
+	return nullptr;
 }
 
-void CodeEdit::UndoRecord::undo(CodeEdit* editor) {
-	if (!content.empty()) {
-		switch (type) {
-		case UndoType::Add: {
-				editor->_state = after;
+static const char* skipCharacters(const char* p, const char* end, uint8_t cls) {
+	const CharacterClasses &cc = characterClasses();
+	while (p < end && (cc[*p] & cls))
+		++p;
 
-				editor->removeRange(start, end);
-				editor->colorize(start.line - 1, end.line - start.line + 2);
+	return p;
+}
 
-				if (!overwritten.empty()) {
-					Coordinates st = start;
-					editor->insertTextAt(st, overwritten.c_str());
-					editor->colorize(st.line - 1, end.line - st.line + 1);
-				}
+static bool isNumberStart(const char* p, const char* end) {
+	const CharacterClasses &cc = characterClasses();
 
-				editor->onChanged(start, start, -1);
-			}
+	return (cc[*p] & CHARACTER_DIGIT) || (*p == '.' && p + 1 < end && (cc[p[1]] & CHARACTER_DIGIT));
+}
 
-			break;
-		case UndoType::Remove: {
-				Coordinates st = start;
-				editor->insertTextAt(st, content.c_str());
-				editor->colorize(st.line - 1, end.line - st.line + 2);
+static const char* scanNumber(const char* p, const char* end, const char* suffixes) {
+	const CharacterClasses &cc = characterClasses();
+	if (p + 2 < end && p[0] == '0' && (p[1] == 'x' || p[1] == 'X') && (cc[p[2]] & CHARACTER_HEX)) {
+		p = skipCharacters(p + 2, end, CHARACTER_HEX);
+	} else {
+		p = skipCharacters(p, end, CHARACTER_DIGIT);
+		if (p < end && *p == '.')
+			p = skipCharacters(p + 1, end, CHARACTER_DIGIT);
+		if (p < end && (*p == 'e' || *p == 'E')) {
+			const char* q = p + 1;
+			if (q < end && (*q == '+' || *q == '-'))
+				++q;
+			if (q < end && (cc[*q] & CHARACTER_DIGIT))
+				p = skipCharacters(q, end, CHARACTER_DIGIT);
+		}
+	}
+	while (p < end && *p && strchr(suffixes, *p))
+		++p;
 
-				editor->onChanged(st, end, -1);
-			}
+	return p;
+}
 
-			break;
-		case UndoType::indent: {
-				assert(end.line - start.line + 1 == (int)content.length());
+static const char* scanQuoted(const char* p, const char* end, bool escapes) {
+	const char quote = *p++;
+	while (p < end) {
+		if (*p == quote)
+			return p + 1;
+		if (escapes && *p == '\\' && p + 1 < end)
+			++p;
+		++p;
+	}
 
-				for (int i = start.line; i <= end.line; ++i) {
-					Line &line = editor->_codeLines[i];
-					const char op = content[i - start.line];
-					if (op == 0) {
-						// Does nothing.
-					} else if (op == std::numeric_limits<char>::max()) {
-						const Glyph &g = *line.begin();
-						if (g.character == '\t') {
-							line.erase(line.begin());
-						} else {
-							assert(false);
-						}
+	return nullptr; // Unterminated.
+}
 
-						Coordinates pos(i, 0);
-						editor->onChanged(pos, pos, -1);
-					} else {
-						assert(false);
-					}
-				}
-			}
+static int countLongBracketLevel(const char* p, const char* end) {
+	// Matches "[[", "[=[", "[==[", etc.
+	if (p >= end || *p != '[')
+		return -1;
+	const char* q = p + 1;
+	while (q < end && *q == '=')
+		++q;
+	if (q >= end || *q != '[')
+		return -1;
 
-			break;
-		case UndoType::unindent: {
-				assert(end.line - start.line + 1 == (int)content.length());
+	return (int)(q - p - 1);
+}
 
-				for (int i = start.line; i <= end.line; ++i) {
-					Line &line = editor->_codeLines[i];
-					char op = content[i - start.line];
-					if (op == 0) {
-						// Does nothing.
-					} else if (op == std::numeric_limits<char>::max()) {
-						line.insert(line.begin(), Glyph('\t', PaletteIndex::Default));
+static const char* findLongBracketEnd(const char* p, const char* end, int level) {
+	while ((p = findToken(p, end, "]", 1)) != nullptr) {
+		const char* q = p + 1;
+		while (q < end && *q == '=')
+			++q;
+		if (q < end && *q == ']' && (int)(q - p - 1) == level)
+			return q + 1;
+		++p;
+	}
 
-						Coordinates pos(i, 0);
-						editor->onChanged(pos, pos, -1);
-					} else if (op > 0) {
-						while (op--) {
-							line.insert(line.begin(), Glyph(' ', PaletteIndex::Default));
-						}
+	return nullptr;
+}
 
-						Coordinates pos(i, 0);
-						editor->onChanged(pos, pos, -1);
-					} else {
-						assert(false);
-					}
-				}
-			}
+static uint8_t tokenizeC(const char* begin, const char* end, uint8_t state, CodeEdit::LanguageDefinition::TokenSpans &spans, bool preprocessor, CodeEdit::PaletteIndex charLiteral) {
+	typedef CodeEdit::PaletteIndex PaletteIndex;
 
-			break;
+	const CharacterClasses &cc = characterClasses();
+	const char* p = begin;
+	if (state & CodeEdit::WithinMultiLineComment) {
+		const char* q = findToken(p, end, "*/", 2);
+		if (!q) {
+			emitToken(spans, p, end, PaletteIndex::MultiLineComment);
+
+			return CodeEdit::WithinMultiLineComment;
+		}
+		emitToken(spans, p, q + 2, PaletteIndex::MultiLineComment);
+		p = q + 2;
+	} else if (preprocessor) {
+		const char* q = skipCharacters(p, end, CHARACTER_SPACE);
+		if (q < end && *q == '#') {
+			q = skipCharacters(q + 1, end, CHARACTER_SPACE);
+			if (q < end && (cc[*q] & CHARACTER_IDENTIFIER)) {
+				q = skipCharacters(q, end, CHARACTER_IDENTIFIER);
+				emitToken(spans, p, q, PaletteIndex::Preprocessor);
+				p = q;
+			}
 		}
 	}
+	while (p < end) {
+		const char* q = p + 1;
+		const uint8_t cls = cc[*p];
+		if (cls & CHARACTER_SPACE) {
+			q = skipCharacters(q, end, CHARACTER_SPACE);
+			emitToken(spans, p, q, PaletteIndex::Default);
+		} else if (cls & CHARACTER_IDENTIFIER) {
+			q = skipCharacters(q, end, CHARACTER_IDENTIFIER | CHARACTER_DIGIT);
+			if (q - p == 1 && *p == 'L' && q < end && *q == '\"') { // Wide string.
+				const char* r = scanQuoted(q, end, true);
+				q = r ? r : end;
+				emitToken(spans, p, q, PaletteIndex::String);
+			} else {
+				emitToken(spans, p, q, PaletteIndex::Identifier);
+			}
+		} else if (isNumberStart(p, end)) {
+			q = scanNumber(p, end, "fFuUlL");
+			emitToken(spans, p, q, PaletteIndex::Number);
+		} else if (*p == '/' && q < end && *q == '/') {
+			q = end;
+			emitToken(spans, p, q, PaletteIndex::Comment);
+		} else if (*p == '/' && q < end && *q == '*') {
+			const char* r = findToken(q + 1, end, "*/", 2);
+			if (!r) {
+				emitToken(spans, p, end, PaletteIndex::MultiLineComment);
+
+				return CodeEdit::WithinMultiLineComment;
+			}
+			q = r + 2;
+			emitToken(spans, p, q, PaletteIndex::MultiLineComment);
+		} else if (*p == '\"') {
+			const char* r = scanQuoted(p, end, true);
+			q = r ? r : end;
+			emitToken(spans, p, q, PaletteIndex::String);
+		} else if (*p == '\'') {
+			const char* r = scanQuoted(p, end, true);
+			if (r) {
+				q = r;
+				emitToken(spans, p, q, charLiteral);
+			} else {
+				emitToken(spans, p, q, PaletteIndex::Default);
+			}
+		} else if (cls & CHARACTER_PUNCTUATION) {
+			emitToken(spans, p, q, PaletteIndex::Punctuation);
+		} else {
+			emitToken(spans, p, q, PaletteIndex::Default);
+		}
+		p = q;
+	}
 
-	editor->_state = before;
-	editor->ensureCursorVisible();
-
-	editor->onModified();
+	return 0;
 }
 
-void CodeEdit::UndoRecord::redo(CodeEdit* editor) {
-	if (!content.empty()) {
-		switch (type) {
-		case UndoType::Add: {
-				editor->_state = before;
+static uint8_t tokenizeLua(const char* begin, const char* end, uint8_t state, CodeEdit::LanguageDefinition::TokenSpans &spans) {
+	typedef CodeEdit::PaletteIndex PaletteIndex;
 
-				editor->removeSelection();
+	// The level of long brackets is kept in the free bits of the state.
+	const CharacterClasses &cc = characterClasses();
+	const char* p = begin;
+	if (state & (CodeEdit::WithinMultiLineComment | CodeEdit::WithinString)) {
+		const PaletteIndex color = (state & CodeEdit::WithinMultiLineComment) ? PaletteIndex::MultiLineComment : PaletteIndex::String;
+		const char* q = findLongBracketEnd(p, end, state >> 2);
+		if (!q) {
+			emitToken(spans, p, end, color);
 
-				Coordinates st = start;
-				editor->insertTextAt(st, content.c_str());
-				editor->colorize(st.line - 1, end.line - st.line + 1);
+			return state;
+		}
+		emitToken(spans, p, q, color);
+		p = q;
+	}
+	while (p < end) {
+		const char* q = p + 1;
+		const uint8_t cls = cc[*p];
+		if (cls & CHARACTER_SPACE) {
+			q = skipCharacters(q, end, CHARACTER_SPACE);
+			emitToken(spans, p, q, PaletteIndex::Default);
+		} else if (cls & CHARACTER_IDENTIFIER) {
+			q = skipCharacters(q, end, CHARACTER_IDENTIFIER | CHARACTER_DIGIT);
+			emitToken(spans, p, q, PaletteIndex::Identifier);
+		} else if (isNumberStart(p, end)) {
+			q = scanNumber(p, end, "");
+			emitToken(spans, p, q, PaletteIndex::Number);
+		} else if (*p == '-' && q < end && *q == '-') {
+			const int level = countLongBracketLevel(q + 1, end);
+			if (level < 0 || level > 0x3f) {
+				q = end;
+				emitToken(spans, p, q, PaletteIndex::Comment);
+			} else {
+				const char* r = findLongBracketEnd(q + level + 3, end, level);
+				if (!r) {
+					emitToken(spans, p, end, PaletteIndex::MultiLineComment);
 
-				editor->onChanged(st, end, 1);
+					return (uint8_t)(CodeEdit::WithinMultiLineComment | (level << 2));
+				}
+				q = r;
+				emitToken(spans, p, q, PaletteIndex::MultiLineComment);
 			}
+		} else if (*p == '[' && countLongBracketLevel(p, end) >= 0 && countLongBracketLevel(p, end) <= 0x3f) {
+			const int level = countLongBracketLevel(p, end);
+			const char* r = findLongBracketEnd(p + level + 2, end, level);
+			if (!r) {
+				emitToken(spans, p, end, PaletteIndex::String);
 
-			break;
-		case UndoType::Remove: {
-				editor->removeRange(start, end);
-				editor->colorize(start.line - 1, end.line - start.line + 1);
-
-				editor->onChanged(start, start, 1);
+				return (uint8_t)(CodeEdit::WithinString | (level << 2));
 			}
+			q = r;
+			emitToken(spans, p, q, PaletteIndex::String);
+		} else if (*p == '\"' || *p == '\'') {
+			const char* r = scanQuoted(p, end, true);
+			q = r ? r : end;
+			emitToken(spans, p, q, PaletteIndex::String);
+		} else if (cls & CHARACTER_PUNCTUATION) {
+			emitToken(spans, p, q, PaletteIndex::Punctuation);
+		} else {
+			emitToken(spans, p, q, PaletteIndex::Default);
+		}
+		p = q;
+	}
 
-			break;
-		case UndoType::indent: {
-				assert(end.line - start.line + 1 == (int)content.length());
+	return 0;
+}
 
-				for (int i = start.line; i <= end.line; ++i) {
-					Line &line = editor->_codeLines[i];
-					const char op = content[i - start.line];
-					if (op == 0) {
-						// Does nothing.
-					} else if (op == std::numeric_limits<char>::max()) {
-						line.insert(line.begin(), Glyph('\t', PaletteIndex::Default));
+static uint8_t tokenizeSQL(const char* begin, const char* end, uint8_t state, CodeEdit::LanguageDefinition::TokenSpans &spans) {
+	typedef CodeEdit::PaletteIndex PaletteIndex;
 
-						Coordinates pos(i, 0);
-						editor->onChanged(pos, pos, 1);
-					} else {
-						assert(false);
-					}
-				}
+	const CharacterClasses &cc = characterClasses();
+	const char* p = begin;
+	if (state & CodeEdit::WithinMultiLineComment) {
+		const char* q = findToken(p, end, "*/", 2);
+		if (!q) {
+			emitToken(spans, p, end, PaletteIndex::MultiLineComment);
+
+			return CodeEdit::WithinMultiLineComment;
+		}
+		emitToken(spans, p, q + 2, PaletteIndex::MultiLineComment);
+		p = q + 2;
+	}
+	while (p < end) {
+		const char* q = p + 1;
+		const uint8_t cls = cc[*p];
+		if (cls & CHARACTER_SPACE) {
+			q = skipCharacters(q, end, CHARACTER_SPACE);
+			emitToken(spans, p, q, PaletteIndex::Default);
+		} else if (cls & CHARACTER_IDENTIFIER) {
+			q = skipCharacters(q, end, CHARACTER_IDENTIFIER | CHARACTER_DIGIT);
+			emitToken(spans, p, q, PaletteIndex::Identifier);
+		} else if (isNumberStart(p, end)) {
+			q = scanNumber(p, end, "");
+			emitToken(spans, p, q, PaletteIndex::Number);
+		} else if (*p == '-' && q < end && *q == '-') {
+			q = end;
+			emitToken(spans, p, q, PaletteIndex::Comment);
+		} else if (*p == '/' && q < end && *q == '*') {
+			const char* r = findToken(q + 1, end, "*/", 2);
+			if (!r) {
+				emitToken(spans, p, end, PaletteIndex::MultiLineComment);
+
+				return CodeEdit::WithinMultiLineComment;
 			}
+			q = r + 2;
+			emitToken(spans, p, q, PaletteIndex::MultiLineComment);
+		} else if (*p == '\"' || *p == '\'') {
+			const char* r = scanQuoted(p, end, *p == '\"');
+			q = r ? r : end;
+			emitToken(spans, p, q, PaletteIndex::String);
+		} else if (cls & CHARACTER_PUNCTUATION) {
+			emitToken(spans, p, q, PaletteIndex::Punctuation);
+		} else {
+			emitToken(spans, p, q, PaletteIndex::Default);
+		}
+		p = q;
+	}
 
-			break;
-		case UndoType::unindent: {
-				assert(end.line - start.line + 1 == (int)content.length());
+	return 0;
+}
 
-				for (int i = start.line; i <= end.line; ++i) {
-					Line &line = editor->_codeLines[i];
-					char op = content[i - start.line];
-					if (op == 0) {
-						// Does nothing.
-					} else if (op == std::numeric_limits<char>::max()) {
-						const Glyph &g = *line.begin();
-						if (g.character == '\t') {
-							line.erase(line.begin());
-						} else {
-							assert(false);
-						}
+static uint8_t tokenizeBASIC8(const char* begin, const char* end, uint8_t state, CodeEdit::LanguageDefinition::TokenSpans &spans) {
+	typedef CodeEdit::PaletteIndex PaletteIndex;
 
-						Coordinates pos(i, 0);
-						editor->onChanged(pos, pos, 1);
-					} else if (op > 0) {
-						while (op--) {
-							const Glyph &g = *line.begin();
-							if (g.character == ' ') {
-								line.erase(line.begin());
-							} else {
-								assert(false);
-							}
-						}
+	// "''[" and "'']" are exceptions of multi-line comment tokens.
+	auto findCommentEnd = [] (const char* p, const char* begin, const char* end) -> const char* {
+		while ((p = findToken(p, end, "']", 2)) != nullptr) {
+			if (p == begin || p[-1] != '\'')
+				return p + 2;
+			++p;
+		}
 
-						Coordinates pos(i, 0);
-						editor->onChanged(pos, pos, 1);
+		return nullptr;
+	};
+	const CharacterClasses &cc = characterClasses();
+	const char* p = begin;
+	if (state & CodeEdit::WithinMultiLineComment) {
+		const char* q = findCommentEnd(p, begin, end);
+		if (!q) {
+			emitToken(spans, p, end, PaletteIndex::MultiLineComment);
+
+			return CodeEdit::WithinMultiLineComment;
+		}
+		emitToken(spans, p, q, PaletteIndex::MultiLineComment);
+		p = q;
+	}
+	while (p < end) {
+		const char* q = p + 1;
+		const uint8_t cls = cc[*p];
+		if (cls & CHARACTER_SPACE) {
+			q = skipCharacters(q, end, CHARACTER_SPACE);
+			emitToken(spans, p, q, PaletteIndex::Default);
+		} else if (cls & CHARACTER_IDENTIFIER) {
+			q = skipCharacters(q, end, CHARACTER_IDENTIFIER | CHARACTER_DIGIT);
+			if (q - p == 3 && CODE_EDIT_CASE_FUNC(p[0]) == 'r' && CODE_EDIT_CASE_FUNC(p[1]) == 'e' && CODE_EDIT_CASE_FUNC(p[2]) == 'm' && (q == end || *q == ' ' || *q == '\t')) {
+				q = end;
+				emitToken(spans, p, q, PaletteIndex::Comment);
+			} else {
+				if (q < end && *q == '$')
+					++q;
+				emitToken(spans, p, q, PaletteIndex::Identifier);
+			}
+		} else if (isNumberStart(p, end)) {
+			q = scanNumber(p, end, "");
+			emitToken(spans, p, q, PaletteIndex::Number);
+		} else if (*p == '\'' && q < end && *q == '[' && (p == begin || p[-1] != '\'')) {
+			const char* r = findCommentEnd(q + 1, begin, end);
+			if (!r) {
+				emitToken(spans, p, end, PaletteIndex::MultiLineComment);
+
+				return CodeEdit::WithinMultiLineComment;
+			}
+			q = r;
+			emitToken(spans, p, q, PaletteIndex::MultiLineComment);
+		} else if (*p == '\'') {
+			q = end;
+			emitToken(spans, p, q, PaletteIndex::Comment);
+		} else if (*p == '\"') {
+			const char* r = scanQuoted(p, end, true);
+			q = r ? r : end;
+			emitToken(spans, p, q, PaletteIndex::String);
+		} else if (*p && strchr("~*/+-^()=<>.", *p)) {
+			emitToken(spans, p, q, PaletteIndex::Punctuation);
+		} else {
+			emitToken(spans, p, q, PaletteIndex::Default);
+		}
+		p = q;
+	}
+
+	return 0;
+}
+
+static_assert(sizeof(CodeEdit::DrawList::Rect) == sizeof(SDL_Rect), "Wrong type size.");
+
+enum class DrawLayer : uint8_t { // In the order a row is drawn, rows don't overlap, nor do the gutter and the code.
+	LineNumber,
+	LineState,
+	GutterCurrentLine,
+	GutterCurrentLineEdge,
+	Selection,
+	MatchingBracket,
+	SymbolOccurrence,
+	Breakpoint,
+	ErrorMarker,
+	CurrentLine,
+	CurrentLineEdge,
+	Cursor,
+	Code,
+	Fold,
+	CompletionBackground,
+	CompletionSelection,
+	CompletionText,
+	CompletionEdge,
+	Max
+};
+
+struct CodeEdit::DrawRecorder {
+	struct Item {
+		DrawList::Op op = DrawList::Op::FillRects;
+		bool utf8 = false;
+		int clip = 0;
+		unsigned color = 0;
+		DrawList::Rect rect; // Or where text begins.
+		int text = 0; // In `texts`, or the line number.
+		int length = 0;
+	};
+
+	typedef std::vector<Item> Items;
+
+	DrawList::Rects clips;
+	Items layers[(size_t)DrawLayer::Max];
+	std::string texts;
+
+	int clip(const SDL_Rect &rect) {
+		clips.push_back(DrawList::Rect(rect.x, rect.y, rect.w, rect.h));
+
+		return (int)clips.size() - 1;
+	}
+
+	void box(DrawLayer layer, int clip, Sint16 x1, Sint16 y1, Sint16 x2, Sint16 y2, unsigned color) {
+		// Like `boxColor`, with both corners inside.
+		const DrawList::Rect rect(std::min(x1, x2), std::min(y1, y2), std::abs(x2 - x1) + 1, std::abs(y2 - y1) + 1);
+		add(layer, clip, DrawList::Op::FillRects, color, rect);
+	}
+
+	void frame(DrawLayer layer, int clip, Sint16 x1, Sint16 y1, Sint16 x2, Sint16 y2, unsigned color) {
+		// Like `rectangleColor`, a line if it's flat, otherwise without the second corner.
+		if (x1 == x2 || y1 == y2) {
+			box(layer, clip, x1, y1, x2, y2, color);
+
+			return;
+		}
+
+		const DrawList::Rect rect(std::min(x1, x2), std::min(y1, y2), std::abs(x2 - x1), std::abs(y2 - y1));
+		add(layer, clip, DrawList::Op::DrawRects, color, rect);
+	}
+
+	void text(DrawLayer layer, int clip, Sint16 x, Sint16 y, const char* txt, unsigned color, bool utf8) {
+		Item item;
+		item.op = DrawList::Op::Text;
+		item.utf8 = utf8;
+		item.clip = clip;
+		item.color = color;
+		item.rect = DrawList::Rect(x, y, 0, 0);
+		item.text = (int)texts.length();
+		texts.append(txt);
+		item.length = (int)texts.length() - item.text;
+		texts.push_back('\0');
+		layers[(size_t)layer].push_back(item);
+	}
+
+	void number(DrawLayer layer, int clip, Sint16 x, Sint16 y, int num, unsigned color) {
+		Item item;
+		item.op = DrawList::Op::Numbers;
+		item.clip = clip;
+		item.color = color;
+		item.rect = DrawList::Rect(x, y, 0, 0);
+		item.text = num;
+		layers[(size_t)layer].push_back(item);
+	}
+
+	void add(DrawLayer layer, int clip, DrawList::Op op, unsigned color, const DrawList::Rect &rect) {
+		Item item;
+		item.op = op;
+		item.clip = clip;
+		item.color = color;
+		item.rect = rect;
+		layers[(size_t)layer].push_back(item);
+	}
+
+	void finish(DrawList &list) {
+		// Sorts the rectangles of each layer by state, which keeps the picture as
+		// rows don't overlap, then merges those of a state into one command, and
+		// line numbers of consecutive rows into one.
+		list.commands.clear();
+		list.rects.clear();
+		list.texts.swap(texts);
+		texts.clear();
+		const DrawList::Rect* current = nullptr;
+		for (Items &items : layers) {
+			std::stable_sort(
+				items.begin(), items.end(),
+				[] (const Item &l, const Item &r) -> bool {
+					if (l.clip != r.clip)
+						return l.clip < r.clip;
+					if (l.op != r.op)
+						return l.op < r.op;
+					if (l.op == DrawList::Op::Text)
+						return false; // Drawn one by one anyway, kept in order.
+
+					return l.color < r.color;
+				}
+			);
+			for (const Item &item : items) {
+				const DrawList::Rect &clip = clips[item.clip];
+				if (!current || memcmp(current, &clip, sizeof(clip)) != 0) {
+					DrawList::Command cmd;
+					cmd.op = DrawList::Op::Clip;
+					cmd.first = (int)list.rects.size();
+					cmd.count = 1;
+					list.commands.push_back(cmd);
+					list.rects.push_back(clip);
+					current = &clip;
+				}
+				if (item.op == DrawList::Op::Text) {
+					DrawList::Command cmd;
+					cmd.op = item.op;
+					cmd.utf8 = item.utf8;
+					cmd.color = item.color;
+					cmd.x = item.rect.x;
+					cmd.y = item.rect.y;
+					cmd.first = item.text;
+					cmd.count = item.length;
+					list.commands.push_back(cmd);
+				} else if (item.op == DrawList::Op::Numbers) {
+					DrawList::Command &last = list.commands.back();
+					if (
+						last.op == item.op && last.color == item.color && last.x == item.rect.x &&
+						last.first + last.count == item.text && last.y + last.count * list.lineHeight == item.rect.y
+					) {
+						++last.count;
 					} else {
-						assert(false);
+						DrawList::Command cmd;
+						cmd.op = item.op;
+						cmd.color = item.color;
+						cmd.x = item.rect.x;
+						cmd.y = item.rect.y;
+						cmd.first = item.text;
+						cmd.count = 1;
+						list.commands.push_back(cmd);
 					}
+				} else if (list.commands.back().op == item.op && list.commands.back().color == item.color) {
+					list.rects.push_back(item.rect);
+					++list.commands.back().count;
+				} else {
+					DrawList::Command cmd;
+					cmd.op = item.op;
+					cmd.color = item.color;
+					cmd.first = (int)list.rects.size();
+					cmd.count = 1;
+					list.commands.push_back(cmd);
+					list.rects.push_back(item.rect);
 				}
 			}
-
-			break;
+			items.clear();
 		}
+		clips.clear();
 	}
+};
 
-	editor->_state = after;
-	editor->ensureCursorVisible();
+static int drawString(gfxFontContext* font, Sint16 x, Sint16 y, const char* txt, Uint32 color, bool utf8) {
+	if (utf8)
+		return fontUtf8StringColor(font, x, y, txt, color);
 
-	editor->onModified();
+	return fontStringColor(font, x, y, txt, color);
 }
 
-CodeEdit::Glyph::Glyph(CodeEdit::Char ch, PaletteIndex idx) : character(ch), colorIndex(idx), multiLineComment(false) {
-	if (ch <= 255) {
-		codepoint = (CodeEdit::CodePoint)ch;
-	} else {
-		const char* txt = (const char*)(&ch);
-		const char* tend = txt + sizeof(CodeEdit::Char);
-		unsigned int cp = 0;
-		charFromUtf8(&cp, txt, tend);
-		codepoint = (CodeEdit::CodePoint)cp;
-	}
-}
+static int numberToChars(char* buf, int width, int num) {
+	// Like `snprintf` with "%*d" for a positive number, returns the length.
+	char digits[16];
+	int count = 0;
+	do {
+		digits[count++] = (char)('0' + num % 10);
+		num /= 10;
+	} while (num);
+	int len = 0;
+	while (len < width - count)
+		buf[len++] = ' ';
+	while (count)
+		buf[len++] = digits[--count];
+	buf[len] = '\0';
 
-void CodeEdit::Line::clear(void) {
-	changed = LineState::None;
+	return len;
 }
 
-void CodeEdit::Line::change(void) {
-	changed = LineState::Edited;
-}
+struct SdlDrawBackend : public CodeEdit::DrawBackend {
+	std::shared_ptr<gfxFontContext> font; // Owns the glyph cache.
+	SDL_Renderer* renderer = nullptr; // Of the glyph cache.
+	const void* fontData = nullptr;
+	CodeEdit::Vec2 characterSize;
+	std::vector<Uint32> glyphs; // Pixels of the characters of line numbers, in white, rows of one after another.
+	int glyphWidth = 0, glyphHeight = 0;
+	std::shared_ptr<SDL_Texture> numbers; // Streaming, slot `n` holds a line number whose value modulo the slots is `n`.
+	std::vector<int> slotNumbers; // 0 if a slot holds none.
+	int numberWidth = 0; // Of the numbers in the slots.
+	int numberColumns = 0; // Characters in a slot.
+	int slotHeight = 0;
+
+	virtual void replay(void* rnd, const CodeEdit::DrawList &list, CodeEdit::RenderStats &stats) override {
+		typedef CodeEdit::DrawList DrawList;
+
+		SDL_Renderer* rndr = (SDL_Renderer*)rnd;
+		if (!font || renderer != rndr || fontData != list.font || characterSize.x != list.characterSize.x || characterSize.y != list.characterSize.y) {
+			font = std::shared_ptr<gfxFontContext>(
+				gfxFontContextCreate(rndr, list.font, (Uint32)list.characterSize.x, (Uint32)list.characterSize.y),
+				gfxFontContextDestroy
+			);
+			renderer = rndr;
+			fontData = list.font;
+			characterSize = list.characterSize;
+			glyphs.clear();
+			numbers = nullptr;
+		}
+		int maxNumber = 0;
+		int maxCount = 0;
+		for (const DrawList::Command &cmd : list.commands) {
+			if (cmd.op == DrawList::Op::Numbers) {
+				maxNumber = std::max(maxNumber, cmd.first + cmd.count - 1);
+				maxCount = std::max(maxCount, cmd.count);
+			}
+		}
+		const bool numbered = maxCount > 0 && prepareNumbers(list, maxNumber, maxCount);
+
+		SDL_Rect clip{ 0, 0, 0, 0 };
+		const bool clipped = !!SDL_RenderIsClipEnabled(rndr);
+		if (clipped)
+			SDL_RenderGetClipRect(rndr, &clip);
+		SDL_Rect current = clip; // Set to the renderer, if `clipping`.
+		bool clipping = clipped;
+		bool colored = false; // Whether the draw color is of the last rectangles.
+		unsigned color = 0;
+		stats.commands += (int)list.commands.size();
+		for (const DrawList::Command &cmd : list.commands) {
+			const SDL_Rect* rects = (const SDL_Rect*)list.rects.data() + cmd.first;
+			switch (cmd.op) {
+			case DrawList::Op::Clip:
+				if (clipping && memcmp(&current, rects, sizeof(current)) == 0) {
+					++stats.clipCallsSkipped;
 
-void CodeEdit::Line::save(void) {
-	changed = LineState::EditedSaved;
-}
+					break;
+				}
+				SDL_RenderSetClipRect(rndr, rects);
+				current = *rects;
+				clipping = true;
+				++stats.clipCalls;
 
-void CodeEdit::Line::revert(void) {
-	changed = LineState::EditedReverted;
-}
+				break;
+			case DrawList::Op::FillRects: // Fall through.
+			case DrawList::Op::DrawRects:
+				if (!colored || color != cmd.color) {
+					const Uint8* c = (const Uint8*)&cmd.color;
+					SDL_SetRenderDrawBlendMode(rndr, c[3] == 255 ? SDL_BLENDMODE_NONE : SDL_BLENDMODE_BLEND);
+					SDL_SetRenderDrawColor(rndr, c[0], c[1], c[2], c[3]);
+					colored = true;
+					color = cmd.color;
+					++stats.colorCalls;
+				}
+				if (cmd.op == DrawList::Op::FillRects)
+					SDL_RenderFillRects(rndr, rects, cmd.count);
+				else
+					SDL_RenderDrawRects(rndr, rects, cmd.count);
+				++stats.drawCalls;
 
-CodeEdit::CodeEdit() {
-	setPalette(DarkPalette());
-	setLanguageDefinition(LanguageDefinition::C());
-	_codeLines.push_back(Line());
-}
+				break;
+			case DrawList::Op::Text:
+				drawString(font.get(), (Sint16)cmd.x, (Sint16)cmd.y, list.texts.c_str() + cmd.first, cmd.color, cmd.utf8);
+				colored = false;
+				++stats.drawCalls;
 
-CodeEdit::~CodeEdit() {
-}
+				break;
+			case DrawList::Op::Numbers:
+				if (numbered) {
+					drawNumbers(cmd, stats);
+				} else {
+					char buf[16];
+					for (int i = 0; i < cmd.count; ++i) {
+						numberToChars(buf, list.numberWidth, cmd.first + i);
+						drawString(font.get(), (Sint16)cmd.x, (Sint16)(cmd.y + i * list.lineHeight), buf, cmd.color, false);
+						++stats.drawCalls;
+					}
+					colored = false;
+				}
 
-const CodeEdit::LanguageDefinition &CodeEdit::getLanguageDefinition(void) const {
-	return _langDef;
-}
+				break;
+			}
+		}
+		if (clipping == clipped && (!clipped || memcmp(&current, &clip, sizeof(clip)) == 0)) {
+			++stats.clipCallsSkipped;
+		} else {
+			SDL_RenderSetClipRect(rndr, clipped ? &clip : nullptr);
+			++stats.clipCalls;
+		}
+	}
 
-CodeEdit::LanguageDefinition &CodeEdit::getLanguageDefinition(void) {
-	return _langDef;
-}
+	bool prepareNumbers(const CodeEdit::DrawList &list, int maxNumber, int maxCount) {
+		// Takes the glyphs of the font, and makes sure there are enough slots of
+		// the size of the numbers, returns false to draw them as text instead.
+		const int width = list.font ? (int)list.characterSize.x : 8; // `SDL gfx` ignores the size without font data.
+		const int height = list.font ? (int)list.characterSize.y : 8;
+		if (width <= 0 || height <= 0 || list.lineHeight < height)
+			return false;
+
+		if (glyphs.empty()) {
+			const int pitch = (width + 7) / 8;
+			const Uint8* font = list.font ? (const Uint8*)list.font : gfxPrimitivesGetDefaultFont();
+			glyphs.assign(NUMBER_GLYPH_COUNT * width * height, 0);
+			for (int g = 0; g < NUMBER_GLYPH_COUNT; ++g) {
+				const Uint8* data = font + (g ? '0' + g - 1 : ' ') * pitch * height;
+				for (int y = 0; y < height; ++y) {
+					for (int x = 0; x < width; ++x) {
+						if (data[y * pitch + x / 8] & (0x80 >> (x % 8)))
+							glyphs[(g * height + y) * width + x] = 0xffffffff;
+					}
+				}
+			}
+			glyphWidth = width;
+			glyphHeight = height;
+		}
 
-CodeEdit::LanguageDefinition &CodeEdit::setLanguageDefinition(const LanguageDefinition &langDef) {
-	_langDef = langDef;
-	_regexes.clear();
+		char buf[16];
+		const int columns = std::max(list.numberWidth, numberToChars(buf, 0, maxNumber));
+		int slots = (int)slotNumbers.size();
+		if (!numbers || numberWidth != list.numberWidth || numberColumns != columns || slotHeight != list.lineHeight || slots < maxCount) {
+			slots = std::max(slots, NUMBER_SLOTS);
+			while (slots < maxCount)
+				slots *= 2;
+			SDL_Texture* tex = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_STREAMING, columns * width, slots * list.lineHeight);
+			if (!tex)
+				return false;
+			SDL_SetTextureBlendMode(tex, SDL_BLENDMODE_BLEND);
+			numbers = std::shared_ptr<SDL_Texture>(tex, SDL_DestroyTexture);
+			slotNumbers.assign(slots, 0);
+			numberWidth = list.numberWidth;
+			numberColumns = columns;
+			slotHeight = list.lineHeight;
+		}
 
-	std::regex_constants::syntax_option_type opt = std::regex_constants::optimize;
-	if (!_langDef.caseSensitive)
-		opt |= std::regex_constants::icase;
-	for (const LanguageDefinition::TokenRegexString &r : _langDef.tokenRegexPatterns)
-		_regexes.push_back(std::make_pair(std::regex(r.first, opt), r.second));
+		return true;
+	}
 
-	return _langDef;
-}
+	void drawNumbers(const CodeEdit::DrawList::Command &cmd, CodeEdit::RenderStats &stats) {
+		// Composes the slots that hold other numbers in contiguous runs, then copies
+		// the numbers in two parts if they wrap around.
+		SDL_Texture* tex = numbers.get();
+		const int slots = (int)slotNumbers.size();
+		const int last = cmd.first + cmd.count;
+		for (int num = cmd.first; num < last; ) {
+			if (slotNumbers[num % slots] == num) {
+				++num;
 
-const CodeEdit::Palette &CodeEdit::getPalette(void) const {
-	return _palette;
-}
+				continue;
+			}
 
-void CodeEdit::setPalette(const Palette &val) {
-	_palette = val;
+			int end = num + 1;
+			while (end < last && end % slots != 0 && slotNumbers[end % slots] != end)
+				++end;
+			const SDL_Rect area{ 0, num % slots * slotHeight, numberColumns * glyphWidth, (end - num) * slotHeight };
+			void* pixels = nullptr;
+			int pitch = 0;
+			if (SDL_LockTexture(tex, &area, &pixels, &pitch) == 0) {
+				for (int i = num; i < end; ++i) {
+					char buf[16];
+					const int len = numberToChars(buf, numberWidth, i);
+					for (int y = 0; y < slotHeight; ++y) {
+						Uint32* row = (Uint32*)((Uint8*)pixels + ((i - num) * slotHeight + y) * pitch);
+						for (int k = 0; k < numberColumns; ++k) {
+							Uint32* dst = row + k * glyphWidth;
+							if (y >= glyphHeight || k >= len) {
+								std::fill(dst, dst + glyphWidth, 0);
+							} else {
+								const int g = buf[k] == ' ' ? 0 : buf[k] - '0' + 1;
+								std::copy_n(&glyphs[(g * glyphHeight + y) * glyphWidth], glyphWidth, dst);
+							}
+						}
+					}
+					slotNumbers[i % slots] = i;
+				}
+				SDL_UnlockTexture(tex);
+			}
+			num = end;
+		}
+
+		const Uint8* c = (const Uint8*)&cmd.color;
+		SDL_SetTextureColorMod(tex, c[0], c[1], c[2]);
+		SDL_SetTextureAlphaMod(tex, c[3]);
+		const int width = numberColumns * glyphWidth;
+		const int split = cmd.first % slots;
+		const int head = std::min(cmd.count, slots - split);
+		const SDL_Rect srcHead{ 0, split * slotHeight, width, head * slotHeight };
+		const SDL_Rect dstHead{ cmd.x, cmd.y, width, head * slotHeight };
+		SDL_RenderCopy(renderer, tex, &srcHead, &dstHead);
+		++stats.drawCalls;
+		if (cmd.count > head) {
+			const SDL_Rect srcTail{ 0, 0, width, (cmd.count - head) * slotHeight };
+			const SDL_Rect dstTail{ cmd.x, cmd.y + head * slotHeight, width, (cmd.count - head) * slotHeight };
+			SDL_RenderCopy(renderer, tex, &srcTail, &dstTail);
+			++stats.drawCalls;
+		}
+	}
+};
+
+static bool isSymbolGlyph(const CodeEdit::Glyph &g) {
+	return !g.multiLineComment &&
+		(g.colorIndex == CodeEdit::PaletteIndex::Identifier || g.colorIndex == CodeEdit::PaletteIndex::KnownIdentifier);
 }
 
-const CodeEdit::Vec2 &CodeEdit::getCharacterSize(void) const {
-	return _characterSize;
+static bool isIdentifierGlyph(const CodeEdit::Glyph &g) {
+	if (g.character > 0x7f)
+		return true; // Any multibyte character.
+
+	return !!(characterClasses()[(char)g.character] & (CHARACTER_IDENTIFIER | CHARACTER_DIGIT));
 }
 
-void CodeEdit::setCharacterSize(const Vec2 &val) {
-	_characterSize = val;
+static char foldCase(char c) {
+	return (c >= 'A' && c <= 'Z') ? (char)(c - 'A' + 'a') : c;
 }
 
-void CodeEdit::setErrorMarkers(const ErrorMarkers &val) {
-	_errorMarkers = val;
+struct CompletionMasks {
+	uint64_t table[256];
+
+	CompletionMasks() {
+		for (int c = 0; c < 256; ++c)
+			table[c] = 1ull << 63; // Others share a bit.
+		for (int c = 'a'; c <= 'z'; ++c)
+			table[c] = table[c - 'a' + 'A'] = 1ull << (c - 'a');
+		for (int c = '0'; c <= '9'; ++c)
+			table[c] = 1ull << (c - '0' + 26);
+		table['_'] = 1ull << 36;
+	}
+};
+
+static uint64_t completionMask(char c) {
+	static const CompletionMasks masks;
+
+	return masks.table[(unsigned char)c];
 }
 
-void CodeEdit::clearErrorMarkers(void) {
-	if (!_errorMarkers.empty())
-		_errorMarkers.clear();
+static bool isCompletionBoundary(char prev, char c) {
+	const uint8_t p = characterClasses()[prev];
+	const uint8_t q = characterClasses()[c];
+	if ((prev >= 'a' && prev <= 'z') && (c >= 'A' && c <= 'Z'))
+		return true; // Camel case.
+
+	return !(p & (CHARACTER_IDENTIFIER | CHARACTER_DIGIT)) || (prev == '_' && c != '_') || ((p & CHARACTER_DIGIT) && !(q & CHARACTER_DIGIT));
 }
 
-void CodeEdit::setBreakpoints(const Breakpoints &val) {
-	_breakpoints = val;
+static int scoreCompletion(const char* query, const char* folded, int n, const char* cand, const char* candFolded, int m) {
+	// Matches the query as a subsequence greedily, and rewards the characters
+	// that a typist is likely to mean.
+	int result = 0;
+	int last = -1;
+	int j = 0;
+	for (int i = 0; j < n; ++i) {
+		const char* p = (const char*)memchr(candFolded + i, folded[j], m - i);
+		if (!p)
+			return -1;
+
+		i = (int)(p - candFolded);
+		const char c = cand[i];
+		int s = COMPLETION_SCORE_MATCH;
+		if (i == 0)
+			s += COMPLETION_SCORE_FIRST;
+		else if (isCompletionBoundary(cand[i - 1], c))
+			s += COMPLETION_SCORE_BOUNDARY;
+		if (last >= 0 && last == i - 1)
+			s += COMPLETION_SCORE_CONSECUTIVE;
+		else
+			s -= std::min(i - last - 1, COMPLETION_PENALTY_GAP_MAX) * COMPLETION_PENALTY_GAP;
+		if (c == query[j])
+			s += COMPLETION_SCORE_CASE;
+		result += s;
+		last = i;
+		++j;
+	}
+
+	return std::max(result - (m - n), 0); // Prefers shorter candidates.
 }
 
-void CodeEdit::clearBrakpoints(void) {
-	if (!_breakpoints.empty())
-		_breakpoints.clear();
+struct CompletionCandidates {
+	// In flat arrays, a keystroke tests the masks one after another before
+	// looking at any text.
+	std::string text; // Words, each followed by a '\0'.
+	std::string folded; // Same as `text` in lowercase, scanned by matching.
+	std::vector<int> offsets;
+	std::vector<int> lengths;
+	std::vector<uint64_t> masks; // Characters that each word contains.
+
+	int count(void) const {
+		return (int)offsets.size();
+	}
+	const char* word(int idx) const {
+		return text.c_str() + offsets[idx];
+	}
+	int find(const std::string &w) const { // Index of the first word not less than the specific one.
+		return (int)(std::lower_bound(offsets.begin(), offsets.end(), w, [&] (int off, const std::string &r) { return strcmp(text.c_str() + off, r.c_str()) < 0; }) - offsets.begin());
+	}
+
+	void clear(void) {
+		text.clear();
+		folded.clear();
+		offsets.clear();
+		lengths.clear();
+		masks.clear();
+	}
+	void add(const std::string &w) {
+		const size_t offset = text.length();
+		const size_t n = w.length();
+		const char* in = w.c_str();
+		text.append(in, n + 1);
+		folded.resize(text.length());
+		char* out = &folded[offset];
+		uint64_t mask = 0;
+		for (size_t i = 0; i < n; ++i) {
+			out[i] = foldCase(in[i]);
+			mask |= completionMask(in[i]);
+		}
+		offsets.push_back((int)offset);
+		lengths.push_back((int)n);
+		masks.push_back(mask);
+	}
+	void append(const CompletionCandidates &other, int begin, int end) {
+		if (begin >= end)
+			return;
+
+		const int from = other.offsets[begin];
+		const int to = end < other.count() ? other.offsets[end] : (int)other.text.length();
+		const int shift = (int)text.length() - from;
+		text.append(other.text, from, to - from);
+		folded.append(other.folded, from, to - from);
+		for (int i = begin; i < end; ++i)
+			offsets.push_back(other.offsets[i] + shift);
+		lengths.insert(lengths.end(), other.lengths.begin() + begin, other.lengths.begin() + end);
+		masks.insert(masks.end(), other.masks.begin() + begin, other.masks.begin() + end);
+	}
+};
+
+struct CodeEdit::Language {
+	LanguageDefinition definition;
+	RegexList regexes; // Of the token patterns, empty if there is a tokenizer.
+};
+
+static const CodeEdit::LanguagePtr &getDefaultLanguage(void) {
+	static const CodeEdit::LanguagePtr language = CodeEdit::compileLanguage(CodeEdit::LanguageDefinition::C());
+
+	return language;
 }
 
-void CodeEdit::render(void* rnd) {
-	SDL_Renderer* renderer = (SDL_Renderer*)rnd;
+struct CodeEdit::TaskPool {
+	enum class Priority : uint8_t {
+		High, // Results the user waits for.
+		Normal,
+		Low, // Bookkeeping.
+		Max
+	};
 
-	constexpr float heightOffset = 1.0f;
-	const SDL_Rect rectContent{
-		(int)getWidgetPos().x, (int)getWidgetPos().y,
-		(int)getWidgetSize().x, (int)getWidgetSize().y
+	typedef std::shared_ptr<std::atomic<bool> > Token; // Drops the jobs posted with it once set.
+
+	struct Job {
+		enum Status {
+			Queued,
+			Running,
+			Done
+		};
+
+		std::function<void(void)> work;
+		Token token;
+		std::atomic<int> status{ Queued };
+		std::mutex lock;
+		std::condition_variable finished;
 	};
-	const float offsetCode = _charAdv.x * _textStart;
-	const SDL_Rect rectCode{
-		(int)(getWidgetPos().x + offsetCode), (int)getWidgetPos().y,
-		(int)(getWidgetSize().x - offsetCode), (int)getWidgetSize().y
+
+	typedef std::shared_ptr<Job> JobPtr;
+
+	struct Queue { // Of a worker, the others steal from it when theirs is empty.
+		std::mutex lock;
+		std::deque<JobPtr> jobs[(size_t)Priority::Max];
 	};
-	Clipper clipContent(renderer, rectContent);
 
-	_withinRender = true;
+	std::vector<std::unique_ptr<Queue> > queues;
+	std::atomic<unsigned> nextQueue{ 0 }; // Where to post to.
+	std::atomic<int> pending{ 0 }; // Jobs not taken yet.
+	std::mutex lock;
+	std::condition_variable signal;
+	bool quit = false;
 
-	const float xadv = _characterSize.x;
-	_charAdv = Vec2(xadv, _characterSize.y + _lineSpacing);
-	if (_codeLines.size() >= 10000)
-		_textStart = 7;
-	else if (_codeLines.size() >= 1000)
-		_textStart = 6;
-	else
-		_textStart = 5;
-	++_textStart; // For edited states.
+	std::vector<std::thread> workers; // Start after the members above.
 
-	const bool shift = isKeyShiftDown();
-	const bool ctrl = isKeyCtrlDown();
-	const bool alt = isKeyAltDown();
+	explicit TaskPool(int threads) {
+		for (int i = 0; i < threads; ++i)
+			queues.push_back(std::unique_ptr<Queue>(new Queue()));
+		for (int i = 0; i < threads; ++i)
+			workers.push_back(std::thread(&TaskPool::run, this, (size_t)i));
+	}
+	~TaskPool() {
+		{
+			std::lock_guard<std::mutex> guard(lock);
+			quit = true;
+		}
+		signal.notify_all();
+		for (std::thread &worker : workers)
+			worker.join(); // After the posted jobs are done.
+	}
 
-	if (isWidgetFocused()) {
-		if (_mouseCursorInput != isWidgetHovered()) {
-			if (_mouseCursorChangedHandler != nullptr)
-				_mouseCursorChangedHandler(isWidgetHovered());
-			_mouseCursorInput = isWidgetHovered();
+	JobPtr post(const std::function<void(void)> &work, Priority priority, const Token &token = nullptr) {
+		JobPtr job = std::make_shared<Job>();
+		job->work = work;
+		job->token = token;
+		Queue &queue = *queues[nextQueue++ % queues.size()];
+		{
+			std::lock_guard<std::mutex> guard(queue.lock);
+			queue.jobs[(size_t)priority].push_back(job);
+		}
+		{
+			std::lock_guard<std::mutex> guard(lock);
+			++pending;
 		}
+		signal.notify_one();
 
-		if (isShortcutsEnabled(ShortcutType::UndoRedo)) {
-			if (!isReadonly()) {
-				if (ctrl && !shift && !alt && isKeyPressed(SDLK_z)) {
-					undo();
-				} else if (ctrl && !shift && !alt && isKeyPressed(SDLK_y)) {
-					redo();
-				}
+		return job;
+	}
+
+	static void wait(const JobPtr &job) {
+		execute(*job); // Here, if no worker took it yet.
+
+		std::unique_lock<std::mutex> guard(job->lock);
+		job->finished.wait(guard, [&] (void) { return job->status == Job::Done; });
+	}
+
+	static void execute(Job &job) {
+		int status = Job::Queued;
+		if (!job.status.compare_exchange_strong(status, Job::Running))
+			return; // Taken by a waiting thread.
+
+		if (!job.token || !*job.token)
+			job.work();
+		job.work = nullptr;
+		{
+			std::lock_guard<std::mutex> guard(job.lock);
+			job.status = Job::Done;
+		}
+		job.finished.notify_all();
+	}
+
+	JobPtr take(size_t self) {
+		// Higher priorities first, from the own queue, then from the others, the
+		// oldest job of a queue first.
+		for (size_t p = 0; p < (size_t)Priority::Max; ++p) {
+			for (size_t i = 0; i < queues.size(); ++i) {
+				Queue &queue = *queues[(self + i) % queues.size()];
+				std::lock_guard<std::mutex> guard(queue.lock);
+				std::deque<JobPtr> &jobs = queue.jobs[p];
+				if (jobs.empty())
+					continue;
+
+				JobPtr job = jobs.front();
+				jobs.pop_front();
+				--pending;
+
+				return job;
 			}
 		}
 
-		if (isShortcutsEnabled(ShortcutType::CopyCutPaste)) {
-			if (ctrl && !shift && !alt && isKeyPressed(SDLK_c))
-				copy();
-			else if (!isReadonly() && ctrl && !shift && !alt && isKeyPressed(SDLK_v))
-				paste();
-			else if (ctrl && !shift && !alt && isKeyPressed(SDLK_x))
-				cut();
-			else if (ctrl && !shift && !alt && isKeyPressed(SDLK_a))
-				selectAll();
+		return nullptr;
+	}
+
+	void run(size_t self) {
+		for (; ; ) {
+			JobPtr job = take(self);
+			if (job) {
+				execute(*job);
+
+				continue;
+			}
+
+			std::unique_lock<std::mutex> guard(lock);
+			signal.wait(guard, [this] (void) { return quit || pending > 0; });
+			if (pending == 0)
+				return;
 		}
+	}
+};
 
-		if (!ctrl && !alt && isKeyPressed(SDLK_UP))
-			moveUp(1, shift);
-		else if (!ctrl && !alt && isKeyPressed(SDLK_DOWN))
-			moveDown(1, shift);
-		else if (!alt && isKeyPressed(SDLK_LEFT))
-			moveLeft(1, shift, ctrl);
-		else if (!alt && isKeyPressed(SDLK_RIGHT))
-			moveRight(1, shift, ctrl);
-		else if (!alt && isKeyPressed(SDLK_PAGEUP))
-			moveUp(getPageSize() - 4, shift);
-		else if (!alt && isKeyPressed(SDLK_PAGEDOWN))
-			moveDown(getPageSize() - 4, shift);
-		else if (!alt && ctrl && isKeyPressed(SDLK_HOME))
-			moveTop(shift);
-		else if (ctrl && !alt && isKeyPressed(SDLK_END))
-			moveBottom(shift);
-		else if (!ctrl && !alt && isKeyPressed(SDLK_HOME))
-			moveHome(shift);
-		else if (!ctrl && !alt && isKeyPressed(SDLK_END))
-			moveEnd(shift);
-		else if (!isReadonly() && !ctrl && !shift && !alt && isKeyPressed(SDLK_DELETE))
-			remove();
-		else if (!isReadonly() && !ctrl && !shift && !alt && isKeyPressed(SDLK_BACKSPACE))
-			backspace();
+static std::shared_ptr<CodeEdit::TaskPool> getDefaultTaskPool(void) {
+	static std::weak_ptr<CodeEdit::TaskPool> shared; // Until the last editor is gone.
+	std::shared_ptr<CodeEdit::TaskPool> result = shared.lock();
+	if (!result) {
+		result = CodeEdit::createTaskPool();
+		shared = result;
+	}
 
-		if (!isReadonly()) {
-			if (isKeyPressed(SDLK_RETURN) || onKeyPressed(SDLK_RETURN)) {
-				if (!alt) {
-					unsigned int c = '\n'; // Inserts new line.
-					addInputCharacter((CodeEdit::CodePoint)c);
+	return result;
+}
+
+struct CodeEdit::SymbolIndex {
+	typedef std::vector<std::pair<int, int> > Deltas; // Symbol id and change of its occurrences.
+
+	struct Handover { // Changes of a frame, the job applies them in order.
+		std::vector<std::pair<int, std::string> > words; // Ids named in the frame.
+		Deltas deltas;
+		std::vector<int> retired; // Ids no longer used, named again later.
+	};
+
+	// Accessed by the UI thread only.
+	std::unordered_map<std::string, int> ids;
+	Symbols words; // By id, empty for free ids.
+	std::vector<int> uses; // Occurrences of each word.
+	std::vector<int> freeIds;
+	std::vector<int> named; // Ids named in this frame.
+	std::vector<int> unused; // Ids whose occurrences dropped to none in this frame.
+	Deltas pending;
+	std::shared_ptr<TaskPool> pool;
+	TaskPool::Token canceled = std::make_shared<std::atomic<bool> >(false);
+
+	// Accessed by one job at a time.
+	Symbols all;
+	std::vector<int> counts;
+	std::vector<int> live; // Ids of the words that occur, sorted by word.
+	std::vector<int> born;
+
+	// Shared with the job, guarded by `lock`.
+	std::mutex lock;
+	std::vector<Handover> handovers;
+	bool reset = false;
+	TaskPool::JobPtr job; // Takes the work handed over until there is none, nullptr if idle.
+	std::shared_ptr<const Symbols> sorted = std::make_shared<Symbols>(); // Words that occur, published by the job.
+	std::shared_ptr<const CompletionCandidates> candidates = std::make_shared<CompletionCandidates>(); // Same words, prepared for completion.
+
+	~SymbolIndex() {
+		*canceled = true;
+		TaskPool::JobPtr running;
+		{
+			std::lock_guard<std::mutex> guard(lock);
+			running = job;
+		}
+		if (running)
+			TaskPool::wait(running);
+	}
+
+	int intern(const std::string &word) {
+		auto it = ids.find(word);
+		if (it != ids.end())
+			return it->second;
+
+		int id = 0;
+		if (freeIds.empty()) {
+			id = (int)words.size();
+			words.push_back(word);
+			uses.push_back(0);
+		} else {
+			id = freeIds.back();
+			freeIds.pop_back();
+			words[id] = word;
+		}
+		ids[word] = id;
+		named.push_back(id);
+
+		return id;
+	}
+
+	void count(int id, int diff) {
+		pending.push_back(std::make_pair(id, diff));
+		uses[id] += diff;
+		if (uses[id] == 0)
+			unused.push_back(id);
+	}
+
+	void clear(void) {
+		ids.clear();
+		words.clear();
+		uses.clear();
+		freeIds.clear();
+		named.clear();
+		unused.clear();
+		pending.clear();
+
+		std::lock_guard<std::mutex> guard(lock);
+		handovers.clear();
+		reset = true;
+		schedule();
+	}
+
+	void flush(void) {
+		if (pending.empty() && named.empty())
+			return;
+
+		// Words still unused at the end of the frame give their ids back, after
+		// their last changes so that the job sees them in order.
+		Handover handover;
+		for (int id : named)
+			handover.words.push_back(std::make_pair(id, words[id]));
+		named.clear();
+		handover.deltas.swap(pending);
+		for (int id : unused) {
+			if (uses[id] != 0 || words[id].empty())
+				continue; // Used again, or given back already.
+
+			ids.erase(words[id]);
+			std::string().swap(words[id]);
+			freeIds.push_back(id);
+			handover.retired.push_back(id);
+		}
+		unused.clear();
+
+		std::lock_guard<std::mutex> guard(lock);
+		handovers.push_back(std::move(handover));
+		schedule();
+	}
+
+	void schedule(void) { // With `lock` held.
+		if (!job)
+			job = pool->post(std::bind(&SymbolIndex::run, this), TaskPool::Priority::Low, canceled);
+	}
+
+	std::shared_ptr<const Symbols> snapshot(void) {
+		std::lock_guard<std::mutex> guard(lock);
+
+		return sorted;
+	}
+
+	std::shared_ptr<const CompletionCandidates> completions(void) {
+		std::lock_guard<std::mutex> guard(lock);
+
+		return candidates;
+	}
+
+	void run(void) {
+		auto less = [&] (int l, int r) -> bool { return all[l] < all[r]; };
+		for (; ; ) {
+			std::vector<Handover> work;
+			bool restart = false;
+			{
+				std::lock_guard<std::mutex> guard(lock);
+				if (*canceled || (!reset && handovers.empty())) {
+					job = nullptr;
+
+					return;
 				}
-			} else if (isKeyPressed(SDLK_TAB)) {
-				if (hasSelection() && getSelectionLines() > 1) {
-					if (!ctrl && !alt && !shift) // Indents multi-lines.
-						indent();
-					else if (!ctrl && !alt && shift) // Unindents multi-lines.
-						unindent();
-					else if (ctrl && !alt && shift) // Unindents multi-lines.
-						unindent();
-				} else {
-					if (!ctrl && !alt && !shift) {
-						unsigned int c = '\t'; // Inserts tab.
-						addInputCharacter((CodeEdit::CodePoint)c);
-					} else if (!ctrl && !alt && shift) {
-						CodeEdit::Char cc = getCharUnderCursor();
-						if (cc == '\t' || cc == ' ')
-							backspace(); // Unindents single line.
-					} else if (ctrl && !alt && shift) {
-						CodeEdit::Char cc = getCharUnderCursor();
-						if (cc == '\t' || cc == ' ')
-							backspace(); // Unindents single line.
+
+				work.swap(handovers);
+				restart = reset;
+				reset = false;
+			}
+
+			bool changed = restart;
+			if (restart) {
+				all.clear();
+				counts.clear();
+				live.clear();
+			}
+			born.clear();
+			for (Handover &h : work) {
+				for (std::pair<int, std::string> &w : h.words) {
+					if (w.first >= (int)all.size()) {
+						all.resize(w.first + 1);
+						counts.resize(w.first + 1, 0);
 					}
+					all[w.first] = std::move(w.second);
+					counts[w.first] = 0;
+				}
+				for (const std::pair<int, int> &d : h.deltas) {
+					int &count = counts[d.first];
+					const bool occurred = count > 0;
+					count += d.second;
+					if (!occurred && count > 0)
+						born.push_back(d.first);
+					changed |= occurred != (count > 0);
+				}
+				for (int id : h.retired) {
+					// Leaves the sorted ones before its id names another word.
+					std::vector<int>::iterator it = std::lower_bound(live.begin(), live.end(), id, less);
+					if (it != live.end() && *it == id)
+						live.erase(it);
+					std::string().swap(all[id]);
 				}
 			}
-		}
+			if (!changed)
+				continue;
 
-		if (!isReadonly() && (!_inputCharacters.empty() && _inputCharacters[0])) {
-			const std::string tmp = strToUtf8StdStr(_inputCharacters.c_str(), nullptr);
-			char* str = (char*)tmp.c_str();
-			while (*str && str < (char*)tmp.c_str() + tmp.length()) {
-				int n = expectUtf8Char(str);
-				CodeEdit::Char c = takeUtf8Bytes(str, n);
-				if (c != 0) {
-					if (c == '\r')
-						c = '\n';
-					enterCharacter(c);
-				}
-				str += n;
+			// Merges the words that begin to occur into the sorted ones that still do,
+			// off the UI thread.
+			live.erase(std::remove_if(live.begin(), live.end(), [&] (int id) { return counts[id] <= 0; }), live.end());
+			born.erase(std::remove_if(born.begin(), born.end(), [&] (int id) { return counts[id] <= 0 || std::binary_search(live.begin(), live.end(), id, less); }), born.end());
+			std::sort(born.begin(), born.end(), less);
+			born.erase(std::unique(born.begin(), born.end()), born.end());
+			const size_t middle = live.size();
+			live.insert(live.end(), born.begin(), born.end());
+			std::inplace_merge(live.begin(), live.begin() + middle, live.end(), less);
+			std::shared_ptr<Symbols> result = std::make_shared<Symbols>();
+			std::shared_ptr<CompletionCandidates> list = std::make_shared<CompletionCandidates>();
+			result->reserve(live.size());
+			for (int id : live) {
+				result->push_back(all[id]);
+				list->add(all[id]);
 			}
+
+			std::lock_guard<std::mutex> guard(lock);
+			sorted = result;
+			candidates = list;
 		}
-		_inputCharacters.clear();
 	}
+};
 
-	if (isWidgetHovered()) {
-		if (!shift && !alt) {
-			if (isMousePressed()) {
-				_state.cursorPosition = _interactiveStart = _interactiveEnd = sanitizeCoordinates(screenPosToCoordinates(getMousePos()));
-				if (ctrl)
-					_wordSelectionMode = true;
-				setSelection(_interactiveStart, _interactiveEnd, _wordSelectionMode);
-			}
-			if (isMouseDoubleClicked() && !ctrl) {
-				_state.cursorPosition = _interactiveStart = _interactiveEnd = sanitizeCoordinates(screenPosToCoordinates(getMousePos()));
-				_wordSelectionMode = true;
-				setSelection(_interactiveStart, _interactiveEnd, _wordSelectionMode);
-				_state.cursorPosition = _state.selectionEnd;
-			} else if (isMouseDragging() && isMouseDown()) {
-				_state.cursorPosition = _interactiveEnd = sanitizeCoordinates(screenPosToCoordinates(getMousePos()));
-				setSelection(_interactiveStart, _interactiveEnd, _wordSelectionMode);
+struct CodeEdit::CompletionPopup {
+	typedef std::pair<int, int> Item; // Score and candidate.
+
+	struct Matches {
+		size_t length = 0; // Of the beginning of the query.
+		std::vector<int> candidates;
+		std::vector<int> scores;
+	};
+
+	CompletionCandidates candidates; // Language words merged into the document identifiers.
+	std::vector<PaletteIndex> colors;
+	std::shared_ptr<const CompletionCandidates> document; // Identifiers prepared by the symbol index.
+	bool stale = true; // Whether the language definition changed since built.
+
+	bool open = false;
+	bool manual = false; // Stays open with an empty word.
+	Coordinates anchor; // Where the completed word begins.
+	std::string query; // Typed part of the word.
+	std::vector<Matches> matches; // For growing beginnings of the query, reused as it grows or shrinks.
+	std::vector<Item> items; // Best matches, ranked.
+	int selected = 0;
+	int top = 0; // First visible item.
+	Vec4 rect; // Where the popup was drawn.
+
+	const char* candidate(int idx) const {
+		return candidates.word(idx);
+	}
+
+	void build(const LanguageDefinition &langDef, const std::shared_ptr<const CompletionCandidates> &doc) {
+		typedef std::pair<std::string, PaletteIndex> Word;
+
+		std::vector<Word> words;
+		for (const std::string &k : langDef.keys)
+			words.push_back(Word(k, PaletteIndex::Keyword));
+		for (const Identifiers::value_type &i : langDef.ids)
+			words.push_back(Word(i.first, PaletteIndex::KnownIdentifier));
+		for (const Identifiers::value_type &i : langDef.preprocIds)
+			words.push_back(Word(i.first, PaletteIndex::PreprocIdentifier));
+		std::sort(words.begin(), words.end()); // Keywords come first among the same words.
+		words.erase(std::unique(words.begin(), words.end(), [] (const Word &l, const Word &r) { return l.first == r.first; }), words.end());
+
+		document = doc;
+		stale = false;
+		candidates.clear();
+		colors.clear();
+
+		// Inserts the few language words among the document identifiers, which are sorted
+		// already, and copies those in between as they are.
+		int copied = 0;
+		for (const Word &w : words) {
+			int pos = document->find(w.first);
+			candidates.append(*document, copied, pos);
+			colors.insert(colors.end(), pos - copied, PaletteIndex::Identifier);
+			if (pos < document->count() && w.first == document->word(pos))
+				++pos;
+			candidates.add(w.first);
+			colors.push_back(w.second);
+			copied = pos;
+		}
+		candidates.append(*document, copied, document->count());
+		colors.insert(colors.end(), document->count() - copied, PaletteIndex::Identifier);
+		matches.clear();
+		query.clear();
+	}
+
+	void match(const std::string &word) {
+		std::string lowered = word;
+		for (char &c : lowered)
+			c = foldCase(c);
+
+		// Narrows down the matches of the longest common beginning with the last query,
+		// as every candidate matching a query matches its beginning too.
+		size_t common = 0;
+		while (common < query.length() && common < word.length() && query[common] == word[common])
+			++common;
+		while (!matches.empty() && matches.back().length > common)
+			matches.pop_back();
+		if (!word.empty() && (matches.empty() || matches.back().length < word.length())) {
+			uint64_t need = 0;
+			for (char c : lowered)
+				need |= completionMask(c);
+			Matches next;
+			next.length = word.length();
+			int count = 0;
+			if (matches.empty()) {
+				const uint64_t* m = candidates.masks.data();
+				next.candidates.resize(candidates.count());
+				for (int i = 0; i < candidates.count(); ++i) {
+					next.candidates[count] = i; // Without branches.
+					count += (m[i] & need) == need;
+				}
+			} else {
+				const std::vector<int> &prev = matches.back().candidates;
+				next.candidates.resize(prev.size());
+				for (int i : prev) {
+					next.candidates[count] = i;
+					count += (candidates.masks[i] & need) == need;
+				}
 			}
-		} else if (shift) {
-			if (isMousePressed()) {
-				_state.cursorPosition = _interactiveEnd = sanitizeCoordinates(screenPosToCoordinates(getMousePos()));
-				setSelection(_interactiveStart, _interactiveEnd, _wordSelectionMode);
+			next.candidates.resize(count);
+
+			// Scores the ones that pass, also dropping those without the characters in order.
+			next.scores.reserve(count);
+			count = 0;
+			for (int i : next.candidates) {
+				const int score = scoreCompletion(word.c_str(), lowered.c_str(), (int)word.length(), candidate(i), candidates.folded.c_str() + candidates.offsets[i], candidates.lengths[i]);
+				next.candidates[count] = i;
+				if (score >= 0) {
+					next.scores.push_back(score);
+					++count;
+				}
 			}
+			next.candidates.resize(count);
+			matches.push_back(std::move(next));
 		}
+		query = word;
 
-		if (!isMouseDown()) {
-			_wordSelectionMode = false;
+		// Ranks the matches.
+		items.clear();
+		if (word.empty()) {
+			for (int i = 0; i < candidates.count() && i < COMPLETION_MAX_ITEMS; ++i)
+				items.push_back(Item(0, i));
+		} else {
+			const Matches &last = matches.back();
+			for (size_t k = 0; k < last.candidates.size(); ++k) {
+				const int i = last.candidates[k];
+				if (candidates.lengths[i] == (int)word.length() && word == candidate(i))
+					continue; // Completes nothing.
+
+				items.push_back(Item(last.scores[k], i));
+			}
+			auto better = [] (const Item &l, const Item &r) -> bool {
+				if (l.first != r.first)
+					return l.first > r.first;
+
+				return l.second < r.second; // Alphabetically.
+			};
+			const size_t count = std::min(items.size(), (size_t)COMPLETION_MAX_ITEMS);
+			std::partial_sort(items.begin(), items.begin() + count, items.end(), better);
+			items.resize(count);
 		}
+		selected = 0;
+		top = 0;
 	}
+};
 
-	colorizeInternal();
+struct CodeEdit::FileTask {
+	// Accessed by the UI thread only.
+	bool loading = false;
+	std::string path;
+	std::string newLine; // To save with, or detected by loading.
+	TextEncoding encoding = TextEncoding::Utf8; // Likewise.
+	Snapshot snapshot; // Of the text to save.
+	unsigned version = 0; // Of the text to save.
+	FileProgressed progressed;
+	FileFinished finished;
+
+	int tabSize = 4; // Of the widget when loading began.
+	int wideWidth = 1;
+
+	// Written by the job, read by the UI thread after `completed`.
+	std::shared_ptr<GlyphPool> pool; // Of the loaded lines.
+	Lines lines; // Loaded.
+	LineWidths widths; // Of the loaded lines.
+	FileResult result = FileResult::Failed;
+
+	// Shared with the job.
+	std::atomic<long long> done{ 0 };
+	std::atomic<long long> total{ 0 };
+	std::atomic<bool> canceled{ false };
+	std::atomic<bool> completed{ false };
+
+	TaskPool::JobPtr job;
+
+	~FileTask() {
+		canceled = true;
+		if (job)
+			TaskPool::wait(job);
+	}
 
-	static std::string buffer; // Shared.
-	Vec2 contentSize = getWidgetSize();
-	int appendIndex = 0;
-	int longest = _textStart;
+	float progress(void) const {
+		const long long n = total;
+		if (n <= 0)
+			return 0.0f;
 
-	const Vec2 cursorScreenPos = getWidgetPos();
-	const float scrollX = getScrollX();
-	const float scrollY = getScrollY();
+		return std::min((float)done / n, 1.0f);
+	}
 
-	int lineNo = (int)floor(scrollY / _charAdv.y);
-	const int lineMax = std::max(0, std::min((int)_codeLines.size() - 1, lineNo + (int)ceil(contentSize.y / _charAdv.y)));
-	if (!_codeLines.empty()) {
-		while (lineNo <= lineMax) {
-			Vec2 lineStartScreenPos(
-				cursorScreenPos.x - scrollX,
-				cursorScreenPos.y - scrollY + lineNo * _charAdv.y
-			);
-			Vec2 textScreenPos(
-				lineStartScreenPos.x + _charAdv.x * _textStart,
-				lineStartScreenPos.y
-			);
+	void load(void) {
+		FILE* fp = fopen(path.c_str(), "rb");
+		if (fp == nullptr) {
+			complete(FileResult::Failed);
 
-			const Line &line = _codeLines[lineNo];
-			longest = std::max(_textStart + textDistanceToLineStart(Coordinates(lineNo, (int)line.size())), longest);
-			int columnNo = 0;
-			const Coordinates lineStartCoord(lineNo, 0);
-			const Coordinates lineEndCoord(lineNo, (int)line.size());
+			return;
+		}
+		fseek(fp, 0, SEEK_END);
+		total = ftell(fp);
+		fseek(fp, 0, SEEK_SET);
+
+		// Decodes block by block, keeps a character or line break that crosses blocks for the next one.
+		std::vector<char> buf(FILE_BLOCK_BYTES + 8);
+		size_t kept = 0;
+		TextDecoder decoder;
+		pool = std::make_shared<GlyphPool>();
+		lines.assign(1, Line(GlyphAllocator<Glyph>(pool.get())));
+		for (;;) {
+			if (canceled)
+				break;
 
-			int sstart = -1;
-			int ssend = -1;
+			const size_t n = fread(&buf.front() + kept, 1, FILE_BLOCK_BYTES, fp);
+			const bool eof = n < (size_t)FILE_BLOCK_BYTES;
+			const char* begin = &buf.front();
+			const char* end = begin + kept + n;
+			const char* stop = decoder.decode(lines, begin, end, eof);
+			done += (long long)n;
+			if (eof)
+				break;
 
-			assert(_state.selectionStart <= _state.selectionEnd);
-			if (_state.selectionStart <= lineEndCoord)
-				sstart = _state.selectionStart > lineStartCoord ? textDistanceToLineStart(_state.selectionStart) : 0;
-			if (_state.selectionEnd > lineStartCoord)
-				ssend = textDistanceToLineStart(_state.selectionEnd < lineEndCoord ? _state.selectionEnd : lineEndCoord);
+			kept = end - stop;
+			memmove(&buf.front(), stop, kept);
+		}
+		encoding = decoder.encoding;
+		if (decoder.newLine != nullptr)
+			newLine = decoder.newLine;
+		const bool failed = ferror(fp) != 0;
+		fclose(fp);
+
+		if (canceled) {
+			lines.clear();
+			complete(FileResult::Canceled);
+		} else if (failed) {
+			lines.clear();
+			complete(FileResult::Failed);
+		} else {
+			measure();
+			complete(FileResult::Succeeded);
+		}
+	}
 
-			if (_state.selectionEnd.line > lineNo)
-				++ssend;
+	void measure(void) {
+		// Same as `advanceDistance`, saves the UI thread from rebuilding the widths.
+		for (Line &line : lines) {
+			int len = 0;
+			for (const Glyph &g : line) {
+				if (g.character == '\t')
+					len = (len / tabSize) * tabSize + tabSize;
+				else if (g.character <= 255 || isPrintable(g.codepoint))
+					++len;
+				else
+					len += wideWidth;
+			}
+			line.width = len;
+			countLineWidth(widths, len, 1);
+		}
+	}
 
-			if (sstart != -1 && ssend != -1 && sstart < ssend) {
-				Clipper clipCode(renderer, rectCode);
+	void save(void) {
+		const std::string temp = path + ".tmp";
+		FILE* fp = fopen(temp.c_str(), "wb");
+		if (fp == nullptr) {
+			complete(FileResult::Failed);
 
-				const Vec2 vstart(lineStartScreenPos.x + (_charAdv.x) * (sstart + _textStart), lineStartScreenPos.y);
-				const Vec2 vend(lineStartScreenPos.x + (_charAdv.x) * (ssend + _textStart), lineStartScreenPos.y + _charAdv.y - heightOffset);
-				boxColor(renderer, (Sint16)vstart.x, (Sint16)vstart.y, (Sint16)vend.x, (Sint16)vend.y, _palette[(int)PaletteIndex::Selection]);
+			return;
+		}
+		long long bytes = 0;
+		for (const Snapshot::ChunkPtr &chunk : snapshot.chunks)
+			bytes += (long long)chunk->bytes.length();
+		total = bytes;
+
+		const bool utf16 = encoding == TextEncoding::Utf16LE || encoding == TextEncoding::Utf16BE;
+		const bool bigEndian = encoding == TextEncoding::Utf16BE;
+		bool ok = true;
+		if (encoding == TextEncoding::Utf8Bom)
+			ok = fwrite("\xef\xbb\xbf", 1, 3, fp) == 3;
+		else if (utf16)
+			ok = fwrite(bigEndian ? "\xfe\xff" : "\xff\xfe", 1, 2, fp) == 2;
+
+		// Lines in a chunk end with '\n' already, except that the last line of the text has none.
+		std::string block;
+		std::string encoded;
+		for (size_t i = 0; i < snapshot.chunks.size() && ok && !canceled; ++i) {
+			const Snapshot::Chunk &chunk = *snapshot.chunks[i];
+			const bool last = i + 1 == snapshot.chunks.size();
+			const std::string* out = &chunk.bytes;
+			size_t n = chunk.bytes.length() - (last && !chunk.bytes.empty() ? 1 : 0);
+			if (newLine != "\n") {
+				block.clear();
+				for (size_t ln = 0; ln + 1 < chunk.starts.size(); ++ln) {
+					block.append(chunk.bytes, chunk.starts[ln], chunk.starts[ln + 1] - chunk.starts[ln] - 1);
+					if (!(last && ln + 2 == chunk.starts.size()))
+						block += newLine;
+				}
+				out = &block;
+				n = block.length();
+			}
+			if (utf16) {
+				encoded.clear();
+				transcodeUtf8ToUtf16(encoded, out->c_str(), out->c_str() + n, bigEndian);
+				out = &encoded;
+				n = encoded.length();
 			}
+			ok = fwrite(out->c_str(), 1, n, fp) == n;
+			done += (long long)chunk.bytes.length();
+		}
+		ok = fclose(fp) == 0 && ok;
 
-			const Vec2 start(lineStartScreenPos.x + scrollX, lineStartScreenPos.y);
+		if (canceled || !ok) {
+			::remove(temp.c_str());
+			complete(canceled ? FileResult::Canceled : FileResult::Failed);
 
-			if (_breakpoints.find(lineNo + 1) != _breakpoints.end()) {
-				Clipper clipCode(renderer, rectCode);
+			return;
+		}
+#if defined _WIN32
+		// `rename` does not replace an existing file on Windows, this does in one step.
+		const bool moved = !!::MoveFileExA(temp.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH);
+#else /* _WIN32 */
+		const bool moved = ::rename(temp.c_str(), path.c_str()) == 0;
+#endif /* _WIN32 */
+		if (!moved)
+			::remove(temp.c_str());
+		complete(moved ? FileResult::Succeeded : FileResult::Failed);
+	}
 
-				const Vec2 end(lineStartScreenPos.x + contentSize.x + 2.0f * scrollX, lineStartScreenPos.y + _charAdv.y - heightOffset);
-				boxColor(renderer, (Sint16)start.x, (Sint16)start.y, (Sint16)end.x, (Sint16)end.y, _palette[(int)PaletteIndex::Breakpoint]);
-			}
+	void complete(FileResult ret) {
+		result = ret;
+		completed = true;
+	}
+};
 
-			auto errorIt = _errorMarkers.find(lineNo + 1);
-			if (errorIt != _errorMarkers.end()) {
-				Clipper clipCode(renderer, rectCode);
+struct CodeEdit::ColorTask {
+	struct Part {
+		int firstLine = 0;
+		int lines = 0;
+		LanguageDefinition::TokenSpans spans; // Of all lines, with identifiers resolved.
+		std::vector<int> starts; // Where the spans of each line begin, and the end of the last one.
+		std::vector<uint8_t> enterStates; // The first one is assumed, it may turn out wrong.
+		std::vector<uint8_t> exitStates;
+		std::vector<int> glyphs; // Of each line, the indexing below holds if the line has as many.
+		std::vector<BracketBalance> brackets;
+		SymbolSpans symbols; // Of all lines, with ids into `words`.
+		std::vector<int> symbolStarts; // Where the symbols of each line begin, and the end of the last one.
+		std::vector<std::string> words; // Met in the part, each once.
+		std::atomic<bool> done{ false };
+	};
 
-				const Vec2 end(lineStartScreenPos.x + contentSize.x + 2.0f * scrollX, lineStartScreenPos.y + _charAdv.y - heightOffset);
-				boxColor(renderer, (Sint16)start.x, (Sint16)start.y, (Sint16)end.x, (Sint16)end.y, _palette[(int)PaletteIndex::ErrorMarker]);
+	// Accessed by the UI thread only.
+	unsigned version = 0; // Of the text being colorized.
+	int next = 0; // First line to adopt.
+	uint8_t state = 0; // Entering `next`.
+	size_t adopting = 0; // Part of `next`.
+	int editedFrom = std::numeric_limits<int>::max(); // First line edited since `version`.
+
+	// Read by the jobs.
+	LanguagePtr language;
+	Snapshot snapshot;
+	uint8_t firstState = 0; // Entering the first part.
+	std::deque<Part> parts; // Only changed while no job runs.
+
+	// Shared with the jobs.
+	TaskPool::Token token; // Of the version, set by an edit.
+	std::atomic<bool> canceled{ false };
+
+	std::vector<TaskPool::JobPtr> jobs; // One per part.
+
+	~ColorTask() {
+		canceled = true;
+		for (const TaskPool::JobPtr &job : jobs)
+			TaskPool::wait(job);
+	}
 
-				//if (_tooltipEnabled) {
-				//	if (ImGui::IsMouseHoveringRect(lineStartScreenPos, end)) {
-				//		ImGui::BeginTooltip();
-				//		ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(1.0f, 0.2f, 0.2f, 1.0f));
-				//		ImGui::Text("Error at line %d:", errorIt->first);
-				//		ImGui::PopStyleColor();
-				//		ImGui::Separator();
-				//		ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(1.0f, 1.0f, 0.2f, 1.0f));
-				//		ImGui::Text("%s", errorIt->second.c_str());
-				//		ImGui::PopStyleColor();
-				//		ImGui::EndTooltip();
-				//	}
-				//}
+	void lex(size_t i) {
+		// Continues from the previous part if it lexed all its lines, otherwise
+		// assumes no comment or string is open, the adopting corrects wrong guesses.
+		Part &part = parts[i];
+		if (canceled || *token) {
+			part.done = true; // Dropped, run by a wait or after an edit.
+
+			return;
+		}
+
+		uint8_t st = firstState;
+		if (i > 0) {
+			const Part &previous = parts[i - 1];
+			const bool finished = previous.done && !previous.exitStates.empty() && (int)previous.exitStates.size() == previous.lines;
+			st = finished ? previous.exitStates.back() : 0;
+		}
+		LanguageDefinition::TokenSpans spans; // Of a line, the tokenizer may merge into the last span.
+		std::unordered_map<std::string, int> ids; // Of `part.words`.
+		part.starts.reserve(part.lines + 1);
+		part.enterStates.reserve(part.lines);
+		part.exitStates.reserve(part.lines);
+		part.glyphs.reserve(part.lines);
+		part.brackets.reserve(part.lines);
+		part.symbolStarts.reserve(part.lines + 1);
+		for (int ln = part.firstLine; ln < part.firstLine + part.lines && !canceled && !*token; ++ln) {
+			const Snapshot::Text txt = snapshot.getLine(ln);
+			const size_t first = part.spans.size();
+			part.starts.push_back((int)first);
+			part.enterStates.push_back(st);
+			st = lexLine(language->definition, txt.begin(), txt.end(), st, spans);
+			part.spans.insert(part.spans.end(), spans.begin(), spans.end());
+			part.exitStates.push_back(st);
+			index(part, txt, first, ids);
+		}
+		part.starts.push_back((int)part.spans.size());
+		part.symbolStarts.push_back((int)part.symbols.size());
+		part.done = true;
+	}
+
+	static void index(Part &part, const Snapshot::Text &txt, size_t first, std::unordered_map<std::string, int> &ids) {
+		// Finds the brackets and symbols that indexing the glyphs would find once
+		// the spans from `first` on are applied, saving that work to the adopting.
+		const LanguageDefinition::TokenSpan* span = part.spans.data() + first;
+		const LanguageDefinition::TokenSpan* last = part.spans.data() + part.spans.size();
+		int spanEnd = span != last ? span->first : 0;
+		BracketBalance balance(0, 0);
+		const char* word = nullptr; // Where the symbol being read begins.
+		int wordColumn = 0;
+		PaletteIndex wordColor = PaletteIndex::Default;
+		int column = 0;
+		part.symbolStarts.push_back((int)part.symbols.size());
+		for (const char* p = txt.begin(); ; ++column) {
+			PaletteIndex color = PaletteIndex::Default;
+			if (p < txt.end()) {
+				const int pos = (int)(p - txt.begin());
+				while (span != last && pos >= spanEnd) {
+					if (++span != last)
+						spanEnd += span->first;
+				}
+				if (span != last)
+					color = span->second;
+			}
+			const bool symbol = p < txt.end() && (color == PaletteIndex::Identifier || color == PaletteIndex::KnownIdentifier);
+			if (word && (!symbol || color != wordColor)) {
+				auto it = ids.insert(std::make_pair(std::string(word, p), (int)part.words.size()));
+				if (it.second)
+					part.words.push_back(it.first->first);
+				part.symbols.push_back(SymbolSpan(wordColumn, column - wordColumn, it.first->second));
+				word = nullptr;
 			}
+			if (p == txt.end())
+				break;
 
-			static char buf[16]; // Shared.
-			switch (_textStart - 1) {
-			case 5: snprintf(buf, countof(buf), "%4d", lineNo + 1); break;
-			case 6: snprintf(buf, countof(buf), "%5d", lineNo + 1); break;
-			default: snprintf(buf, countof(buf), "%6d", lineNo + 1); break;
+			if (symbol && !word) {
+				word = p;
+				wordColumn = column;
+				wordColor = color;
 			}
-			stringColor(renderer, (Sint16)(lineStartScreenPos.x + scrollX), (Sint16)lineStartScreenPos.y, buf, _palette[(int)PaletteIndex::LineNumber]);
-			switch (line.changed) {
-			case LineState::None:
-				// Does nothing.
+			const bool code = color != PaletteIndex::Comment && color != PaletteIndex::MultiLineComment &&
+				color != PaletteIndex::String && color != PaletteIndex::CharLiteral;
+			if (code && isOpeningBracket((unsigned char)*p)) {
+				++balance.second;
+			} else if (code && isClosingBracket((unsigned char)*p)) {
+				if (balance.second > 0)
+					--balance.second;
+				else
+					++balance.first;
+			}
+			const int n = measureUtf8Char(p, txt.end());
+			p += n > 0 ? n : 1; // As the text was split into glyphs.
+		}
+		part.glyphs.push_back(column);
+		part.brackets.push_back(balance);
+	}
+};
+
+CodeEdit::LanguageDefinition CodeEdit::LanguageDefinition::AngelScript(void) {
+	static bool inited = false;
+	static LanguageDefinition langDef;
+	if (!inited) {
+		static const char* const keywords[] = {
+			"and", "abstract", "auto", "bool", "break", "case", "cast", "class", "const", "continue", "default", "do", "double", "else", "enum", "false", "final", "float", "for",
+			"from", "funcdef", "function", "get", "if", "import", "in", "inout", "int", "interface", "int8", "int16", "int32", "int64", "is", "mixin", "namespace", "not",
+			"null", "or", "out", "override", "private", "protected", "return", "set", "shared", "super", "switch", "this ", "true", "typedef", "uint", "uint8", "uint16", "uint32",
+			"uint64", "void", "while", "xor"
+		};
+
+		for (const char* const k : keywords)
+			langDef.keys.insert(k);
+
+		static const char* const identifiers[] = {
+			"cos", "sin", "tab", "acos", "asin", "atan", "atan2", "cosh", "sinh", "tanh", "log", "log10", "pow", "sqrt", "abs", "ceil", "floor", "fraction", "closeTo", "fpFromIEEE", "fpToIEEE",
+			"complex", "opEquals", "opAddAssign", "opSubAssign", "opMulAssign", "opDivAssign", "opAdd", "opSub", "opMul", "opDiv"
+		};
+		for (const char* const k : identifiers) {
+			Identifier id;
+			id.declaration = "Built-in function";
+			langDef.ids.insert(std::make_pair(std::string(k), id));
+		}
+
+		langDef.tokenRegexPatterns.push_back(std::make_pair<std::string, PaletteIndex>("//.*", PaletteIndex::Comment));
+		langDef.tokenRegexPatterns.push_back(std::make_pair<std::string, PaletteIndex>("L?\\\"(\\\\.|[^\\\"])*\\\"", PaletteIndex::String));
+		langDef.tokenRegexPatterns.push_back(std::make_pair<std::string, PaletteIndex>("\\'\\\\?[^\\']\\'", PaletteIndex::String));
+		langDef.tokenRegexPatterns.push_back(std::make_pair<std::string, PaletteIndex>("[+-]?([0-9]+([.][0-9]*)?|[.][0-9]+)([eE][+-]?[0-9]+)?[fF]?", PaletteIndex::Number));
+		langDef.tokenRegexPatterns.push_back(std::make_pair<std::string, PaletteIndex>("[+-]?[0-9]+[Uu]?[lL]?[lL]?", PaletteIndex::Number));
+		langDef.tokenRegexPatterns.push_back(std::make_pair<std::string, PaletteIndex>("0[0-7]+[Uu]?[lL]?[lL]?", PaletteIndex::Number));
+		langDef.tokenRegexPatterns.push_back(std::make_pair<std::string, PaletteIndex>("0[xX][0-9a-fA-F]+[uU]?[lL]?[lL]?", PaletteIndex::Number));
+		langDef.tokenRegexPatterns.push_back(std::make_pair<std::string, PaletteIndex>("[a-zA-Z_][a-zA-Z0-9_]*", PaletteIndex::Identifier));
+		langDef.tokenRegexPatterns.push_back(std::make_pair<std::string, PaletteIndex>("[\\[\\]\\{\\}\\!\\%\\^\\&\\*\\(\\)\\-\\+\\=\\~\\|\\<\\>\\?\\/\\;\\,\\.]", PaletteIndex::Punctuation));
+
+		langDef.commentStart = "/*";
+		langDef.commentEnd = "*/";
+
+		langDef.caseSensitive = true;
+
+		langDef.tokenizer = [] (const char* begin, const char* end, uint8_t state, TokenSpans &spans) -> uint8_t {
+			return tokenizeC(begin, end, state, spans, false, PaletteIndex::String);
+		};
+
+		langDef.name = "AngelScript";
+
+		inited = true;
+	}
+
+	return langDef;
+}
+
+CodeEdit::LanguageDefinition CodeEdit::LanguageDefinition::C(void) {
+	static bool inited = false;
+	static LanguageDefinition langDef;
+	if (!inited) {
+		static const char* const keywords[] = {
+			"auto", "break", "case", "char", "const", "continue", "default", "do", "double", "else", "enum", "extern", "float", "for", "goto", "if", "inline", "int", "long", "register", "restrict", "return", "short",
+			"signed", "sizeof", "static", "struct", "switch", "typedef", "union", "unsigned", "void", "volatile", "while", "_Alignas", "_Alignof", "_Atomic", "_Bool", "_Complex", "_Generic", "_Imaginary",
+			"_Noreturn", "_Static_assert", "_Thread_local"
+		};
+		for (const char* const k : keywords)
+			langDef.keys.insert(k);
+
+		static const char* const identifiers[] = {
+			"abort", "abs", "acos", "asin", "atan", "atexit", "atof", "atoi", "atol", "ceil", "clock", "cosh", "ctime", "div", "exit", "fabs", "floor", "fmod", "getchar", "getenv", "isalnum", "isalpha", "isdigit", "isgraph",
+			"ispunct", "isspace", "isupper", "kbhit", "log10", "log2", "log", "memcmp", "modf", "pow", "putchar", "putenv", "puts", "rand", "remove", "rename", "sinh", "sqrt", "srand", "strcat", "strcmp", "strerror", "time", "tolower", "toupper"
+		};
+		for (const char* const k : identifiers) {
+			Identifier id;
+			id.declaration = "Built-in function";
+			langDef.ids.insert(std::make_pair(std::string(k), id));
+		}
+
+		langDef.tokenRegexPatterns.push_back(std::make_pair<std::string, PaletteIndex>("//.*", PaletteIndex::Comment));
+		langDef.tokenRegexPatterns.push_back(std::make_pair<std::string, PaletteIndex>("[ \t]*#[ \\t]*[a-zA-Z_]+", PaletteIndex::Preprocessor));
+		langDef.tokenRegexPatterns.push_back(std::make_pair<std::string, PaletteIndex>("L?\\\"(\\\\.|[^\\\"])*\\\"", PaletteIndex::String));
+		langDef.tokenRegexPatterns.push_back(std::make_pair<std::string, PaletteIndex>("\\'\\\\?[^\\']\\'", PaletteIndex::CharLiteral));
+		langDef.tokenRegexPatterns.push_back(std::make_pair<std::string, PaletteIndex>("[+-]?([0-9]+([.][0-9]*)?|[.][0-9]+)([eE][+-]?[0-9]+)?[fF]?", PaletteIndex::Number));
+		langDef.tokenRegexPatterns.push_back(std::make_pair<std::string, PaletteIndex>("[+-]?[0-9]+[Uu]?[lL]?[lL]?", PaletteIndex::Number));
+		langDef.tokenRegexPatterns.push_back(std::make_pair<std::string, PaletteIndex>("0[0-7]+[Uu]?[lL]?[lL]?", PaletteIndex::Number));
+		langDef.tokenRegexPatterns.push_back(std::make_pair<std::string, PaletteIndex>("0[xX][0-9a-fA-F]+[uU]?[lL]?[lL]?", PaletteIndex::Number));
+		langDef.tokenRegexPatterns.push_back(std::make_pair<std::string, PaletteIndex>("[a-zA-Z_][a-zA-Z0-9_]*", PaletteIndex::Identifier));
+		langDef.tokenRegexPatterns.push_back(std::make_pair<std::string, PaletteIndex>("[\\[\\]\\{\\}\\!\\%\\^\\&\\*\\(\\)\\-\\+\\=\\~\\|\\<\\>\\?\\/\\;\\,\\.]", PaletteIndex::Punctuation));
+
+		langDef.commentStart = "/*";
+		langDef.commentEnd = "*/";
+
+		langDef.caseSensitive = true;
+
+		langDef.tokenizer = [] (const char* begin, const char* end, uint8_t state, TokenSpans &spans) -> uint8_t {
+			return tokenizeC(begin, end, state, spans, true, PaletteIndex::CharLiteral);
+		};
+
+		langDef.name = "C";
+
+		inited = true;
+	}
+
+	return langDef;
+}
+
+CodeEdit::LanguageDefinition CodeEdit::LanguageDefinition::CPlusPlus(void) {
+	static bool inited = false;
+	static LanguageDefinition langDef;
+	if (!inited) {
+		static const char* const cppKeywords[] = {
+			"alignas", "alignof", "and", "and_eq", "asm", "atomic_cancel", "atomic_commit", "atomic_noexcept", "auto", "bitand", "bitor", "bool", "break", "case", "catch", "char", "char16_t", "char32_t", "class",
+			"compl", "concept", "const", "constexpr", "const_cast", "continue", "decltype", "default", "delete", "do", "double", "dynamic_cast", "else", "enum", "explicit", "export", "extern", "false", "float",
+			"for", "friend", "goto", "if", "import", "inline", "int", "long", "module", "mutable", "namespace", "new", "noexcept", "not", "not_eq", "nullptr", "operator", "or", "or_eq", "private", "protected", "public",
+			"register", "reinterpret_cast", "requires", "return", "short", "signed", "sizeof", "static", "static_assert", "static_cast", "struct", "switch", "synchronized", "template", "this", "thread_local",
+			"throw", "true", "try", "typedef", "typeid", "typename", "union", "unsigned", "using", "virtual", "void", "volatile", "wchar_t", "while", "xor", "xor_eq"
+		};
+		for (const char* const k : cppKeywords)
+			langDef.keys.insert(k);
+
+		static const char* const identifiers[] = {
+			"abort", "abs", "acos", "asin", "atan", "atexit", "atof", "atoi", "atol", "ceil", "clock", "cosh", "ctime", "div", "exit", "fabs", "floor", "fmod", "getchar", "getenv", "isalnum", "isalpha", "isdigit", "isgraph",
+			"ispunct", "isspace", "isupper", "kbhit", "log10", "log2", "log", "memcmp", "modf", "pow", "printf", "sprintf", "snprintf", "putchar", "putenv", "puts", "rand", "remove", "rename", "sinh", "sqrt", "srand", "strcat", "strcmp", "strerror", "time", "tolower", "toupper",
+			"std", "string", "vector", "map", "unordered_map", "set", "unordered_set", "min", "max"
+		};
+		for (const char* const k : identifiers) {
+			Identifier id;
+			id.declaration = "Built-in function";
+			langDef.ids.insert(std::make_pair(std::string(k), id));
+		}
+
+		langDef.tokenRegexPatterns.push_back(std::make_pair<std::string, PaletteIndex>("//.*", PaletteIndex::Comment));
+		langDef.tokenRegexPatterns.push_back(std::make_pair<std::string, PaletteIndex>("[ \t]*#[ \\t]*[a-zA-Z_]+", PaletteIndex::Preprocessor));
+		langDef.tokenRegexPatterns.push_back(std::make_pair<std::string, PaletteIndex>("L?\\\"(\\\\.|[^\\\"])*\\\"", PaletteIndex::String));
+		langDef.tokenRegexPatterns.push_back(std::make_pair<std::string, PaletteIndex>("\\'\\\\?[^\\']\\'", PaletteIndex::CharLiteral));
+		langDef.tokenRegexPatterns.push_back(std::make_pair<std::string, PaletteIndex>("0[xX][0-9a-fA-F]+[uU]?[lL]?[lL]?", PaletteIndex::Number));
+		langDef.tokenRegexPatterns.push_back(std::make_pair<std::string, PaletteIndex>("[+-]?([0-9]+([.][0-9]*)?|[.][0-9]+)([eE][+-]?[0-9]+)?[fF]?", PaletteIndex::Number));
+		langDef.tokenRegexPatterns.push_back(std::make_pair<std::string, PaletteIndex>("0[0-7]+[Uu]?[lL]?[lL]?", PaletteIndex::Number));
+		langDef.tokenRegexPatterns.push_back(std::make_pair<std::string, PaletteIndex>("[+-]?[0-9]+[Uu]?[lL]?[lL]?", PaletteIndex::Number));
+		langDef.tokenRegexPatterns.push_back(std::make_pair<std::string, PaletteIndex>("[a-zA-Z_][a-zA-Z0-9_]*", PaletteIndex::Identifier));
+		langDef.tokenRegexPatterns.push_back(std::make_pair<std::string, PaletteIndex>("[\\[\\]\\{\\}\\!\\%\\^\\&\\*\\(\\)\\-\\+\\=\\~\\|\\<\\>\\?\\/\\;\\,\\.]", PaletteIndex::Punctuation));
+
+		langDef.commentStart = "/*";
+		langDef.commentEnd = "*/";
+
+		langDef.caseSensitive = true;
+
+		langDef.tokenizer = [] (const char* begin, const char* end, uint8_t state, TokenSpans &spans) -> uint8_t {
+			return tokenizeC(begin, end, state, spans, true, PaletteIndex::CharLiteral);
+		};
+
+		langDef.name = "C++";
+
+		inited = true;
+	}
+
+	return langDef;
+}
+
+CodeEdit::LanguageDefinition CodeEdit::LanguageDefinition::GLSL(void) {
+	static bool inited = false;
+	static LanguageDefinition langDef;
+	if (!inited) {
+		static const char* const keywords[] = {
+			"auto", "break", "case", "char", "const", "continue", "default", "do", "double", "else", "enum", "extern", "float", "for", "goto", "if", "inline", "int", "long", "register", "restrict", "return", "short",
+			"signed", "sizeof", "static", "struct", "switch", "typedef", "union", "unsigned", "void", "volatile", "while", "_Alignas", "_Alignof", "_Atomic", "_Bool", "_Complex", "_Generic", "_Imaginary",
+			"_Noreturn", "_Static_assert", "_Thread_local"
+		};
+		for (const char* const k : keywords)
+			langDef.keys.insert(k);
+
+		static const char* const identifiers[] = {
+			"abort", "abs", "acos", "asin", "atan", "atexit", "atof", "atoi", "atol", "ceil", "clock", "cosh", "ctime", "div", "exit", "fabs", "floor", "fmod", "getchar", "getenv", "isalnum", "isalpha", "isdigit", "isgraph",
+			"ispunct", "isspace", "isupper", "kbhit", "log10", "log2", "log", "memcmp", "modf", "pow", "putchar", "putenv", "puts", "rand", "remove", "rename", "sinh", "sqrt", "srand", "strcat", "strcmp", "strerror", "time", "tolower", "toupper"
+		};
+		for (const char* const k : identifiers) {
+			Identifier id;
+			id.declaration = "Built-in function";
+			langDef.ids.insert(std::make_pair(std::string(k), id));
+		}
+
+		langDef.tokenRegexPatterns.push_back(std::make_pair<std::string, PaletteIndex>("//.*", PaletteIndex::Comment));
+		langDef.tokenRegexPatterns.push_back(std::make_pair<std::string, PaletteIndex>("[ \t]*#[ \\t]*[a-zA-Z_]+", PaletteIndex::Preprocessor));
+		langDef.tokenRegexPatterns.push_back(std::make_pair<std::string, PaletteIndex>("L?\\\"(\\\\.|[^\\\"])*\\\"", PaletteIndex::String));
+		langDef.tokenRegexPatterns.push_back(std::make_pair<std::string, PaletteIndex>("\\'\\\\?[^\\']\\'", PaletteIndex::CharLiteral));
+		langDef.tokenRegexPatterns.push_back(std::make_pair<std::string, PaletteIndex>("[+-]?([0-9]+([.][0-9]*)?|[.][0-9]+)([eE][+-]?[0-9]+)?[fF]?", PaletteIndex::Number));
+		langDef.tokenRegexPatterns.push_back(std::make_pair<std::string, PaletteIndex>("[+-]?[0-9]+[Uu]?[lL]?[lL]?", PaletteIndex::Number));
+		langDef.tokenRegexPatterns.push_back(std::make_pair<std::string, PaletteIndex>("0[0-7]+[Uu]?[lL]?[lL]?", PaletteIndex::Number));
+		langDef.tokenRegexPatterns.push_back(std::make_pair<std::string, PaletteIndex>("0[xX][0-9a-fA-F]+[uU]?[lL]?[lL]?", PaletteIndex::Number));
+		langDef.tokenRegexPatterns.push_back(std::make_pair<std::string, PaletteIndex>("[a-zA-Z_][a-zA-Z0-9_]*", PaletteIndex::Identifier));
+		langDef.tokenRegexPatterns.push_back(std::make_pair<std::string, PaletteIndex>("[\\[\\]\\{\\}\\!\\%\\^\\&\\*\\(\\)\\-\\+\\=\\~\\|\\<\\>\\?\\/\\;\\,\\.]", PaletteIndex::Punctuation));
+
+		langDef.commentStart = "/*";
+		langDef.commentEnd = "*/";
+
+		langDef.caseSensitive = true;
+
+		langDef.tokenizer = [] (const char* begin, const char* end, uint8_t state, TokenSpans &spans) -> uint8_t {
+			return tokenizeC(begin, end, state, spans, true, PaletteIndex::CharLiteral);
+		};
+
+		langDef.name = "GLSL";
+
+		inited = true;
+	}
+
+	return langDef;
+}
+
+CodeEdit::LanguageDefinition CodeEdit::LanguageDefinition::HLSL(void) {
+	static bool inited = false;
+	static LanguageDefinition langDef;
+	if (!inited) {
+		static const char* const keywords[] = {
+			"AppendStructuredBuffer", "asm", "asm_fragment", "BlendState", "bool", "break", "Buffer", "ByteAddressBuffer", "case", "cbuffer", "centroid", "class", "column_major", "compile", "compile_fragment",
+			"CompileShader", "const", "continue", "ComputeShader", "ConsumeStructuredBuffer", "default", "DepthStencilState", "DepthStencilView", "discard", "do", "double", "DomainShader", "dword", "else",
+			"export", "extern", "false", "float", "for", "fxgroup", "GeometryShader", "groupshared", "half", "Hullshader", "if", "in", "inline", "inout", "InputPatch", "int", "interface", "line", "lineadj",
+			"linear", "LineStream", "matrix", "min16float", "min10float", "min16int", "min12int", "min16uint", "namespace", "nointerpolation", "noperspective", "NULL", "out", "OutputPatch", "packoffset",
+			"pass", "pixelfragment", "PixelShader", "point", "PointStream", "precise", "RasterizerState", "RenderTargetView", "return", "register", "row_major", "RWBuffer", "RWByteAddressBuffer", "RWStructuredBuffer",
+			"RWTexture1D", "RWTexture1DArray", "RWTexture2D", "RWTexture2DArray", "RWTexture3D", "sample", "sampler", "SamplerState", "SamplerComparisonState", "shared", "snorm", "stateblock", "stateblock_state",
+			"static", "string", "struct", "switch", "StructuredBuffer", "tbuffer", "technique", "technique10", "technique11", "texture", "Texture1D", "Texture1DArray", "Texture2D", "Texture2DArray", "Texture2DMS",
+			"Texture2DMSArray", "Texture3D", "TextureCube", "TextureCubeArray", "true", "typedef", "triangle", "triangleadj", "TriangleStream", "uint", "uniform", "unorm", "unsigned", "vector", "vertexfragment",
+			"VertexShader", "void", "volatile", "while",
+			"bool1","bool2","bool3","bool4","double1","double2","double3","double4", "float1", "float2", "float3", "float4", "int1", "int2", "int3", "int4", "in", "out", "inout",
+			"uint1", "uint2", "uint3", "uint4", "dword1", "dword2", "dword3", "dword4", "half1", "half2", "half3", "half4",
+			"float1x1","float2x1","float3x1","float4x1","float1x2","float2x2","float3x2","float4x2",
+			"float1x3","float2x3","float3x3","float4x3","float1x4","float2x4","float3x4","float4x4",
+			"half1x1","half2x1","half3x1","half4x1","half1x2","half2x2","half3x2","half4x2",
+			"half1x3","half2x3","half3x3","half4x3","half1x4","half2x4","half3x4","half4x4",
+		};
+		for (const char* const k : keywords)
+			langDef.keys.insert(k);
+
+		static const char* const identifiers[] = {
+			"abort", "abs", "acos", "all", "AllMemoryBarrier", "AllMemoryBarrierWithGroupSync", "any", "asdouble", "asfloat", "asin", "asint", "asint", "asuint",
+			"asuint", "atan", "atan2", "ceil", "CheckAccessFullyMapped", "clamp", "clip", "cos", "cosh", "countbits", "cross", "D3DCOLORtoUBYTE4", "ddx",
+			"ddx_coarse", "ddx_fine", "ddy", "ddy_coarse", "ddy_fine", "degrees", "determinant", "DeviceMemoryBarrier", "DeviceMemoryBarrierWithGroupSync",
+			"distance", "dot", "dst", "errorf", "EvaluateAttributeAtCentroid", "EvaluateAttributeAtSample", "EvaluateAttributeSnapped", "exp", "exp2",
+			"f16tof32", "f32tof16", "faceforward", "firstbithigh", "firstbitlow", "floor", "fma", "fmod", "frac", "frexp", "fwidth", "GetRenderTargetSampleCount",
+			"GetRenderTargetSamplePosition", "GroupMemoryBarrier", "GroupMemoryBarrierWithGroupSync", "InterlockedAdd", "InterlockedAnd", "InterlockedCompareExchange",
+			"InterlockedCompareStore", "InterlockedExchange", "InterlockedMax", "InterlockedMin", "InterlockedOr", "InterlockedXor", "isfinite", "isinf", "isnan",
+			"ldexp", "length", "lerp", "lit", "log", "log10", "log2", "mad", "max", "min", "modf", "msad4", "mul", "noise", "normalize", "pow", "printf",
+			"Process2DQuadTessFactorsAvg", "Process2DQuadTessFactorsMax", "Process2DQuadTessFactorsMin", "ProcessIsolineTessFactors", "ProcessQuadTessFactorsAvg",
+			"ProcessQuadTessFactorsMax", "ProcessQuadTessFactorsMin", "ProcessTriTessFactorsAvg", "ProcessTriTessFactorsMax", "ProcessTriTessFactorsMin",
+			"radians", "rcp", "reflect", "refract", "reversebits", "round", "rsqrt", "saturate", "sign", "sin", "sincos", "sinh", "smoothstep", "sqrt", "step",
+			"tan", "tanh", "tex1D", "tex1D", "tex1Dbias", "tex1Dgrad", "tex1Dlod", "tex1Dproj", "tex2D", "tex2D", "tex2Dbias", "tex2Dgrad", "tex2Dlod", "tex2Dproj",
+			"tex3D", "tex3D", "tex3Dbias", "tex3Dgrad", "tex3Dlod", "tex3Dproj", "texCUBE", "texCUBE", "texCUBEbias", "texCUBEgrad", "texCUBElod", "texCUBEproj", "transpose", "trunc"
+		};
+		for (const char* const k : identifiers) {
+			Identifier id;
+			id.declaration = "Built-in function";
+			langDef.ids.insert(std::make_pair(std::string(k), id));
+		}
+
+		langDef.tokenRegexPatterns.push_back(std::make_pair<std::string, PaletteIndex>("//.*", PaletteIndex::Comment));
+		langDef.tokenRegexPatterns.push_back(std::make_pair<std::string, PaletteIndex>("[ \t]*#[ \\t]*[a-zA-Z_]+", PaletteIndex::Preprocessor));
+		langDef.tokenRegexPatterns.push_back(std::make_pair<std::string, PaletteIndex>("L?\\\"(\\\\.|[^\\\"])*\\\"", PaletteIndex::String));
+		langDef.tokenRegexPatterns.push_back(std::make_pair<std::string, PaletteIndex>("\\'\\\\?[^\\']\\'", PaletteIndex::CharLiteral));
+		langDef.tokenRegexPatterns.push_back(std::make_pair<std::string, PaletteIndex>("[+-]?([0-9]+([.][0-9]*)?|[.][0-9]+)([eE][+-]?[0-9]+)?[fF]?", PaletteIndex::Number));
+		langDef.tokenRegexPatterns.push_back(std::make_pair<std::string, PaletteIndex>("[+-]?[0-9]+[Uu]?[lL]?[lL]?", PaletteIndex::Number));
+		langDef.tokenRegexPatterns.push_back(std::make_pair<std::string, PaletteIndex>("0[0-7]+[Uu]?[lL]?[lL]?", PaletteIndex::Number));
+		langDef.tokenRegexPatterns.push_back(std::make_pair<std::string, PaletteIndex>("0[xX][0-9a-fA-F]+[uU]?[lL]?[lL]?", PaletteIndex::Number));
+		langDef.tokenRegexPatterns.push_back(std::make_pair<std::string, PaletteIndex>("[a-zA-Z_][a-zA-Z0-9_]*", PaletteIndex::Identifier));
+		langDef.tokenRegexPatterns.push_back(std::make_pair<std::string, PaletteIndex>("[\\[\\]\\{\\}\\!\\%\\^\\&\\*\\(\\)\\-\\+\\=\\~\\|\\<\\>\\?\\/\\;\\,\\.]", PaletteIndex::Punctuation));
+
+		langDef.commentStart = "/*";
+		langDef.commentEnd = "*/";
+
+		langDef.caseSensitive = true;
+
+		langDef.tokenizer = [] (const char* begin, const char* end, uint8_t state, TokenSpans &spans) -> uint8_t {
+			return tokenizeC(begin, end, state, spans, true, PaletteIndex::CharLiteral);
+		};
+
+		langDef.name = "HLSL";
+
+		inited = true;
+	}
+
+	return langDef;
+}
+
+CodeEdit::LanguageDefinition CodeEdit::LanguageDefinition::Lua(void) {
+	static bool inited = false;
+	static LanguageDefinition langDef;
+	if (!inited) {
+		static const char* const keywords[] = {
+			"and", "break", "do", "", "else", "elseif", "end", "false", "for", "function", "if", "in", "", "local", "nil", "not", "or", "repeat", "return", "then", "true", "until", "while"
+		};
+
+		for (const char* const k : keywords)
+			langDef.keys.insert(k);
+
+		static const char* const identifiers[] = {
+			"assert", "collectgarbage", "dofile", "error", "getmetatable", "ipairs", "loadfile", "load", "loadstring",  "next",  "pairs",  "pcall",  "print",  "rawequal",  "rawlen",  "rawget",  "rawset",
+			"select",  "setmetatable",  "tonumber",  "tostring",  "type",  "xpcall",  "_G",  "_VERSION","arshift", "band", "bnot", "bor", "bxor", "btest", "extract", "lrotate", "lshift", "replace",
+			"rrotate", "rshift", "create", "resume", "running", "status", "wrap", "yield", "isyieldable", "debug","getuservalue", "gethook", "getinfo", "getlocal", "getregistry", "getmetatable",
+			"getupvalue", "upvaluejoin", "upvalueid", "setuservalue", "sethook", "setlocal", "setmetatable", "setupvalue", "traceback", "close", "flush", "input", "lines", "open", "output", "popen",
+			"read", "tmpfile", "type", "write", "close", "flush", "lines", "read", "seek", "setvbuf", "write", "__gc", "__tostring", "abs", "acos", "asin", "atan", "ceil", "cos", "deg", "exp", "tointeger",
+			"floor", "fmod", "ult", "log", "max", "min", "modf", "rad", "random", "randomseed", "sin", "sqrt", "string", "tan", "type", "atan2", "cosh", "sinh", "tanh",
+			"pow", "frexp", "ldexp", "log10", "pi", "huge", "maxinteger", "mininteger", "loadlib", "searchpath", "seeall", "preload", "cpath", "path", "searchers", "loaded", "module", "require", "clock",
+			"date", "difftime", "execute", "exit", "getenv", "remove", "rename", "setlocale", "time", "tmpname", "byte", "char", "dump", "find", "format", "gmatch", "gsub", "len", "lower", "match", "rep",
+			"reverse", "sub", "upper", "pack", "packsize", "unpack", "concat", "maxn", "insert", "pack", "unpack", "remove", "move", "sort", "offset", "codepoint", "char", "len", "codes", "charpattern",
+			"coroutine", "table", "io", "os", "string", "utf8", "bit32", "math", "debug", "package"
+		};
+		for (const char* const k : identifiers) {
+			Identifier id;
+			id.declaration = "Built-in function";
+			langDef.ids.insert(std::make_pair(std::string(k), id));
+		}
+
+		langDef.tokenRegexPatterns.push_back(std::make_pair<std::string, PaletteIndex>("\\-\\-.*", PaletteIndex::Comment));
+		langDef.tokenRegexPatterns.push_back(std::make_pair<std::string, PaletteIndex>("L?\\\"(\\\\.|[^\\\"])*\\\"", PaletteIndex::String));
+		langDef.tokenRegexPatterns.push_back(std::make_pair<std::string, PaletteIndex>("\\\'[^\\\']*\\\'", PaletteIndex::String));
+		langDef.tokenRegexPatterns.push_back(std::make_pair<std::string, PaletteIndex>("0[xX][0-9a-fA-F]+[uU]?[lL]?[lL]?", PaletteIndex::Number));
+		langDef.tokenRegexPatterns.push_back(std::make_pair<std::string, PaletteIndex>("[+-]?([0-9]+([.][0-9]*)?|[.][0-9]+)([eE][+-]?[0-9]+)?[fF]?", PaletteIndex::Number));
+		langDef.tokenRegexPatterns.push_back(std::make_pair<std::string, PaletteIndex>("[+-]?[0-9]+[Uu]?[lL]?[lL]?", PaletteIndex::Number));
+		langDef.tokenRegexPatterns.push_back(std::make_pair<std::string, PaletteIndex>("[a-zA-Z_][a-zA-Z0-9_]*", PaletteIndex::Identifier));
+		langDef.tokenRegexPatterns.push_back(std::make_pair<std::string, PaletteIndex>("[\\[\\]\\{\\}\\!\\%\\^\\&\\*\\(\\)\\-\\+\\=\\~\\|\\<\\>\\?\\/\\;\\,\\.]", PaletteIndex::Punctuation));
+
+		langDef.commentStart = "--[[";
+		langDef.commentEnd = "]]";
+
+		static const char* const foldStartKeys[] = {
+			"function", "do", "then", "repeat"
+		};
+		static const char* const foldEndKeys[] = {
+			"end", "until", "elseif"
+		};
+
+		for (const char* const k : foldStartKeys)
+			langDef.foldStartKeys.insert(k);
+		for (const char* const k : foldEndKeys)
+			langDef.foldEndKeys.insert(k);
+
+		langDef.caseSensitive = true;
+
+		langDef.tokenizer = tokenizeLua;
+
+		langDef.name = "Lua";
+
+		inited = true;
+	}
+
+	return langDef;
+}
+
+CodeEdit::LanguageDefinition CodeEdit::LanguageDefinition::SQL(void) {
+	static bool inited = false;
+	static LanguageDefinition langDef;
+	if (!inited) {
+		static const char* const keywords[] = {
+			"ADD", "EXCEPT", "PERCENT", "ALL", "EXEC", "PLAN", "ALTER", "EXECUTE", "PRECISION", "AND", "EXISTS", "PRIMARY", "ANY", "EXIT", "PRINT", "AS", "FETCH", "PROC", "ASC", "FILE", "PROCEDURE",
+			"AUTHORIZATION", "FILLFACTOR", "PUBLIC", "BACKUP", "FOR", "RAISERROR", "BEGIN", "FOREIGN", "READ", "BETWEEN", "FREETEXT", "READTEXT", "BREAK", "FREETEXTTABLE", "RECONFIGURE",
+			"BROWSE", "FROM", "REFERENCES", "BULK", "FULL", "REPLICATION", "BY", "FUNCTION", "RESTORE", "CASCADE", "GOTO", "RESTRICT", "CASE", "GRANT", "RETURN", "CHECK", "GROUP", "REVOKE",
+			"CHECKPOINT", "HAVING", "RIGHT", "CLOSE", "HOLDLOCK", "ROLLBACK", "CLUSTERED", "IDENTITY", "ROWCOUNT", "COALESCE", "IDENTITY_INSERT", "ROWGUIDCOL", "COLLATE", "IDENTITYCOL", "RULE",
+			"COLUMN", "IF", "SAVE", "COMMIT", "IN", "SCHEMA", "COMPUTE", "INDEX", "SELECT", "CONSTRAINT", "INNER", "SESSION_USER", "CONTAINS", "INSERT", "SET", "CONTAINSTABLE", "INTERSECT", "SETUSER",
+			"CONTINUE", "INTO", "SHUTDOWN", "CONVERT", "IS", "SOME", "CREATE", "JOIN", "STATISTICS", "CROSS", "KEY", "SYSTEM_USER", "CURRENT", "KILL", "TABLE", "CURRENT_DATE", "LEFT", "TEXTSIZE",
+			"CURRENT_TIME", "LIKE", "THEN", "CURRENT_TIMESTAMP", "LINENO", "TO", "CURRENT_USER", "LOAD", "TOP", "CURSOR", "NATIONAL", "TRAN", "DATABASE", "NOCHECK", "TRANSACTION",
+			"DBCC", "NONCLUSTERED", "TRIGGER", "DEALLOCATE", "NOT", "TRUNCATE", "DECLARE", "NULL", "TSEQUAL", "DEFAULT", "NULLIF", "UNION", "DELETE", "OF", "UNIQUE", "DENY", "OFF", "UPDATE",
+			"DESC", "OFFSETS", "UPDATETEXT", "DISK", "ON", "USE", "DISTINCT", "OPEN", "USER", "DISTRIBUTED", "OPENDATASOURCE", "VALUES", "DOUBLE", "OPENQUERY", "VARYING","DROP", "OPENROWSET", "VIEW",
+			"DUMMY", "OPENXML", "WAITFOR", "DUMP", "OPTION", "WHEN", "ELSE", "OR", "WHERE", "END", "ORDER", "WHILE", "ERRLVL", "OUTER", "WITH", "ESCAPE", "OVER", "WRITETEXT"
+		};
+
+		for (const char* const k : keywords)
+			langDef.keys.insert(k);
+
+		static const char* const identifiers[] = {
+			"ABS",  "ACOS",  "ADD_MONTHS",  "ASCII",  "ASCIISTR",  "ASIN",  "ATAN",  "ATAN2",  "AVG",  "BFILENAME",  "BIN_TO_NUM",  "BITAND",  "CARDINALITY",  "CASE",  "CAST",  "CEIL",
+			"CHARTOROWID",  "CHR",  "COALESCE",  "COMPOSE",  "CONCAT",  "CONVERT",  "CORR",  "COS",  "COSH",  "COUNT",  "COVAR_POP",  "COVAR_SAMP",  "CUME_DIST",  "CURRENT_DATE",
+			"CURRENT_TIMESTAMP",  "DBTIMEZONE",  "DECODE",  "DECOMPOSE",  "DENSE_RANK",  "DUMP",  "EMPTY_BLOB",  "EMPTY_CLOB",  "EXP",  "EXTRACT",  "FIRST_VALUE",  "FLOOR",  "FROM_TZ",  "GREATEST",
+			"GROUP_ID",  "HEXTORAW",  "INITCAP",  "INSTR",  "INSTR2",  "INSTR4",  "INSTRB",  "INSTRC",  "LAG",  "LAST_DAY",  "LAST_VALUE",  "LEAD",  "LEAST",  "LENGTH",  "LENGTH2",  "LENGTH4",
+			"LENGTHB",  "LENGTHC",  "LISTAGG",  "LN",  "LNNVL",  "LOCALTIMESTAMP",  "LOG",  "LOWER",  "LPAD",  "LTRIM",  "MAX",  "MEDIAN",  "MIN",  "MOD",  "MONTHS_BETWEEN",  "NANVL",  "NCHR",
+			"NEW_TIME",  "NEXT_DAY",  "NTH_VALUE",  "NULLIF",  "NUMTODSINTERVAL",  "NUMTOYMINTERVAL",  "NVL",  "NVL2",  "POWER",  "RANK",  "RAWTOHEX",  "REGEXP_COUNT",  "REGEXP_INSTR",
+			"REGEXP_REPLACE",  "REGEXP_SUBSTR",  "REMAINDER",  "REPLACE",  "ROUND",  "ROWNUM",  "RPAD",  "RTRIM",  "SESSIONTIMEZONE",  "SIGN",  "SIN",  "SINH",
+			"SOUNDEX",  "SQRT",  "STDDEV",  "SUBSTR",  "SUM",  "SYS_CONTEXT",  "SYSDATE",  "SYSTIMESTAMP",  "TAN",  "TANH",  "TO_CHAR",  "TO_CLOB",  "TO_DATE",  "TO_DSINTERVAL",  "TO_LOB",
+			"TO_MULTI_BYTE",  "TO_NCLOB",  "TO_NUMBER",  "TO_SINGLE_BYTE",  "TO_TIMESTAMP",  "TO_TIMESTAMP_TZ",  "TO_YMINTERVAL",  "TRANSLATE",  "TRIM",  "TRUNC", "TZ_OFFSET",  "UID",  "UPPER",
+			"USER",  "USERENV",  "VAR_POP",  "VAR_SAMP",  "VARIANCE",  "VSIZE "
+		};
+		for (const char* const k : identifiers) {
+			Identifier id;
+			id.declaration = "Built-in function";
+			langDef.ids.insert(std::make_pair(std::string(k), id));
+		}
+
+		langDef.tokenRegexPatterns.push_back(std::make_pair<std::string, PaletteIndex>("\\-\\-.*", PaletteIndex::Comment));
+		langDef.tokenRegexPatterns.push_back(std::make_pair<std::string, PaletteIndex>("L?\\\"(\\\\.|[^\\\"])*\\\"", PaletteIndex::String));
+		langDef.tokenRegexPatterns.push_back(std::make_pair<std::string, PaletteIndex>("\\\'[^\\\']*\\\'", PaletteIndex::String));
+		langDef.tokenRegexPatterns.push_back(std::make_pair<std::string, PaletteIndex>("[+-]?([0-9]+([.][0-9]*)?|[.][0-9]+)([eE][+-]?[0-9]+)?[fF]?", PaletteIndex::Number));
+		langDef.tokenRegexPatterns.push_back(std::make_pair<std::string, PaletteIndex>("[+-]?[0-9]+[Uu]?[lL]?[lL]?", PaletteIndex::Number));
+		langDef.tokenRegexPatterns.push_back(std::make_pair<std::string, PaletteIndex>("0[0-7]+[Uu]?[lL]?[lL]?", PaletteIndex::Number));
+		langDef.tokenRegexPatterns.push_back(std::make_pair<std::string, PaletteIndex>("0[xX][0-9a-fA-F]+[uU]?[lL]?[lL]?", PaletteIndex::Number));
+		langDef.tokenRegexPatterns.push_back(std::make_pair<std::string, PaletteIndex>("[a-zA-Z_][a-zA-Z0-9_]*", PaletteIndex::Identifier));
+		langDef.tokenRegexPatterns.push_back(std::make_pair<std::string, PaletteIndex>("[\\[\\]\\{\\}\\!\\%\\^\\&\\*\\(\\)\\-\\+\\=\\~\\|\\<\\>\\?\\/\\;\\,\\.]", PaletteIndex::Punctuation));
+
+		langDef.commentStart = "/*";
+		langDef.commentEnd = "*/";
+
+		langDef.caseSensitive = false;
+
+		langDef.tokenizer = tokenizeSQL;
+
+		langDef.name = "SQL";
+
+		inited = true;
+	}
+
+	return langDef;
+}
+
+CodeEdit::LanguageDefinition CodeEdit::LanguageDefinition::BASIC8(void) {
+	static bool inited = false;
+	static LanguageDefinition langDef;
+	if (!inited) {
+		static const char* const keywords[] = {
+			/* Constants. */
+			"nil", "true", "false",
+			/* Operators. */
+			"mod", "and", "or", "not", "is", "...",
+			/* Keywords. */
+			"let", "dim", "if", "then", "elseif", "else", "endif",
+			"for", "in", "to", "step", "next", "while", "wend", "do", "until", "exit",
+			"goto", "gosub", "return", "call", "def", "enddef",
+			"class", "endclass", "new", "var", "reflect", "lambda",
+			"import", "type",
+			/* Extra keywords. */
+			"typeof"
+		};
+
+		for (const char* const k : keywords)
+			langDef.keys.insert(k);
+
+		static const char* const identifiers[] = {
+			/* Built-in basic. */
+			"abs", "sgn", "sqr", "floor", "ceil", "fix", "round", "srnd", "rnd", "sin", "cos", "tan", "asin", "acos", "atan", "exp", "log",
+			"asc", "chr", "left", "mid", "right", "str", "val",
+			"mem", "end", "len", "get", "set", "print", "input",
+			"list", "dict", "push", "pop", "back", "insert", "sort", "exists", "index_of", "remove", "clear", "clone", "to_array", "iterator", "move_next",
+			/* Built-in advanced. */
+			"ticks", "cpu_core_count", "now", "trace", "raise", "gc", "beep",
+			/* Common. */
+			"open", "close", "lock", "unlock", "read", "read_u8", "read_s8", "read_u16", "read_s16", "read_int", "read_real", "read_all", "end_of_stream",
+			"peek", "poke", "pack", "unpack", "parse", "serialize", "load", "save",
+			"send", "recv", "broadcast", "poll",
+			"start", "abort", "play", "stop", "parent", "children",
+			"create", "valid", "find", "resize", "copy_to",
+			/* Algorithm. */
+			"pather", "set_diagonal_cost",
+			/* Audio. */
+			"wave", "sfx", "use_sound_font", "set_volume",
+			/* Bytes. */
+			"bytes", "push_u8", "push_s8", "push_u16", "push_s16", "push_int", "push_real", "pop_u8", "pop_s8", "pop_u16", "pop_s16", "pop_int", "pop_real",
+			/* Coroutine. */
+			"coroutine", "yield", "get_error", "wait_for",
+			/* Complex. */
+			"rgba",
+			/* Database. */
+			"data", "restore",
+			"database", "has_table", "query", "exec",
+			/* Date time. */
+			"sleep",
+			/* Driver. */
+			"driver",
+			"set_clearer", "set_interpolator", "set_orderby",
+			"update_with",
+			"load_resource", "load_blank",
+			"flip_x", "flip_y", "set_flip_condition",
+			/* File. */
+			"file", "read_line", "write", "write_u8", "write_s8", "write_u16", "write_s16", "write_int", "write_real", "write_line",
+			/* GUI. */
+			"msgbox", "open_file_dialog", "save_file_dialog", "pick_directory_dialog",
+			/* Image. */
+			"image",
+			/* IO. */
+			"get_document_path", "combine_path",
+			"file_info", "directory_info", "get_files", "get_directories", "get_full_path", "get_parent_path", "get_file_name", "get_ext_name", "get_dir_name", "is_blank",
+			/* JSON. */
+			"json", "json_bool",
+			/* Math. */
+			"pi", "deg", "rad", "min", "max",
+			"vec2", "vec3", "vec4", "vec4_from_euler", "vec4_from_axis_angle", "mat4x4", "mat4x4_from_euler", "mat4x4_from_axis_angle", "mat4x4_from_scale", "mat4x4_from_translation",
+			"mat4x4_lookat", "mat4x4_ortho", "mat4x4_perspective", "mat4x4_perspective_fov",
+			"dot", "cross", "normalize", "length_square", "length", "distance_square", "distance", "lerp", "identity", "conjugate", "transpose", "inverse",
+			/* Network. */
+			"net",
+			/* Persistence. */
+			"persist",
+			/* System. */
+			"set_output_visible",
+			"get_app_directory", "get_current_directory",
+			"set_clipboard_text", "get_clipboard_text", "has_clipboard_text",
+			"os", "sys",
+			/* Text. */
+			"lcase", "ucase", "split", "starts_with", "ends_with", "like", "regex",
+			/* Utils. */
+			"assert", "swap", "iif",
+			"band", "bor", "bnot", "bxor", "shl", "shr",
+			/* Web. */
+			"web", "web_request",
+			/* Zip. */
+			"zip", "unpack_all",
+			"compress", "decompress",
+			/* Plugin primitives. */
+			"cls", "sync", "col", "clip", "camera", "font",
+			"text", "plot", "line", "circ", "circfill", "ellipse", "ellipsefill", "arc", "arcfill", "rect", "rectfill", "tri", "trifill", "tritex", "quad", "quadfill",
+			"spr", "sspr", "step_on", "map", "img", "simg",
+			"pget", "pset", "sget", "sset", "mget", "mset", "iget", "iset",
+			"key", "keyp", "touch", "btn", "btnp"
+		};
+		for (const char* const k : identifiers) {
+			Identifier id;
+			//id.declaration = "Library function";
+			langDef.ids.insert(std::make_pair(std::string(k), id));
+		}
+
+		langDef.tokenRegexPatterns.push_back(std::make_pair<std::string, PaletteIndex>("'.*|rem$|rem[ \t](.*)?", PaletteIndex::Comment));
+		langDef.tokenRegexPatterns.push_back(std::make_pair<std::string, PaletteIndex>("L?\\\"(\\\\.|[^\\\"])*\\\"", PaletteIndex::String));
+		langDef.tokenRegexPatterns.push_back(std::make_pair<std::string, PaletteIndex>("0[x][0-9a-f]+", PaletteIndex::Number));
+		langDef.tokenRegexPatterns.push_back(std::make_pair<std::string, PaletteIndex>("[+-]?([0-9]+([.][0-9]*)?|[.][0-9]+)([e][+-]?[0-9]+)?", PaletteIndex::Number));
+		langDef.tokenRegexPatterns.push_back(std::make_pair<std::string, PaletteIndex>("[_]*[a-z_][a-z0-9_]*[$]?", PaletteIndex::Identifier));
+		langDef.tokenRegexPatterns.push_back(std::make_pair<std::string, PaletteIndex>("[\\~\\*\\/\\+\\-\\^\\(\\)\\=\\<\\>\\.]", PaletteIndex::Punctuation));
+
+		langDef.commentStart = "'[";
+		langDef.commentEnd = "']";
+		langDef.commentException = '\'';
+
+		static const char* const foldStartKeys[] = {
+			"def", "class", "for", "while", "do"
+		};
+		static const char* const foldEndKeys[] = {
+			"enddef", "endclass", "next", "wend", "until", "elseif", "endif"
+		};
+
+		for (const char* const k : foldStartKeys)
+			langDef.foldStartKeys.insert(k);
+		for (const char* const k : foldEndKeys)
+			langDef.foldEndKeys.insert(k);
+		langDef.foldTrailingKeys.insert("then"); // Single line `IF`s have no `ENDIF`.
+
+		langDef.caseSensitive = false;
+
+		langDef.tokenizer = tokenizeBASIC8;
+
+		langDef.name = "BASIC8";
+
+		inited = true;
+	}
+
+	return langDef;
+}
+
+bool CodeEdit::UndoRecord::similar(const UndoRecord* o) const {
+	if (o == nullptr)
+		return false;
+	if (type != o->type)
+		return false;
+	if (start.line != o->start.line || end.line != o->end.line)
+		return false;
+
+	auto isalpha = [] (char ch) {
+		return (ch >= 'A' && ch <= 'Z') || (ch >= 'a' && ch <= 'z');
+	};
+	auto isnum = [] (char ch) {
+		return ch >= '0' && ch <= '9';
+	};
+	auto isblank = [] (char ch) {
+		return ch >= ' ' && ch <= '\t';
+	};
+	if ((content.length() == 1 && isalpha(*content.begin())) &&
+		(o->content.length() == 1 && isalpha(*o->content.begin()))) {
+		return true;
+	}
+	if ((content.length() == 1 && isnum(*content.begin())) &&
+		(o->content.length() == 1 && isnum(*o->content.begin()))) {
+		return true;
+	}
+	if ((content.length() == 1 && isblank(*content.begin())) &&
+		(o->content.length() == 1 && isblank(*o->content.begin()))) {
+		return true;
+	}
+	if (content.length() > 1 && content.length() <= 4 && o->content.length() > 1 && o->content.length() <= 4) {
+		int l = expectUtf8Char(content.c_str());
+		int r = expectUtf8Char(o->content.c_str());
+		if ((int)content.length() == l && (int)o->content.length() == r)
+			return true;
+	}
+
+	return false;
+}
+
+void CodeEdit::UndoRecord::undo(CodeEdit* editor) {
+	if (!content.empty()) {
+		switch (type) {
+		case UndoType::Add: {
+				editor->_state = after;
+
+				editor->removeRange(start, end);
+				editor->colorize(start.line - 1, end.line - start.line + 2);
+
+				if (!overwritten.empty()) {
+					Coordinates st = start;
+					editor->insertTextAt(st, overwritten.c_str());
+					editor->colorize(start.line - 1, st.line - start.line + 2);
+				}
+
+				editor->onChanged(start, start, -1);
+			}
+
+			break;
+		case UndoType::Remove: {
+				Coordinates st = start; // Moved to the end of the inserted text.
+				editor->insertTextAt(st, content.c_str());
+				editor->colorize(start.line - 1, st.line - start.line + 2);
+
+				editor->onChanged(start, st, -1);
+			}
+
+			break;
+		case UndoType::indent: {
+				assert(end.line - start.line + 1 == (int)content.length());
+
+				for (int i = start.line; i <= end.line; ++i) {
+					Line &line = editor->_codeLines[i];
+					const char op = content[i - start.line];
+					if (op == 0) {
+						// Does nothing.
+					} else if (op == std::numeric_limits<char>::max()) {
+						const Glyph &g = *line.begin();
+						if (g.character == '\t') {
+							line.erase(line.begin());
+						} else {
+							assert(false);
+						}
+
+						Coordinates pos(i, 0);
+						editor->onChanged(pos, pos, -1);
+					} else {
+						assert(false);
+					}
+				}
+			}
+
+			break;
+		case UndoType::unindent: {
+				assert(end.line - start.line + 1 == (int)content.length());
+
+				for (int i = start.line; i <= end.line; ++i) {
+					Line &line = editor->_codeLines[i];
+					char op = content[i - start.line];
+					if (op == 0) {
+						// Does nothing.
+					} else if (op == std::numeric_limits<char>::max()) {
+						line.insert(line.begin(), Glyph('\t', PaletteIndex::Default));
+
+						Coordinates pos(i, 0);
+						editor->onChanged(pos, pos, -1);
+					} else if (op > 0) {
+						while (op--) {
+							line.insert(line.begin(), Glyph(' ', PaletteIndex::Default));
+						}
+
+						Coordinates pos(i, 0);
+						editor->onChanged(pos, pos, -1);
+					} else {
+						assert(false);
+					}
+				}
+			}
+
+			break;
+		}
+	}
+
+	editor->recordChanges(*this, true);
+
+	editor->_state = before;
+	editor->ensureCursorVisible();
+
+	editor->onModified();
+}
+
+void CodeEdit::UndoRecord::redo(CodeEdit* editor) {
+	if (!content.empty()) {
+		switch (type) {
+		case UndoType::Add: {
+				editor->_state = before;
+
+				if (!overwritten.empty())
+					editor->removeRange(start, advanceUtf8Text(start, overwritten));
+
+				Coordinates st = start; // Moved to the end of the inserted text.
+				editor->insertTextAt(st, content.c_str());
+				editor->colorize(start.line - 1, st.line - start.line + 2);
+
+				editor->onChanged(start, st, 1);
+			}
+
+			break;
+		case UndoType::Remove: {
+				editor->removeRange(start, end);
+				editor->colorize(start.line - 1, end.line - start.line + 2);
+
+				editor->onChanged(start, start, 1);
+			}
+
+			break;
+		case UndoType::indent: {
+				assert(end.line - start.line + 1 == (int)content.length());
+
+				for (int i = start.line; i <= end.line; ++i) {
+					Line &line = editor->_codeLines[i];
+					const char op = content[i - start.line];
+					if (op == 0) {
+						// Does nothing.
+					} else if (op == std::numeric_limits<char>::max()) {
+						line.insert(line.begin(), Glyph('\t', PaletteIndex::Default));
+
+						Coordinates pos(i, 0);
+						editor->onChanged(pos, pos, 1);
+					} else {
+						assert(false);
+					}
+				}
+			}
+
+			break;
+		case UndoType::unindent: {
+				assert(end.line - start.line + 1 == (int)content.length());
+
+				for (int i = start.line; i <= end.line; ++i) {
+					Line &line = editor->_codeLines[i];
+					char op = content[i - start.line];
+					if (op == 0) {
+						// Does nothing.
+					} else if (op == std::numeric_limits<char>::max()) {
+						const Glyph &g = *line.begin();
+						if (g.character == '\t') {
+							line.erase(line.begin());
+						} else {
+							assert(false);
+						}
+
+						Coordinates pos(i, 0);
+						editor->onChanged(pos, pos, 1);
+					} else if (op > 0) {
+						while (op--) {
+							const Glyph &g = *line.begin();
+							if (g.character == ' ') {
+								line.erase(line.begin());
+							} else {
+								assert(false);
+							}
+						}
+
+						Coordinates pos(i, 0);
+						editor->onChanged(pos, pos, 1);
+					} else {
+						assert(false);
+					}
+				}
+			}
+
+			break;
+		}
+	}
+
+	editor->recordChanges(*this, false);
+
+	editor->_state = after;
+	editor->ensureCursorVisible();
+
+	editor->onModified();
+}
+
+struct CodeEdit::GlyphPool {
+	// Blocks are carved out of large ones in the size asked for, so bulk loaded lines
+	// waste nothing. Freed blocks are kept by size class for lines that grow later.
+	std::vector<char*> blocks;
+	char* cursor = nullptr;
+	char* limit = nullptr;
+	void* freeLists[GLYPH_POOL_CLASSES] = { }; // Blocks of at least 8 << n bytes, linked through their first bytes.
+	bool discarded = false; // Whether all lines are about to go, freeing one by one is pointless then.
+
+	GlyphPool() {
+	}
+	~GlyphPool() {
+		for (char* b : blocks)
+			::operator delete(b);
+	}
+
+	static size_t round(size_t bytes) {
+		return (std::max(bytes, sizeof(void*)) + 7) & ~(size_t)7;
+	}
+	static int ceilClass(size_t bytes) {
+		int n = 0;
+		while (((size_t)8 << n) < bytes)
+			++n;
+
+		return n;
+	}
+	static int floorClass(size_t bytes) {
+		int n = 0;
+		while (((size_t)16 << n) <= bytes && n < GLYPH_POOL_CLASSES - 1)
+			++n;
+
+		return n;
+	}
+
+	void* allocate(size_t bytes) {
+		bytes = round(bytes);
+		const int n = ceilClass(bytes);
+		if (freeLists[n] != nullptr) {
+			void* result = freeLists[n];
+			freeLists[n] = *(void**)result;
+
+			return result;
+		}
+		if ((size_t)(limit - cursor) < bytes) {
+			if (limit - cursor >= (ptrdiff_t)sizeof(void*))
+				deallocate(cursor, limit - cursor);
+			char* b = (char*)::operator new(GLYPH_POOL_BLOCK_BYTES);
+			blocks.push_back(b);
+			cursor = b;
+			limit = b + GLYPH_POOL_BLOCK_BYTES;
+		}
+		void* result = cursor;
+		cursor += bytes;
+
+		return result;
+	}
+	void deallocate(void* ptr, size_t bytes) {
+		if (discarded)
+			return;
+
+		const int n = floorClass(round(bytes));
+		*(void**)ptr = freeLists[n];
+		freeLists[n] = ptr;
+	}
+};
+
+void* CodeEdit::allocateGlyphs(GlyphPool* pool, size_t bytes) {
+	if (pool == nullptr || bytes > ((size_t)8 << (GLYPH_POOL_CLASSES - 1)))
+		return ::operator new(bytes);
+
+	return pool->allocate(bytes);
+}
+
+void CodeEdit::deallocateGlyphs(GlyphPool* pool, void* ptr, size_t bytes) {
+	if (pool == nullptr || bytes > ((size_t)8 << (GLYPH_POOL_CLASSES - 1))) {
+		::operator delete(ptr);
+
+		return;
+	}
+
+	pool->deallocate(ptr, bytes);
+}
+
+CodeEdit::Glyph::Glyph(CodeEdit::Char ch, PaletteIndex idx) : character(ch), colorIndex(idx), multiLineComment(false) {
+	if (ch <= 255) {
+		codepoint = (CodeEdit::CodePoint)ch;
+	} else {
+		const char* txt = (const char*)(&ch);
+		const char* tend = txt + sizeof(CodeEdit::Char);
+		unsigned int cp = 0;
+		charFromUtf8(&cp, txt, tend);
+		codepoint = (CodeEdit::CodePoint)cp;
+	}
+}
+
+void CodeEdit::Line::clear(void) {
+	changed = LineState::None;
+}
+
+void CodeEdit::Line::change(void) {
+	changed = LineState::Edited;
+}
+
+void CodeEdit::Line::save(void) {
+	changed = LineState::EditedSaved;
+}
+
+void CodeEdit::Line::revert(void) {
+	changed = LineState::EditedReverted;
+}
+
+CodeEdit::Snapshot::Text CodeEdit::Snapshot::Iterator::operator * (void) const {
+	const Chunk &c = *snapshot->chunks[chunk];
+	const char* bytes = c.bytes.c_str();
+
+	return Text(bytes + c.starts[line], bytes + c.starts[line + 1] - 1);
+}
+
+CodeEdit::Snapshot::Iterator &CodeEdit::Snapshot::Iterator::operator ++ (void) {
+	if (++line >= (int)snapshot->chunks[chunk]->starts.size() - 1) {
+		++chunk;
+		line = 0;
+	}
+
+	return *this;
+}
+
+int CodeEdit::Snapshot::getTotalLines(void) const {
+	return totalLines;
+}
+
+CodeEdit::Snapshot::Text CodeEdit::Snapshot::getLine(int ln) const {
+	assert(ln >= 0 && ln < totalLines);
+
+	Iterator it(this, std::upper_bound(firstLines.begin(), firstLines.end(), ln) - firstLines.begin() - 1);
+	it.line = ln - firstLines[it.chunk];
+
+	return *it;
+}
+
+CodeEdit::Snapshot::Iterator CodeEdit::Snapshot::begin(void) const {
+	return Iterator(this, 0);
+}
+
+CodeEdit::Snapshot::Iterator CodeEdit::Snapshot::end(void) const {
+	return Iterator(this, chunks.size());
+}
+
+std::string CodeEdit::Snapshot::getText(const char* newLine) const {
+	std::string result;
+	size_t bytes = 0;
+	for (const ChunkPtr &c : chunks)
+		bytes += c->bytes.length();
+	result.reserve(bytes);
+
+	if (strcmp(newLine, "\n") == 0) {
+		for (const ChunkPtr &c : chunks)
+			result += c->bytes;
+	} else {
+		for (Text ln : *this) {
+			result.append(ln.first, ln.last);
+			result += newLine;
+		}
+	}
+	if (totalLines > 0)
+		result.resize(result.length() - strlen(newLine)); // No new line after the last line.
+
+	return result;
+}
+
+CodeEdit::DrawBackend::~DrawBackend() {
+}
+
+CodeEdit::CodeEdit() {
+	_glyphPool = std::make_shared<GlyphPool>();
+	_taskPool = getDefaultTaskPool();
+	_symbolIndex = std::make_shared<SymbolIndex>();
+	_symbolIndex->pool = _taskPool;
+	_completion = std::make_shared<CompletionPopup>();
+	_drawRecorder = std::make_shared<DrawRecorder>();
+	_rowTree = std::make_shared<RowTree>();
+	_foldTree = std::make_shared<FoldTree>();
+	_bracketTree = std::make_shared<BracketTree>();
+	_drawBackend = std::make_shared<SdlDrawBackend>();
+	setPalette(DarkPalette());
+	_language = getDefaultLanguage();
+	_codeLines.push_back(createLine());
+}
+
+CodeEdit::~CodeEdit() {
+	_glyphPool->discarded = true;
+}
+
+CodeEdit::LanguagePtr CodeEdit::compileLanguage(const LanguageDefinition &langDef) {
+	std::shared_ptr<Language> result = std::make_shared<Language>();
+	result->definition = langDef;
+	if (langDef.tokenizer)
+		return result; // Regex patterns are not used.
+
+	std::regex_constants::syntax_option_type opt = std::regex_constants::optimize;
+	if (!langDef.caseSensitive)
+		opt |= std::regex_constants::icase;
+	for (const LanguageDefinition::TokenRegexString &r : langDef.tokenRegexPatterns)
+		result->regexes.push_back(std::make_pair(std::regex(r.first, opt), r.second));
+
+	return result;
+}
+
+const CodeEdit::LanguagePtr &CodeEdit::getLanguage(void) const {
+	return _language;
+}
+
+void CodeEdit::setLanguage(const LanguagePtr &lang) {
+	_language = lang ? lang : getDefaultLanguage();
+	_completion->stale = true;
+	_colorTask = nullptr; // Of the former language.
+	_entryStates.clear();
+}
+
+const CodeEdit::LanguageDefinition &CodeEdit::getLanguageDefinition(void) const {
+	return _language->definition;
+}
+
+CodeEdit::LanguageDefinition &CodeEdit::getLanguageDefinition(void) {
+	_completion->stale = true; // Might be modified.
+	if (_language.use_count() > 1) {
+		_colorTask = nullptr; // Reads the shared one.
+		_language = std::make_shared<Language>(*_language);
+	}
+	_entryStates.clear(); // Might lex differently.
+
+	return const_cast<LanguageDefinition &>(_language->definition); // Not shared, so not read elsewhere.
+}
+
+CodeEdit::LanguageDefinition &CodeEdit::setLanguageDefinition(const LanguageDefinition &langDef) {
+	setLanguage(compileLanguage(langDef));
+
+	return getLanguageDefinition();
+}
+
+const CodeEdit::Palette &CodeEdit::getPalette(void) const {
+	return _palette;
+}
+
+void CodeEdit::setPalette(const Palette &val) {
+	_palette = val;
+	_minimapStaleFrom = 0;
+}
+
+const CodeEdit::Vec2 &CodeEdit::getCharacterSize(void) const {
+	return _characterSize;
+}
+
+void CodeEdit::setCharacterSize(const Vec2 &val) {
+	_characterSize = val;
+}
+
+const void* CodeEdit::getFont(void) const {
+	return _font;
+}
+
+void CodeEdit::setFont(const void* data, const Vec2 &size) {
+	_font = data;
+	_characterSize = data ? size : Vec2(8, 8);
+}
+
+void CodeEdit::setErrorMarkers(const ErrorMarkers &val) {
+	_errorMarkers = val;
+}
+
+void CodeEdit::clearErrorMarkers(void) {
+	if (!_errorMarkers.empty())
+		_errorMarkers.clear();
+}
+
+void CodeEdit::setBreakpoints(const Breakpoints &val) {
+	_breakpoints = val;
+}
+
+void CodeEdit::clearBrakpoints(void) {
+	if (!_breakpoints.empty())
+		_breakpoints.clear();
+}
+
+const CodeEdit::Folds &CodeEdit::getFolds(void) const {
+	_folds.clear();
+	_foldTree->visit(_foldTree->size(), 0, [&] (int, int header, int last) { _folds[header] = last; });
+
+	return _folds;
+}
+
+bool CodeEdit::foldAt(int ln) {
+	if (ln < 0 || ln >= (int)_codeLines.size())
+		return false;
+
+	int opens = 0, depth = 0;
+	const int end = findFoldEnd(ln, -1, opens, depth);
+	if (end < ln + 2)
+		return false; // Nothing between the header and the closing line.
+
+	_foldTree->add(ln, end - 1, opens, depth);
+	refreshFolded(ln + 1, end - 1);
+
+	const Coordinates pos = getActualCursorCoordinates();
+	if (pos.line > ln && pos.line < end)
+		setCursorPosition(Coordinates(ln, (int)_codeLines[ln].size()));
+
+	return true;
+}
+
+bool CodeEdit::unfoldAt(int ln) {
+	std::vector<int> found;
+	int first = ln, last = ln;
+	_foldTree->visit(_foldTree->lowerBound(ln + 1), ln, [&] (int i, int header, int end) {
+		found.push_back(i);
+		first = std::min(first, header);
+		last = std::max(last, end);
+	});
+	for (std::vector<int>::reverse_iterator it = found.rbegin(); it != found.rend(); ++it)
+		_foldTree->removeAt(*it);
+	refreshFolded(first + 1, last);
+
+	return !found.empty();
+}
+
+void CodeEdit::unfoldAll(void) {
+	if (_foldTree->size() == 0)
+		return;
+
+	_foldTree->clear();
+	_wrapRowTreeDirty = true;
+}
+
+bool CodeEdit::isFoldHeader(int ln) const {
+	const int i = _foldTree->lowerBound(ln);
+
+	return i < _foldTree->size() && _foldTree->headerAt(i) == ln;
+}
+
+bool CodeEdit::findMatchingBracket(const Coordinates &at, Coordinates &bracket, Coordinates &match) const {
+	if (at.line < 0 || at.line >= (int)_codeLines.size())
+		return false;
+
+	const Line &line = _codeLines[at.line];
+	for (int column : { at.column, at.column - 1 }) {
+		if (column < 0 || column >= (int)line.size() || !isCodeGlyph(line[column]))
+			continue;
+
+		const Char c = line[column].character;
+		if (!isOpeningBracket(c) && !isClosingBracket(c))
+			continue;
+
+		bracket = Coordinates(at.line, column);
+		if (isOpeningBracket(c)) {
+			if (!findBracketForward(Coordinates(at.line, column + 1), 1, match))
+				return false;
+
+			return isBracketPair(c, _codeLines[match.line][match.column].character);
+		} else {
+			if (!findBracketBackward(bracket, 1, match))
+				return false;
+
+			return isBracketPair(_codeLines[match.line][match.column].character, c);
+		}
+	}
+
+	return false;
+}
+
+bool CodeEdit::findEnclosingBrackets(const Coordinates &at, Coordinates &open, Coordinates &close) const {
+	if (at.line < 0 || at.line >= (int)_codeLines.size())
+		return false;
+
+	if (!findBracketBackward(at, 1, open) || !findBracketForward(at, 1, close))
+		return false;
+
+	return isBracketPair(_codeLines[open.line][open.column].character, _codeLines[close.line][close.column].character);
+}
+
+bool CodeEdit::moveToMatchingBracket(bool select) {
+	const Coordinates oldPos = getActualCursorCoordinates();
+	Coordinates bracket, match;
+	if (!findMatchingBracket(oldPos, bracket, match))
+		return false;
+
+	// Keeps the cursor on the same side of the bracket.
+	if (oldPos.column > bracket.column)
+		++match.column;
+	setCursorPosition(match);
+
+	if (select) {
+		if (oldPos == _interactiveStart) {
+			_interactiveStart = _state.cursorPosition;
+		} else if (oldPos == _interactiveEnd) {
+			_interactiveEnd = _state.cursorPosition;
+		} else {
+			_interactiveStart = _state.cursorPosition;
+			_interactiveEnd = oldPos;
+		}
+	} else {
+		_interactiveStart = _interactiveEnd = _state.cursorPosition;
+	}
+	setSelection(_interactiveStart, _interactiveEnd);
+
+	return true;
+}
+
+CodeEdit::Symbols CodeEdit::getSymbols(const std::string &prefix, size_t maxCount) const {
+	Symbols result;
+	std::shared_ptr<const Symbols> sorted = _symbolIndex->snapshot();
+	for (Symbols::const_iterator it = std::lower_bound(sorted->begin(), sorted->end(), prefix); it != sorted->end(); ++it) {
+		if (it->compare(0, prefix.length(), prefix) != 0)
+			break;
+
+		result.push_back(*it);
+		if (maxCount && result.size() >= maxCount)
+			break;
+	}
+
+	return result;
+}
+
+bool CodeEdit::findSymbolOccurrence(const Coordinates &from, bool forward, Coordinates &result) const {
+	const SymbolSpan* symbol = getSymbolAt(from);
+	if (!symbol)
+		return false;
+
+	const int id = symbol->id;
+	const int column = symbol->column;
+	if (forward) {
+		for (int ln = from.line; ln < (int)_codeLines.size(); ++ln) {
+			for (const SymbolSpan &s : _codeLines[ln].symbols) {
+				if (s.id == id && (ln > from.line || s.column > column)) {
+					result = Coordinates(ln, s.column);
+
+					return true;
+				}
+			}
+		}
+	} else {
+		for (int ln = from.line; ln >= 0; --ln) {
+			const SymbolSpans &symbols = _codeLines[ln].symbols;
+			for (SymbolSpans::const_reverse_iterator it = symbols.rbegin(); it != symbols.rend(); ++it) {
+				if (it->id == id && (ln < from.line || it->column < column)) {
+					result = Coordinates(ln, it->column);
+
+					return true;
+				}
+			}
+		}
+	}
+
+	return false;
+}
+
+bool CodeEdit::isCompletionEnabled(void) const {
+	return _completionEnabled;
+}
+
+void CodeEdit::setCompletionEnabled(bool en) {
+	_completionEnabled = en;
+	if (!en)
+		_completion->open = false;
+}
+
+bool CodeEdit::isCompleting(void) const {
+	return _completion->open;
+}
+
+void CodeEdit::complete(void) {
+	_completion->open = false;
+	openCompletion(true);
+}
+
+void CodeEdit::cancelCompletion(void) {
+	_completion->open = false;
+}
+
+void CodeEdit::render(void* rnd) {
+	constexpr float heightOffset = 1.0f;
+	const SDL_Rect rectContent{
+		(int)getWidgetPos().x, (int)getWidgetPos().y,
+		(int)getWidgetSize().x, (int)getWidgetSize().y
+	};
+	const float offsetCode = _charAdv.x * _textStart;
+	const SDL_Rect rectCode{
+		(int)(getWidgetPos().x + offsetCode), (int)getWidgetPos().y,
+		(int)(getWidgetSize().x - offsetCode), (int)getWidgetSize().y
+	};
+	const SDL_Rect rectGutter{
+		rectContent.x, rectContent.y,
+		rectCode.x - rectContent.x, rectContent.h
+	};
+	DrawRecorder &recorder = *_drawRecorder;
+	const int clipGutter = recorder.clip(rectGutter); // The gutter and the code are drawn with one clip each.
+	const int clipCode = recorder.clip(rectCode);
+
+	_withinRender = true;
+
+	const float xadv = _characterSize.x;
+	if (_charAdv.x != xadv)
+		_lineWidthsDirty = true; // Glyph widths depend on the advance.
+	_charAdv = Vec2(xadv, _characterSize.y + _lineSpacing);
+	if (_lineWidthsDirty)
+		rebuildLineWidths();
+	if (_codeLines.size() >= 10000)
+		_textStart = 7;
+	else if (_codeLines.size() >= 1000)
+		_textStart = 6;
+	else
+		_textStart = 5;
+	++_textStart; // For edited states.
+	if (_foldsStaleFrom <= _foldsStaleTo) {
+		// Colors changed by an edit elsewhere, like an opened comment, can end or move a region.
+		const int from = _foldsStaleFrom, to = _foldsStaleTo;
+		_foldsStaleFrom = 0;
+		_foldsStaleTo = -1;
+		validateFolds(from, to);
+	}
+	updateWrapLayout();
+
+	const bool shift = isKeyShiftDown();
+	const bool ctrl = isKeyCtrlDown();
+	const bool alt = isKeyAltDown();
+	bool typed = false; // Whether the input ends with part of an identifier.
+
+	if (isWidgetFocused()) {
+		if (_mouseCursorInput != isWidgetHovered()) {
+			if (_mouseCursorChangedHandler != nullptr)
+				_mouseCursorChangedHandler(isWidgetHovered());
+			_mouseCursorInput = isWidgetHovered();
+		}
+
+		if (isShortcutsEnabled(ShortcutType::UndoRedo)) {
+			if (!isReadonly()) {
+				if (ctrl && !shift && !alt && isKeyPressed(SDLK_z)) {
+					undo();
+				} else if (ctrl && !shift && !alt && isKeyPressed(SDLK_y)) {
+					redo();
+				}
+			}
+		}
+
+		if (isShortcutsEnabled(ShortcutType::CopyCutPaste)) {
+			if (ctrl && !shift && !alt && isKeyPressed(SDLK_c))
+				copy();
+			else if (!isReadonly() && ctrl && !shift && !alt && isKeyPressed(SDLK_v))
+				paste();
+			else if (ctrl && !shift && !alt && isKeyPressed(SDLK_x))
+				cut();
+			else if (ctrl && !shift && !alt && isKeyPressed(SDLK_a))
+				selectAll();
+		}
+
+		if (isShortcutsEnabled(ShortcutType::Folding)) {
+			if (ctrl && shift && !alt && isKeyPressed(SDLK_LEFTBRACKET))
+				foldAt(getActualCursorCoordinates().line);
+			else if (ctrl && shift && !alt && isKeyPressed(SDLK_RIGHTBRACKET))
+				unfoldAt(getActualCursorCoordinates().line);
+		}
+
+		if (isShortcutsEnabled(ShortcutType::Brackets)) {
+			if (ctrl && !alt && isKeyPressed(SDLK_BACKSLASH))
+				moveToMatchingBracket(shift);
+		}
+
+		if (isShortcutsEnabled(ShortcutType::Completion)) {
+			if (!isReadonly() && ctrl && !shift && !alt && isKeyPressed(SDLK_SPACE))
+				complete();
+		}
+
+		const bool completionKeys = handleCompletionKeys();
+		if (completionKeys) {
+			// Does nothing.
+		} else if (!ctrl && !alt && isKeyPressed(SDLK_UP))
+			moveUp(1, shift);
+		else if (!ctrl && !alt && isKeyPressed(SDLK_DOWN))
+			moveDown(1, shift);
+		else if (!alt && isKeyPressed(SDLK_LEFT))
+			moveLeft(1, shift, ctrl);
+		else if (!alt && isKeyPressed(SDLK_RIGHT))
+			moveRight(1, shift, ctrl);
+		else if (!alt && isKeyPressed(SDLK_PAGEUP))
+			moveUp(getPageSize() - 4, shift);
+		else if (!alt && isKeyPressed(SDLK_PAGEDOWN))
+			moveDown(getPageSize() - 4, shift);
+		else if (!alt && ctrl && isKeyPressed(SDLK_HOME))
+			moveTop(shift);
+		else if (ctrl && !alt && isKeyPressed(SDLK_END))
+			moveBottom(shift);
+		else if (!ctrl && !alt && isKeyPressed(SDLK_HOME))
+			moveHome(shift);
+		else if (!ctrl && !alt && isKeyPressed(SDLK_END))
+			moveEnd(shift);
+		else if (!isReadonly() && !ctrl && !shift && !alt && isKeyPressed(SDLK_DELETE))
+			remove();
+		else if (!isReadonly() && !ctrl && !shift && !alt && isKeyPressed(SDLK_BACKSPACE))
+			backspace();
+
+		if (!isReadonly() && !completionKeys) {
+			if (isKeyPressed(SDLK_RETURN) || onKeyPressed(SDLK_RETURN)) {
+				if (!alt) {
+					unsigned int c = '\n'; // Inserts new line.
+					addInputCharacter((CodeEdit::CodePoint)c);
+				}
+			} else if (isKeyPressed(SDLK_TAB)) {
+				if (hasSelection() && getSelectionLines() > 1) {
+					if (!ctrl && !alt && !shift) // Indents multi-lines.
+						indent();
+					else if (!ctrl && !alt && shift) // Unindents multi-lines.
+						unindent();
+					else if (ctrl && !alt && shift) // Unindents multi-lines.
+						unindent();
+				} else {
+					if (!ctrl && !alt && !shift) {
+						unsigned int c = '\t'; // Inserts tab.
+						addInputCharacter((CodeEdit::CodePoint)c);
+					} else if (!ctrl && !alt && shift) {
+						CodeEdit::Char cc = getCharUnderCursor();
+						if (cc == '\t' || cc == ' ')
+							backspace(); // Unindents single line.
+					} else if (ctrl && !alt && shift) {
+						CodeEdit::Char cc = getCharUnderCursor();
+						if (cc == '\t' || cc == ' ')
+							backspace(); // Unindents single line.
+					}
+				}
+			}
+		}
+
+		if (!isReadonly() && (!_inputCharacters.empty() && _inputCharacters[0])) {
+			const std::string tmp = strToUtf8StdStr(_inputCharacters.c_str(), nullptr);
+			char* str = (char*)tmp.c_str();
+			while (*str && str < (char*)tmp.c_str() + tmp.length()) {
+				int n = expectUtf8Char(str);
+				CodeEdit::Char c = takeUtf8Bytes(str, n);
+				if (c != 0) {
+					if (c == '\r')
+						c = '\n';
+					enterCharacter(c);
+					typed = isIdentifierGlyph(Glyph(c, PaletteIndex::Default));
+				}
+				str += n;
+			}
+		}
+		_inputCharacters.clear();
+	}
+
+	if (isWidgetHovered()) {
+		if (isWidgetFocused() && isMousePressed() && clickCompletion(getMousePos())) {
+			// Does nothing.
+		} else if (!shift && !alt) {
+			if (isMousePressed()) {
+				_state.cursorPosition = _interactiveStart = _interactiveEnd = sanitizeCoordinates(screenPosToCoordinates(getMousePos()));
+				if (ctrl)
+					_wordSelectionMode = true;
+				setSelection(_interactiveStart, _interactiveEnd, _wordSelectionMode);
+			}
+			if (isMouseDoubleClicked() && !ctrl) {
+				_state.cursorPosition = _interactiveStart = _interactiveEnd = sanitizeCoordinates(screenPosToCoordinates(getMousePos()));
+				_wordSelectionMode = true;
+				setSelection(_interactiveStart, _interactiveEnd, _wordSelectionMode);
+				_state.cursorPosition = _state.selectionEnd;
+			} else if (isMouseDragging() && isMouseDown()) {
+				_state.cursorPosition = _interactiveEnd = sanitizeCoordinates(screenPosToCoordinates(getMousePos()));
+				setSelection(_interactiveStart, _interactiveEnd, _wordSelectionMode);
+			}
+		} else if (shift) {
+			if (isMousePressed()) {
+				_state.cursorPosition = _interactiveEnd = sanitizeCoordinates(screenPosToCoordinates(getMousePos()));
+				setSelection(_interactiveStart, _interactiveEnd, _wordSelectionMode);
+			}
+		}
+
+		if (!isMouseDown()) {
+			_wordSelectionMode = false;
+		}
+	}
+
+	static std::string buffer; // Shared.
+	Vec2 contentSize = getWidgetSize();
+	int appendIndex = 0;
+
+	const Vec2 cursorScreenPos = getWidgetPos();
+	const float scrollX = getScrollX();
+	const float scrollY = getScrollY();
+
+	int rowNo = (int)floor(scrollY / _charAdv.y);
+	const int rowMax = rowNo + (int)ceil(contentSize.y / _charAdv.y);
+	int lineRow = 0;
+	int lineNo = rowToLine(rowNo, lineRow);
+	int lineRowMax = 0;
+	const int lineMax = std::max(0, std::min((int)_codeLines.size() - 1, rowToLine(rowMax, lineRowMax)));
+	updateColorTask();
+	if (!colorizeVisible(lineNo, lineMax + 1))
+		colorizeInternal(); // Colorizes off-screen lines in idle time only.
+	if (typed && _completionEnabled && !_completion->open)
+		openCompletion(false); // After colorizing, to tell comments and strings.
+	else
+		updateCompletion();
+	Coordinates bracket, bracketMatch;
+	const bool bracketMatched = findMatchingBracket(_state.cursorPosition, bracket, bracketMatch);
+	const SymbolSpan* cursorSymbol = hasSelection() ? nullptr : getSymbolAt(_state.cursorPosition);
+	const int symbol = cursorSymbol ? cursorSymbol->id : -1;
+	if (!_codeLines.empty()) {
+		while (lineNo <= lineMax && rowNo <= rowMax) {
+			Vec2 lineStartScreenPos(
+				cursorScreenPos.x - scrollX,
+				cursorScreenPos.y - scrollY + rowNo * _charAdv.y
+			);
+			Vec2 textScreenPos(
+				lineStartScreenPos.x + _charAdv.x * _textStart,
+				lineStartScreenPos.y
+			);
+
+			const Line &line = _codeLines[lineNo];
+			const bool lastRow = lineRow == (int)line.wraps.size();
+			const int rowBegin = lineRow > 0 ? line.wraps[lineRow - 1] : 0;
+			const int rowEnd = lastRow ? (int)line.size() : line.wraps[lineRow];
+			const int rowOffset = rowBegin > 0 ? textDistanceToLineStart(Coordinates(lineNo, rowBegin)) : 0;
+			const Coordinates lineStartCoord(lineNo, rowBegin);
+			const Coordinates lineEndCoord(lineNo, rowEnd);
+
+			int sstart = -1;
+			int ssend = -1;
+
+			assert(_state.selectionStart <= _state.selectionEnd);
+			if (_state.selectionStart <= lineEndCoord)
+				sstart = _state.selectionStart > lineStartCoord ? textDistanceToLineStart(_state.selectionStart) - rowOffset : 0;
+			if (_state.selectionEnd > lineStartCoord)
+				ssend = textDistanceToLineStart(_state.selectionEnd < lineEndCoord ? _state.selectionEnd : lineEndCoord) - rowOffset;
+
+			if (_state.selectionEnd.line > lineNo && lastRow)
+				++ssend;
+
+			if (sstart != -1 && ssend != -1 && sstart < ssend) {
+				const Vec2 vstart(lineStartScreenPos.x + (_charAdv.x) * (sstart + _textStart), lineStartScreenPos.y);
+				const Vec2 vend(lineStartScreenPos.x + (_charAdv.x) * (ssend + _textStart), lineStartScreenPos.y + _charAdv.y - heightOffset);
+				recorder.box(DrawLayer::Selection, clipCode, (Sint16)vstart.x, (Sint16)vstart.y, (Sint16)vend.x, (Sint16)vend.y, _palette[(int)PaletteIndex::Selection]);
+			}
+
+			if (bracketMatched) {
+				for (const Coordinates &b : { bracket, bracketMatch }) {
+					if (b.line != lineNo || b.column < rowBegin || b.column >= rowEnd)
+						continue;
+
+					const int bx = textDistanceToLineStart(b) - rowOffset;
+					const Vec2 bstart(lineStartScreenPos.x + _charAdv.x * (bx + _textStart), lineStartScreenPos.y);
+					const Vec2 bend(bstart.x + _charAdv.x - 1.0f, lineStartScreenPos.y + _charAdv.y - heightOffset);
+					recorder.box(DrawLayer::MatchingBracket, clipCode, (Sint16)bstart.x, (Sint16)bstart.y, (Sint16)bend.x, (Sint16)bend.y, _palette[(int)PaletteIndex::MatchingBracket]);
+				}
+			}
+
+			if (symbol >= 0) {
+				for (const SymbolSpan &s : line.symbols) {
+					if (s.id != symbol || s.column >= rowEnd || s.column + s.length <= rowBegin)
+						continue;
+
+					const int sx = textDistanceToLineStart(Coordinates(lineNo, std::max(s.column, rowBegin))) - rowOffset;
+					const int ex = textDistanceToLineStart(Coordinates(lineNo, std::min(s.column + s.length, rowEnd))) - rowOffset;
+					const Vec2 sstart(lineStartScreenPos.x + _charAdv.x * (sx + _textStart), lineStartScreenPos.y);
+					const Vec2 send(lineStartScreenPos.x + _charAdv.x * (ex + _textStart) - 1.0f, lineStartScreenPos.y + _charAdv.y - heightOffset);
+					recorder.box(DrawLayer::SymbolOccurrence, clipCode, (Sint16)sstart.x, (Sint16)sstart.y, (Sint16)send.x, (Sint16)send.y, _palette[(int)PaletteIndex::SymbolOccurrence]);
+				}
+			}
+
+			const Vec2 start(lineStartScreenPos.x + scrollX, lineStartScreenPos.y);
+
+			if (_breakpoints.find(lineNo + 1) != _breakpoints.end()) {
+				const Vec2 end(lineStartScreenPos.x + contentSize.x + 2.0f * scrollX, lineStartScreenPos.y + _charAdv.y - heightOffset);
+				recorder.box(DrawLayer::Breakpoint, clipCode, (Sint16)start.x, (Sint16)start.y, (Sint16)end.x, (Sint16)end.y, _palette[(int)PaletteIndex::Breakpoint]);
+			}
+
+			auto errorIt = _errorMarkers.find(lineNo + 1);
+			if (errorIt != _errorMarkers.end()) {
+				const Vec2 end(lineStartScreenPos.x + contentSize.x + 2.0f * scrollX, lineStartScreenPos.y + _charAdv.y - heightOffset);
+				recorder.box(DrawLayer::ErrorMarker, clipCode, (Sint16)start.x, (Sint16)start.y, (Sint16)end.x, (Sint16)end.y, _palette[(int)PaletteIndex::ErrorMarker]);
+
+				//if (_tooltipEnabled) {
+				//	if (ImGui::IsMouseHoveringRect(lineStartScreenPos, end)) {
+				//		ImGui::BeginTooltip();
+				//		ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(1.0f, 0.2f, 0.2f, 1.0f));
+				//		ImGui::Text("Error at line %d:", errorIt->first);
+				//		ImGui::PopStyleColor();
+				//		ImGui::Separator();
+				//		ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(1.0f, 1.0f, 0.2f, 1.0f));
+				//		ImGui::Text("%s", errorIt->second.c_str());
+				//		ImGui::PopStyleColor();
+				//		ImGui::EndTooltip();
+				//	}
+				//}
+			}
+
+			if (lineRow == 0)
+				recorder.number(DrawLayer::LineNumber, clipGutter, (Sint16)(lineStartScreenPos.x + scrollX), (Sint16)lineStartScreenPos.y, lineNo + 1, _palette[(int)PaletteIndex::LineNumber]);
+			switch (line.changed) {
+			case LineState::None:
+				// Does nothing.
+
+				break;
+			case LineState::Edited:
+				recorder.box(
+					DrawLayer::LineState, clipGutter,
+					(Sint16)(lineStartScreenPos.x + scrollX + _charAdv.x * (_textStart - 1)), (Sint16)lineStartScreenPos.y,
+					(Sint16)(lineStartScreenPos.x + scrollX + _charAdv.x * (_textStart - 1) + _charAdv.x * 0.5f), (Sint16)(lineStartScreenPos.y + _charAdv.y - heightOffset),
+					_palette[(int)PaletteIndex::LineEdited]
+				);
+
+				break;
+			case LineState::EditedSaved:
+				recorder.box(
+					DrawLayer::LineState, clipGutter,
+					(Sint16)(lineStartScreenPos.x + scrollX + _charAdv.x * (_textStart - 1)), (Sint16)lineStartScreenPos.y,
+					(Sint16)(lineStartScreenPos.x + scrollX + _charAdv.x * (_textStart - 1) + _charAdv.x * 0.5f), (Sint16)(lineStartScreenPos.y + _charAdv.y - heightOffset),
+					_palette[(int)PaletteIndex::LineEditedSaved]
+				);
+
+				break;
+			case LineState::EditedReverted:
+				recorder.box(
+					DrawLayer::LineState, clipGutter,
+					(Sint16)(lineStartScreenPos.x + scrollX + _charAdv.x * (_textStart - 1)), (Sint16)lineStartScreenPos.y,
+					(Sint16)(lineStartScreenPos.x + scrollX + _charAdv.x * (_textStart - 1) + _charAdv.x * 0.5f), (Sint16)(lineStartScreenPos.y + _charAdv.y - heightOffset),
+					_palette[(int)PaletteIndex::LineEditedReverted]
+				);
+
+				break;
+			}
+
+			if (_state.cursorPosition.line == lineNo) {
+				const bool focused = isWidgetFocused();
+
+				if (!hasSelection()) {
+					const Vec2 end(start.x + contentSize.x, start.y + _charAdv.y - heightOffset);
+					const unsigned fill = _palette[(int)(focused ? PaletteIndex::CurrentLineFill : PaletteIndex::CurrentLineFillInactive)];
+					const unsigned edge = _palette[(int)PaletteIndex::CurrentLineEdge];
+					recorder.box(DrawLayer::GutterCurrentLine, clipGutter, (Sint16)start.x, (Sint16)start.y, (Sint16)end.x, (Sint16)end.y, fill);
+					recorder.frame(DrawLayer::GutterCurrentLineEdge, clipGutter, (Sint16)start.x, (Sint16)start.y, (Sint16)end.x, (Sint16)end.y + 1, edge);
+					recorder.box(DrawLayer::CurrentLine, clipCode, (Sint16)start.x, (Sint16)start.y, (Sint16)end.x, (Sint16)end.y, fill); // The clips split it.
+					recorder.frame(DrawLayer::CurrentLineEdge, clipCode, (Sint16)start.x, (Sint16)start.y, (Sint16)end.x, (Sint16)end.y + 1, edge);
+				}
+
+				int cx = 0;
+				const int cursorRow = coordinatesToRow(_state.cursorPosition, cx);
+
+				if (focused && cursorRow == rowNo) {
+					static auto timeStart = std::chrono::system_clock::now(); // Shared.
+					auto timeEnd = std::chrono::system_clock::now();
+					auto diff = timeEnd - timeStart;
+					const long long elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(diff).count();
+					const Vec2 cstart(lineStartScreenPos.x + _charAdv.x * (cx + _textStart), lineStartScreenPos.y);
+					if (elapsed > 400) {
+						const Vec2 cend(lineStartScreenPos.x + _charAdv.x * (cx + _textStart) + (_overwrite ? _charAdv.x : 1.0f), lineStartScreenPos.y + _charAdv.y - heightOffset);
+						recorder.box(DrawLayer::Cursor, clipCode, (Sint16)cstart.x, (Sint16)cstart.y, (Sint16)cend.x, (Sint16)cend.y, _palette[(int)PaletteIndex::Cursor]);
+						if (elapsed > 800)
+							timeStart = timeEnd;
+					}
+				}
+			}
+
+			appendIndex = rowOffset; // Keeps tab stops aligned to the line.
+			PaletteIndex prevColor = rowBegin >= rowEnd ? PaletteIndex::Default : (line[rowBegin].multiLineComment ? PaletteIndex::MultiLineComment : line[rowBegin].colorIndex);
+
+			int width = 0;
+			for (int columnNo = rowBegin; columnNo < rowEnd; ++columnNo) {
+				const Glyph &glyph = line[columnNo];
+				const PaletteIndex color = glyph.multiLineComment ? PaletteIndex::MultiLineComment : glyph.colorIndex;
+
+				if (color != prevColor && !buffer.empty()) {
+					recorder.text(DrawLayer::Code, clipCode, (Sint16)textScreenPos.x, (Sint16)textScreenPos.y, buffer.c_str(), _palette[(uint8_t)prevColor], _utf8SupportEnabled);
+					textScreenPos.x += _charAdv.x * width;
+					buffer.clear();
+					prevColor = color;
+					width = 0;
+				}
+				appendIndex = appendBuffer(buffer, glyph, appendIndex, width);
+			}
+
+			if (!buffer.empty()) {
+				recorder.text(DrawLayer::Code, clipCode, (Sint16)textScreenPos.x, (Sint16)textScreenPos.y, buffer.c_str(), _palette[(uint8_t)prevColor], _utf8SupportEnabled);
+				buffer.clear();
+			}
+
+			if (lastRow && isFoldHeader(lineNo)) {
+				const float x = lineStartScreenPos.x + _charAdv.x * (_textStart + line.width - rowOffset + 1);
+				recorder.text(DrawLayer::Fold, clipCode, (Sint16)x, (Sint16)lineStartScreenPos.y, "...", _palette[(int)PaletteIndex::Comment], false);
+			}
+			appendIndex = 0;
+			lineStartScreenPos.y += _charAdv.y;
+			textScreenPos.x = lineStartScreenPos.x + _charAdv.x * _textStart;
+			textScreenPos.y = lineStartScreenPos.y;
+			++rowNo;
+			if (++lineRow > (int)line.wraps.size())
+				lineNo = rowToLine(rowNo, lineRow); // Skips folded lines.
+		}
+
+		if (_tooltipEnabled) {
+			//std::string id = getWordAt(screenPosToCoordinates(getMousePos()));
+			//if (!id.empty()) {
+			//	auto it = _language->definition.ids.find(id);
+			//	if (it != _language->definition.ids.end() && !it->second.declaration.empty()) {
+			//		ImGui::BeginTooltip();
+			//		ImGui::TextUnformatted(it->second.declaration.c_str());
+			//		ImGui::EndTooltip();
+			//	} else {
+			//		auto pi = _language->definition.preprocIds.find(id);
+			//		if (pi != _language->definition.preprocIds.end() && !pi->second.declaration.empty()) {
+			//			ImGui::BeginTooltip();
+			//			ImGui::TextUnformatted(pi->second.declaration.c_str());
+			//			ImGui::EndTooltip();
+			//		}
+			//	}
+			//}
+		}
+	}
+
+	if (_completion->open && isWidgetFocused())
+		drawCompletion();
+
+	_drawList.font = _font;
+	_drawList.characterSize = _characterSize;
+	_drawList.numberWidth = _textStart - 2; // Leaves a column for edited states.
+	_drawList.lineHeight = (int)_charAdv.y;
+	recorder.finish(_drawList);
+	_renderStats = RenderStats();
+	_drawBackend->replay(rnd, _drawList, _renderStats);
+
+	const int longest = _wordWrapEnabled ? std::min(getLongestLineWidth(), _wrapColumns) : getLongestLineWidth();
+	_contentSize = Vec2((_textStart + longest + 1) * _charAdv.x, getTotalRows() * _charAdv.y);
+	if (_scrollX > _contentSize.x - _widgetSize.x)
+		_scrollX = std::max(_contentSize.x - _widgetSize.x, 0.0f);
+
+	if (_scrollToCursor) {
+		ensureCursorVisible(_scrollToCursor == -1);
+		_widgetFocused = true;
+		_scrollToCursor = 0;
+	}
+
+	_symbolIndex->flush(); // Hands the symbols changed in this frame over to the index job.
+
+	updateFileTask();
+
+	onTextChanged();
+
+	_withinRender = false;
+}
+
+void CodeEdit::renderMinimap(void* rnd, const Vec4 &rect) {
+	SDL_Renderer* renderer = (SDL_Renderer*)rnd;
+
+	const int width = (int)rect.width;
+	const int height = (int)rect.height / MINIMAP_LINE_HEIGHT;
+	if (width <= 0 || height <= 0 || _charAdv.y <= 0.0f)
+		return;
+
+	int texWidth = 0, texHeight = 0;
+	if (_minimapTexture)
+		SDL_QueryTexture(_minimapTexture.get(), nullptr, nullptr, &texWidth, &texHeight);
+	if (!_minimapTexture || _minimapRenderer != renderer || texWidth != width || texHeight != height) {
+		SDL_Texture* tex = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ABGR8888, SDL_TEXTUREACCESS_STREAMING, width, height);
+		if (!tex)
+			return;
+		SDL_SetTextureBlendMode(tex, SDL_BLENDMODE_BLEND);
+		_minimapTexture = std::shared_ptr<SDL_Texture>(tex, SDL_DestroyTexture);
+		_minimapRenderer = renderer;
+		_minimapRowLines.assign(height, -1);
+	}
+	SDL_Texture* tex = _minimapTexture.get();
+
+	// Scrolls along with the widget when there are more lines than rows.
+	const int total = (int)_codeLines.size();
+	const int totalRows = getTotalRows();
+	const int firstRow = std::min((int)(_scrollY / _charAdv.y), totalRows - 1);
+	const int lastRow = std::min((int)((_scrollY + _widgetSize.y) / _charAdv.y), totalRows - 1);
+	int lineRow = 0;
+	const int firstLine = rowToLine(firstRow, lineRow);
+	const int lastLine = rowToLine(lastRow, lineRow);
+	int top = 0;
+	if (total > height && _contentSize.y > _widgetSize.y)
+		top = (int)(std::min(_scrollY / (_contentSize.y - _widgetSize.y), 1.0f) * (total - height));
+	const int count = std::min(height, total - top);
+
+	// Uploads the rows of lines that are edited, recolorized or moved, in contiguous runs.
+	auto stale = [&] (int ln) -> bool {
+		return _minimapRowLines[ln % height] != ln || !_codeLines[ln].minimapDrawn || ln >= _minimapStaleFrom;
+	};
+	for (int ln = top; ln < top + count; ) {
+		if (!stale(ln)) {
+			++ln;
+
+			continue;
+		}
+
+		int end = ln + 1;
+		while (end < top + count && end % height != 0 && stale(end))
+			++end;
+		const SDL_Rect area{ 0, ln % height, width, end - ln };
+		void* pixels = nullptr;
+		int pitch = 0;
+		if (SDL_LockTexture(tex, &area, &pixels, &pitch) == 0) {
+			for (int i = ln; i < end; ++i) {
+				Line &line = _codeLines[i];
+				drawMinimapLine(line, (unsigned*)((Uint8*)pixels + (i - ln) * pitch), width);
+				line.minimapDrawn = true;
+				_minimapRowLines[i % height] = i;
+			}
+			SDL_UnlockTexture(tex);
+		}
+		ln = end;
+	}
+	_minimapStaleFrom = total;
+
+	// The texture is a ring of rows, copies it in two parts if it wraps around.
+	const int split = top % height;
+	const int head = std::min(count, height - split);
+	const SDL_Rect srcHead{ 0, split, width, head };
+	const SDL_Rect dstHead{ (int)rect.x, (int)rect.y, width, head * MINIMAP_LINE_HEIGHT };
+	SDL_RenderCopy(renderer, tex, &srcHead, &dstHead);
+	if (count > head) {
+		const SDL_Rect srcTail{ 0, 0, width, count - head };
+		const SDL_Rect dstTail{ (int)rect.x, (int)rect.y + head * MINIMAP_LINE_HEIGHT, width, (count - head) * MINIMAP_LINE_HEIGHT };
+		SDL_RenderCopy(renderer, tex, &srcTail, &dstTail);
+	}
+
+	// Markers are drawn over the texture, they don't invalidate any row.
+	const Sint16 x0 = (Sint16)rect.x;
+	const Sint16 x1 = (Sint16)(rect.x + width - 1);
+	auto lineY = [&] (int ln) -> Sint16 {
+		return (Sint16)(rect.y + (ln - top) * MINIMAP_LINE_HEIGHT);
+	};
+	for (int ln : _breakpoints) {
+		if (ln - 1 >= top && ln - 1 < top + count)
+			boxColor(renderer, x0, lineY(ln - 1), x1, lineY(ln) - 1, _palette[(int)PaletteIndex::Breakpoint]);
+	}
+	for (ErrorMarkers::const_iterator it = _errorMarkers.lower_bound(top + 1); it != _errorMarkers.end() && it->first <= top + count; ++it)
+		boxColor(renderer, x0, lineY(it->first - 1), x1, lineY(it->first) - 1, _palette[(int)PaletteIndex::ErrorMarker]);
+	const int viewBegin = std::max(firstLine, top);
+	const int viewEnd = std::min(lastLine + 1, top + count);
+	if (viewBegin < viewEnd)
+		boxColor(renderer, x0, lineY(viewBegin), x1, lineY(viewEnd) - 1, _palette[(int)PaletteIndex::CurrentLineFillInactive]);
+
+	// Centers the line under the mouse while it's pressed on the minimap.
+	const bool pressed =
+		_mouseDownPos.x >= rect.x && _mouseDownPos.x < rect.x + rect.width &&
+		_mouseDownPos.y >= rect.y && _mouseDownPos.y < rect.y + rect.height;
+	if (isMouseDown() && pressed) {
+		const int ln = std::max(0, std::min(top + (int)(_mousePos.y - rect.y) / MINIMAP_LINE_HEIGHT, total - 1));
+		const float y = (lineToRow(ln) + 0.5f) * _charAdv.y - _widgetSize.y * 0.5f;
+		setScrollY(std::min(y, std::max(_contentSize.y - _widgetSize.y, 0.0f)));
+	}
+}
+
+const CodeEdit::DrawList &CodeEdit::getDrawList(void) const {
+	return _drawList;
+}
+
+const CodeEdit::RenderStats &CodeEdit::getRenderStats(void) const {
+	return _renderStats;
+}
+
+const std::shared_ptr<CodeEdit::DrawBackend> &CodeEdit::getDrawBackend(void) const {
+	return _drawBackend;
+}
+
+void CodeEdit::setDrawBackend(const std::shared_ptr<DrawBackend> &backend) {
+	_drawBackend = backend ? backend : std::make_shared<SdlDrawBackend>();
+}
+
+void CodeEdit::setKeyPressedHandler(const KeyPressed &handler) {
+	_keyPressedHandler = handler;
+}
+
+void CodeEdit::setColorizedHandler(const Colorized &handler) {
+	_colorizedHandler = handler;
+}
+
+void CodeEdit::setModifiedHandler(const Modified &handler) {
+	_modifiedHandler = handler;
+}
+
+void CodeEdit::setMouseCursorChangedHandler(const MouseCursorChanged &handler) {
+	_mouseCursorChangedHandler = handler;
+}
+
+void CodeEdit::setTextChangedHandler(const TextChanged &handler) {
+	_textChangedHandler = handler;
+	_changes.clear();
+}
+
+unsigned CodeEdit::getVersion(void) const {
+	return _version;
+}
+
+void CodeEdit::setChangesCleared(void) {
+	for (Line &line : _codeLines) {
+		if (line.changed == LineState::Edited || line.changed == LineState::EditedSaved || line.changed == LineState::EditedReverted)
+			line.clear();
+	}
+}
+
+void CodeEdit::setChangesSaved(void) {
+	_savedIndex = _undoIndex;
+
+	for (Line &line : _codeLines) {
+		if (line.changed == LineState::Edited || line.changed == LineState::EditedReverted)
+			line.save();
+	}
+}
+
+bool CodeEdit::isChangesSaved(void) const {
+	return _savedIndex == _undoIndex;
+}
+
+std::vector<std::string> CodeEdit::getTextLines(bool includeComment, bool includeString) const {
+	std::vector<std::string> result;
+	result.reserve(_codeLines.size());
+	for (const Line &ln : _codeLines) {
+		result.push_back(std::string());
+		std::string &str = result.back();
+		if (includeComment && includeString) {
+			appendGlyphsToStdStr(str, ln);
+
+			continue;
+		}
+
+		for (const Glyph &g : ln) {
+			const bool multilinecomment =
+				g.colorIndex == PaletteIndex::Comment || g.colorIndex == PaletteIndex::MultiLineComment ||
+				ln[0].multiLineComment;
+			if (!includeComment && multilinecomment)
+				continue;
+			if (!includeString && (g.colorIndex == PaletteIndex::String))
+				continue;
+
+			appendUtf8ToStdStr(str, g.character);
+		}
+	}
+
+	return result;
+}
+
+std::string CodeEdit::getText(const char* newLine) const {
+	return getSnapshot().getText(newLine);
+}
+
+void CodeEdit::setText(const std::string &txt) {
+	std::shared_ptr<GlyphPool> pool = std::make_shared<GlyphPool>();
+	Lines lines(1, Line(GlyphAllocator<Glyph>(pool.get())));
+	TextDecoder decoder;
+	decoder.decode(lines, txt.c_str(), txt.c_str() + txt.length(), true);
+	_textEncoding = decoder.encoding;
+	if (decoder.newLine != nullptr)
+		_newLine = decoder.newLine;
+	replaceLines(lines, pool);
+}
+
+CodeEdit::Snapshot CodeEdit::getSnapshot(void) const {
+	int total = 0;
+	for (const SnapshotSlot &slot : _snapshotSlots)
+		total += slot.first;
+	if (_snapshotSlotsDirty || total != (int)_codeLines.size()) {
+		_snapshotSlots.clear();
+		for (int ln = 0; ln < (int)_codeLines.size(); ln += SNAPSHOT_CHUNK_LINES)
+			_snapshotSlots.push_back(SnapshotSlot(std::min(SNAPSHOT_CHUNK_LINES, (int)_codeLines.size() - ln), nullptr));
+		_snapshotSlotsDirty = false;
+	}
+
+	// Builds the chunks of changed lines only, others are shared.
+	Snapshot result;
+	result.chunks.reserve(_snapshotSlots.size());
+	result.firstLines.reserve(_snapshotSlots.size());
+	int first = 0;
+	for (size_t i = 0; i < _snapshotSlots.size(); ++i) {
+		if (!_snapshotSlots[i].second) {
+			while (i + 1 < _snapshotSlots.size() && !_snapshotSlots[i + 1].second && _snapshotSlots[i].first + _snapshotSlots[i + 1].first <= SNAPSHOT_CHUNK_LINES) {
+				_snapshotSlots[i].first += _snapshotSlots[i + 1].first; // Merges small ones.
+				_snapshotSlots.erase(_snapshotSlots.begin() + i + 1);
+			}
+			if (_snapshotSlots[i].first > SNAPSHOT_CHUNK_LINES * 2) {
+				const int rest = _snapshotSlots[i].first - SNAPSHOT_CHUNK_LINES; // Splits big ones.
+				_snapshotSlots[i].first = SNAPSHOT_CHUNK_LINES;
+				_snapshotSlots.insert(_snapshotSlots.begin() + i + 1, SnapshotSlot(rest, nullptr));
+			}
+			_snapshotSlots[i].second = buildSnapshotChunk(first, _snapshotSlots[i].first);
+		}
+		result.chunks.push_back(_snapshotSlots[i].second);
+		result.firstLines.push_back(first);
+		first += _snapshotSlots[i].first;
+	}
+	result.totalLines = first;
+
+	return result;
+}
+
+CodeEdit::TextEncoding CodeEdit::getTextEncoding(void) const {
+	return _textEncoding;
+}
+
+void CodeEdit::setTextEncoding(TextEncoding val) {
+	_textEncoding = val;
+}
+
+const char* CodeEdit::getNewLine(void) const {
+	return _newLine.c_str();
+}
+
+void CodeEdit::setNewLine(const char* val) {
+	_newLine = val != nullptr ? val : "\n";
+}
+
+bool CodeEdit::loadFileAsync(const char* path, const FileProgressed &progressed, const FileFinished &finished) {
+	if (path == nullptr || isFileBusy())
+		return false;
+
+	_fileTask = std::make_shared<FileTask>();
+	FileTask &task = *_fileTask;
+	task.loading = true;
+	task.path = path;
+	task.tabSize = _tabSize;
+	task.wideWidth = getWideCharacterWidth();
+	task.progressed = progressed;
+	task.finished = finished;
+	task.job = _taskPool->post(std::bind(&FileTask::load, &task), TaskPool::Priority::High);
+
+	return true;
+}
+
+bool CodeEdit::saveFileAsync(const char* path, const char* newLine, const FileProgressed &progressed, const FileFinished &finished) {
+	if (path == nullptr || isFileBusy())
+		return false;
+
+	_fileTask = std::make_shared<FileTask>();
+	FileTask &task = *_fileTask;
+	task.loading = false;
+	task.path = path;
+	task.newLine = newLine != nullptr ? newLine : _newLine;
+	task.encoding = _textEncoding;
+	task.snapshot = getSnapshot();
+	task.version = _version;
+	task.progressed = progressed;
+	task.finished = finished;
+	task.job = _taskPool->post(std::bind(&FileTask::save, &task), TaskPool::Priority::High);
+
+	return true;
+}
+
+bool CodeEdit::isFileBusy(void) const {
+	return !!_fileTask;
+}
+
+void CodeEdit::cancelFile(void) {
+	if (!_fileTask)
+		return;
+
+	std::shared_ptr<FileTask> task = _fileTask;
+	_fileTask = nullptr;
+	task->canceled = true;
+	TaskPool::wait(task->job);
+
+	// A save may have finished already.
+	if (!task->loading && task->result == FileResult::Succeeded && task->version == _version)
+		setChangesSaved();
+	if (task->finished)
+		task->finished(task->loading ? FileResult::Canceled : task->result);
+}
+
+std::shared_ptr<CodeEdit::TaskPool> CodeEdit::createTaskPool(int threads) {
+	if (threads <= 0)
+		threads = std::max((int)std::thread::hardware_concurrency(), 1);
+
+	return std::make_shared<TaskPool>(threads);
+}
+
+const std::shared_ptr<CodeEdit::TaskPool> &CodeEdit::getTaskPool(void) const {
+	return _taskPool;
+}
+
+void CodeEdit::setTaskPool(const std::shared_ptr<CodeEdit::TaskPool> &pool) {
+	_taskPool = pool ? pool : getDefaultTaskPool();
+	_symbolIndex->pool = _taskPool;
+}
+
+void CodeEdit::insertText(const char* val) {
+	if (val == nullptr)
+		return;
+
+	const Coordinates at = getActualCursorCoordinates();
+	insertTextAtCursor(val);
+	recordChange(at, at, val); // Not undoable, but a change still.
+	if (_foldTree->size() > 0)
+		validateFolds(at.line, getActualCursorCoordinates().line);
+}
+
+void CodeEdit::insertTextAtCursor(const char* val) {
+	Coordinates pos = getActualCursorCoordinates();
+	Coordinates start = std::min(pos, _state.selectionStart);
+	int totalLines = pos.line - start.line;
+
+	totalLines += insertTextAt(pos, val);
+
+	setSelection(pos, pos);
+	setCursorPosition(pos);
+	colorize(start.line - 1, totalLines + 2);
+}
+
+int CodeEdit::getTotalLines(void) const {
+	return (int)_codeLines.size();
+}
+
+int CodeEdit::getColumnsAt(int ln) const {
+	if (ln < 0 || ln >= (int)_codeLines.size())
+		return 0;
+
+	const Line &l = _codeLines[ln];
+
+	return (int)l.size();
+}
+
+CodeEdit::Coordinates CodeEdit::getCursorPosition(void) const {
+	return getActualCursorCoordinates();
+}
+
+void CodeEdit::setCursorPosition(const Coordinates &pos) {
+	if (_state.cursorPosition != pos) {
+		_state.cursorPosition = pos;
+		ensureCursorVisible();
+	}
+}
+
+void CodeEdit::ensureCursorVisible(bool force) {
+	if (!_withinRender) {
+		_scrollToCursor = force ? -1 : 1;
+
+		return;
+	}
+
+	float scrollX = getScrollX();
+	float scrollY = getScrollY();
+
+	float height = getWidgetSize().y;
+	float width = getWidgetSize().x;
+
+	int top = 1 + (int)ceil(scrollY / _charAdv.y);
+	int bottom = (int)ceil((scrollY + height) / _charAdv.y);
+
+	int left = (int)ceil(scrollX / _charAdv.x);
+	int right = (int)ceil((scrollX + width) / _charAdv.x);
+
+	Coordinates pos = getActualCursorCoordinates();
+	if (_foldTree->size() > 0) {
+		buildWrapRowTree();
+		if (_codeLines[pos.line].folded)
+			unfoldAt(pos.line); // Reveals the cursor.
+	}
+	int len = 0;
+	const int row = coordinatesToRow(pos, len);
+
+	const int bottomBorder = 1;
+	if (row < top || force)
+		setScrollY(std::max(0.0f, (row - 1) * _charAdv.y));
+	else if (row > bottom - bottomBorder)
+		setScrollY(std::max(0.0f, (row + bottomBorder) * _charAdv.y - height));
+	if (len < left)
+		setScrollX(std::max(0.0f, len * _charAdv.x));
+	else if (len > right - _textStart - 1)
+		setScrollX(std::max(0.0f, (len + _textStart + 1) * _charAdv.x - width));
+}
+
+std::string CodeEdit::getWordUnderCursor(void) const {
+	const Coordinates c = getCursorPosition();
+
+	return getWordAt(c);
+}
+
+void CodeEdit::setSelectionStart(const Coordinates &pos) {
+	_state.selectionStart = sanitizeCoordinates(pos);
+	if (_state.selectionStart > _state.selectionEnd)
+		std::swap(_state.selectionStart, _state.selectionEnd);
+}
+
+void CodeEdit::setSelectionEnd(const Coordinates &pos) {
+	_state.selectionEnd = sanitizeCoordinates(pos);
+	if (_state.selectionStart > _state.selectionEnd)
+		std::swap(_state.selectionStart, _state.selectionEnd);
+}
+
+void CodeEdit::setSelection(const Coordinates &start, const Coordinates &end, bool wordMode) {
+	_state.selectionStart = sanitizeCoordinates(start);
+	_state.selectionEnd = sanitizeCoordinates(end);
+	if (start > end)
+		std::swap(_state.selectionStart, _state.selectionEnd);
+
+	if (wordMode) {
+		_state.selectionStart = findWordStart(_state.selectionStart);
+		if (!isOnWordBoundary(_state.selectionEnd))
+			_state.selectionEnd = findWordEnd(findWordStart(_state.selectionEnd));
+	}
+}
+
+void CodeEdit::selectWordUnderCursor(void) {
+	Coordinates c = getCursorPosition();
+	setSelection(findWordStart(c), findWordEnd(c));
+}
+
+void CodeEdit::selectAll(void) {
+	setSelection(Coordinates(0, 0), Coordinates((int)_codeLines.size(), 0));
+}
+
+bool CodeEdit::hasSelection(void) const {
+	return _state.selectionEnd > _state.selectionStart;
+}
+
+void CodeEdit::getSelection(Coordinates &start, Coordinates &end) {
+	start = _state.selectionStart;
+	end = _state.selectionEnd;
+}
+
+std::string CodeEdit::getSelectionText(void) const {
+	return getText(_state.selectionStart, _state.selectionEnd);
+}
+
+int CodeEdit::getSelectionLines(void) const {
+	if (!hasSelection())
+		return 0;
+
+	return std::abs(_state.selectionEnd.line - _state.selectionStart.line) + 1;
+}
+
+bool CodeEdit::isUtf8SupportEnabled(void) const {
+	return _utf8SupportEnabled;
+}
+
+void CodeEdit::setUtf8SupportEnabled(bool val) {
+	_utf8SupportEnabled = val;
+}
+
+bool CodeEdit::isWordWrapEnabled(void) const {
+	return _wordWrapEnabled;
+}
+
+void CodeEdit::setWordWrapEnabled(bool val) {
+	if (_wordWrapEnabled == val)
+		return;
+
+	_wordWrapEnabled = val;
+	_wrapColumns = 0;
+	_wrapLayoutNext = -1;
+	_wrapRowTreeDirty = true;
+	if (!val) {
+		for (Line &line : _codeLines)
+			line.wraps.clear();
+	}
+}
+
+bool CodeEdit::isOverwrite(void) const {
+	return _overwrite;
+}
+
+void CodeEdit::setOverwrite(bool val) {
+	_overwrite = val;
+}
+
+bool CodeEdit::isReadonly(void) const {
+	return _readonly;
+}
+
+void CodeEdit::setReadonly(bool val) {
+	_readonly = val;
+}
+
+bool CodeEdit::isShortcutsEnabled(ShortcutType type) const {
+	return !!(_shortcutsEnabled & type);
+}
+
+void CodeEdit::enableShortcut(ShortcutType type) {
+	_shortcutsEnabled = (ShortcutType)(_shortcutsEnabled | type);
+}
+
+void CodeEdit::disableShortcut(ShortcutType type) {
+	_shortcutsEnabled = (ShortcutType)(_shortcutsEnabled & ~type);
+}
+
+bool CodeEdit::isTooltipEnabled(void) const {
+	return _tooltipEnabled;
+}
+
+void CodeEdit::setTooltipEnabled(bool en) {
+	_tooltipEnabled = en;
+}
+
+void CodeEdit::moveUp(int amount, bool select) {
+	Coordinates oldPos = _state.cursorPosition;
+	if (usesRowTree()) {
+		int distance = 0;
+		const int row = coordinatesToRow(getActualCursorCoordinates(), distance);
+		_state.cursorPosition = rowPosToCoordinates(std::max(0, row - amount), distance);
+	} else {
+		_state.cursorPosition.line = std::max(0, _state.cursorPosition.line - amount);
+	}
+	if (oldPos != _state.cursorPosition) {
+		if (select) {
+			if (oldPos == _interactiveStart) {
+				_interactiveStart = _state.cursorPosition;
+			} else if (oldPos == _interactiveEnd) {
+				_interactiveEnd = _state.cursorPosition;
+			} else {
+				_interactiveStart = _state.cursorPosition;
+				_interactiveEnd = oldPos;
+			}
+		} else {
+			_interactiveStart = _interactiveEnd = _state.cursorPosition;
+		}
+		setSelection(_interactiveStart, _interactiveEnd);
+
+		ensureCursorVisible();
+	}
+}
+
+void CodeEdit::moveDown(int amount, bool select) {
+	assert(_state.cursorPosition.column >= 0);
+	Coordinates oldPos = _state.cursorPosition;
+	if (usesRowTree()) {
+		int distance = 0;
+		const int row = coordinatesToRow(getActualCursorCoordinates(), distance);
+		_state.cursorPosition = rowPosToCoordinates(std::max(0, std::min(getTotalRows() - 1, row + amount)), distance);
+	} else {
+		_state.cursorPosition.line = std::max(0, std::min((int)_codeLines.size() - 1, _state.cursorPosition.line + amount));
+	}
+
+	if (_state.cursorPosition != oldPos) {
+		if (select) {
+			if (oldPos == _interactiveEnd) {
+				_interactiveEnd = _state.cursorPosition;
+			} else if (oldPos == _interactiveStart) {
+				_interactiveStart = _state.cursorPosition;
+			} else {
+				_interactiveStart = oldPos;
+				_interactiveEnd = _state.cursorPosition;
+			}
+		} else {
+			_interactiveStart = _interactiveEnd = _state.cursorPosition;
+		}
+		setSelection(_interactiveStart, _interactiveEnd);
+
+		ensureCursorVisible();
+	}
+}
+
+void CodeEdit::moveLeft(int amount, bool select, bool wordMode) {
+	if (_codeLines.empty())
+		return;
+
+	Coordinates oldPos = _state.cursorPosition;
+	_state.cursorPosition = getActualCursorCoordinates();
+
+	while (amount-- > 0) {
+		if (_state.cursorPosition.column == 0) {
+			if (_state.cursorPosition.line > 0) {
+				--_state.cursorPosition.line;
+				_state.cursorPosition.column = (int)_codeLines[_state.cursorPosition.line].size();
+			}
+		} else {
+			_state.cursorPosition.column = std::max(0, _state.cursorPosition.column - 1);
+			if (wordMode)
+				_state.cursorPosition = findWordStart(_state.cursorPosition);
+		}
+	}
+
+	assert(_state.cursorPosition.column >= 0);
+	if (select) {
+		if (oldPos == _interactiveStart) {
+			_interactiveStart = _state.cursorPosition;
+		} else if (oldPos == _interactiveEnd) {
+			_interactiveEnd = _state.cursorPosition;
+		} else {
+			_interactiveStart = _state.cursorPosition;
+			_interactiveEnd = oldPos;
+		}
+	} else {
+		_interactiveStart = _interactiveEnd = _state.cursorPosition;
+	}
+	setSelection(_interactiveStart, _interactiveEnd, select && wordMode);
+
+	ensureCursorVisible();
+}
+
+void CodeEdit::moveRight(int amount, bool select, bool wordMode) {
+	Coordinates oldPos = _state.cursorPosition;
+
+	if (_codeLines.empty())
+		return;
+
+	while (amount-- > 0) {
+		const Line &line = _codeLines[_state.cursorPosition.line];
+		if (_state.cursorPosition.column >= (int)line.size()) {
+			if (_state.cursorPosition.line < (int)_codeLines.size() - 1) {
+				_state.cursorPosition.line = std::max(0, std::min((int)_codeLines.size() - 1, _state.cursorPosition.line + 1));
+				_state.cursorPosition.column = 0;
+			}
+		} else {
+			_state.cursorPosition.column = std::max(0, std::min((int)line.size(), _state.cursorPosition.column + 1));
+			if (wordMode)
+				_state.cursorPosition = findWordEnd(_state.cursorPosition);
+		}
+	}
+
+	if (select) {
+		if (oldPos == _interactiveEnd) {
+			_interactiveEnd = sanitizeCoordinates(_state.cursorPosition);
+		} else if (oldPos == _interactiveStart) {
+			_interactiveStart = _state.cursorPosition;
+		} else {
+			_interactiveStart = oldPos;
+			_interactiveEnd = _state.cursorPosition;
+		}
+	} else {
+		_interactiveStart = _interactiveEnd = _state.cursorPosition;
+	}
+	setSelection(_interactiveStart, _interactiveEnd, select && wordMode);
+
+	ensureCursorVisible();
+}
+
+void CodeEdit::moveTop(bool select) {
+	Coordinates oldPos = _state.cursorPosition;
+	setCursorPosition(Coordinates(0, 0));
+
+	if (_state.cursorPosition != oldPos) {
+		if (select) {
+			_interactiveEnd = oldPos;
+			_interactiveStart = _state.cursorPosition;
+		} else {
+			_interactiveStart = _interactiveEnd = _state.cursorPosition;
+		}
+		setSelection(_interactiveStart, _interactiveEnd);
+	}
+}
+
+void CodeEdit::CodeEdit::moveBottom(bool select) {
+	Coordinates oldPos = getCursorPosition();
+	Coordinates newPos((int)_codeLines.size() - 1, (int)_codeLines.back().size());
+	setCursorPosition(newPos);
+	if (select) {
+		_interactiveStart = oldPos;
+		_interactiveEnd = newPos;
+	} else {
+		_interactiveStart = _interactiveEnd = newPos;
+	}
+	setSelection(_interactiveStart, _interactiveEnd);
+}
+
+void CodeEdit::moveHome(bool select) {
+	Coordinates oldPos = _state.cursorPosition;
+	setCursorPosition(Coordinates(_state.cursorPosition.line, 0));
+
+	if (_state.cursorPosition != oldPos) {
+		if (select) {
+			if (oldPos == _interactiveStart) {
+				_interactiveStart = _state.cursorPosition;
+			} else if (oldPos == _interactiveEnd) {
+				_interactiveEnd = _state.cursorPosition;
+			} else {
+				_interactiveStart = _state.cursorPosition;
+				_interactiveEnd = oldPos;
+			}
+		} else {
+			_interactiveStart = _interactiveEnd = _state.cursorPosition;
+		}
+		setSelection(_interactiveStart, _interactiveEnd);
+	}
+}
+
+void CodeEdit::moveEnd(bool select) {
+	Coordinates oldPos = _state.cursorPosition;
+	setCursorPosition(Coordinates(_state.cursorPosition.line, (int)_codeLines[oldPos.line].size()));
+
+	if (_state.cursorPosition != oldPos) {
+		if (select) {
+			if (oldPos == _interactiveEnd) {
+				_interactiveEnd = _state.cursorPosition;
+			} else if (oldPos == _interactiveStart) {
+				_interactiveStart = _state.cursorPosition;
+			} else {
+				_interactiveStart = oldPos;
+				_interactiveEnd = _state.cursorPosition;
+			}
+		} else {
+			_interactiveStart = _interactiveEnd = _state.cursorPosition;
+		}
+		setSelection(_interactiveStart, _interactiveEnd);
+	}
+}
+
+void CodeEdit::copy(void) {
+	if (hasSelection()) {
+		SDL_SetClipboardText(getSelectionText().c_str());
+	} else {
+		if (!_codeLines.empty()) {
+			std::string str;
+			appendGlyphsToStdStr(str, _codeLines[getActualCursorCoordinates().line]);
+			SDL_SetClipboardText(str.c_str());
+		}
+	}
+}
+
+void CodeEdit::cut(void) {
+	if (isReadonly()) {
+		copy();
+	} else {
+		if (hasSelection()) {
+			UndoRecord u;
+			u.type = UndoType::Remove;
+			u.before = _state;
+
+			u.content = getSelectionText();
+			u.start = _state.selectionStart;
+			u.end = _state.selectionEnd;
+
+			copy();
+			removeSelection();
+
+			u.after = _state;
+			addUndo(u);
+
+			onModified();
+
+			Coordinates pos = u.start < u.end ? u.start : u.end;
+			onChanged(pos, pos, 0);
+		}
+	}
+}
+
+void CodeEdit::paste(void) {
+	const char* const clipText = SDL_GetClipboardText();
+	if (clipText != nullptr && strlen(clipText) > 0) {
+		UndoRecord u;
+		u.type = UndoType::Add;
+		u.before = _state;
 
-				break;
-			case LineState::Edited:
-				boxColor(
-					renderer,
-					(Sint16)(lineStartScreenPos.x + scrollX + _charAdv.x * (_textStart - 1)), (Sint16)lineStartScreenPos.y,
-					(Sint16)(lineStartScreenPos.x + scrollX + _charAdv.x * (_textStart - 1) + _charAdv.x * 0.5f), (Sint16)(lineStartScreenPos.y + _charAdv.y - heightOffset),
-					_palette[(int)PaletteIndex::LineEdited]
-				);
+		if (hasSelection()) {
+			u.overwritten = getSelectionText();
+			removeSelection();
+		}
 
-				break;
-			case LineState::EditedSaved:
-				boxColor(
-					renderer,
-					(Sint16)(lineStartScreenPos.x + scrollX + _charAdv.x * (_textStart - 1)), (Sint16)lineStartScreenPos.y,
-					(Sint16)(lineStartScreenPos.x + scrollX + _charAdv.x * (_textStart - 1) + _charAdv.x * 0.5f), (Sint16)(lineStartScreenPos.y + _charAdv.y - heightOffset),
-					_palette[(int)PaletteIndex::LineEditedSaved]
-				);
+		u.content = clipText;
+		u.start = getActualCursorCoordinates();
 
-				break;
-			case LineState::EditedReverted:
-				boxColor(
-					renderer,
-					(Sint16)(lineStartScreenPos.x + scrollX + _charAdv.x * (_textStart - 1)), (Sint16)lineStartScreenPos.y,
-					(Sint16)(lineStartScreenPos.x + scrollX + _charAdv.x * (_textStart - 1) + _charAdv.x * 0.5f), (Sint16)(lineStartScreenPos.y + _charAdv.y - heightOffset),
-					_palette[(int)PaletteIndex::LineEditedReverted]
-				);
+		insertTextAtCursor(clipText);
 
-				break;
-			}
+		u.end = getActualCursorCoordinates();
+		u.after = _state;
+		addUndo(u);
 
-			if (_state.cursorPosition.line == lineNo) {
-				const bool focused = isWidgetFocused();
+		onModified();
 
-				if (!hasSelection()) {
-					const Vec2 end(start.x + contentSize.x, start.y + _charAdv.y - heightOffset);
-					boxColor(renderer, (Sint16)start.x, (Sint16)start.y, (Sint16)end.x, (Sint16)end.y, _palette[(int)(focused ? PaletteIndex::CurrentLineFill : PaletteIndex::CurrentLineFillInactive)]);
-					rectangleColor(renderer, (Sint16)start.x, (Sint16)start.y, (Sint16)end.x, (Sint16)end.y + 1, _palette[(int)PaletteIndex::CurrentLineEdge]);
-				}
+		onChanged(u.start, u.end, 0);
+	}
+}
 
-				const int cx = textDistanceToLineStart(_state.cursorPosition);
+void CodeEdit::remove(void) {
+	assert(!_readonly);
 
-				if (focused) {
-					static auto timeStart = std::chrono::system_clock::now(); // Shared.
-					auto timeEnd = std::chrono::system_clock::now();
-					auto diff = timeEnd - timeStart;
-					const long long elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(diff).count();
-					const Vec2 cstart(lineStartScreenPos.x + _charAdv.x * (cx + _textStart), lineStartScreenPos.y);
-					if (elapsed > 400) {
-						Clipper clipCode(renderer, rectCode);
+	if (_codeLines.empty())
+		return;
 
-						const Vec2 cend(lineStartScreenPos.x + _charAdv.x * (cx + _textStart) + (_overwrite ? _charAdv.x : 1.0f), lineStartScreenPos.y + _charAdv.y - heightOffset);
-						boxColor(renderer, (Sint16)cstart.x, (Sint16)cstart.y, (Sint16)cend.x, (Sint16)cend.y, _palette[(int)PaletteIndex::Cursor]);
-						if (elapsed > 800)
-							timeStart = timeEnd;
-					}
-				}
-			}
+	UndoRecord u;
+	u.type = UndoType::Remove;
+	u.before = _state;
 
-			appendIndex = 0;
-			PaletteIndex prevColor = line.empty() ? PaletteIndex::Default : (line[0].multiLineComment ? PaletteIndex::MultiLineComment : line[0].colorIndex);
+	if (hasSelection()) {
+		u.content = getSelectionText();
+		u.start = _state.selectionStart;
+		u.end = _state.selectionEnd;
+		removeSelection();
 
-			Clipper clipCode(renderer, rectCode);
+		Coordinates pos = _state.selectionStart < _state.selectionEnd ? _state.selectionStart : _state.selectionEnd;
+		onChanged(pos, pos, 0);
+	} else {
+		Coordinates pos = getActualCursorCoordinates();
+		setCursorPosition(pos);
+		Line &line = _codeLines[pos.line];
 
-			int width = 0;
-			for (const Glyph &glyph : line) {
-				const PaletteIndex color = glyph.multiLineComment ? PaletteIndex::MultiLineComment : glyph.colorIndex;
+		if (pos.column == (int)line.size()) {
+			if (pos.line == (int)_codeLines.size() - 1)
+				return;
 
-				if (color != prevColor && !buffer.empty()) {
-					stringColor(renderer, (Sint16)textScreenPos.x, (Sint16)textScreenPos.y, buffer.c_str(), _palette[(uint8_t)prevColor]);
-					textScreenPos.x += _charAdv.x * width;
-					buffer.clear();
-					prevColor = color;
-					width = 0;
-				}
-				appendIndex = appendBuffer(buffer, glyph, appendIndex, width);
-				++columnNo;
-			}
+			u.content = '\n';
+			u.start = u.end = getActualCursorCoordinates();
+			advance(u.end);
 
-			if (!buffer.empty()) {
-				stringColor(renderer, (Sint16)textScreenPos.x, (Sint16)textScreenPos.y, buffer.c_str(), _palette[(uint8_t)prevColor]);
-				buffer.clear();
-			}
-			appendIndex = 0;
-			lineStartScreenPos.y += _charAdv.y;
-			textScreenPos.x = lineStartScreenPos.x + _charAdv.x * _textStart;
-			textScreenPos.y = lineStartScreenPos.y;
-			++lineNo;
-		}
+			const Line &nextLine = _codeLines[pos.line + 1];
+			line.insert(line.end(), nextLine.begin(), nextLine.end());
+			removeLine(pos.line + 1);
+		} else {
+			u.content.clear();
+			appendUtf8ToStdStr(u.content, line[pos.column].character);
+			u.start = u.end = getActualCursorCoordinates();
+			u.end.column++;
 
-		if (_tooltipEnabled) {
-			//std::string id = getWordAt(screenPosToCoordinates(getMousePos()));
-			//if (!id.empty()) {
-			//	auto it = _langDef.ids.find(id);
-			//	if (it != _langDef.ids.end() && !it->second.declaration.empty()) {
-			//		ImGui::BeginTooltip();
-			//		ImGui::TextUnformatted(it->second.declaration.c_str());
-			//		ImGui::EndTooltip();
-			//	} else {
-			//		auto pi = _langDef.preprocIds.find(id);
-			//		if (pi != _langDef.preprocIds.end() && !pi->second.declaration.empty()) {
-			//			ImGui::BeginTooltip();
-			//			ImGui::TextUnformatted(pi->second.declaration.c_str());
-			//			ImGui::EndTooltip();
-			//		}
-			//	}
-			//}
+			line.erase(line.begin() + pos.column);
 		}
-	}
 
-	_contentSize = Vec2((longest + 1) * _charAdv.x, _codeLines.size() * _charAdv.y);
-	if (_scrollX > _contentSize.x - _widgetSize.x)
-		_scrollX = std::max(_contentSize.x - _widgetSize.x, 0.0f);
+		colorize(pos.line, 1);
 
-	if (_scrollToCursor) {
-		ensureCursorVisible(_scrollToCursor == -1);
-		_widgetFocused = true;
-		_scrollToCursor = 0;
+		onChanged(pos, pos, 0);
 	}
 
-	_withinRender = false;
-}
+	u.after = _state;
+	addUndo(u);
 
-void CodeEdit::setKeyPressedHandler(const KeyPressed &handler) {
-	_keyPressedHandler = handler;
+	onModified();
 }
 
-void CodeEdit::setColorizedHandler(const Colorized &handler) {
-	_colorizedHandler = handler;
-}
+void CodeEdit::indent(void) {
+	if (isReadonly())
+		return;
 
-void CodeEdit::setModifiedHandler(const Modified &handler) {
-	_modifiedHandler = handler;
-}
+	if (hasSelection() && getSelectionLines() > 1) {
+		UndoRecord u;
+		u.type = UndoType::indent;
+		u.before = _state;
 
-void CodeEdit::setMouseCursorChangedHandler(const MouseCursorChanged &handler) {
-	_mouseCursorChangedHandler = handler;
-}
+		u.start = _state.selectionStart;
+		u.end = _state.selectionEnd;
 
-void CodeEdit::setChangesCleared(void) {
-	for (Line &line : _codeLines) {
-		if (line.changed == LineState::Edited || line.changed == LineState::EditedSaved || line.changed == LineState::EditedReverted)
-			line.clear();
-	}
-}
+		for (int i = u.start.line; i <= u.end.line; ++i) {
+			Line &line = _codeLines[i];
+			if (line.empty()) {
+				u.content.push_back(0);
 
-void CodeEdit::setChangesSaved(void) {
-	_savedIndex = _undoIndex;
+				continue;
+			}
+			line.insert(line.begin(), Glyph('\t', PaletteIndex::Default));
+			u.content.push_back(std::numeric_limits<char>::max());
 
-	for (Line &line : _codeLines) {
-		if (line.changed == LineState::Edited || line.changed == LineState::EditedReverted)
-			line.save();
+			Coordinates pos(i, 0);
+			onChanged(pos, pos, 0);
+		}
+
+		_state.selectionEnd.column = (int)_codeLines[_state.selectionEnd.line].size();
+
+		u.after = _state;
+		addUndo(u);
+
+		onModified();
 	}
 }
 
-bool CodeEdit::isChangesSaved(void) const {
-	return _savedIndex == _undoIndex;
-}
+void CodeEdit::unindent(void) {
+	if (isReadonly())
+		return;
+
+	if (hasSelection() && getSelectionLines() > 1) {
+		UndoRecord u;
+		u.type = UndoType::unindent;
+		u.before = _state;
+
+		u.start = _state.selectionStart;
+		u.end = _state.selectionEnd;
+
+		int affectedLines = 0;
+		for (int i = u.start.line; i <= u.end.line; ++i) {
+			Line &line = _codeLines[i];
+			if (line.empty()) {
+				u.content.push_back(0);
 
-std::vector<std::string> CodeEdit::getTextLines(bool includeComment, bool includeString) const {
-	std::vector<std::string> result;
-	for (const Line &ln : _codeLines) {
-		result.push_back(std::string());
-		std::string &str = result.back();
-		for (const Glyph &g : ln) {
-			const bool multilinecomment =
-				g.colorIndex == PaletteIndex::Comment || g.colorIndex == PaletteIndex::MultiLineComment ||
-				ln[0].multiLineComment;
-			if (!includeComment && multilinecomment)
-				continue;
-			if (!includeString && (g.colorIndex == PaletteIndex::String))
 				continue;
+			}
 
-			appendUtf8ToStdStr(str, g.character);
-		}
-	}
+			const Glyph &g = *line.begin();
+			if (g.character == '\t') {
+				line.erase(line.begin());
+				u.content.push_back(std::numeric_limits<char>::max());
+				++affectedLines;
 
-	return result;
-}
+				Coordinates pos(i, 0);
+				onChanged(pos, pos, 0);
+			} else if (g.character == ' ') {
+				int k = 0;
+				for (int j = 0; j < _tabSize; ++j, ++k) {
+					if (line.empty())
+						break;
+					const Glyph &h = *line.begin();
+					if (h.character != ' ')
+						break;
+					line.erase(line.begin());
+				}
+				u.content.push_back((char)k);
+				if (k)
+					++affectedLines;
 
-std::string CodeEdit::getText(const char* newLine) const {
-	return getText(Coordinates(), Coordinates((int)_codeLines.size(), 0), newLine);
-}
+				Coordinates pos(i, 0);
+				onChanged(pos, pos, 0);
+			} else {
+				u.content.push_back(0);
+			}
+		}
+		if (affectedLines > 0) {
+			const Line &line = _codeLines[_state.selectionEnd.line];
+			if ((int)line.size() < _state.selectionEnd.column)
+				_state.selectionEnd.column = (int)line.size();
+		}
+
+		u.after = _state;
+		if (affectedLines > 0) {
+			addUndo(u);
 
-void CodeEdit::setText(const std::string &txt) {
-	_codeLines.clear();
-	char* str = (char*)txt.c_str();
-	while (str < (char*)txt.c_str() + txt.length()) {
-		int n = expectUtf8Char(str);
-		CodeEdit::Char c = takeUtf8Bytes(str, n);
-		if (_codeLines.empty())
-			_codeLines.push_back(Line());
-		if (c == '\n')
-			_codeLines.push_back(Line());
-		else
-			_codeLines.back().push_back(Glyph(c, PaletteIndex::Default));
-		str += n;
+			onModified();
+		}
 	}
-	if (_codeLines.empty())
-		_codeLines.push_back(Line());
+}
 
-	clearUndoRedoStack();
+void CodeEdit::clearUndoRedoStack(void) {
+	_undoBuf.clear();
+	_undoIndex = 0;
+	_savedIndex = 0;
+}
 
-	colorize();
+bool CodeEdit::canUndo(void) const {
+	return _undoIndex > 0;
 }
 
-void CodeEdit::insertText(const char* val) {
-	if (val == nullptr)
-		return;
+bool CodeEdit::canRedo(void) const {
+	return _undoIndex < (int)_undoBuf.size();
+}
 
-	Coordinates pos = getActualCursorCoordinates();
-	Coordinates start = std::min(pos, _state.selectionStart);
-	int totalLines = pos.line - start.line;
+void CodeEdit::undo(int steps) {
+#if CODE_EDIT_MERGE_UNDO_REDO
+	if (steps == 1) {
+		UndoRecord r;
+		UndoRecord* p = nullptr;
+		while (canUndo() && (!p || _undoBuf[_undoIndex - 1].similar(p))) {
+			if (p == nullptr) {
+				p = &r;
+				*p = _undoBuf[_undoIndex - 1];
+			}
+			_undoBuf[--_undoIndex].undo(this);
+		}
 
-	totalLines += insertTextAt(pos, val);
+		return;
+	}
+#endif /* CODE_EDIT_MERGE_UNDO_REDO */
 
-	setSelection(pos, pos);
-	setCursorPosition(pos);
-	colorize(start.line - 1, totalLines + 2);
+	while (canUndo() && steps-- > 0) {
+		_undoBuf[--_undoIndex].undo(this);
+	}
 }
 
-int CodeEdit::getTotalLines(void) const {
-	return (int)_codeLines.size();
-}
+void CodeEdit::redo(int steps) {
+#if CODE_EDIT_MERGE_UNDO_REDO
+	if (steps == 1) {
+		UndoRecord r;
+		UndoRecord* p = nullptr;
+		while (canRedo() && (!p || (_undoIndex + 1 <= (int)_undoBuf.size() && _undoBuf[_undoIndex].similar(p)))) {
+			if (p == nullptr && _undoIndex + 1 < (int)_undoBuf.size()) {
+				p = &r;
+				*p = _undoBuf[_undoIndex + 1];
+			}
+			_undoBuf[_undoIndex++].redo(this);
+		}
 
-int CodeEdit::getColumnsAt(int ln) const {
-	if (ln < 0 || ln >= (int)_codeLines.size())
-		return 0;
+		return;
+	}
+#endif /* CODE_EDIT_MERGE_UNDO_REDO */
 
-	const Line &l = _codeLines[ln];
+	while (canRedo() && steps-- > 0) {
+		_undoBuf[_undoIndex++].redo(this);
+	}
+}
 
-	return (int)l.size();
+const CodeEdit::Vec2 &CodeEdit::getWidgetPos(void) const {
+	return _widgetPos;
 }
 
-CodeEdit::Coordinates CodeEdit::getCursorPosition(void) const {
-	return getActualCursorCoordinates();
+void CodeEdit::setWidgetPos(const Vec2 &pos) {
+	_widgetPos = pos;
 }
 
-void CodeEdit::setCursorPosition(const Coordinates &pos) {
-	if (_state.cursorPosition != pos) {
-		_state.cursorPosition = pos;
-		ensureCursorVisible();
-	}
+const CodeEdit::Vec2 &CodeEdit::getWidgetSize(void) const {
+	return _widgetSize;
 }
 
-void CodeEdit::ensureCursorVisible(bool force) {
-	if (!_withinRender) {
-		_scrollToCursor = force ? -1 : 1;
+void CodeEdit::setWidgetSize(const Vec2 &sz) {
+	_widgetSize = sz;
+}
 
-		return;
-	}
+bool CodeEdit::isWidgetFocused(void) const {
+	return _widgetFocused;
+}
 
-	float scrollX = getScrollX();
-	float scrollY = getScrollY();
+void CodeEdit::setWidgetFocused(bool val) {
+	_widgetFocused = val;
+}
 
-	float height = getWidgetSize().y;
-	float width = getWidgetSize().x;
+bool CodeEdit::isWidgetHovered(void) const {
+	if (!_widgetHoverable)
+		return false;
 
-	int top = 1 + (int)ceil(scrollY / _charAdv.y);
-	int bottom = (int)ceil((scrollY + height) / _charAdv.y);
+	const Vec2 &mpos = getMousePos();
+	const Vec2 &wpos = getWidgetPos();
+	const Vec2 &wsz = getWidgetSize();
 
-	int left = (int)ceil(scrollX / _charAdv.x);
-	int right = (int)ceil((scrollX + width) / _charAdv.x);
+	return (mpos.x > wpos.x && mpos.x <= wpos.x + wsz.x) && (mpos.y > wpos.y && mpos.y <= wpos.y + wsz.y);
+}
 
-	Coordinates pos = getActualCursorCoordinates();
-	int len = textDistanceToLineStart(pos);
+void CodeEdit::setWidgetHoverable(bool val) {
+	_widgetHoverable = val;
+}
 
-	const int bottomBorder = 1;
-	if (pos.line < top || force)
-		setScrollY(std::max(0.0f, (pos.line - 1) * _charAdv.y));
-	else if (pos.line > bottom - bottomBorder)
-		setScrollY(std::max(0.0f, (pos.line + bottomBorder) * _charAdv.y - height));
-	if (len < left)
-		setScrollX(std::max(0.0f, len * _charAdv.x));
-	else if (len > right - _textStart - 1)
-		setScrollX(std::max(0.0f, (len + _textStart + 1) * _charAdv.x - width));
+const CodeEdit::Vec2 &CodeEdit::getContentSize(void) const {
+	return _contentSize;
 }
 
-std::string CodeEdit::getWordUnderCursor(void) const {
-	const Coordinates c = getCursorPosition();
+float CodeEdit::getScrollX(void) const {
+	return _scrollX;
+}
 
-	return getWordAt(c);
+void CodeEdit::setScrollX(float val) {
+	_scrollX = std::max(val, 0.0f);
 }
 
-void CodeEdit::setSelectionStart(const Coordinates &pos) {
-	_state.selectionStart = sanitizeCoordinates(pos);
-	if (_state.selectionStart > _state.selectionEnd)
-		std::swap(_state.selectionStart, _state.selectionEnd);
+float CodeEdit::getScrollY(void) const {
+	return _scrollY;
 }
 
-void CodeEdit::setSelectionEnd(const Coordinates &pos) {
-	_state.selectionEnd = sanitizeCoordinates(pos);
-	if (_state.selectionStart > _state.selectionEnd)
-		std::swap(_state.selectionStart, _state.selectionEnd);
+void CodeEdit::setScrollY(float val) {
+	_scrollY = std::max(val, 0.0f);
 }
 
-void CodeEdit::setSelection(const Coordinates &start, const Coordinates &end, bool wordMode) {
-	_state.selectionStart = sanitizeCoordinates(start);
-	_state.selectionEnd = sanitizeCoordinates(end);
-	if (start > end)
-		std::swap(_state.selectionStart, _state.selectionEnd);
+unsigned CodeEdit::getFrameCount(void) const {
+	return _frameCount;
+}
 
-	if (wordMode) {
-		_state.selectionStart = findWordStart(_state.selectionStart);
-		if (!isOnWordBoundary(_state.selectionEnd))
-			_state.selectionEnd = findWordEnd(findWordStart(_state.selectionEnd));
-	}
+void CodeEdit::setFrameCount(unsigned val) {
+	_frameCount = val;
 }
 
-void CodeEdit::selectWordUnderCursor(void) {
-	Coordinates c = getCursorPosition();
-	setSelection(findWordStart(c), findWordEnd(c));
+void CodeEdit::addInputCharacter(CodeEdit::CodePoint cp) {
+	_inputCharacters.push_back(cp);
 }
 
-void CodeEdit::selectAll(void) {
-	setSelection(Coordinates(0, 0), Coordinates((int)_codeLines.size(), 0));
+void CodeEdit::addInputCharactersUtf8(const char* utf8Chars) {
+	CodeEdit::CodePoint wchars[17];
+	strFromUtf8(wchars, countof(wchars), utf8Chars, nullptr);
+	for (int i = 0; i < countof(wchars) && wchars[i] != 0; i++)
+		addInputCharacter(wchars[i]);
 }
 
-bool CodeEdit::hasSelection(void) const {
-	return _state.selectionEnd > _state.selectionStart;
+bool CodeEdit::isKeyShiftDown(void) const {
+	return _keyShift;
 }
 
-void CodeEdit::getSelection(Coordinates &start, Coordinates &end) {
-	start = _state.selectionStart;
-	end = _state.selectionEnd;
+bool CodeEdit::isKeyCtrlDown(void) const {
+	return _keyCtrl;
 }
 
-std::string CodeEdit::getSelectionText(void) const {
-	return getText(_state.selectionStart, _state.selectionEnd);
+bool CodeEdit::isKeyAltDown(void) const {
+	return _keyAlt;
 }
 
-int CodeEdit::getSelectionLines(void) const {
-	if (!hasSelection())
-		return 0;
+bool CodeEdit::isKeyDown(Keycode kbkey) const {
+	const SDL_Keycode kc = kbkey;
+	const SDL_Scancode scancode = SDL_GetScancodeFromKey(kc);
+	if (scancode < 0 || scancode >= (SDL_Scancode)_keyStates1.size())
+		return false;
 
-	return std::abs(_state.selectionEnd.line - _state.selectionStart.line) + 1;
+	return !!_keyStates1[scancode];
 }
 
-bool CodeEdit::isUtf8SupportEnabled(void) const {
-	return _utf8SupportEnabled;
-}
+bool CodeEdit::isKeyPressed(Keycode kbkey) const {
+	bool result = true;
+	int n = 0;
+	const SDL_Keycode kc = kbkey;
+	const SDL_Scancode scancode = SDL_GetScancodeFromKey(kc);
 
-void CodeEdit::setUtf8SupportEnabled(bool val) {
-	_utf8SupportEnabled = val;
-}
+	do {
+		if (scancode < 0 || scancode >= (SDL_Scancode)_keyStates0.size()) {
+			result = false;
+			break;
+		}
 
-bool CodeEdit::isOverwrite(void) const {
-	return _overwrite;
+		if (_keyStates0[scancode]) {
+			++n;
+		} else {
+			result = false;
+			break;
+		}
+
+		if (scancode < 0 || scancode >= (SDL_Scancode)_keyStates1.size()) {
+			result = false;
+			break;
+		}
+
+		if (_keyStates1[scancode]) {
+			++n;
+			result = false;
+			break;
+		}
+	} while (false);
+
+	do {
+		if (_keyTimestamps.size() < _keyStates0.size())
+			_keyTimestamps.resize(_keyStates0.size());
+		if (scancode < 0 || scancode >= (SDL_Scancode)_keyStates0.size())
+			break;
+		if (result) {
+			_keyTimestamps[scancode] = 0;
+		} else if (!result && n == 2) {
+			const long long now = std::chrono::steady_clock::now().time_since_epoch().count();
+			if (_keyTimestamps[scancode] == 0)
+				_keyTimestamps[scancode] = now + 300000000; // Delays 0.3s for the first continuous event.
+			const long long diff = now - _keyTimestamps[scancode];
+			if (diff > 50000000) { // Repeats once per 0.05s.
+				_keyTimestamps[scancode] = now;
+				result = true;
+			}
+		}
+	} while (false);
+
+	return result;
 }
 
-void CodeEdit::setOverwrite(bool val) {
-	_overwrite = val;
-}
+void CodeEdit::updateKeyStates(void) {
+	int kc = 0;
+	const Uint8* kbdState = SDL_GetKeyboardState(&kc);
+	_keyStates0 = _keyStates1;
+	if ((int)_keyStates1.size() < kc)
+		_keyStates1.resize(kc, 0);
+	memcpy(&_keyStates1.front(), kbdState, kc);
 
-bool CodeEdit::isReadonly(void) const {
-	return _readonly;
+	const SDL_Keymod mod = SDL_GetModState();
+	_keyShift = !!(KMOD_SHIFT & mod);
+	_keyCtrl = !!(KMOD_CTRL & mod);
+	_keyAlt = !!(KMOD_ALT & mod);
 }
 
-void CodeEdit::setReadonly(bool val) {
-	_readonly = val;
+const CodeEdit::Vec2 &CodeEdit::getMousePos(void) const {
+	return _mousePos;
 }
 
-bool CodeEdit::isShortcutsEnabled(ShortcutType type) const {
-	return !!(_shortcutsEnabled & type);
+bool CodeEdit::isMousePressed(void) const {
+	return _mousePressed;
 }
 
-void CodeEdit::enableShortcut(ShortcutType type) {
-	_shortcutsEnabled = (ShortcutType)(_shortcutsEnabled | type);
+bool CodeEdit::isMouseDoubleClicked(void) const {
+	return _mouseClickCount == 2;
 }
 
-void CodeEdit::disableShortcut(ShortcutType type) {
-	_shortcutsEnabled = (ShortcutType)(_shortcutsEnabled & ~type);
+bool CodeEdit::isMouseDragging(void) const {
+	return _mouseDragged;
 }
 
-bool CodeEdit::isTooltipEnabled(void) const {
-	return _tooltipEnabled;
+bool CodeEdit::isMouseDown(void) const {
+	return _mouseDown;
 }
 
-void CodeEdit::setTooltipEnabled(bool en) {
-	_tooltipEnabled = en;
-}
+void CodeEdit::updateMouseStates(int mouseClickCount, const Vec4* frame, const Vec2* scale) {
+	if (!_mouseDragged)
+		_mouseClickCount = mouseClickCount;
 
-void CodeEdit::moveUp(int amount, bool select) {
-	Coordinates oldPos = _state.cursorPosition;
-	_state.cursorPosition.line = std::max(0, _state.cursorPosition.line - amount);
-	if (oldPos != _state.cursorPosition) {
-		if (select) {
-			if (oldPos == _interactiveStart) {
-				_interactiveStart = _state.cursorPosition;
-			} else if (oldPos == _interactiveEnd) {
-				_interactiveEnd = _state.cursorPosition;
-			} else {
-				_interactiveStart = _state.cursorPosition;
-				_interactiveEnd = oldPos;
-			}
+	const Vec2 mscale = scale ? *scale : Vec2(1, 1);
+	int tx = 0, ty = 0, tw = 0, th = 0;
+	int x_ = 0, y_ = 0;
+	int dispw = 0, disph = 0;
+	tx = (int)getWidgetPos().x;
+	ty = (int)getWidgetPos().y;
+	tw = (int)getWidgetSize().x;
+	th = (int)getWidgetSize().y;
+	dispw = tw;
+	disph = th;
+
+	auto clicked = [] (const Vec4* frame, const Vec2 &widgetPos, const Vec2 &widgetSz, const Vec2 &mscale, Vec2 &mousePos, Vec2 &mouseDownPos, bool &mouseDown, bool &mouseClicked, bool &mouseDragged, bool &widgetFocused, int x, int y) {
+		if (frame) {
+			x -= (int)frame->x;
+			y -= (int)frame->y;
+		}
+		mousePos.x = (float)x * mscale.x;
+		mousePos.y = (float)y * mscale.y;
+		if (!mouseDown) {
+			mouseDownPos = mousePos;
+			mouseClicked = true;
 		} else {
-			_interactiveStart = _interactiveEnd = _state.cursorPosition;
+			mouseDragged |= std::abs(mouseDownPos.x - mousePos.x) + std::abs(mouseDownPos.y - mousePos.y) > 8.0f;
+			mouseClicked = false;
 		}
-		setSelection(_interactiveStart, _interactiveEnd);
+		mouseDown = true;
 
-		ensureCursorVisible();
-	}
-}
+		widgetFocused = (mouseDownPos.x > widgetPos.x && mouseDownPos.x <= widgetPos.x + widgetSz.x) && (mouseDownPos.y > widgetPos.y && mouseDownPos.y <= widgetPos.y + widgetSz.y);
+	};
 
-void CodeEdit::moveDown(int amount, bool select) {
-	assert(_state.cursorPosition.column >= 0);
-	Coordinates oldPos = _state.cursorPosition;
-	_state.cursorPosition.line = std::max(0, std::min((int)_codeLines.size() - 1, _state.cursorPosition.line + amount));
+	const int n = SDL_GetNumTouchDevices();
+	for (int m = 0; m < n; ++m) {
+		SDL_TouchID tid = SDL_GetTouchDevice(m);
+		if (tid == 0)
+			continue;
+		const int f = SDL_GetNumTouchFingers(tid);
+		do {
+			if (f < 1) break;
+			SDL_Finger* finger = SDL_GetTouchFinger(tid, 0);
+			if (!finger) break;
 
-	if (_state.cursorPosition != oldPos) {
-		if (select) {
-			if (oldPos == _interactiveEnd) {
-				_interactiveEnd = _state.cursorPosition;
-			} else if (oldPos == _interactiveStart) {
-				_interactiveStart = _state.cursorPosition;
-			} else {
-				_interactiveStart = oldPos;
-				_interactiveEnd = _state.cursorPosition;
-			}
-		} else {
-			_interactiveStart = _interactiveEnd = _state.cursorPosition;
-		}
-		setSelection(_interactiveStart, _interactiveEnd);
+			x_ = (int)(finger->x * ((float)dispw - CODE_EDIT_EPSILON));
+			y_ = (int)(finger->y * ((float)disph - CODE_EDIT_EPSILON));
 
-		ensureCursorVisible();
-	}
-}
+			clicked(frame, getWidgetPos(), getWidgetSize(), mscale, _mousePos, _mouseDownPos, _mouseDown, _mousePressed, _mouseDragged, _widgetFocused, x_, y_);
 
-void CodeEdit::moveLeft(int amount, bool select, bool wordMode) {
-	if (_codeLines.empty())
-		return;
+			return;
+		} while (false);
+	}
 
-	Coordinates oldPos = _state.cursorPosition;
-	_state.cursorPosition = getActualCursorCoordinates();
+	Uint32 btns = SDL_GetMouseState(&x_, &y_);
+	if (!!(btns & SDL_BUTTON(SDL_BUTTON_LEFT))) {
+		clicked(frame, getWidgetPos(), getWidgetSize(), mscale, _mousePos, _mouseDownPos, _mouseDown, _mousePressed, _mouseDragged, _widgetFocused, x_, y_);
 
-	while (amount-- > 0) {
-		if (_state.cursorPosition.column == 0) {
-			if (_state.cursorPosition.line > 0) {
-				--_state.cursorPosition.line;
-				_state.cursorPosition.column = (int)_codeLines[_state.cursorPosition.line].size();
-			}
-		} else {
-			_state.cursorPosition.column = std::max(0, _state.cursorPosition.column - 1);
-			if (wordMode)
-				_state.cursorPosition = findWordStart(_state.cursorPosition);
-		}
+		return;
 	}
 
-	assert(_state.cursorPosition.column >= 0);
-	if (select) {
-		if (oldPos == _interactiveStart) {
-			_interactiveStart = _state.cursorPosition;
-		} else if (oldPos == _interactiveEnd) {
-			_interactiveEnd = _state.cursorPosition;
-		} else {
-			_interactiveStart = _state.cursorPosition;
-			_interactiveEnd = oldPos;
-		}
-	} else {
-		_interactiveStart = _interactiveEnd = _state.cursorPosition;
+	if (frame) {
+		x_ -= (int)frame->x;
+		y_ -= (int)frame->y;
 	}
-	setSelection(_interactiveStart, _interactiveEnd, select && wordMode);
+	_mousePos.x = (float)x_ * mscale.x;
+	_mousePos.y = (float)y_ * mscale.y;
 
-	ensureCursorVisible();
+	_mouseDown = false;
+	_mouseDragged = false;
+	_mousePressed = false;
 }
 
-void CodeEdit::moveRight(int amount, bool select, bool wordMode) {
-	Coordinates oldPos = _state.cursorPosition;
-
-	if (_codeLines.empty())
-		return;
+const CodeEdit::Palette &CodeEdit::DarkPalette(void) {
+	static Palette p = {
+		0xffffffff, // None.
+		0xffd69c56, // Keyword.
+		0xffa8ceb5, // Number.
+		0xff859dd6, // String.
+		0xff70a0e0, // CodeEdit::Char literal.
+		0xffb4b4b4, // Punctuation.
+		0xff409090, // Preprocessor.
+		0xffdadada, // Identifier.
+		0xffb0c94e, // Known identifier.
+		0xffc040a0, // Preproc identifier.
+		0xff4aa657, // Comment (single line).
+		0xff4aa657, // Comment (multi line).
+		0xff2C2C2C, // Background.
+		0xffe0e0e0, // Cursor.
+		0xffa06020, // Selection.
+		0x804d00ff, // ErrorMarker.
+		0x40f08000, // Breakpoint.
+		0xffaf912b, // Line number.
+		0x40000000, // Current line fill.
+		0x40808080, // Current line fill (inactive).
+		0x40a0a0a0, // Current line edge.
+		0xff84f2ef, // Line edited.
+		0xff307457, // Line edited saved.
+		0xfffa955f, // Line edited reverted.
+		0x60a0a0a0, // Matching bracket.
+		0x40c0c0c0, // Symbol occurrence.
+		0xff404040  // Completion background.
+	};
 
-	while (amount-- > 0) {
-		const Line &line = _codeLines[_state.cursorPosition.line];
-		if (_state.cursorPosition.column >= (int)line.size()) {
-			if (_state.cursorPosition.line < (int)_codeLines.size() - 1) {
-				_state.cursorPosition.line = std::max(0, std::min((int)_codeLines.size() - 1, _state.cursorPosition.line + 1));
-				_state.cursorPosition.column = 0;
-			}
-		} else {
-			_state.cursorPosition.column = std::max(0, std::min((int)line.size(), _state.cursorPosition.column + 1));
-			if (wordMode)
-				_state.cursorPosition = findWordEnd(_state.cursorPosition);
-		}
-	}
+	return p;
+}
 
-	if (select) {
-		if (oldPos == _interactiveEnd) {
-			_interactiveEnd = sanitizeCoordinates(_state.cursorPosition);
-		} else if (oldPos == _interactiveStart) {
-			_interactiveStart = _state.cursorPosition;
-		} else {
-			_interactiveStart = oldPos;
-			_interactiveEnd = _state.cursorPosition;
-		}
-	} else {
-		_interactiveStart = _interactiveEnd = _state.cursorPosition;
-	}
-	setSelection(_interactiveStart, _interactiveEnd, select && wordMode);
+const CodeEdit::Palette &CodeEdit::LightPalette(void) {
+	static Palette p = {
+		0xff000000, // None.
+		0xffff0c06, // Keyword.
+		0xff008000, // Number.
+		0xff2020a0, // String.
+		0xff304070, // CodeEdit::Char literal.
+		0xff000000, // Punctuation.
+		0xff409090, // Preprocessor.
+		0xff404040, // Identifier.
+		0xff606010, // Known identifier.
+		0xffc040a0, // Preproc identifier.
+		0xff205020, // Comment (single line).
+		0xff405020, // Comment (multi line).
+		0xffffffff, // Background.
+		0xff000000, // Cursor.
+		0xff600000, // Selection.
+		0xa00010ff, // ErrorMarker.
+		0x80f08000, // Breakpoint.
+		0xff505000, // Line number.
+		0x40000000, // Current line fill.
+		0x40808080, // Current line fill (inactive).
+		0x40000000, // Current line edge.
+		0xff84f2ef, // Line edited.
+		0xff307457, // Line edited saved.
+		0xfffa955f, // Line edited reverted.
+		0x40000000, // Matching bracket.
+		0x30000000, // Symbol occurrence.
+		0xfff0f0f0  // Completion background.
+	};
 
-	ensureCursorVisible();
+	return p;
 }
 
-void CodeEdit::moveTop(bool select) {
-	Coordinates oldPos = _state.cursorPosition;
-	setCursorPosition(Coordinates(0, 0));
+const CodeEdit::Palette &CodeEdit::RetroBluePalette(void) {
+	static Palette p = {
+		0xff00ffff, // None.
+		0xffffff00, // Keyword.
+		0xff00ff00, // Number.
+		0xff808000, // String.
+		0xff808000, // CodeEdit::Char literal.
+		0xffffffff, // Punctuation.
+		0xff008000, // Preprocessor.
+		0xff00ffff, // Identifier.
+		0xffffffff, // Known identifier.
+		0xffff00ff, // Preproc identifier.
+		0xff808080, // Comment (single line).
+		0xff404040, // Comment (multi line).
+		0xff800000, // Background.
+		0xff0080ff, // Cursor.
+		0xffffff00, // Selection.
+		0xa00000ff, // ErrorMarker.
+		0x80ff8000, // Breakpoint.
+		0xff808000, // Line number.
+		0x40000000, // Current line fill.
+		0x40808080, // Current line fill (inactive).
+		0x40000000, // Current line edge.
+		0xff84f2ef, // Line edited.
+		0xff307457, // Line edited saved.
+		0xfffa955f, // Line edited reverted.
+		0x80ffffff, // Matching bracket.
+		0x50ffffff, // Symbol occurrence.
+		0xffa00000  // Completion background.
+	};
 
-	if (_state.cursorPosition != oldPos) {
-		if (select) {
-			_interactiveEnd = oldPos;
-			_interactiveStart = _state.cursorPosition;
-		} else {
-			_interactiveStart = _interactiveEnd = _state.cursorPosition;
-		}
-		setSelection(_interactiveStart, _interactiveEnd);
-	}
+	return p;
 }
 
-void CodeEdit::CodeEdit::moveBottom(bool select) {
-	Coordinates oldPos = getCursorPosition();
-	Coordinates newPos((int)_codeLines.size() - 1, (int)_codeLines.back().size());
-	setCursorPosition(newPos);
-	if (select) {
-		_interactiveStart = oldPos;
-		_interactiveEnd = newPos;
-	} else {
-		_interactiveStart = _interactiveEnd = newPos;
+void CodeEdit::colorize(int fromLine, int lines) {
+	int toLine = lines == -1 ? (int)_codeLines.size() : std::min((int)_codeLines.size(), fromLine + lines);
+	for (int i = std::max(0, fromLine); i < toLine; ++i) {
+		Line &line = _codeLines[i];
+		line.colorized = false;
+		line.commentsChecked = false;
 	}
-	setSelection(_interactiveStart, _interactiveEnd);
+	_multilineCommentsChecked = std::min(_multilineCommentsChecked, std::max(0, fromLine));
+	_colorRangeMin = std::min(_colorRangeMin, fromLine);
+	_colorRangeMax = std::max(_colorRangeMax, toLine);
+	_colorRangeMin = std::max(0, _colorRangeMin);
+	_colorRangeMax = std::max(_colorRangeMin, _colorRangeMax);
+	_checkMultilineComments = getFrameCount() + COLORIZE_DELAY_FRAME_COUNT;
+	if (toLine - fromLine >= COLORIZE_PARALLEL_MIN_LINES)
+		startColorTask(_multilineCommentsChecked);
 }
 
-void CodeEdit::moveHome(bool select) {
-	Coordinates oldPos = _state.cursorPosition;
-	setCursorPosition(Coordinates(_state.cursorPosition.line, 0));
+void CodeEdit::colorizeRange(int fromLine, int toLine) {
+	if (_codeLines.empty() || fromLine >= toLine)
+		return;
 
-	if (_state.cursorPosition != oldPos) {
-		if (select) {
-			if (oldPos == _interactiveStart) {
-				_interactiveStart = _state.cursorPosition;
-			} else if (oldPos == _interactiveEnd) {
-				_interactiveEnd = _state.cursorPosition;
-			} else {
-				_interactiveStart = _state.cursorPosition;
-				_interactiveEnd = oldPos;
-			}
-		} else {
-			_interactiveStart = _interactiveEnd = _state.cursorPosition;
+	int endLine = std::max(0, std::min((int)_codeLines.size(), toLine));
+	if (_language->definition.tokenizer) {
+		// Continues from the state of the previous line, it will be corrected by
+		// the multi-line comment checking if it's not up to date.
+		uint8_t state = fromLine > 0 ? _codeLines[fromLine - 1].exitState : 0;
+		for (int i = fromLine; i < endLine; ++i) {
+			state = tokenizeLine(_codeLines[i], state);
+			reindexLine(i);
 		}
-		setSelection(_interactiveStart, _interactiveEnd);
+
+		return;
 	}
-}
 
-void CodeEdit::moveEnd(bool select) {
-	Coordinates oldPos = _state.cursorPosition;
-	setCursorPosition(Coordinates(_state.cursorPosition.line, (int)_codeLines[oldPos.line].size()));
+	std::string buffer;
+	for (int i = fromLine; i < endLine; ++i) {
+		bool preproc = false;
+		Line &line = _codeLines[i];
+		line.colorized = true;
+		line.minimapDrawn = false;
+		buffer.clear();
+		appendGlyphsToStdStr(buffer, line);
+		for (Glyph &g : line)
+			g.colorIndex = PaletteIndex::Default;
 
-	if (_state.cursorPosition != oldPos) {
-		if (select) {
-			if (oldPos == _interactiveEnd) {
-				_interactiveEnd = _state.cursorPosition;
-			} else if (oldPos == _interactiveStart) {
-				_interactiveStart = _state.cursorPosition;
-			} else {
-				_interactiveStart = oldPos;
-				_interactiveEnd = _state.cursorPosition;
-			}
-		} else {
-			_interactiveStart = _interactiveEnd = _state.cursorPosition;
-		}
-		setSelection(_interactiveStart, _interactiveEnd);
-	}
-}
+		std::match_results<std::string::const_iterator> results;
+		auto last = buffer.cend();
+		for (auto first = buffer.cbegin(); first != last; ++first) {
+			for (auto &p : _language->regexes) {
+				const std::regex_constants::match_flag_type flag = std::regex_constants::match_continuous;
+				if (std::regex_search<std::string::const_iterator>(first, last, results, p.first, flag)) {
+					auto v = *results.begin();
+					auto start = v.first - buffer.begin();
+					auto end = v.second - buffer.begin();
+					std::string id = buffer.substr(start, end - start);
+					PaletteIndex color = p.second;
+					if (color == PaletteIndex::Identifier) {
+						color = classifyIdentifier(_language->definition, id, preproc);
+					} else if (color == PaletteIndex::Preprocessor) {
+						preproc = true;
+					}
+					//for (int j = (int)start; j < (int)end; ++j)
+					//	line[j].colorIndex = color;
+					int k = 0;
+					for (int j = 0; j < (int)line.size(); ++j) {
+						Glyph &g = line[j];
+						if (k >= (int)start) {
+							g.colorIndex = color;
+						}
+						k += countUtf8Bytes(g.character);
+						if (k >= (int)end)
+							break;
+					}
+					first += end - start - 1;
 
-void CodeEdit::copy(void) {
-	if (hasSelection()) {
-		SDL_SetClipboardText(getSelectionText().c_str());
-	} else {
-		if (!_codeLines.empty()) {
-			std::string str;
-			const Line &line = _codeLines[getActualCursorCoordinates().line];
-			for (const Glyph &g : line) {
-				appendUtf8ToStdStr(str, g.character);
+					break;
+				}
 			}
-			SDL_SetClipboardText(str.c_str());
 		}
+		reindexLine(i);
 	}
 }
 
-void CodeEdit::cut(void) {
-	if (isReadonly()) {
-		copy();
-	} else {
-		if (hasSelection()) {
-			UndoRecord u;
-			u.type = UndoType::Remove;
-			u.before = _state;
-
-			u.content = getSelectionText();
-			u.start = _state.selectionStart;
-			u.end = _state.selectionEnd;
-
-			copy();
-			removeSelection();
+void CodeEdit::colorizeInternal(void) {
+	if (_codeLines.empty() || _colorTask)
+		return; // Left to the pool if it is on it.
 
-			u.after = _state;
-			addUndo(u);
+	if (_checkMultilineComments && (int)getFrameCount() > _checkMultilineComments) {
+		// Sweeps down from the first unchecked line, a slice per frame.
+		const int end = (int)_codeLines.size();
+		int ln = std::min(_multilineCommentsChecked, end);
+		uint8_t state = ln > 0 ? _codeLines[ln - 1].exitState : 0;
+		int budget = COLORIZE_COMMENT_GLYPHS_PER_FRAME;
+		for (; ln < end && budget > 0; ++ln) {
+			Line &line = _codeLines[ln];
+			if (!line.commentsChecked || line.enterState != state) {
+				checkMultilineComments(line, state);
+				reindexLine(ln);
+				budget -= (int)line.size();
+			}
+			--budget;
+			state = line.exitState;
+		}
+		_multilineCommentsChecked = ln;
 
-			onModified();
+		if (ln >= end) {
+			_checkMultilineComments = 0;
 
-			Coordinates pos = u.start < u.end ? u.start : u.end;
-			onChanged(pos, pos, 0);
+			onColorized(true);
 		}
+
+		return;
 	}
-}
 
-void CodeEdit::paste(void) {
-	const char* const clipText = SDL_GetClipboardText();
-	if (clipText != nullptr && strlen(clipText) > 0) {
-		UndoRecord u;
-		u.type = UndoType::Add;
-		u.before = _state;
+	if (_colorRangeMin < _colorRangeMax) {
+		const int end = std::min(_colorRangeMax, (int)_codeLines.size());
+		int ln = _colorRangeMin;
+		for (int n = 0; ln < end && n < COLORIZE_LINES_PER_FRAME; ++ln) {
+			if (_codeLines[ln].colorized)
+				continue; // Already colorized as visible line.
 
-		if (hasSelection()) {
-			u.overwritten = getSelectionText();
-			removeSelection();
+			colorizeRange(ln, ln + 1);
+			++n;
 		}
+		_colorRangeMin = ln;
 
-		u.content = clipText;
-		u.start = getActualCursorCoordinates();
-
-		insertText(clipText);
-
-		u.end = getActualCursorCoordinates();
-		u.after = _state;
-		addUndo(u);
+		if (_colorRangeMin >= end) {
+			_colorRangeMin = std::numeric_limits<int>::max();
+			_colorRangeMax = 0;
+		}
 
-		onModified();
+		onColorized(false);
 
-		onChanged(u.start, u.end, 0);
+		return;
 	}
 }
 
-void CodeEdit::remove(void) {
-	assert(!_readonly);
-
-	if (_codeLines.empty())
-		return;
-
-	UndoRecord u;
-	u.type = UndoType::Remove;
-	u.before = _state;
-
-	if (hasSelection()) {
-		u.content = getSelectionText();
-		u.start = _state.selectionStart;
-		u.end = _state.selectionEnd;
-		removeSelection();
-
-		Coordinates pos = _state.selectionStart < _state.selectionEnd ? _state.selectionStart : _state.selectionEnd;
-		onChanged(pos, pos, 0);
-	} else {
-		Coordinates pos = getActualCursorCoordinates();
-		setCursorPosition(pos);
-		Line &line = _codeLines[pos.line];
-
-		if (pos.column == (int)line.size()) {
-			if (pos.line == (int)_codeLines.size() - 1)
-				return;
-
-			u.content = '\n';
-			u.start = u.end = getActualCursorCoordinates();
-			advance(u.end);
+bool CodeEdit::colorizeVisible(int fromLine, int toLine) {
+	toLine = std::min(toLine, (int)_codeLines.size());
+	if (fromLine < 0 || fromLine >= toLine)
+		return false;
 
-			const Line &nextLine = _codeLines[pos.line + 1];
-			line.insert(line.end(), nextLine.begin(), nextLine.end());
-			removeLine(pos.line + 1);
+	bool worked = false;
+
+	if (_multilineCommentsChecked < toLine) {
+		// Continues from the checked lines if they are close enough, otherwise
+		// resolves the entry state without colorizing the lines in between.
+		int ln = fromLine;
+		uint8_t state = 0;
+		const bool adjacent = fromLine - _multilineCommentsChecked <= COLORIZE_CATCH_UP_LINE_COUNT;
+		if (adjacent) {
+			ln = _multilineCommentsChecked;
+			state = ln > 0 ? _codeLines[ln - 1].exitState : 0;
 		} else {
-			u.content.clear();
-			appendUtf8ToStdStr(u.content, line[pos.column].character);
-			u.start = u.end = getActualCursorCoordinates();
-			u.end.column++;
-
-			line.erase(line.begin() + pos.column);
+			state = resolveEntryState(fromLine);
 		}
-
-		colorize(pos.line, 1);
-
-		onChanged(pos, pos, 0);
+		for (; ln < toLine; ++ln) {
+			Line &line = _codeLines[ln];
+			if (!line.commentsChecked || line.enterState != state) {
+				checkMultilineComments(line, state);
+				reindexLine(ln);
+				worked = true;
+			}
+			state = line.exitState;
+		}
+		if (adjacent)
+			_multilineCommentsChecked = toLine;
 	}
 
-	u.after = _state;
-	addUndo(u);
-
-	onModified();
-}
-
-void CodeEdit::indent(void) {
-	if (isReadonly())
-		return;
-
-	if (hasSelection() && getSelectionLines() > 1) {
-		UndoRecord u;
-		u.type = UndoType::indent;
-		u.before = _state;
-
-		u.start = _state.selectionStart;
-		u.end = _state.selectionEnd;
+	for (int ln = fromLine; ln < toLine; ++ln) {
+		if (_codeLines[ln].colorized)
+			continue;
 
-		for (int i = u.start.line; i <= u.end.line; ++i) {
-			Line &line = _codeLines[i];
-			if (line.empty()) {
-				u.content.push_back(0);
+		colorizeRange(ln, ln + 1);
+		worked = true;
+	}
 
-				continue;
-			}
-			line.insert(line.begin(), Glyph('\t', PaletteIndex::Default));
-			u.content.push_back(std::numeric_limits<char>::max());
+	if (worked)
+		onColorized(false);
 
-			Coordinates pos(i, 0);
-			onChanged(pos, pos, 0);
-		}
+	return worked;
+}
 
-		_state.selectionEnd.column = (int)_codeLines[_state.selectionEnd.line].size();
+void CodeEdit::startColorTask(int fromLine) {
+	_colorTask = nullptr;
+	if (!_language->definition.tokenizer || (int)_codeLines.size() - fromLine < COLORIZE_PARALLEL_MIN_LINES)
+		return;
 
-		u.after = _state;
-		addUndo(u);
+	_colorTask = std::make_shared<ColorTask>();
+	ColorTask &task = *_colorTask;
+	task.version = _version;
+	task.next = fromLine;
+	task.state = fromLine > 0 ? _codeLines[fromLine - 1].exitState : 0;
+	task.firstState = task.state;
+	task.language = _language;
+	task.snapshot = getSnapshot();
+	postColorParts(fromLine);
+}
+
+bool CodeEdit::resumeColorTask(void) {
+	// Keeps the parts lexed above the first edited line, fails if none is left
+	// to adopt there.
+	ColorTask &task = *_colorTask;
+	if (task.editedFrom <= task.next)
+		return false;
 
-		onModified();
+	for (const TaskPool::JobPtr &job : task.jobs)
+		TaskPool::wait(job); // Stops at its next line, as the token is set.
+	size_t kept = task.adopting;
+	for (; kept < task.parts.size(); ++kept) {
+		const ColorTask::Part &part = task.parts[kept];
+		if ((int)part.exitStates.size() != part.lines || part.firstLine + part.lines > task.editedFrom)
+			break;
+	}
+	if (kept == task.adopting)
+		return false;
+
+	while (task.parts.size() > kept)
+		task.parts.pop_back();
+	task.jobs.resize(kept);
+	task.version = _version;
+	task.editedFrom = std::numeric_limits<int>::max();
+	task.snapshot = getSnapshot();
+	const ColorTask::Part &last = task.parts.back();
+	postColorParts(last.firstLine + last.lines);
+
+	return true;
+}
+
+void CodeEdit::postColorParts(int fromLine) {
+	// Lexes the lines from `fromLine` on in parts, after the parts there are.
+	ColorTask &task = *_colorTask;
+	for (int ln = fromLine; ln < (int)_codeLines.size(); ln += COLORIZE_PART_LINES) {
+		task.parts.emplace_back();
+		ColorTask::Part &part = task.parts.back();
+		part.firstLine = ln;
+		part.lines = std::min(COLORIZE_PART_LINES, (int)_codeLines.size() - ln);
+	}
+	if (!_versionToken)
+		_versionToken = std::make_shared<std::atomic<bool> >(false);
+	task.token = _versionToken;
+	for (size_t i = task.jobs.size(); i < task.parts.size(); ++i) {
+		const TaskPool::Priority priority = i == task.adopting ? TaskPool::Priority::High : TaskPool::Priority::Normal; // Adopted first.
+		task.jobs.push_back(_taskPool->post(std::bind(&ColorTask::lex, &task, i), priority, task.token));
 	}
 }
 
-void CodeEdit::unindent(void) {
-	if (isReadonly())
+void CodeEdit::updateColorTask(void) {
+	if (!_colorTask)
 		return;
 
-	if (hasSelection() && getSelectionLines() > 1) {
-		UndoRecord u;
-		u.type = UndoType::unindent;
-		u.before = _state;
+	ColorTask &task = *_colorTask;
+	if (task.version != _version) {
+		// Edited meanwhile, lexes again below the edit, or starts over from the
+		// first line whose state is not sure if the edit is above the next part.
+		if (!resumeColorTask())
+			startColorTask(std::min(task.next, _multilineCommentsChecked));
 
-		u.start = _state.selectionStart;
-		u.end = _state.selectionEnd;
+		return;
+	}
 
-		int affectedLines = 0;
-		for (int i = u.start.line; i <= u.end.line; ++i) {
-			Line &line = _codeLines[i];
-			if (line.empty()) {
-				u.content.push_back(0);
+	// Takes the parts in order, a line lexed from a wrong state is lexed again
+	// until a line ends in the state the job saw, the rest is right then.
+	SymbolIndex &index = *_symbolIndex;
+	std::vector<int> ids; // Of the words of the part, interned when first met.
+	auto adoptIndex = [&] (const ColorTask::Part &part, int i) -> void {
+		Line &line = _codeLines[task.next];
+		setBrackets(task.next, part.brackets[i]);
+		updateFolds(task.next);
+		for (const SymbolSpan &s : line.symbols)
+			index.count(s.id, -1);
+		line.symbols.assign(part.symbols.begin() + part.symbolStarts[i], part.symbols.begin() + part.symbolStarts[i + 1]);
+		for (SymbolSpan &s : line.symbols) {
+			int &id = ids[s.id];
+			if (id < 0)
+				id = index.intern(part.words[s.id]);
+			s.id = id;
+			index.count(id, 1);
+		}
+	};
+	int budget = COLORIZE_ADOPT_GLYPHS_PER_FRAME;
+	const int from = task.next;
+	while (budget > 0 && task.adopting < task.parts.size()) {
+		ColorTask::Part &part = task.parts[task.adopting];
+		if (!part.done)
+			break;
 
-				continue;
+		ids.assign(part.words.size(), -1);
+		const int end = part.firstLine + part.lines;
+		for (; task.next < end && budget > 0; ++task.next) {
+			Line &line = _codeLines[task.next];
+			const int i = task.next - part.firstLine;
+			if (line.colorized && line.commentsChecked && line.enterState == task.state) {
+				// Colorized on this thread meanwhile, as visible.
+			} else if (part.enterStates[i] == task.state) {
+				const LanguageDefinition::TokenSpan* spans = part.spans.data();
+				applyTokenSpans(line, spans + part.starts[i], spans + part.starts[i + 1], task.state, part.exitStates[i]);
+				if (part.glyphs[i] == (int)line.size())
+					adoptIndex(part, i);
+				else
+					reindexLine(task.next);
+			} else {
+				tokenizeLine(line, task.state);
+				reindexLine(task.next);
 			}
+			task.state = line.exitState;
+			budget -= (int)line.size() + 1;
+		}
+		if (task.next < end)
+			break;
 
-			const Glyph &g = *line.begin();
-			if (g.character == '\t') {
-				line.erase(line.begin());
-				u.content.push_back(std::numeric_limits<char>::max());
-				++affectedLines;
+		part.spans = LanguageDefinition::TokenSpans();
+		part.starts = std::vector<int>();
+		part.glyphs = std::vector<int>();
+		part.brackets = std::vector<BracketBalance>();
+		part.symbols = SymbolSpans();
+		part.symbolStarts = std::vector<int>();
+		part.words = std::vector<std::string>();
+		++task.adopting;
+	}
+	_multilineCommentsChecked = std::max(_multilineCommentsChecked, task.next);
+	if (task.next == from)
+		return;
 
-				Coordinates pos(i, 0);
-				onChanged(pos, pos, 0);
-			} else if (g.character == ' ') {
-				int k = 0;
-				for (int j = 0; j < _tabSize; ++j, ++k) {
-					if (line.empty())
-						break;
-					const Glyph &h = *line.begin();
-					if (h.character != ' ')
-						break;
-					line.erase(line.begin());
-				}
-				u.content.push_back((char)k);
-				if (k)
-					++affectedLines;
+	if (task.adopting < task.parts.size()) {
+		onColorized(false);
 
-				Coordinates pos(i, 0);
-				onChanged(pos, pos, 0);
-			} else {
-				u.content.push_back(0);
+		return;
+	}
+
+	_colorTask = nullptr;
+	_colorRangeMin = std::numeric_limits<int>::max();
+	_colorRangeMax = 0;
+	_checkMultilineComments = 0;
+	onColorized(true);
+}
+
+uint8_t CodeEdit::checkMultilineComments(Line &line, uint8_t state) {
+	const LanguageDefinition &langDef = _language->definition;
+	if (langDef.tokenizer)
+		return tokenizeLine(line, state);
+
+	line.minimapDrawn = false;
+	const std::string &startStr = langDef.commentStart;
+	const std::string &endStr = langDef.commentEnd;
+	bool inComment = !!(state & WithinMultiLineComment);
+	bool withinString = !!(state & WithinString);
+	const int size = (int)line.size();
+	for (int col = 0; col < size; ++col) {
+		const CodeEdit::Char c = line[col].character;
+
+		if (withinString) {
+			line[col].multiLineComment = inComment;
+
+			if (c == '\"') {
+				if (col + 1 < size && line[col + 1].character == '\"') {
+					++col;
+					line[col].multiLineComment = inComment;
+				} else {
+					withinString = false;
+				}
+			} else if (c == '\\') {
+				if (col + 1 < size) {
+					++col;
+					line[col].multiLineComment = inComment;
+				}
 			}
-		}
-		if (affectedLines > 0) {
-			const Line &line = _codeLines[_state.selectionEnd.line];
-			if ((int)line.size() < _state.selectionEnd.column)
-				_state.selectionEnd.column = (int)line.size();
-		}
+		} else {
+			if (c == '\"') {
+				withinString = true;
+				line[col].multiLineComment = inComment;
+			} else {
+				const bool exceptStart = langDef.commentException != '\0' && col > 0 && line[col - 1].character == langDef.commentException;
+				if (!exceptStart && matchGlyphs(startStr, line, col))
+					inComment = true;
 
-		u.after = _state;
-		if (affectedLines > 0) {
-			addUndo(u);
+				line[col].multiLineComment = inComment;
 
-			onModified();
+				const int till = col + 1 - (int)endStr.size();
+				const bool exceptEnd = langDef.commentException != '\0' && till > 0 && line[till - 1].character == langDef.commentException;
+				if (!exceptEnd && matchGlyphs(endStr, line, till))
+					inComment = false;
+			}
 		}
 	}
-}
 
-void CodeEdit::clearUndoRedoStack(void) {
-	_undoBuf.clear();
-	_undoIndex = 0;
-	_savedIndex = 0;
-}
+	line.commentsChecked = true;
+	line.enterState = state;
+	line.exitState = (uint8_t)((inComment ? WithinMultiLineComment : 0) | (withinString ? WithinString : 0));
 
-bool CodeEdit::canUndo(void) const {
-	return _undoIndex > 0;
+	return line.exitState;
 }
 
-bool CodeEdit::canRedo(void) const {
-	return _undoIndex < (int)_undoBuf.size();
+uint8_t CodeEdit::tokenizeLine(Line &line, uint8_t state) {
+	std::string &buffer = _tokenBuffer;
+	LanguageDefinition::TokenSpans &spans = _tokenSpans;
+	buffer.clear();
+	appendGlyphsToStdStr(buffer, line);
+
+	const char* begin = buffer.c_str();
+	const uint8_t exitState = lexLine(_language->definition, begin, begin + buffer.length(), state, spans);
+	applyTokenSpans(line, spans.data(), spans.data() + spans.size(), state, exitState);
+
+	return exitState;
 }
 
-void CodeEdit::undo(int steps) {
-#if CODE_EDIT_MERGE_UNDO_REDO
-	if (steps == 1) {
-		UndoRecord r;
-		UndoRecord* p = nullptr;
-		while (canUndo() && (!p || _undoBuf[_undoIndex - 1].similar(p))) {
-			if (p == nullptr) {
-				p = &r;
-				*p = _undoBuf[_undoIndex - 1];
-			}
-			_undoBuf[--_undoIndex].undo(this);
-		}
+uint8_t CodeEdit::lexLine(const LanguageDefinition &langDef, const char* begin, const char* end, uint8_t state, LanguageDefinition::TokenSpans &spans) {
+	// Fills the spans with identifiers resolved, touches nothing else thus safe on any thread.
+	spans.clear();
+	const uint8_t exitState = langDef.tokenizer(begin, end, state, spans);
 
-		return;
+	bool preproc = false;
+	const char* pos = begin;
+	for (LanguageDefinition::TokenSpan &span : spans) {
+		if (span.second == PaletteIndex::Identifier) {
+			std::string id(pos, span.first);
+			span.second = classifyIdentifier(langDef, id, preproc);
+		} else if (span.second == PaletteIndex::Preprocessor) {
+			preproc = true;
+		}
+		pos += span.first;
 	}
-#endif /* CODE_EDIT_MERGE_UNDO_REDO */
 
-	while (canUndo() && steps-- > 0) {
-		_undoBuf[--_undoIndex].undo(this);
-	}
+	return exitState;
 }
 
-void CodeEdit::redo(int steps) {
-#if CODE_EDIT_MERGE_UNDO_REDO
-	if (steps == 1) {
-		UndoRecord r;
-		UndoRecord* p = nullptr;
-		while (canRedo() && (!p || (_undoIndex + 1 <= (int)_undoBuf.size() && _undoBuf[_undoIndex].similar(p)))) {
-			if (p == nullptr && _undoIndex + 1 < (int)_undoBuf.size()) {
-				p = &r;
-				*p = _undoBuf[_undoIndex + 1];
-			}
-			_undoBuf[_undoIndex++].redo(this);
-		}
+CodeEdit::PaletteIndex CodeEdit::classifyIdentifier(const LanguageDefinition &langDef, std::string &id, bool preproc) {
+	if (!langDef.caseSensitive)
+		std::transform(id.begin(), id.end(), id.begin(), CODE_EDIT_CASE_FUNC);
 
-		return;
+	if (!preproc) {
+		if (langDef.keys.find(id) != langDef.keys.end())
+			return PaletteIndex::Keyword;
+		else if (langDef.ids.find(id) != langDef.ids.end())
+			return PaletteIndex::KnownIdentifier;
+		else if (langDef.preprocIds.find(id) != langDef.preprocIds.end())
+			return PaletteIndex::PreprocIdentifier;
+	} else {
+		if (langDef.preprocIds.find(id) != langDef.preprocIds.end())
+			return PaletteIndex::PreprocIdentifier;
 	}
-#endif /* CODE_EDIT_MERGE_UNDO_REDO */
 
-	while (canRedo() && steps-- > 0) {
-		_undoBuf[_undoIndex++].redo(this);
+	return PaletteIndex::Identifier;
+}
+
+uint8_t CodeEdit::resolveEntryState(int ln) {
+	// Walks down from the checked lines or the nearest checkpoint, taking the
+	// states of checked lines and of lines lexed by the color task where they
+	// were entered in the same state. The others are lexed for the state only,
+	// or checked for comments without a tokenizer.
+	const LanguageDefinition &langDef = _language->definition;
+	if (_entryStates.empty())
+		_entryStates.push_back(0);
+	for (int k = (int)_entryStates.size(); k * COLORIZE_CHECKPOINT_LINES <= std::min(_multilineCommentsChecked, ln); ++k)
+		_entryStates.push_back(_codeLines[k * COLORIZE_CHECKPOINT_LINES - 1].exitState); // Of the checked lines.
+	int at = std::min(ln / COLORIZE_CHECKPOINT_LINES, (int)_entryStates.size() - 1) * COLORIZE_CHECKPOINT_LINES;
+	uint8_t state = _entryStates[at / COLORIZE_CHECKPOINT_LINES];
+	if (_multilineCommentsChecked > at && _multilineCommentsChecked <= ln) {
+		at = _multilineCommentsChecked;
+		state = _codeLines[at - 1].exitState;
+	}
+	const ColorTask* task = _colorTask && _colorTask->version == _version && !_colorTask->parts.empty() ? _colorTask.get() : nullptr;
+	for (; at < ln; ++at) {
+		Line &line = _codeLines[at];
+		const ColorTask::Part* part = nullptr;
+		if (task && at >= task->parts.front().firstLine) {
+			const size_t i = (size_t)((at - task->parts.front().firstLine) / COLORIZE_PART_LINES);
+			if (i < task->parts.size() && !task->parts[i].done)
+				TaskPool::wait(task->jobs[i]); // Lexes it here if no worker took it yet, for the adopting too.
+			if (i < task->parts.size() && (int)task->parts[i].exitStates.size() == task->parts[i].lines)
+				part = &task->parts[i];
+		}
+		if (line.commentsChecked && line.enterState == state) {
+			state = line.exitState;
+		} else if (part && part->enterStates[at - part->firstLine] == state) {
+			state = part->exitStates[at - part->firstLine];
+		} else if (langDef.tokenizer) {
+			_tokenBuffer.clear();
+			appendGlyphsToStdStr(_tokenBuffer, line);
+			const char* begin = _tokenBuffer.c_str();
+			state = lexLine(langDef, begin, begin + _tokenBuffer.length(), state, _tokenSpans);
+		} else {
+			state = checkMultilineComments(line, state);
+			reindexLine(at);
+		}
+		if ((at + 1) % COLORIZE_CHECKPOINT_LINES == 0 && (at + 1) / COLORIZE_CHECKPOINT_LINES == (int)_entryStates.size())
+			_entryStates.push_back(state);
 	}
-}
 
-const CodeEdit::Vec2 &CodeEdit::getWidgetPos(void) const {
-	return _widgetPos;
+	return state;
 }
 
-void CodeEdit::setWidgetPos(const Vec2 &pos) {
-	_widgetPos = pos;
-}
+int CodeEdit::textDistanceToLineStart(const Coordinates &from) const {
+	const Line &line = _codeLines[from.line];
+	const int end = std::min((unsigned)line.size(), (unsigned)from.column);
+	int it = 0;
+	int len = 0;
+	if (end >= LINE_OFFSET_CHECKPOINT_COLUMNS) {
+		// Starts from the nearest checkpoint.
+		const std::vector<int> &offsets = getLineOffsets(line);
+		const int idx = end / LINE_OFFSET_CHECKPOINT_COLUMNS;
+		it = idx * LINE_OFFSET_CHECKPOINT_COLUMNS;
+		len = offsets[idx];
+	}
+	for (; it < end; ++it)
+		len = advanceDistance(line[it], len);
 
-const CodeEdit::Vec2 &CodeEdit::getWidgetSize(void) const {
-	return _widgetSize;
+	return len;
 }
 
-void CodeEdit::setWidgetSize(const Vec2 &sz) {
-	_widgetSize = sz;
+int CodeEdit::advanceDistance(const Glyph &g, int distance) const {
+	if (g.character == '\t')
+		return (distance / _tabSize) * _tabSize + _tabSize;
+	else if (g.character <= 255)
+		return distance + 1;
+	else
+		return distance + getCharacterWidth(g);
 }
 
-bool CodeEdit::isWidgetFocused(void) const {
-	return _widgetFocused;
-}
+const std::vector<int> &CodeEdit::getLineOffsets(const Line &line) const {
+	std::vector<int> &offsets = line.offsets;
+	const size_t count = line.size() / LINE_OFFSET_CHECKPOINT_COLUMNS + 1;
+	if (offsets.size() == count)
+		return offsets;
 
-void CodeEdit::setWidgetFocused(bool val) {
-	_widgetFocused = val;
+	offsets.clear();
+	offsets.reserve(count);
+	int len = 0;
+	for (size_t it = 0u; it < line.size(); ++it) {
+		if (it % LINE_OFFSET_CHECKPOINT_COLUMNS == 0)
+			offsets.push_back(len);
+		len = advanceDistance(line[it], len);
+	}
+	if (line.size() % LINE_OFFSET_CHECKPOINT_COLUMNS == 0)
+		offsets.push_back(len);
+
+	return offsets;
 }
 
-bool CodeEdit::isWidgetHovered(void) const {
-	if (!_widgetHoverable)
-		return false;
+void CodeEdit::updateLineWidths(int fromLine, int toLine) {
+	fromLine = std::max(fromLine, 0);
+	toLine = std::min(toLine, (int)_codeLines.size() - 1);
+	for (int ln = fromLine; ln <= toLine; ++ln) {
+		_codeLines[ln].offsets.clear();
+		_codeLines[ln].minimapDrawn = false;
+		reindexLine(ln);
+	}
+	invalidateSnapshot(fromLine, toLine);
 
-	const Vec2 &mpos = getMousePos();
-	const Vec2 &wpos = getWidgetPos();
-	const Vec2 &wsz = getWidgetSize();
+	if (_lineWidthsDirty)
+		return; // Will be rebuilt entirely.
 
-	return (mpos.x > wpos.x && mpos.x <= wpos.x + wsz.x) && (mpos.y > wpos.y && mpos.y <= wpos.y + wsz.y);
-}
+	for (int ln = fromLine; ln <= toLine; ++ln) {
+		Line &line = _codeLines[ln];
+		const int width = textDistanceToLineStart(Coordinates(ln, (int)line.size()));
+		if (width != line.width) {
+			countLineWidth(_lineWidths, line.width, -1);
+			countLineWidth(_lineWidths, width, 1);
+			line.width = width;
+		}
 
-void CodeEdit::setWidgetHoverable(bool val) {
-	_widgetHoverable = val;
+		if (_wrapColumns > 0)
+			wrapLine(ln);
+	}
 }
 
-const CodeEdit::Vec2 &CodeEdit::getContentSize(void) const {
-	return _contentSize;
+void CodeEdit::rebuildLineWidths(void) {
+	_lineWidths.clear();
+	for (int ln = 0; ln < (int)_codeLines.size(); ++ln) {
+		Line &line = _codeLines[ln];
+		line.offsets.clear();
+		line.width = textDistanceToLineStart(Coordinates(ln, (int)line.size()));
+		countLineWidth(_lineWidths, line.width, 1);
+	}
+	_lineWidthsDirty = false;
+	_wrapColumns = 0; // Lays out again with the new widths.
 }
 
-float CodeEdit::getScrollX(void) const {
-	return _scrollX;
-}
+int CodeEdit::getLongestLineWidth(void) const {
+	if (_lineWidths.empty())
+		return 0;
 
-void CodeEdit::setScrollX(float val) {
-	_scrollX = std::max(val, 0.0f);
+	return _lineWidths.rbegin()->first;
 }
 
-float CodeEdit::getScrollY(void) const {
-	return _scrollY;
-}
+void CodeEdit::updateWrapLayout(void) {
+	if (!_wordWrapEnabled)
+		return;
 
-void CodeEdit::setScrollY(float val) {
-	_scrollY = std::max(val, 0.0f);
-}
+	const int columns = std::max((int)(getWidgetSize().x / _charAdv.x) - _textStart - 1, 1);
+	if (columns != _wrapColumns) {
+		// The lines on screen are laid out at once, the others in the following frames.
+		_wrapColumns = columns;
+		int lineRow = 0;
+		const int first = rowToLine((int)(_scrollY / _charAdv.y), lineRow);
+		const int last = std::min(first + (int)(_widgetSize.y / _charAdv.y) + 1, (int)_codeLines.size() - 1);
+		for (int ln = first; ln <= last; ++ln)
+			wrapLine(ln);
+		_wrapLayoutNext = 0;
+	}
+	if (_wrapLayoutNext < 0)
+		return;
 
-unsigned CodeEdit::getFrameCount(void) const {
-	return _frameCount;
+	// Keeps the top line in place while the lines above it change their rows.
+	int lineRow = 0;
+	const int top = rowToLine((int)(_scrollY / _charAdv.y), lineRow);
+	const int end = std::min(_wrapLayoutNext + WRAP_LAYOUT_LINES_PER_FRAME, (int)_codeLines.size());
+	int rowsAbove = 0;
+	for (int ln = _wrapLayoutNext; ln < end; ++ln) {
+		const int rows = wrapLine(ln);
+		if (ln < top)
+			rowsAbove += rows;
+	}
+	_wrapLayoutNext = end < (int)_codeLines.size() ? end : -1;
+	if (rowsAbove != 0)
+		setScrollY(_scrollY + rowsAbove * _charAdv.y);
 }
 
-void CodeEdit::setFrameCount(unsigned val) {
-	_frameCount = val;
-}
+int CodeEdit::wrapLine(int ln) {
+	// Returns the number of rows the line gained.
+	Line &line = _codeLines[ln];
+	const int rows = (int)line.wraps.size();
+	if (rows == 0 && line.width <= _wrapColumns)
+		return 0;
 
-void CodeEdit::addInputCharacter(CodeEdit::CodePoint cp) {
-	_inputCharacters.push_back(cp);
-}
+	line.wraps.clear();
+	if (line.width > _wrapColumns)
+		breakLine(line);
+	const int diff = (int)line.wraps.size() - rows;
+	if (diff == 0 || line.folded)
+		return 0;
 
-void CodeEdit::addInputCharactersUtf8(const char* utf8Chars) {
-	CodeEdit::CodePoint wchars[17];
-	strFromUtf8(wchars, countof(wchars), utf8Chars, nullptr);
-	for (int i = 0; i < countof(wchars) && wchars[i] != 0; i++)
-		addInputCharacter(wchars[i]);
-}
+	addWrapRows(ln, diff);
 
-bool CodeEdit::isKeyShiftDown(void) const {
-	return _keyShift;
+	return diff;
 }
 
-bool CodeEdit::isKeyCtrlDown(void) const {
-	return _keyCtrl;
+void CodeEdit::breakLine(Line &line) {
+
+	int rowBegin = 0;
+	int rowDistance = 0;
+	int breakColumn = 0;
+	int breakDistance = 0;
+	int distance = 0;
+	for (int it = 0; it < (int)line.size(); ++it) {
+		const Glyph &g = line[it];
+		const int next = advanceDistance(g, distance);
+		if (next - rowDistance > _wrapColumns && it > rowBegin) {
+			if (breakColumn > rowBegin) { // Wraps after the last blank.
+				rowBegin = breakColumn;
+				rowDistance = breakDistance;
+			} else { // Wraps inside a word that does not fit.
+				rowBegin = it;
+				rowDistance = distance;
+			}
+			line.wraps.push_back(rowBegin);
+		}
+		distance = next;
+		if (g.character == ' ' || g.character == '\t') {
+			breakColumn = it + 1;
+			breakDistance = distance;
+		}
+	}
 }
 
-bool CodeEdit::isKeyAltDown(void) const {
-	return _keyAlt;
+void CodeEdit::buildWrapRowTree(void) const {
+	if (!_wrapRowTreeDirty)
+		return;
+
+	const int n = (int)_codeLines.size();
+	std::vector<std::pair<int, int> > folds;
+	_foldTree->visit(_foldTree->size(), 0, [&] (int, int header, int last) { folds.push_back(std::make_pair(header, last)); });
+	size_t f = 0;
+	int hiddenTo = -1;
+	for (int ln = 0; ln < n; ++ln) {
+		while (f < folds.size() && folds[f].first < ln)
+			hiddenTo = std::max(hiddenTo, folds[f++].second);
+		_codeLines[ln].folded = ln <= hiddenTo;
+	}
+	_rowTree->assign(n, [&] (int ln) -> int {
+		const Line &line = _codeLines[ln];
+
+		return line.folded ? 0 : 1 + (int)line.wraps.size();
+	});
+	_wrapRowTreeDirty = false;
 }
 
-bool CodeEdit::isKeyDown(Keycode kbkey) const {
-	const SDL_Keycode kc = kbkey;
-	const SDL_Scancode scancode = SDL_GetScancodeFromKey(kc);
-	if (scancode < 0 || scancode >= (SDL_Scancode)_keyStates1.size())
-		return false;
+void CodeEdit::addWrapRows(int ln, int diff) {
+	if (_wrapRowTreeDirty)
+		return; // Will be rebuilt entirely.
+	if (_codeLines[ln].folded)
+		return; // Has no rows.
 
-	return !!_keyStates1[scancode];
+	_rowTree->set(ln, _rowTree->at(ln) + diff);
 }
 
-bool CodeEdit::isKeyPressed(Keycode kbkey) const {
-	bool result = true;
-	int n = 0;
-	const SDL_Keycode kc = kbkey;
-	const SDL_Scancode scancode = SDL_GetScancodeFromKey(kc);
+void CodeEdit::shiftRows(int ln, int count) {
+	if (_wrapLayoutNext > ln)
+		_wrapLayoutNext = std::max(ln, _wrapLayoutNext + count);
+	if (_wrapRowTreeDirty)
+		return; // Will be rebuilt entirely.
 
-	do {
-		if (scancode < 0 || scancode >= (SDL_Scancode)_keyStates0.size()) {
-			result = false;
-			break;
-		}
+	if (count > 0)
+		_rowTree->insert(ln, count, 1); // Inserted lines are empty, the folds hide them afterwards.
+	else
+		_rowTree->erase(ln, -count);
+}
 
-		if (_keyStates0[scancode]) {
-			++n;
-		} else {
-			result = false;
-			break;
-		}
+void CodeEdit::refreshFolded(int fromLine, int toLine) {
+	// Finds again which lines of the range the folds hide, along with their rows.
+	if (_wrapRowTreeDirty)
+		return; // Will be rebuilt entirely.
+
+	toLine = std::min(toLine, (int)_codeLines.size() - 1);
+	if (fromLine > toLine)
+		return;
 
-		if (scancode < 0 || scancode >= (SDL_Scancode)_keyStates1.size()) {
-			result = false;
-			break;
-		}
+	std::vector<std::pair<int, int> > folds;
+	_foldTree->visit(_foldTree->lowerBound(toLine + 1), fromLine, [&] (int, int header, int last) { folds.push_back(std::make_pair(header, last)); });
+	size_t f = 0;
+	int hiddenTo = -1;
+	for (int ln = fromLine; ln <= toLine; ++ln) {
+		while (f < folds.size() && folds[f].first < ln)
+			hiddenTo = std::max(hiddenTo, folds[f++].second);
+		Line &line = _codeLines[ln];
+		const bool folded = ln <= hiddenTo;
+		if (line.folded == folded)
+			continue;
 
-		if (_keyStates1[scancode]) {
-			++n;
-			result = false;
-			break;
-		}
-	} while (false);
+		line.folded = folded;
+		_rowTree->set(ln, folded ? 0 : 1 + (int)line.wraps.size());
+	}
+}
 
-	do {
-		if (_keyTimestamps.size() < _keyStates0.size())
-			_keyTimestamps.resize(_keyStates0.size());
-		if (scancode < 0 || scancode >= (SDL_Scancode)_keyStates0.size())
-			break;
-		if (result) {
-			_keyTimestamps[scancode] = 0;
-		} else if (!result && n == 2) {
-			const long long now = std::chrono::steady_clock::now().time_since_epoch().count();
-			if (_keyTimestamps[scancode] == 0)
-				_keyTimestamps[scancode] = now + 300000000; // Delays 0.3s for the first continuous event.
-			const long long diff = now - _keyTimestamps[scancode];
-			if (diff > 50000000) { // Repeats once per 0.05s.
-				_keyTimestamps[scancode] = now;
-				result = true;
-			}
-		}
-	} while (false);
+int CodeEdit::lineToRow(int ln) const {
+	if (!usesRowTree())
+		return ln;
 
-	return result;
+	buildWrapRowTree();
+
+	return _rowTree->prefix(std::min(ln, (int)_codeLines.size()));
 }
 
-void CodeEdit::updateKeyStates(void) {
-	int kc = 0;
-	const Uint8* kbdState = SDL_GetKeyboardState(&kc);
-	_keyStates0 = _keyStates1;
-	if ((int)_keyStates1.size() < kc)
-		_keyStates1.resize(kc, 0);
-	memcpy(&_keyStates1.front(), kbdState, kc);
+int CodeEdit::rowToLine(int row, int &lineRow) const {
+	if (!usesRowTree()) {
+		lineRow = 0;
 
-	const SDL_Keymod mod = SDL_GetModState();
-	_keyShift = !!(KMOD_SHIFT & mod);
-	_keyCtrl = !!(KMOD_CTRL & mod);
-	_keyAlt = !!(KMOD_ALT & mod);
+		return row;
+	}
+
+	buildWrapRowTree();
+	int before = 0;
+	const int ln = _rowTree->find(0, [row] (int rows) -> bool { return rows > row; }, before);
+	lineRow = row - before;
+
+	return ln;
 }
 
-const CodeEdit::Vec2 &CodeEdit::getMousePos(void) const {
-	return _mousePos;
+int CodeEdit::getTotalRows(void) const {
+	return lineToRow((int)_codeLines.size());
 }
 
-bool CodeEdit::isMousePressed(void) const {
-	return _mousePressed;
+int CodeEdit::getRowInLine(const Line &line, int column) const {
+	return (int)(std::upper_bound(line.wraps.begin(), line.wraps.end(), column) - line.wraps.begin());
 }
 
-bool CodeEdit::isMouseDoubleClicked(void) const {
-	return _mouseClickCount == 2;
+bool CodeEdit::usesRowTree(void) const {
+	return _wordWrapEnabled || _foldTree->size() > 0;
 }
 
-bool CodeEdit::isMouseDragging(void) const {
-	return _mouseDragged;
+int CodeEdit::findFoldEnd(int ln, int lastLine) {
+	int opens = 0, depth = 0;
+
+	return findFoldEnd(ln, lastLine, opens, depth);
 }
 
-bool CodeEdit::isMouseDown(void) const {
-	return _mouseDown;
+int CodeEdit::findFoldEnd(int ln, int lastLine, int &opens, int &depth) {
+	opens = depth = foldBalance(ln).second;
+	if (depth == 0)
+		return -1; // Does not open a region.
+
+	const int end = lastLine < 0 ? (int)_codeLines.size() : std::min(lastLine + 1, (int)_codeLines.size());
+	for (int l = ln + 1; l < end; ++l) {
+		const BracketBalance balance = foldBalance(l);
+		if (balance.first >= depth)
+			return l;
+
+		depth += balance.second - balance.first;
+	}
+
+	return -1;
 }
 
-void CodeEdit::updateMouseStates(int mouseClickCount, const Vec4* frame, const Vec2* scale) {
-	if (!_mouseDragged)
-		_mouseClickCount = mouseClickCount;
+CodeEdit::BracketBalance CodeEdit::foldBalance(int ln) {
+	// Unmatched region ends and starts on the line.
+	if (!_codeLines[ln].colorized || ln >= _multilineCommentsChecked)
+		colorizeVisible(ln, ln + FOLD_COLORIZE_LINE_COUNT); // Tells code from comments and strings, as the lines above end.
 
-	const Vec2 mscale = scale ? *scale : Vec2(1, 1);
-	int tx = 0, ty = 0, tw = 0, th = 0;
-	int x_ = 0, y_ = 0;
-	int dispw = 0, disph = 0;
-	tx = (int)getWidgetPos().x;
-	ty = (int)getWidgetPos().y;
-	tw = (int)getWidgetSize().x;
-	th = (int)getWidgetSize().y;
-	dispw = tw;
-	disph = th;
+	const Line &line = _codeLines[ln];
+	if (!line.foldsIndexed)
+		indexFolds(line);
 
-	auto clicked = [] (const Vec4* frame, const Vec2 &widgetPos, const Vec2 &widgetSz, const Vec2 &mscale, Vec2 &mousePos, Vec2 &mouseDownPos, bool &mouseDown, bool &mouseClicked, bool &mouseDragged, bool &widgetFocused, int x, int y) {
-		if (frame) {
-			x -= (int)frame->x;
-			y -= (int)frame->y;
+	return BracketBalance(line.foldCloses, line.foldOpens);
+}
+
+void CodeEdit::indexFolds(const Line &line) const {
+	const CharacterClasses &cc = characterClasses();
+	const LanguageDefinition &langDef = _language->definition;
+	const bool braces = langDef.foldStartKeys.empty();
+	BracketBalance result(0, 0);
+	std::string word;
+	bool trailing = false;
+	for (size_t i = 0; i <= line.size(); ++i) {
+		const Glyph* g = i < line.size() ? &line[i] : nullptr;
+		const bool code = g && isCodeGlyph(*g);
+		if (!braces && code && g->character <= 255 && (cc[(char)g->character] & (CHARACTER_IDENTIFIER | CHARACTER_DIGIT))) {
+			word.push_back(langDef.caseSensitive ? (char)g->character : (char)CODE_EDIT_CASE_FUNC((int)g->character));
+
+			continue;
 		}
-		mousePos.x = (float)x * mscale.x;
-		mousePos.y = (float)y * mscale.y;
-		if (!mouseDown) {
-			mouseDownPos = mousePos;
-			mouseClicked = true;
-		} else {
-			mouseDragged |= std::abs(mouseDownPos.x - mousePos.x) + std::abs(mouseDownPos.y - mousePos.y) > 8.0f;
-			mouseClicked = false;
+
+		int diff = 0;
+		if (!word.empty()) {
+			if (langDef.foldStartKeys.find(word) != langDef.foldStartKeys.end())
+				diff = 1;
+			else if (langDef.foldEndKeys.find(word) != langDef.foldEndKeys.end())
+				diff = -1;
+			trailing = langDef.foldTrailingKeys.find(word) != langDef.foldTrailingKeys.end();
+			word.clear();
+		}
+		if (code && !(g->character <= 255 && (cc[(char)g->character] & CHARACTER_SPACE))) {
+			trailing = false; // Something follows the keyword.
+			if (braces && g->character == '{')
+				diff = 1;
+			else if (braces && g->character == '}')
+				diff = -1;
 		}
-		mouseDown = true;
 
-		widgetFocused = (mouseDownPos.x > widgetPos.x && mouseDownPos.x <= widgetPos.x + widgetSz.x) && (mouseDownPos.y > widgetPos.y && mouseDownPos.y <= widgetPos.y + widgetSz.y);
-	};
+		if (diff > 0)
+			++result.second;
+		else if (diff < 0 && result.second > 0)
+			--result.second;
+		else if (diff < 0)
+			++result.first;
+	}
+	if (trailing)
+		++result.second;
+	line.foldCloses = result.first;
+	line.foldOpens = result.second;
+	line.foldsIndexed = true;
+}
+
+void CodeEdit::shiftFolds(int ln, int count) {
+	if (_foldsStaleFrom <= _foldsStaleTo) {
+		if (_foldsStaleFrom >= ln)
+			_foldsStaleFrom = std::max(ln, _foldsStaleFrom + count);
+		if (_foldsStaleTo >= ln)
+			_foldsStaleTo = std::max(ln, _foldsStaleTo + count);
+	}
+	if (_foldTree->size() == 0)
+		return;
 
-	const int n = SDL_GetNumTouchDevices();
-	for (int m = 0; m < n; ++m) {
-		SDL_TouchID tid = SDL_GetTouchDevice(m);
-		if (tid == 0)
-			continue;
-		const int f = SDL_GetNumTouchFingers(tid);
-		do {
-			if (f < 1) break;
-			SDL_Finger* finger = SDL_GetTouchFinger(tid, 0);
-			if (!finger) break;
+	// Folds before the line whose hidden lines or closing line reach it, by index.
+	const int first = _foldTree->lowerBound(ln);
+	std::vector<std::pair<int, int> > around; // Index and last hidden line.
+	_foldTree->visit(first, ln - 1, [&] (int i, int, int last) { around.push_back(std::make_pair(i, last)); });
+	if (count > 0) {
+		for (const std::pair<int, int> &f : around)
+			_foldTree->setLast(f.first, f.second + count);
+		_foldTree->move(first, count);
+		refreshFolded(ln, ln + count - 1);
 
-			x_ = (int)(finger->x * ((float)dispw - CODE_EDIT_EPSILON));
-			y_ = (int)(finger->y * ((float)disph - CODE_EDIT_EPSILON));
+		return;
+	}
 
-			clicked(frame, getWidgetPos(), getWidgetSize(), mscale, _mousePos, _mouseDownPos, _mouseDown, _mousePressed, _mouseDragged, _widgetFocused, x_, y_);
+	// Folds whose header or closing line is removed go, the lines left of them show again.
+	const int end = ln - count;
+	int shownFrom = ln, shownTo = -1;
+	for (int i = _foldTree->lowerBound(end) - 1; i >= first; --i) {
+		shownTo = std::max(shownTo, _foldTree->lastAt(i) + count);
+		_foldTree->removeAt(i);
+	}
+	_foldTree->move(first, count);
+	for (std::vector<std::pair<int, int> >::reverse_iterator it = around.rbegin(); it != around.rend(); ++it) {
+		const int header = _foldTree->headerAt(it->first);
+		if (it->second >= end) {
+			_foldTree->setLast(it->first, it->second + count);
+		} else if (it->second + 1 < end || ln - 1 <= header) {
+			_foldTree->removeAt(it->first);
+			shownFrom = std::min(shownFrom, header + 1);
+			shownTo = std::max(shownTo, std::min(it->second, ln - 1));
+		} else {
+			_foldTree->setLast(it->first, ln - 1);
+		}
+	}
+	refreshFolded(shownFrom, shownTo);
+}
+
+void CodeEdit::validateFolds(int fromLine, int toLine) {
+	// Only the folds with a changed line are checked again. If that is the header
+	// or the closing line alone, the line is checked against the depths found before,
+	// otherwise the region is searched again up to the closing line.
+	std::vector<std::pair<int, int> > changed; // Index and last hidden line.
+	_foldTree->visit(_foldTree->lowerBound(toLine + 1), fromLine - 1, [&] (int i, int, int last) { changed.push_back(std::make_pair(i, last)); });
+	int shownFrom = (int)_codeLines.size(), shownTo = -1;
+	for (std::vector<std::pair<int, int> >::reverse_iterator it = changed.rbegin(); it != changed.rend(); ++it) {
+		const int header = _foldTree->headerAt(it->first);
+		const int closing = it->second + 1;
+		const FoldSpan span = _foldTree->at(it->first);
+		const bool hidden = fromLine < closing && toLine > header; // Whether a hidden line changed.
+		bool known = false, valid = false;
+		if (closing >= (int)_codeLines.size()) {
+			known = true;
+		} else if (!hidden && toLine < closing && span.opens >= 0) {
+			known = valid = foldBalance(header).second == span.opens; // Otherwise it may still end there.
+		} else if (!hidden && fromLine > header && span.depth >= 0) {
+			known = true;
+			valid = foldBalance(closing).first >= span.depth;
+		}
+		if (!known) {
+			int opens = 0, depth = 0;
+			valid = findFoldEnd(header, closing, opens, depth) == closing;
+			if (valid)
+				_foldTree->setDepths(it->first, opens, depth);
+		}
+		if (valid)
+			continue;
 
-			return;
-		} while (false);
+		_foldTree->removeAt(it->first);
+		shownFrom = std::min(shownFrom, header + 1);
+		shownTo = std::max(shownTo, it->second);
 	}
+	refreshFolded(shownFrom, shownTo);
+}
 
-	Uint32 btns = SDL_GetMouseState(&x_, &y_);
-	if (!!(btns & SDL_BUTTON(SDL_BUTTON_LEFT))) {
-		clicked(frame, getWidgetPos(), getWidgetSize(), mscale, _mousePos, _mouseDownPos, _mouseDown, _mousePressed, _mouseDragged, _widgetFocused, x_, y_);
+void CodeEdit::updateFolds(int ln) {
+	// Indexed again as colorized, the regions of lines not asked for yet count as changed.
+	const Line &line = _codeLines[ln];
+	const bool indexed = line.foldsIndexed;
+	const BracketBalance old(line.foldCloses, line.foldOpens);
+	line.foldsIndexed = false;
+	if (_foldTree->size() == 0)
+		return;
 
+	indexFolds(line);
+	if (indexed && BracketBalance(line.foldCloses, line.foldOpens) == old)
 		return;
+
+	if (_foldsStaleFrom > _foldsStaleTo) {
+		_foldsStaleFrom = _foldsStaleTo = ln;
+	} else {
+		_foldsStaleFrom = std::min(_foldsStaleFrom, ln);
+		_foldsStaleTo = std::max(_foldsStaleTo, ln);
 	}
+}
 
-	if (frame) {
-		x_ -= (int)frame->x;
-		y_ -= (int)frame->y;
+void CodeEdit::drawMinimapLine(const Line &line, unsigned* pixels, int width) const {
+	int column = 0;
+	for (const Glyph &g : line) {
+		if (column >= width)
+			break;
+
+		const int next = std::min(advanceDistance(g, column), width);
+		const PaletteIndex color = g.multiLineComment ? PaletteIndex::MultiLineComment : g.colorIndex;
+		const unsigned pixel = g.character > ' ' ? _palette[(int)color] : 0;
+		for (; column < next; ++column)
+			pixels[column] = pixel;
 	}
-	_mousePos.x = (float)x_ * mscale.x;
-	_mousePos.y = (float)y_ * mscale.y;
+	for (; column < width; ++column)
+		pixels[column] = 0;
+}
 
-	_mouseDown = false;
-	_mouseDragged = false;
-	_mousePressed = false;
+void CodeEdit::indexBrackets(const Line &line) const {
+	line.bracketCloses = 0;
+	line.bracketOpens = 0;
+	for (const Glyph &g : line) {
+		if (!isCodeGlyph(g))
+			continue;
+
+		if (isOpeningBracket(g.character)) {
+			++line.bracketOpens;
+		} else if (isClosingBracket(g.character)) {
+			if (line.bracketOpens > 0)
+				--line.bracketOpens;
+			else
+				++line.bracketCloses;
+		}
+	}
+	line.bracketsIndexed = true;
 }
 
-const CodeEdit::Palette &CodeEdit::DarkPalette(void) {
-	static Palette p = {
-		0xffffffff, // None.
-		0xffd69c56, // Keyword.
-		0xffa8ceb5, // Number.
-		0xff859dd6, // String.
-		0xff70a0e0, // CodeEdit::Char literal.
-		0xffb4b4b4, // Punctuation.
-		0xff409090, // Preprocessor.
-		0xffdadada, // Identifier.
-		0xffb0c94e, // Known identifier.
-		0xffc040a0, // Preproc identifier.
-		0xff4aa657, // Comment (single line).
-		0xff4aa657, // Comment (multi line).
-		0xff2C2C2C, // Background.
-		0xffe0e0e0, // Cursor.
-		0xffa06020, // Selection.
-		0x804d00ff, // ErrorMarker.
-		0x40f08000, // Breakpoint.
-		0xffaf912b, // Line number.
-		0x40000000, // Current line fill.
-		0x40808080, // Current line fill (inactive).
-		0x40a0a0a0, // Current line edge.
-		0xff84f2ef, // Line edited.
-		0xff307457, // Line edited saved.
-		0xfffa955f  // Line edited reverted.
-	};
+void CodeEdit::updateBrackets(int ln) {
+	const Line &line = _codeLines[ln];
+	const BracketBalance old(line.bracketCloses, line.bracketOpens);
+	indexBrackets(line);
+	const BracketBalance balance(line.bracketCloses, line.bracketOpens);
+	if (_bracketTreeDirty || balance == old)
+		return;
 
-	return p;
+	_bracketTree->set(ln, balance);
 }
 
-const CodeEdit::Palette &CodeEdit::LightPalette(void) {
-	static Palette p = {
-		0xff000000, // None.
-		0xffff0c06, // Keyword.
-		0xff008000, // Number.
-		0xff2020a0, // String.
-		0xff304070, // CodeEdit::Char literal.
-		0xff000000, // Punctuation.
-		0xff409090, // Preprocessor.
-		0xff404040, // Identifier.
-		0xff606010, // Known identifier.
-		0xffc040a0, // Preproc identifier.
-		0xff205020, // Comment (single line).
-		0xff405020, // Comment (multi line).
-		0xffffffff, // Background.
-		0xff000000, // Cursor.
-		0xff600000, // Selection.
-		0xa00010ff, // ErrorMarker.
-		0x80f08000, // Breakpoint.
-		0xff505000, // Line number.
-		0x40000000, // Current line fill.
-		0x40808080, // Current line fill (inactive).
-		0x40000000, // Current line edge.
-		0xff84f2ef, // Line edited.
-		0xff307457, // Line edited saved.
-		0xfffa955f  // Line edited reverted.
-	};
+void CodeEdit::setBrackets(int ln, const BracketBalance &balance) {
+	// Takes a balance found off this thread.
+	const Line &line = _codeLines[ln];
+	const BracketBalance old(line.bracketCloses, line.bracketOpens);
+	line.bracketCloses = balance.first;
+	line.bracketOpens = balance.second;
+	line.bracketsIndexed = true;
+	if (_bracketTreeDirty || balance == old)
+		return;
 
-	return p;
+	_bracketTree->set(ln, balance);
 }
 
-const CodeEdit::Palette &CodeEdit::RetroBluePalette(void) {
-	static Palette p = {
-		0xff00ffff, // None.
-		0xffffff00, // Keyword.
-		0xff00ff00, // Number.
-		0xff808000, // String.
-		0xff808000, // CodeEdit::Char literal.
-		0xffffffff, // Punctuation.
-		0xff008000, // Preprocessor.
-		0xff00ffff, // Identifier.
-		0xffffffff, // Known identifier.
-		0xffff00ff, // Preproc identifier.
-		0xff808080, // Comment (single line).
-		0xff404040, // Comment (multi line).
-		0xff800000, // Background.
-		0xff0080ff, // Cursor.
-		0xffffff00, // Selection.
-		0xa00000ff, // ErrorMarker.
-		0x80ff8000, // Breakpoint.
-		0xff808000, // Line number.
-		0x40000000, // Current line fill.
-		0x40808080, // Current line fill (inactive).
-		0x40000000, // Current line edge.
-		0xff84f2ef, // Line edited.
-		0xff307457, // Line edited saved.
-		0xfffa955f  // Line edited reverted.
+void CodeEdit::buildBracketTree(void) const {
+	if (!_bracketTreeDirty)
+		return;
+
+	_bracketTree->assign((int)_codeLines.size(), [&] (int ln) -> BracketBalance {
+		const Line &line = _codeLines[ln];
+		if (!line.bracketsIndexed)
+			indexBrackets(line);
+
+		return BracketBalance(line.bracketCloses, line.bracketOpens);
+	});
+	_bracketTreeDirty = false;
+}
+
+void CodeEdit::shiftBrackets(int ln, int count) {
+	if (_bracketTreeDirty)
+		return;
+
+	// Moves the balances along with the lines, without touching the lines.
+	if (count > 0)
+		_bracketTree->insert(ln, count, BracketBalance(0, 0));
+	else
+		_bracketTree->erase(ln, -count);
+}
+
+bool CodeEdit::findBracketForward(const Coordinates &from, int need, Coordinates &result) const {
+	// Finds the closing bracket that takes the depth `need` below the position.
+	auto scan = [&] (int ln, int column) -> bool {
+		const Line &line = _codeLines[ln];
+		for (int i = std::max(column, 0); i < (int)line.size(); ++i) {
+			const Glyph &g = line[i];
+			if (!isCodeGlyph(g))
+				continue;
+
+			if (isOpeningBracket(g.character)) {
+				++need;
+			} else if (isClosingBracket(g.character) && --need == 0) {
+				result = Coordinates(ln, i);
+
+				return true;
+			}
+		}
+
+		return false;
+	};
+
+	if (scan(from.line, from.column))
+		return true;
+	if (from.line + 1 >= (int)_codeLines.size())
+		return false;
+
+	// Finds the first line where the lines since this one have enough unmatched
+	// closing brackets, the ones between only change the depth.
+	buildBracketTree();
+	BracketBalance before;
+	const int ln = _bracketTree->find(from.line + 1, [need] (const BracketBalance &balance) -> bool { return balance.first >= need; }, before);
+	if (ln >= (int)_codeLines.size())
+		return false;
+
+	need += before.second - before.first;
+
+	return scan(ln, 0);
+}
+
+bool CodeEdit::findBracketBackward(const Coordinates &from, int need, Coordinates &result) const {
+	// Finds the opening bracket that takes the depth `need` below the position.
+	auto scan = [&] (int ln, int column) -> bool {
+		const Line &line = _codeLines[ln];
+		for (int i = std::min(column, (int)line.size()) - 1; i >= 0; --i) {
+			const Glyph &g = line[i];
+			if (!isCodeGlyph(g))
+				continue;
+
+			if (isClosingBracket(g.character)) {
+				++need;
+			} else if (isOpeningBracket(g.character) && --need == 0) {
+				result = Coordinates(ln, i);
+
+				return true;
+			}
+		}
+
+		return false;
 	};
 
-	return p;
+	if (scan(from.line, from.column))
+		return true;
+	if (from.line <= 0)
+		return false;
+
+	buildBracketTree();
+	BracketBalance after;
+	const int ln = _bracketTree->findBackward(from.line, [need] (const BracketBalance &balance) -> bool { return balance.second >= need; }, after);
+	if (ln < 0)
+		return false;
+
+	need += after.first - after.second;
+
+	return scan(ln, (int)_codeLines[ln].size());
 }
 
-void CodeEdit::colorize(int fromLine, int lines) {
-	int toLine = lines == -1 ? (int)_codeLines.size() : std::min((int)_codeLines.size(), fromLine + lines);
-	_colorRangeMin = std::min(_colorRangeMin, fromLine);
-	_colorRangeMax = std::max(_colorRangeMax, toLine);
-	_colorRangeMin = std::max(0, _colorRangeMin);
-	_colorRangeMax = std::max(_colorRangeMin, _colorRangeMax);
-	_checkMultilineComments = getFrameCount() + COLORIZE_DELAY_FRAME_COUNT;
+CodeEdit::Snapshot::ChunkPtr CodeEdit::buildSnapshotChunk(int fromLine, int lines) const {
+	std::shared_ptr<Snapshot::Chunk> result = std::make_shared<Snapshot::Chunk>();
+	size_t bytes = 0;
+	for (int ln = fromLine; ln < fromLine + lines; ++ln)
+		bytes += _codeLines[ln].size() + 1;
+	result->bytes.reserve(bytes);
+	result->starts.reserve(lines + 1);
+	for (int ln = fromLine; ln < fromLine + lines; ++ln) {
+		result->starts.push_back((int)result->bytes.length());
+		appendGlyphsToStdStr(result->bytes, _codeLines[ln]);
+		result->bytes.push_back('\n');
+	}
+	result->starts.push_back((int)result->bytes.length());
+
+	return result;
 }
 
-void CodeEdit::colorizeRange(int fromLine, int toLine) {
-	if (_codeLines.empty() || fromLine >= toLine)
+void CodeEdit::invalidateSnapshot(int fromLine, int toLine) {
+	if (_snapshotSlotsDirty)
+		return; // Will be rebuilt entirely.
+
+	int first = 0;
+	for (SnapshotSlot &slot : _snapshotSlots) {
+		if (first > toLine)
+			break;
+		if (first + slot.first > fromLine)
+			slot.second = nullptr;
+		first += slot.first;
+	}
+}
+
+void CodeEdit::shiftSnapshot(int ln, int count) {
+	if (_snapshotSlotsDirty || _snapshotSlots.empty())
+		return; // Will be rebuilt entirely.
+
+	int first = 0;
+	size_t i = 0;
+	while (i + 1 < _snapshotSlots.size() && first + _snapshotSlots[i].first <= ln)
+		first += _snapshotSlots[i++].first;
+	if (count > 0) {
+		_snapshotSlots[i].first += count; // Inserted lines join the slot they land in.
+		_snapshotSlots[i].second = nullptr;
+
 		return;
+	}
 
-	std::string buffer;
-	int endLine = std::max(0, std::min((int)_codeLines.size(), toLine));
-	for (int i = fromLine; i < endLine; ++i) {
-		bool preproc = false;
-		Line &line = _codeLines[i];
-		buffer.clear();
-		for (Glyph &g : _codeLines[i]) {
-			appendUtf8ToStdStr(buffer, g.character);
-			g.colorIndex = PaletteIndex::Default;
+	for (int removing = -count; removing > 0 && i < _snapshotSlots.size(); ) {
+		SnapshotSlot &slot = _snapshotSlots[i];
+		const int n = std::min(removing, first + slot.first - std::max(ln, first));
+		slot.first -= n;
+		slot.second = nullptr;
+		removing -= n;
+		if (slot.first == 0) {
+			_snapshotSlots.erase(_snapshotSlots.begin() + i);
+		} else {
+			first += slot.first;
+			++i;
 		}
+	}
+}
 
-		std::match_results<std::string::const_iterator> results;
-		auto last = buffer.cend();
-		for (auto first = buffer.cbegin(); first != last; ++first) {
-			for (auto &p : _regexes) {
-				const std::regex_constants::match_flag_type flag = std::regex_constants::match_continuous;
-				if (std::regex_search<std::string::const_iterator>(first, last, results, p.first, flag)) {
-					auto v = *results.begin();
-					auto start = v.first - buffer.begin();
-					auto end = v.second - buffer.begin();
-					std::string id = buffer.substr(start, end - start);
-					PaletteIndex color = p.second;
-					if (color == PaletteIndex::Identifier) {
-						if (!_langDef.caseSensitive)
-							std::transform(id.begin(), id.end(), id.begin(), CODE_EDIT_CASE_FUNC);
-
-						if (!preproc) {
-							if (_langDef.keys.find(id) != _langDef.keys.end())
-								color = PaletteIndex::Keyword;
-							else if (_langDef.ids.find(id) != _langDef.ids.end())
-								color = PaletteIndex::KnownIdentifier;
-							else if (_langDef.preprocIds.find(id) != _langDef.preprocIds.end())
-								color = PaletteIndex::PreprocIdentifier;
-						} else {
-							if (_langDef.preprocIds.find(id) != _langDef.preprocIds.end())
-								color = PaletteIndex::PreprocIdentifier;
-							else
-								color = PaletteIndex::Identifier;
-						}
-					} else if (color == PaletteIndex::Preprocessor) {
-						preproc = true;
-					}
-					//for (int j = (int)start; j < (int)end; ++j)
-					//	line[j].colorIndex = color;
-					int k = 0;
-					for (int j = 0; j < (int)line.size(); ++j) {
-						Glyph &g = line[j];
-						if (k >= (int)start) {
-							g.colorIndex = color;
-						}
-						k += countUtf8Bytes(g.character);
-						if (k >= (int)end)
-							break;
-					}
-					first += end - start - 1;
+void CodeEdit::updateSymbols(int ln) {
+	Line &line = _codeLines[ln];
+	SymbolIndex &index = *_symbolIndex;
+	for (const SymbolSpan &s : line.symbols)
+		index.count(s.id, -1);
+	line.symbols.clear();
 
-					break;
-				}
-			}
+	std::string word;
+	const int size = (int)line.size();
+	for (int i = 0; i < size; ) {
+		if (!isSymbolGlyph(line[i])) {
+			++i;
+
+			continue;
 		}
+
+		int j = i;
+		word.clear();
+		while (j < size && isSymbolGlyph(line[j]) && line[j].colorIndex == line[i].colorIndex)
+			appendUtf8ToStdStr(word, line[j++].character);
+		const int id = index.intern(word);
+		line.symbols.push_back(SymbolSpan(i, j - i, id));
+		index.count(id, 1);
+		i = j;
 	}
 }
 
-void CodeEdit::colorizeInternal(void) {
-	if (_codeLines.empty())
-		return;
+void CodeEdit::removeSymbols(int start, int end) {
+	SymbolIndex &index = *_symbolIndex;
+	for (int ln = start; ln < end; ++ln) {
+		for (const SymbolSpan &s : _codeLines[ln].symbols)
+			index.count(s.id, -1);
+	}
+}
 
-	if (_checkMultilineComments && (int)getFrameCount() > _checkMultilineComments) {
-		Coordinates end((int)_codeLines.size(), 0);
-		Coordinates commentStart = end;
-		bool withinString = false;
-		for (Coordinates i = Coordinates(0, 0); i < end; advance(i)) {
-			Line &line = _codeLines[i.line];
-			if (!line.empty()) {
-				const Glyph &g = line[i.column];
-				CodeEdit::Char c = g.character;
-
-				bool inComment = commentStart <= i;
-
-				if (withinString) {
-					line[i.column].multiLineComment = inComment;
-
-					if (c == '\"') {
-						if (i.column + 1 < (int)line.size() && line[i.column + 1].character == '\"') {
-							advance(i);
-							if (i.column < (int)line.size())
-								line[i.column].multiLineComment = inComment;
-						} else {
-							withinString = false;
-						}
-					} else if (c == '\\') {
-						advance(i);
-						if (i.column < (int)line.size())
-							line[i.column].multiLineComment = inComment;
-					}
-				} else {
-					if (c == '\"') {
-						withinString = true;
-						line[i.column].multiLineComment = inComment;
-					} else {
-						auto pred = [] (const char &a, const Glyph &b) {
-							return a == (const char)b.character;
-						};
-						bool except = false;
-						const std::string &startStr = _langDef.commentStart;
-						auto from = line.begin() + i.column;
-						if (i.column + startStr.size() <= line.size()) {
-							if (_langDef.commentException != '\0' && from != line.begin()) {
-								auto prev = from - 1;
-								if (prev->character == _langDef.commentException)
-									except = true;
-							}
-							if (!except) {
-								if (std::equal(startStr.begin(), startStr.end(), from, from + startStr.size(), pred)) {
-									commentStart = i;
-								}
-							}
-						}
+const CodeEdit::SymbolSpan* CodeEdit::getSymbolAt(const Coordinates &pos) const {
+	if (pos.line < 0 || pos.line >= (int)_codeLines.size())
+		return nullptr;
+
+	for (const SymbolSpan &s : _codeLines[pos.line].symbols) {
+		if (pos.column >= s.column && pos.column <= s.column + s.length)
+			return &s; // Also when the position is right after it.
+	}
 
-						inComment = commentStart <= i;
+	return nullptr;
+}
 
-						line[i.column].multiLineComment = inComment;
+void CodeEdit::reindexLine(int ln) {
+	updateBrackets(ln);
+	updateSymbols(ln);
+	updateFolds(ln);
+}
 
-						except = false;
-						const std::string &endStr = _langDef.commentEnd;
-						if (i.column + 1 >= (int)endStr.size()) {
-							auto till = from + 1 - endStr.size();
-							if (_langDef.commentException != '\0' && till != line.begin()) {
-								auto prev = till - 1;
-								if (prev->character == _langDef.commentException)
-									except = true;
-							}
-							if (!except) {
-								if (std::equal(endStr.begin(), endStr.end(), till, from + 1, pred)) {
-									commentStart = end;
-								}
-							}
-						}
-					}
-				}
-			}
+CodeEdit::Coordinates CodeEdit::findIdentifierStart(const Coordinates &from) const {
+	Coordinates at = from;
+	const Line &line = _codeLines[at.line];
+	while (at.column > 0 && isIdentifierGlyph(line[at.column - 1]))
+		--at.column;
+
+	return at;
+}
+
+bool CodeEdit::openCompletion(bool manual) {
+	CompletionPopup &c = *_completion;
+	if (isReadonly() || hasSelection() || _codeLines.empty())
+		return false;
+
+	const Coordinates pos = getActualCursorCoordinates();
+	const Coordinates start = findIdentifierStart(pos);
+	const Line &line = _codeLines[pos.line];
+	if (start.column < pos.column && line[start.column].character >= '0' && line[start.column].character <= '9')
+		return false; // A number.
+
+	if (!manual) {
+		if (start == pos)
+			return false;
+
+		// Not within comments or strings.
+		for (int i = start.column; i < pos.column; ++i) {
+			const Glyph &g = line[i];
+			if (g.multiLineComment || g.colorIndex == PaletteIndex::Comment || g.colorIndex == PaletteIndex::String || g.colorIndex == PaletteIndex::CharLiteral)
+				return false;
 		}
-		_checkMultilineComments = 0;
+	}
+
+	std::shared_ptr<const CompletionCandidates> document = _symbolIndex->completions();
+	if (c.stale || c.document != document)
+		c.build(_language->definition, document);
+	c.open = true;
+	c.manual = manual;
+	c.anchor = start;
+	c.query.clear();
+	c.matches.clear();
+	c.match(getText(start, pos));
+	if (c.items.empty())
+		c.open = false;
+
+	return c.open;
+}
+
+void CodeEdit::updateCompletion(void) {
+	CompletionPopup &c = *_completion;
+	if (!c.open)
+		return;
 
-		onColorized(true);
+	const Coordinates pos = getActualCursorCoordinates();
+	if (isReadonly() || hasSelection() || pos.line != c.anchor.line || pos.line >= (int)_codeLines.size() || findIdentifierStart(pos) != c.anchor) {
+		c.open = false;
 
 		return;
 	}
 
-	if (_colorRangeMin < _colorRangeMax) {
-		int to = std::min(_colorRangeMin + 10, _colorRangeMax);
-		colorizeRange(_colorRangeMin, to);
-		_colorRangeMin = to;
+	const std::string word = getText(c.anchor, pos);
+	if (word == c.query)
+		return;
 
-		if (_colorRangeMax == _colorRangeMin) {
-			_colorRangeMin = std::numeric_limits<int>::max();
-			_colorRangeMax = 0;
-		}
+	c.match(word);
+	if (c.items.empty() || (word.empty() && !c.manual))
+		c.open = false;
+}
 
-		onColorized(false);
+bool CodeEdit::handleCompletionKeys(void) {
+	CompletionPopup &c = *_completion;
+	if (!c.open || isKeyCtrlDown() || isKeyAltDown() || isKeyShiftDown())
+		return false;
+
+	const int count = (int)c.items.size();
+	if (isKeyPressed(SDLK_ESCAPE)) {
+		c.open = false;
+	} else if (isKeyPressed(SDLK_RETURN) || isKeyPressed(SDLK_TAB)) {
+		acceptCompletion();
+	} else if (isKeyPressed(SDLK_UP)) {
+		c.selected = (c.selected + count - 1) % count;
+	} else if (isKeyPressed(SDLK_DOWN)) {
+		c.selected = (c.selected + 1) % count;
+	} else if (isKeyPressed(SDLK_PAGEUP)) {
+		c.selected = std::max(c.selected - COMPLETION_VISIBLE_ITEMS, 0);
+	} else if (isKeyPressed(SDLK_PAGEDOWN)) {
+		c.selected = std::min(c.selected + COMPLETION_VISIBLE_ITEMS, count - 1);
+	} else {
+		return false;
+	}
+	if (c.selected < c.top)
+		c.top = c.selected;
+	else if (c.selected >= c.top + COMPLETION_VISIBLE_ITEMS)
+		c.top = c.selected - COMPLETION_VISIBLE_ITEMS + 1;
+
+	return true;
+}
+
+bool CodeEdit::clickCompletion(const Vec2 &pos) {
+	CompletionPopup &c = *_completion;
+	if (!c.open)
+		return false;
+	if (pos.x < c.rect.x || pos.x >= c.rect.x + c.rect.width || pos.y < c.rect.y || pos.y >= c.rect.y + c.rect.height)
+		return false;
+
+	const int idx = c.top + (int)((pos.y - c.rect.y) / _charAdv.y);
+	if (idx < (int)c.items.size()) {
+		c.selected = idx;
+		acceptCompletion();
+	}
+
+	return true;
+}
 
+void CodeEdit::acceptCompletion(void) {
+	CompletionPopup &c = *_completion;
+	c.open = false;
+	if (isReadonly() || c.items.empty())
 		return;
+
+	// Replaces the typed part of the word as one undo record.
+	const std::string word = c.candidate(c.items[c.selected].second);
+	const Coordinates pos = getActualCursorCoordinates();
+	setSelection(c.anchor, pos);
+
+	UndoRecord u;
+	u.type = UndoType::Add;
+	u.before = _state;
+
+	if (hasSelection()) {
+		u.overwritten = getSelectionText();
+		removeSelection();
 	}
+
+	u.content = word;
+	u.start = getActualCursorCoordinates();
+
+	insertTextAtCursor(word.c_str());
+
+	u.end = getActualCursorCoordinates();
+	u.after = _state;
+	addUndo(u);
+
+	onModified();
+
+	onChanged(u.start, u.end, 0);
 }
 
-int CodeEdit::textDistanceToLineStart(const Coordinates &from) const {
-	const Line &line = _codeLines[from.line];
-	int len = 0;
-	for (size_t it = 0u; it < line.size() && it < (unsigned)from.column; ++it) {
-		const Glyph &g = line[it];
-		if (g.character == '\t') {
-			len = (len / _tabSize) * _tabSize + _tabSize;
-		} else {
-			if (g.character <= 255) {
-				++len;
-			} else {
-				const int w = getCharacterWidth(g);
-				len += w;
-			}
+void CodeEdit::drawCompletion(void) {
+	DrawRecorder &recorder = *_drawRecorder;
+	CompletionPopup &c = *_completion;
+
+	int columns = 1;
+	for (const CompletionPopup::Item &i : c.items) {
+		const char* str = c.candidate(i.second);
+		int n = 0;
+		for (const char* ch = str; *ch; ch += expectUtf8Char(ch))
+			++n;
+		columns = std::max(columns, std::min(n, COMPLETION_MAX_COLUMNS));
+	}
+	const int rows = std::min((int)c.items.size(), COMPLETION_VISIBLE_ITEMS);
+
+	// Below the word, or above if there is more room.
+	int distance = 0;
+	const int row = coordinatesToRow(c.anchor, distance);
+	const float width = _charAdv.x * (columns + 1);
+	const float height = _charAdv.y * rows;
+	float x = getWidgetPos().x - getScrollX() + _charAdv.x * (_textStart + distance);
+	float y = getWidgetPos().y - getScrollY() + _charAdv.y * (row + 1);
+	if (y + height > getWidgetPos().y + getWidgetSize().y && y - _charAdv.y - height >= getWidgetPos().y)
+		y -= _charAdv.y + height;
+	x = std::max(std::min(x, getWidgetPos().x + getWidgetSize().x - width), getWidgetPos().x);
+	c.rect = Vec4(x, y, width, height);
+
+	const SDL_Rect rect{ (int)x, (int)y, (int)width + 1, (int)height + 1 };
+	const int clip = recorder.clip(rect);
+
+	recorder.box(DrawLayer::CompletionBackground, clip, (Sint16)x, (Sint16)y, (Sint16)(x + width), (Sint16)(y + height), _palette[(int)PaletteIndex::CompletionBackground]);
+	for (int i = c.top; i < c.top + rows && i < (int)c.items.size(); ++i) {
+		const int idx = c.items[i].second;
+		const float iy = y + _charAdv.y * (i - c.top);
+		if (i == c.selected)
+			recorder.box(DrawLayer::CompletionSelection, clip, (Sint16)x, (Sint16)iy, (Sint16)(x + width), (Sint16)(iy + _charAdv.y - 1.0f), _palette[(int)PaletteIndex::Selection]);
+		recorder.text(DrawLayer::CompletionText, clip, (Sint16)(x + _charAdv.x * 0.5f), (Sint16)iy, c.candidate(idx), _palette[(int)c.colors[idx]], _utf8SupportEnabled);
+	}
+	recorder.frame(DrawLayer::CompletionEdge, clip, (Sint16)x, (Sint16)y, (Sint16)(x + width), (Sint16)(y + height), _palette[(int)PaletteIndex::CurrentLineEdge]);
+}
+
+int CodeEdit::coordinatesToRow(const Coordinates &pos, int &distance) const {
+	distance = textDistanceToLineStart(pos);
+	if (!usesRowTree())
+		return pos.line;
+
+	const Line &line = _codeLines[pos.line];
+	const int lineRow = getRowInLine(line, pos.column);
+	if (lineRow > 0)
+		distance -= textDistanceToLineStart(Coordinates(pos.line, line.wraps[lineRow - 1]));
+
+	return lineToRow(pos.line) + lineRow;
+}
+
+CodeEdit::Coordinates CodeEdit::rowPosToCoordinates(int row, int distance) const {
+	int lineRow = 0;
+	const int lineNo = rowToLine(row, lineRow);
+	if (lineNo >= (int)_codeLines.size())
+		return Coordinates(lineNo + lineRow, 0);
+
+	const Line &line = _codeLines[lineNo];
+	const int rowBegin = lineRow > 0 ? line.wraps[lineRow - 1] : 0;
+	const int rowEnd = lineRow < (int)line.wraps.size() ? line.wraps[lineRow] : (int)line.size();
+	int column = rowBegin;
+	int dist = rowBegin > 0 ? textDistanceToLineStart(Coordinates(lineNo, rowBegin)) : 0;
+	distance += dist;
+	if (rowEnd - rowBegin >= LINE_OFFSET_CHECKPOINT_COLUMNS) {
+		// Starts from the last checkpoint before the position.
+		const std::vector<int> &offsets = getLineOffsets(line);
+		const int idx = std::min(
+			std::max((int)(std::lower_bound(offsets.begin(), offsets.end(), distance) - offsets.begin()) - 1, 0),
+			rowEnd / LINE_OFFSET_CHECKPOINT_COLUMNS
+		);
+		if (idx * LINE_OFFSET_CHECKPOINT_COLUMNS > column) {
+			column = idx * LINE_OFFSET_CHECKPOINT_COLUMNS;
+			dist = offsets[idx];
 		}
 	}
+	while (dist < distance && column < rowEnd) {
+		dist = advanceDistance(line[column], dist);
+		++column;
+	}
+	if (column == rowEnd && lineRow < (int)line.wraps.size())
+		--column; // Stays on this row rather than at the beginning of the next one.
 
-	return len;
+	return Coordinates(lineNo, column);
 }
 
 int CodeEdit::getPageSize(void) const {
@@ -2819,24 +7565,18 @@ void CodeEdit::advance(Coordinates &val) const {
 }
 
 int CodeEdit::getCharacterWidth(const Glyph &g) const {
-	CodeEdit::CodePoint cp = g.codepoint;
-	if (cp == 0) {
-		const char* txt = (const char*)(&g.character);
-		const char* tend = txt + sizeof(CodeEdit::Char);
-		unsigned int codepoint = 0;
-		charFromUtf8(&codepoint, txt, tend);
-		cp = (CodeEdit::CodePoint)codepoint;
-	}
+	if (!isPrintable(g.codepoint))
+		return getWideCharacterWidth();
+	else
+		return 1;
+}
 
-	if (!isPrintable(cp)) {
-		const float cadvx = _characterSize.x;
-		if (cadvx > _charAdv.x)
-			return CODE_EDIT_UTF8_CHAR_FACTOR;
-		else
-			return 1;
-	} else {
+int CodeEdit::getWideCharacterWidth(void) const {
+	const float cadvx = _characterSize.x;
+	if (cadvx > _charAdv.x)
+		return CODE_EDIT_UTF8_CHAR_FACTOR;
+	else
 		return 1;
-	}
 }
 
 CodeEdit::Coordinates CodeEdit::screenPosToCoordinates(const Vec2 &pos) const {
@@ -2844,30 +7584,10 @@ CodeEdit::Coordinates CodeEdit::screenPosToCoordinates(const Vec2 &pos) const {
 	float originY = getWidgetPos().y - getScrollY();
 	Vec2 local(pos.x - originX, pos.y - originY);
 
-	int lineNo = std::max(0, (int)floor(local.y / _charAdv.y));
-	int columnCoord = std::max(0, (int)floor(local.x / _charAdv.x) - _textStart);
-
-	int column = 0;
-	if (lineNo >= 0 && lineNo < (int)_codeLines.size()) {
-		const Line &line = _codeLines[lineNo];
-		int distance = 0;
-		while (distance < columnCoord && column < (int)line.size()) {
-			const Glyph &g = line[column];
-			if (g.character == '\t') {
-				distance = (distance / _tabSize) * _tabSize + _tabSize;
-			} else {
-				if (g.character <= 255) {
-					++distance;
-				} else {
-					const int w = getCharacterWidth(g);
-					distance += w;
-				}
-			}
-			++column;
-		}
-	}
+	const int row = std::max(0, (int)floor(local.y / _charAdv.y));
+	const int distance = std::max(0, (int)floor(local.x / _charAdv.x) - _textStart);
 
-	return Coordinates(lineNo, column);
+	return rowPosToCoordinates(row, distance);
 }
 
 bool CodeEdit::isOnWordBoundary(const Coordinates &at) const {
@@ -2887,25 +7607,101 @@ void CodeEdit::addUndo(UndoRecord &val) {
 	_undoBuf.resize(_undoIndex + 1);
 	_undoBuf.back() = val;
 	++_undoIndex;
+
+	recordChanges(val, false);
+}
+
+void CodeEdit::recordChange(const Coordinates &start, const Coordinates &end, const std::string &text) {
+	if (start == end && text.empty())
+		return;
+
+	++_version;
+	const int edited = std::min(start.line, end.line);
+	if ((int)_entryStates.size() > edited / COLORIZE_CHECKPOINT_LINES + 1)
+		_entryStates.resize(edited / COLORIZE_CHECKPOINT_LINES + 1); // Those entering lines below the edit.
+	if (_colorTask)
+		_colorTask->editedFrom = std::min(_colorTask->editedFrom, edited);
+	if (_versionToken) {
+		*_versionToken = true;
+		_versionToken = nullptr;
+	}
+	if (_textChangedHandler == nullptr)
+		return;
+
+	std::string txt;
+	txt.reserve(text.length());
+	for (char c : text) {
+		if (c != '\r')
+			txt.push_back(c);
+	}
+
+	// Typing goes into the insertion right before it.
+	if (!_changes.empty() && start == end) {
+		Change &last = _changes.back();
+		if (advanceUtf8Text(last.start, last.text) == start) {
+			last.text += txt;
+			last.version = _version;
+
+			return;
+		}
+	}
+
+	Change c;
+	c.start = start;
+	c.end = end;
+	c.text = txt;
+	c.version = _version;
+	_changes.push_back(c);
+}
+
+void CodeEdit::recordChanges(const UndoRecord &u, bool undone) {
+	switch (u.type) {
+	case UndoType::Add:
+		if (undone)
+			recordChange(u.start, u.end, u.overwritten);
+		else
+			recordChange(u.start, advanceUtf8Text(u.start, u.overwritten), u.content);
+
+		break;
+	case UndoType::Remove:
+		if (undone)
+			recordChange(u.start, u.start, u.content);
+		else
+			recordChange(u.start, u.end, std::string());
+
+		break;
+	case UndoType::indent:
+	case UndoType::unindent:
+		// One change per line, as `content` holds what happened to each.
+		for (int i = u.start.line; i <= u.end.line && i - u.start.line < (int)u.content.length(); ++i) {
+			const char op = u.content[i - u.start.line];
+			if (op == 0)
+				continue;
+
+			const int n = op == std::numeric_limits<char>::max() ? 1 : op;
+			const std::string text = op == std::numeric_limits<char>::max() ? std::string("\t") : std::string(op, ' ');
+			const Coordinates pos(i, 0);
+			if ((u.type == UndoType::indent) != undone)
+				recordChange(pos, pos, text);
+			else
+				recordChange(pos, Coordinates(i, n), std::string());
+		}
+
+		break;
+	}
 }
 
 std::string CodeEdit::getText(const Coordinates &start, const Coordinates &end, const char* newLine) const {
 	std::string result;
 
-	int prevLineNo = start.line;
-	for (Coordinates it = start; it <= end; advance(it)) {
-		if (prevLineNo != it.line && it.line < (int)_codeLines.size())
+	// Takes a slice of glyphs per line.
+	const int last = std::min(end.line, (int)_codeLines.size() - 1);
+	for (int ln = start.line; ln <= last && start <= end; ++ln) {
+		if (ln != start.line)
 			result += newLine;
 
-		if (it == end)
-			break;
-
-		prevLineNo = it.line;
-		const Line &line = _codeLines[it.line];
-		if (!line.empty() && it.column < (int)line.size()) {
-			const Glyph &g = line[it.column];
-			appendUtf8ToStdStr(result, g.character);
-		}
+		const Line &line = _codeLines[ln];
+		appendGlyphsToStdStr(result, line, ln == start.line ? start.column : 0, ln == end.line ? end.column : (int)line.size());
 	}
 
 	return result;
@@ -2948,14 +7744,88 @@ int CodeEdit::appendBuffer(std::string &buf, const Glyph &g, int idx, int &width
 	}
 }
 
+CodeEdit::Line CodeEdit::createLine(void) const {
+	return Line(GlyphAllocator<Glyph>(_glyphPool.get()));
+}
+
+void CodeEdit::replaceLines(Lines &lines, std::shared_ptr<GlyphPool> &pool) {
+	const Coordinates end = _codeLines.empty() ?
+		Coordinates() :
+		Coordinates((int)_codeLines.size() - 1, (int)_codeLines.back().size());
+
+	// The old lines and their pool are handed back to be freed together.
+	_codeLines.swap(lines);
+	_glyphPool.swap(pool);
+	if (pool)
+		pool->discarded = true;
+	if (_codeLines.empty())
+		_codeLines.push_back(createLine());
+	_lineWidthsDirty = true;
+	_wrapRowTreeDirty = true;
+	_bracketTreeDirty = true;
+	_snapshotSlotsDirty = true;
+	_symbolIndex->clear();
+	_completion->open = false;
+	_foldTree->clear();
+
+	// Reports the whole text as replaced, only builds it if anyone listens.
+	recordChange(Coordinates(), end, _textChangedHandler != nullptr ? getText() : std::string());
+
+	clearUndoRedoStack();
+
+	// The lines are new thus not colorized, only schedules them rather than visiting each.
+	_multilineCommentsChecked = 0;
+	_colorRangeMin = 0;
+	_colorRangeMax = (int)_codeLines.size();
+	_checkMultilineComments = getFrameCount() + COLORIZE_DELAY_FRAME_COUNT;
+	startColorTask(0);
+}
+
+void CodeEdit::updateFileTask(void) {
+	if (!_fileTask)
+		return;
+
+	std::shared_ptr<FileTask> task = _fileTask;
+	if (!task->completed) {
+		if (task->progressed)
+			task->progressed(task->progress());
+
+		return;
+	}
+
+	TaskPool::wait(task->job);
+	_fileTask = nullptr;
+	if (task->result == FileResult::Succeeded) {
+		if (task->loading) {
+			_textEncoding = task->encoding;
+			if (!task->newLine.empty())
+				_newLine = task->newLine;
+			replaceLines(task->lines, task->pool);
+			setCursorPosition(Coordinates());
+			if (task->tabSize == _tabSize && task->wideWidth == getWideCharacterWidth()) {
+				_lineWidths.swap(task->widths);
+				_lineWidthsDirty = false;
+				_wrapColumns = 0;
+			}
+		} else if (task->version == _version) {
+			setChangesSaved();
+		}
+	}
+	if (task->finished)
+		task->finished(task->result);
+}
+
 int CodeEdit::insertTextAt(Coordinates & /* inout */ where, const char* val) {
 	assert(!_readonly);
 
 	int totalLines = 0;
+	const int fromLine = where.line;
 	const char* str = val;
 	while (*str != '\0') {
-		if (_codeLines.empty())
-			_codeLines.push_back(Line());
+		if (_codeLines.empty()) {
+			_codeLines.push_back(createLine());
+			countLineWidth(_lineWidths, 0, 1);
+		}
 
 		int n = expectUtf8Char(str);
 		CodeEdit::Char c = takeUtf8Bytes(str, n);
@@ -2980,6 +7850,7 @@ int CodeEdit::insertTextAt(Coordinates & /* inout */ where, const char* val) {
 		}
 		str += n;
 	}
+	updateLineWidths(fromLine, where.line);
 
 	return totalLines;
 }
@@ -3010,6 +7881,7 @@ void CodeEdit::removeRange(const Coordinates &start, const Coordinates &end) {
 		if (start.line < end.line)
 			removeLine(start.line + 1, end.line + 1);
 	}
+	updateLineWidths(start.line, start.line);
 }
 
 void CodeEdit::removeSelection(void) {
@@ -3030,7 +7902,13 @@ void CodeEdit::removeSelection(void) {
 CodeEdit::Line &CodeEdit::insertLine(int idx) {
 	assert(!_readonly);
 
-	Line &result = *_codeLines.insert(_codeLines.begin() + idx, Line());
+	Line &result = *_codeLines.insert(_codeLines.begin() + idx, createLine());
+	countLineWidth(_lineWidths, result.width, 1);
+	_minimapStaleFrom = std::min(_minimapStaleFrom, idx);
+	shiftRows(idx, 1);
+	shiftFolds(idx, 1);
+	shiftBrackets(idx, 1);
+	shiftSnapshot(idx, 1);
 
 	ErrorMarkers etmp;
 	for (auto &i : _errorMarkers)
@@ -3067,7 +7945,15 @@ void CodeEdit::removeLine(int start, int end) {
 	}
 	_breakpoints = std::move(btmp);
 
+	for (int ln = start; ln < end; ++ln)
+		countLineWidth(_lineWidths, _codeLines[ln].width, -1);
+	removeSymbols(start, end);
 	_codeLines.erase(_codeLines.begin() + start, _codeLines.begin() + end);
+	_minimapStaleFrom = std::min(_minimapStaleFrom, start);
+	shiftRows(start, start - end);
+	shiftFolds(start, start - end);
+	shiftBrackets(start, start - end);
+	shiftSnapshot(start, start - end);
 }
 
 void CodeEdit::removeLine(int idx) {
@@ -3092,7 +7978,14 @@ void CodeEdit::removeLine(int idx) {
 	}
 	_breakpoints = std::move(btmp);
 
+	countLineWidth(_lineWidths, _codeLines[idx].width, -1);
+	removeSymbols(idx, idx + 1);
 	_codeLines.erase(_codeLines.begin() + idx);
+	_minimapStaleFrom = std::min(_minimapStaleFrom, idx);
+	shiftRows(idx, -1);
+	shiftFolds(idx, -1);
+	shiftBrackets(idx, -1);
+	shiftSnapshot(idx, -1);
 }
 
 void CodeEdit::backspace(void) {
@@ -3172,8 +8065,12 @@ void CodeEdit::enterCharacter(CodeEdit::Char ch) {
 	const Coordinates coord = getActualCursorCoordinates();
 	u.start = coord;
 
-	if (_codeLines.empty())
-		_codeLines.push_back(Line());
+	if (_codeLines.empty()) {
+		_codeLines.push_back(createLine());
+		countLineWidth(_lineWidths, 0, 1);
+		_wrapRowTreeDirty = true;
+		_bracketTreeDirty = true;
+	}
 
 	if (ch == '\n') {
 		insertLine(coord.line + 1);
@@ -3221,10 +8118,12 @@ void CodeEdit::enterCharacter(CodeEdit::Char ch) {
 		onChanged(coord, Coordinates(coord.line + 1, 0), 0);
 	} else {
 		Line &line = _codeLines[coord.line];
-		if (_overwrite && (int)line.size() > coord.column)
+		if (_overwrite && (int)line.size() > coord.column) {
+			appendUtf8ToStdStr(u.overwritten, line[coord.column].character);
 			line[coord.column] = Glyph(ch, PaletteIndex::Default);
-		else
+		} else {
 			line.insert(line.begin() + coord.column, Glyph(ch, PaletteIndex::Default));
+		}
 		_state.cursorPosition = coord;
 		++_state.cursorPosition.column;
 
@@ -3331,6 +8230,15 @@ void CodeEdit::onModified(void) const {
 	_modifiedHandler();
 }
 
+void CodeEdit::onTextChanged(void) {
+	if (_textChangedHandler == nullptr || _changes.empty())
+		return;
+
+	Changes changes;
+	changes.swap(_changes);
+	_textChangedHandler(changes);
+}
+
 void CodeEdit::onChanged(const Coordinates &start, const Coordinates &end, int offset) {
 	Coordinates s, e;
 	if (start < end) {
@@ -3351,6 +8259,9 @@ void CodeEdit::onChanged(const Coordinates &start, const Coordinates &end, int o
 			line.change();
 		}
 	}
+	updateLineWidths(s.line, e.line);
+	if (_foldTree->size() > 0)
+		validateFolds(s.line, e.line);
 }
 
 /* ========================================================} */
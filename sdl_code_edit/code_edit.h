@@ -13,6 +13,7 @@
 
 #include <array>
 #include <assert.h>
+#include <atomic>
 #include <functional>
 #include <map>
 #include <memory>
@@ -22,6 +23,8 @@
 #include <unordered_set>
 #include <vector>
 
+struct SDL_Texture;
+
 /*
 ** {========================================================
 ** Code edit
@@ -54,13 +57,24 @@ public:
 		LineEdited,
 		LineEditedSaved,
 		LineEditedReverted,
+		MatchingBracket,
+		SymbolOccurrence,
+		CompletionBackground,
 		Max
 	};
 
 	enum ShortcutType {
 		UndoRedo = 1 << 0,
 		CopyCutPaste = 1 << 2,
-		All = UndoRedo | CopyCutPaste
+		Folding = 1 << 3,
+		Brackets = 1 << 4,
+		Completion = 1 << 5,
+		All = UndoRedo | CopyCutPaste | Folding | Brackets | Completion
+	};
+
+	enum ColorizeState {
+		WithinMultiLineComment = 1 << 0,
+		WithinString = 1 << 1
 	};
 
 	struct Vec2 {
@@ -177,6 +191,8 @@ public:
 
 	typedef std::unordered_set<int> Breakpoints;
 
+	typedef std::map<int, int> Folds; // Header line -> last hidden line, both 0-based.
+
 	typedef std::array<unsigned, (size_t)PaletteIndex::Max> Palette;
 
 	typedef unsigned short CodePoint;
@@ -188,8 +204,8 @@ public:
 	typedef int32_t Keycode;
 
 	struct Glyph {
+		Char character = 0; // Leads so that a glyph packs into 8 bytes, and whole text scans stream.
 		CodePoint codepoint = 0;
-		Char character = 0;
 		PaletteIndex colorIndex : 7;
 		bool multiLineComment : 1;
 
@@ -203,8 +219,79 @@ public:
 		EditedReverted
 	};
 
-	struct Line : public std::vector<Glyph> {
+	struct SymbolSpan {
+		int column = 0; // Glyph index where the identifier begins.
+		int length = 0; // In glyphs.
+		int id = 0; // Index in the symbol table of the widget.
+
+		SymbolSpan() {
+		}
+		SymbolSpan(int col, int len, int i) : column(col), length(len), id(i) {
+		}
+	};
+
+	typedef std::vector<SymbolSpan> SymbolSpans;
+
+	typedef std::vector<std::string> Symbols;
+
+	struct GlyphPool;
+
+	static void* allocateGlyphs(GlyphPool* pool, size_t bytes); // From the heap if the pool is nullptr.
+	static void deallocateGlyphs(GlyphPool* pool, void* ptr, size_t bytes);
+
+	template<typename T> struct GlyphAllocator {
+		typedef T value_type;
+		typedef std::true_type propagate_on_container_copy_assignment;
+		typedef std::true_type propagate_on_container_move_assignment;
+		typedef std::true_type propagate_on_container_swap;
+
+		GlyphPool* pool = nullptr; // Owned along with the lines, used by one thread at a time as they are.
+
+		GlyphAllocator() {
+		}
+		explicit GlyphAllocator(GlyphPool* p) : pool(p) {
+		}
+		template<typename U> GlyphAllocator(const GlyphAllocator<U> &o) : pool(o.pool) {
+		}
+
+		T* allocate(size_t n) {
+			return (T*)allocateGlyphs(pool, n * sizeof(T));
+		}
+		void deallocate(T* ptr, size_t n) {
+			deallocateGlyphs(pool, ptr, n * sizeof(T));
+		}
+
+		template<typename U> bool operator == (const GlyphAllocator<U> &o) const {
+			return pool == o.pool;
+		}
+		template<typename U> bool operator != (const GlyphAllocator<U> &o) const {
+			return pool != o.pool;
+		}
+	};
+
+	struct Line : public std::vector<Glyph, GlyphAllocator<Glyph> > {
 		LineState changed = LineState::None;
+		bool colorized = false; // Whether token colors are up to date.
+		bool commentsChecked = false; // Whether multi-line comment flags are computed from `enterState`.
+		uint8_t enterState = 0; // `ColorizeState` at the beginning of this line.
+		uint8_t exitState = 0; // `ColorizeState` at the end of this line.
+		int width = 0; // Display width in columns, as counted in `_lineWidths`.
+		mutable std::vector<int> offsets; // Display offsets at every checkpoint column, built on demand.
+		std::vector<int> wraps; // Columns where the wrapped rows after the first one begin.
+		mutable bool folded = false; // Whether hidden by a collapsed fold region, as of the last row tree build.
+		bool minimapDrawn = false; // Whether the minimap shows the current glyphs and colors of this line.
+		mutable int bracketCloses = 0; // Closing brackets not matched within the line.
+		mutable int bracketOpens = 0; // Opening brackets not matched within the line.
+		mutable bool bracketsIndexed = false;
+		mutable bool foldsIndexed = false;
+		mutable int foldCloses = 0; // Region ends not matched within the line, as of the colors when indexed.
+		mutable int foldOpens = 0; // Region starts not matched within the line.
+		SymbolSpans symbols; // Identifiers as colorized, counted in the symbol index.
+
+		Line() {
+		}
+		explicit Line(const GlyphAllocator<Glyph> &alloc) : std::vector<Glyph, GlyphAllocator<Glyph> >(alloc) {
+		}
 
 		void clear(void);
 		void change(void);
@@ -214,19 +301,154 @@ public:
 
 	typedef std::vector<Line> Lines;
 
+	struct Snapshot {
+		struct Chunk {
+			std::string bytes; // UTF-8 lines, each followed by a '\n'.
+			std::vector<int> starts; // Where each line begins in `bytes`, and the end of the last one.
+		};
+
+		typedef std::shared_ptr<const Chunk> ChunkPtr;
+
+		struct Text {
+			const char* first = nullptr;
+			const char* last = nullptr;
+
+			Text() {
+			}
+			Text(const char* f, const char* l) : first(f), last(l) {
+			}
+			const char* begin(void) const {
+				return first;
+			}
+			const char* end(void) const {
+				return last;
+			}
+			size_t size(void) const {
+				return last - first;
+			}
+			std::string str(void) const {
+				return std::string(first, last);
+			}
+		};
+
+		struct Iterator { // Over lines, each of which iterates over its bytes.
+			const Snapshot* snapshot = nullptr;
+			size_t chunk = 0;
+			int line = 0; // In the chunk.
+
+			Iterator() {
+			}
+			Iterator(const Snapshot* s, size_t c) : snapshot(s), chunk(c) {
+			}
+			Text operator * (void) const;
+			Iterator &operator ++ (void);
+			bool operator == (const Iterator &o) const {
+				return chunk == o.chunk && line == o.line;
+			}
+			bool operator != (const Iterator &o) const {
+				return chunk != o.chunk || line != o.line;
+			}
+		};
+
+		std::vector<ChunkPtr> chunks; // Immutable, shared with the widget and other snapshots.
+		std::vector<int> firstLines; // Of each chunk.
+		int totalLines = 0;
+
+		int getTotalLines(void) const;
+		Text getLine(int ln) const;
+		Iterator begin(void) const;
+		Iterator end(void) const;
+		std::string getText(const char* newLine = "\n") const;
+	};
+
+	struct Change {
+		Coordinates start; // Of the replaced range, in the text before the change.
+		Coordinates end;
+		std::string text; // Inserted in place of the range, UTF-8 with '\n' line breaks.
+		unsigned version = 0; // Of the text after the change.
+	};
+
+	typedef std::vector<Change> Changes;
+
+	struct DrawList { // Primitives recorded by `render` in drawing order, those of the same state merged.
+		enum class Op : uint8_t {
+			Clip, // To the rectangle `first`.
+			FillRects, // `count` rectangles from `first`.
+			DrawRects, // Outlines, likewise.
+			Text, // `count` bytes from `first` of `texts`, followed by a '\0', at `x` and `y`.
+			Numbers // `count` line numbers counting up from `first`, one every `lineHeight` down from `x` and `y`.
+		};
+
+		struct Rect { // Same layout as `SDL_Rect`.
+			int x = 0, y = 0;
+			int width = 0, height = 0;
+
+			Rect() {
+			}
+			Rect(int _x, int _y, int _w, int _h) : x(_x), y(_y), width(_w), height(_h) {
+			}
+		};
+
+		struct Command {
+			Op op = Op::Clip;
+			bool utf8 = false; // Of text.
+			unsigned color = 0; // Like a palette entry.
+			int x = 0, y = 0; // Of text.
+			int first = 0;
+			int count = 0;
+		};
+
+		typedef std::vector<Command> Commands;
+
+		typedef std::vector<Rect> Rects;
+
+		Commands commands;
+		Rects rects;
+		std::string texts;
+		const void* font = nullptr; // Font data in the `SDL gfx` layout, or nullptr for the default 8x8 font.
+		Vec2 characterSize;
+		int numberWidth = 0; // In characters, line numbers are right aligned to it like "%*d".
+		int lineHeight = 0; // Between line numbers.
+	};
+
+	struct RenderStats { // Of the last `render`, counted by the backend.
+		int commands = 0; // Of the draw list.
+		int drawCalls = 0; // Of rectangles and text.
+		int colorCalls = 0; // Draw color and blend mode changes.
+		int clipCalls = 0; // Clip rectangles set, the one restored included.
+		int clipCallsSkipped = 0; // Clip rectangles already set.
+	};
+
+	struct DrawBackend { // Replays draw lists, to swap in another rasterizer or to record them.
+		virtual ~DrawBackend();
+
+		virtual void replay(void* rnd, const DrawList &list, RenderStats &stats) = 0; // With the renderer passed to `render`, the clip it had is restored after.
+	};
+
 	struct LanguageDefinition {
 		typedef std::pair<std::string, PaletteIndex> TokenRegexString;
 
 		typedef std::vector<TokenRegexString> TokenRegexStrings;
 
+		typedef std::pair<int, PaletteIndex> TokenSpan; // Length in bytes, and color.
+
+		typedef std::vector<TokenSpan> TokenSpans;
+
+		// Tokenizes a line of UTF-8 bytes from the entry state, appends spans and returns
+		// the exit state; bits of `ColorizeState` keep their meaning, others are free to use.
+		typedef std::function<uint8_t(const char* /* begin */, const char* /* end */, uint8_t /* state */, TokenSpans & /* spans */)> Tokenizer;
+
 		std::string name;
 		Keywords keys;
 		Identifiers ids;
 		Identifiers preprocIds;
 		std::string commentStart, commentEnd;
 		Char commentException = '\0';
+		Keywords foldStartKeys, foldEndKeys; // Keywords that open and close fold regions, braces if empty.
+		Keywords foldTrailingKeys; // Keywords that open a fold region only at the end of a line.
 
-		TokenRegexStrings tokenRegexPatterns;
+		TokenRegexStrings tokenRegexPatterns; // Fallback if there is no tokenizer.
+		Tokenizer tokenizer;
 
 		bool caseSensitive;
 
@@ -248,30 +470,85 @@ public:
 
 	typedef std::function<void(bool)> MouseCursorChanged;
 
+	typedef std::function<void(const Changes &)> TextChanged;
+
+	enum class TextEncoding : uint8_t {
+		Utf8,
+		Utf8Bom,
+		Utf16LE,
+		Utf16BE
+	};
+
+	enum class FileResult : uint8_t {
+		Succeeded,
+		Failed,
+		Canceled
+	};
+
+	typedef std::function<void(float)> FileProgressed; // Part of the file done, from 0 to 1.
+
+	typedef std::function<void(FileResult)> FileFinished;
+
+	struct Language; // A language definition with its patterns compiled, immutable, shared by the editors of the language.
+
+	typedef std::shared_ptr<const Language> LanguagePtr;
+
+	struct TaskPool; // Runs background work of editors on a bounded number of threads.
+
 	CodeEdit();
 	virtual ~CodeEdit();
 
+	static LanguagePtr compileLanguage(const LanguageDefinition &langDef); // Compile once and set it on every editor of the language.
+	const LanguagePtr &getLanguage(void) const;
+	void setLanguage(const LanguagePtr &lang); // Shares it, the default C language if nullptr.
 	const LanguageDefinition &getLanguageDefinition(void) const;
-	LanguageDefinition &getLanguageDefinition(void);
-	LanguageDefinition &setLanguageDefinition(const LanguageDefinition &langDef);
+	LanguageDefinition &getLanguageDefinition(void); // Copies a shared language before it can be modified.
+	LanguageDefinition &setLanguageDefinition(const LanguageDefinition &langDef); // Compiles a language of this editor.
 
 	const Palette &getPalette(void) const;
 	void setPalette(const Palette &val);
 
 	const Vec2 &getCharacterSize(void) const;
 	void setCharacterSize(const Vec2 &val);
+	const void* getFont(void) const;
+	void setFont(const void* data, const Vec2 &size); // Font data in the `SDL gfx` layout, or nullptr for the default 8x8 font.
 
 	void setErrorMarkers(const ErrorMarkers &val);
 	void clearErrorMarkers(void);
 	void setBreakpoints(const Breakpoints &val);
 	void clearBrakpoints(void);
 
+	const Folds &getFolds(void) const;
+	bool foldAt(int ln); // Collapses the region that begins on the line.
+	bool unfoldAt(int ln); // Expands the regions that begin on or hide the line.
+	void unfoldAll(void);
+
+	bool findMatchingBracket(const Coordinates &at, Coordinates &bracket, Coordinates &match) const; // Of the bracket at the position or right before it.
+	bool findEnclosingBrackets(const Coordinates &at, Coordinates &open, Coordinates &close) const; // Innermost pair around the position.
+	bool moveToMatchingBracket(bool select = false);
+
+	Symbols getSymbols(const std::string &prefix, size_t maxCount = 0) const; // Identifiers in the document, sorted, as indexed in background.
+	bool findSymbolOccurrence(const Coordinates &from, bool forward, Coordinates &result) const; // Of the identifier at the position.
+
+	bool isCompletionEnabled(void) const; // Whether typing an identifier opens the completion popup.
+	void setCompletionEnabled(bool en);
+	bool isCompleting(void) const;
+	void complete(void); // Opens the completion popup for the word before the cursor.
+	void cancelCompletion(void);
+
 	void render(void* rnd);
+	void renderMinimap(void* rnd, const Vec4 &rect); // Draws an overview of the lines in the rectangle, scrolls to where it's clicked.
+	const DrawList &getDrawList(void) const; // Recorded by the last `render`.
+	const RenderStats &getRenderStats(void) const;
+	const std::shared_ptr<DrawBackend> &getDrawBackend(void) const;
+	void setDrawBackend(const std::shared_ptr<DrawBackend> &backend); // Draws with SDL and `SDL gfx` if nullptr.
 
 	void setKeyPressedHandler(const KeyPressed &handler);
 	void setColorizedHandler(const Colorized &handler);
 	void setModifiedHandler(const Modified &handler);
 	void setMouseCursorChangedHandler(const MouseCursorChanged &handler);
+	void setTextChangedHandler(const TextChanged &handler); // Called once per frame with the changes made since the last call, in order.
+	unsigned getVersion(void) const; // Counts the changes made to the text.
 	void setChangesCleared(void);
 	void setChangesSaved(void);
 	bool isChangesSaved(void) const;
@@ -279,6 +556,20 @@ public:
 	std::vector<std::string> getTextLines(bool includeComment, bool includeString) const;
 	std::string getText(const char* newLine = "\n") const;
 	void setText(const std::string &txt);
+	Snapshot getSnapshot(void) const; // Of the text, cheap to take and safe to read on any thread.
+	TextEncoding getTextEncoding(void) const; // Detected when the text is set or loaded, used for saving.
+	void setTextEncoding(TextEncoding val);
+	const char* getNewLine(void) const; // Likewise, kept if the text has no line break.
+	void setNewLine(const char* val);
+
+	bool loadFileAsync(const char* path, const FileProgressed &progressed = nullptr, const FileFinished &finished = nullptr); // Replaces the text when done, handlers are called from `render`.
+	bool saveFileAsync(const char* path, const char* newLine = nullptr, const FileProgressed &progressed = nullptr, const FileFinished &finished = nullptr); // Writes a snapshot to a temporary file, then renames it, with the detected line break if `newLine` is nullptr.
+	bool isFileBusy(void) const;
+	void cancelFile(void);
+
+	static std::shared_ptr<TaskPool> createTaskPool(int threads = 0); // With a thread per core if 0.
+	const std::shared_ptr<TaskPool> &getTaskPool(void) const;
+	void setTaskPool(const std::shared_ptr<TaskPool> &pool); // Editors share a default pool unless set, work that began stays on its pool.
 
 	void insertText(const char* val);
 
@@ -303,6 +594,9 @@ public:
 	bool isUtf8SupportEnabled(void) const;
 	void setUtf8SupportEnabled(bool val);
 
+	bool isWordWrapEnabled(void) const;
+	void setWordWrapEnabled(bool val);
+
 	bool isOverwrite(void) const;
 	void setOverwrite(bool val);
 
@@ -421,21 +715,109 @@ protected:
 
 	typedef std::basic_string<CodePoint, std::char_traits<CodePoint>, std::allocator<CodePoint> > InputBuffer;
 
+	typedef std::map<int, int> LineWidths; // Display width -> number of lines of that width.
+
+	typedef std::pair<int, int> BracketBalance; // Unmatched closing and opening brackets of a range of lines.
+
+	typedef std::pair<int, Snapshot::ChunkPtr> SnapshotSlot; // Number of lines, and their chunk or nullptr if changed.
+
+	struct RowTree;
+
+	struct FoldTree;
+
+	struct BracketTree;
+
+	struct SymbolIndex;
+
+	struct CompletionPopup;
+
+	struct FileTask;
+
+	struct ColorTask;
+
+	struct DrawRecorder;
+
 	void colorize(int fromLine = 0, int lines = -1);
 	void colorizeRange(int fromLine = 0, int toLine = 0);
 	void colorizeInternal(void);
+	bool colorizeVisible(int fromLine, int toLine);
+	void startColorTask(int fromLine);
+	bool resumeColorTask(void);
+	void postColorParts(int fromLine);
+	void updateColorTask(void);
+	uint8_t checkMultilineComments(Line &line, uint8_t state);
+	uint8_t tokenizeLine(Line &line, uint8_t state);
+	static uint8_t lexLine(const LanguageDefinition &langDef, const char* begin, const char* end, uint8_t state, LanguageDefinition::TokenSpans &spans);
+	static PaletteIndex classifyIdentifier(const LanguageDefinition &langDef, std::string &id, bool preproc);
+	uint8_t resolveEntryState(int ln);
 	int textDistanceToLineStart(const Coordinates &from) const;
+	int advanceDistance(const Glyph &g, int distance) const;
+	const std::vector<int> &getLineOffsets(const Line &line) const;
+	void updateLineWidths(int fromLine, int toLine);
+	void rebuildLineWidths(void);
+	int getLongestLineWidth(void) const;
+	void updateWrapLayout(void);
+	int wrapLine(int ln);
+	void breakLine(Line &line);
+	void buildWrapRowTree(void) const;
+	void addWrapRows(int ln, int diff);
+	void shiftRows(int ln, int count);
+	void refreshFolded(int fromLine, int toLine);
+	int lineToRow(int ln) const;
+	int rowToLine(int row, int &lineRow) const;
+	int getTotalRows(void) const;
+	int getRowInLine(const Line &line, int column) const;
+	bool usesRowTree(void) const;
+	bool isFoldHeader(int ln) const;
+	int findFoldEnd(int ln, int lastLine = -1); // Searched up to the last line, or the end if -1.
+	int findFoldEnd(int ln, int lastLine, int &opens, int &depth); // Also gives the regions the line opens and those open at the end.
+	BracketBalance foldBalance(int ln);
+	void shiftFolds(int ln, int count);
+	void validateFolds(int fromLine, int toLine);
+	void indexFolds(const Line &line) const;
+	void updateFolds(int ln); // Checks the folds over the line in the next frame if its regions changed.
+	void drawMinimapLine(const Line &line, unsigned* pixels, int width) const;
+	void indexBrackets(const Line &line) const;
+	void updateBrackets(int ln);
+	void setBrackets(int ln, const BracketBalance &balance);
+	void buildBracketTree(void) const;
+	void shiftBrackets(int ln, int count);
+	void updateSymbols(int ln);
+	void removeSymbols(int start, int end);
+	const SymbolSpan* getSymbolAt(const Coordinates &pos) const;
+	void reindexLine(int ln);
+	Coordinates findIdentifierStart(const Coordinates &from) const;
+	bool openCompletion(bool manual);
+	void updateCompletion(void);
+	bool handleCompletionKeys(void);
+	bool clickCompletion(const Vec2 &pos);
+	void acceptCompletion(void);
+	void drawCompletion(void);
+	bool findBracketForward(const Coordinates &from, int need, Coordinates &result) const;
+	bool findBracketBackward(const Coordinates &from, int need, Coordinates &result) const;
+	Snapshot::ChunkPtr buildSnapshotChunk(int fromLine, int lines) const;
+	void invalidateSnapshot(int fromLine, int toLine);
+	void shiftSnapshot(int ln, int count);
+	int coordinatesToRow(const Coordinates &pos, int &distance) const;
+	Coordinates rowPosToCoordinates(int row, int distance) const;
 	int getPageSize(void) const;
 	Coordinates getActualCursorCoordinates(void) const;
 	Coordinates sanitizeCoordinates(const Coordinates &val) const;
 	void advance(Coordinates &val) const;
 	int getCharacterWidth(const Glyph &g) const;
+	int getWideCharacterWidth(void) const;
 	Coordinates screenPosToCoordinates(const Vec2 &pos) const;
 	bool isOnWordBoundary(const Coordinates &at) const;
 	void addUndo(UndoRecord &val);
+	void recordChange(const Coordinates &start, const Coordinates &end, const std::string &text);
+	void recordChanges(const UndoRecord &u, bool undone);
 	std::string getText(const Coordinates &start, const Coordinates &end, const char* newLine = "\n") const;
 	int appendBuffer(std::string &buf, const Glyph &g, int idx, int &width);
+	Line createLine(void) const;
+	void replaceLines(Lines &lines, std::shared_ptr<GlyphPool> &pool);
+	void updateFileTask(void);
 	int insertTextAt(Coordinates &where, const char* val);
+	void insertTextAtCursor(const char* val);
 	void removeRange(const Coordinates &start, const Coordinates &end);
 	void removeSelection(void);
 	Line &insertLine(int idx);
@@ -451,8 +833,12 @@ protected:
 	void onColorized(bool multilineComment) const;
 	void onModified(void) const;
 	void onChanged(const Coordinates &start, const Coordinates &end, int offset);
+	void onTextChanged(void);
 
+	std::shared_ptr<GlyphPool> _glyphPool; // Of the lines, outlives them.
 	Lines _codeLines;
+	LineWidths _lineWidths;
+	bool _lineWidthsDirty = true;
 	float _lineSpacing = 1.0f;
 	EditorState _state;
 	UndoBuffer _undoBuf;
@@ -462,11 +848,31 @@ protected:
 	Colorized _colorizedHandler;
 	Modified _modifiedHandler;
 	MouseCursorChanged _mouseCursorChangedHandler;
+	TextChanged _textChangedHandler;
+	Changes _changes; // Not handed over to the text changed handler yet.
+	unsigned _version = 0;
 
 	Vec2 _charAdv;
 	int _tabSize = 4;
 	int _textStart = 7;
 	bool _utf8SupportEnabled = false;
+	bool _wordWrapEnabled = false;
+	int _wrapColumns = 0; // Row width the wraps are computed for, 0 if not laid out yet.
+	int _wrapLayoutNext = -1; // Lines from here are laid out again in idle time, -1 if all are.
+	std::shared_ptr<RowTree> _rowTree; // Rows of each line, none for folded ones.
+	mutable bool _wrapRowTreeDirty = true;
+	std::shared_ptr<BracketTree> _bracketTree; // Bracket balance of each line, moved along with the lines in logarithmic time.
+	mutable bool _bracketTreeDirty = true;
+	mutable std::vector<SnapshotSlot> _snapshotSlots; // Consecutive lines, chunks are built on demand.
+	mutable bool _snapshotSlotsDirty = true;
+	std::shared_ptr<TaskPool> _taskPool; // Runs the work of the background tasks below.
+	std::shared_ptr<std::atomic<bool> > _versionToken; // Set when the text changes, to drop the work on the former version, nullptr if not handed out.
+	std::shared_ptr<SymbolIndex> _symbolIndex; // Interns identifiers, counts and sorts them on the pool.
+	std::shared_ptr<CompletionPopup> _completion; // Candidates and state of the completion popup.
+	bool _completionEnabled = true;
+	TextEncoding _textEncoding = TextEncoding::Utf8;
+	std::string _newLine = "\n";
+	std::shared_ptr<FileTask> _fileTask; // Loads or saves on the pool, nullptr if idle.
 	bool _overwrite = false;
 	bool _readonly = false;
 	ShortcutType _shortcutsEnabled = ShortcutType::All;
@@ -475,16 +881,32 @@ protected:
 	bool _wordSelectionMode = false;
 	int _colorRangeMin = 0, _colorRangeMax = 0;
 	int _checkMultilineComments = 0;
+	int _multilineCommentsChecked = 0;
+	std::vector<uint8_t> _entryStates; // Entering every `COLORIZE_CHECKPOINT_LINES`-th line, as far as resolved.
+	std::shared_ptr<ColorTask> _colorTask; // Colorizes a large text on the pool, nullptr if idle.
 	bool _tooltipEnabled = true;
 
 	Breakpoints _breakpoints;
 	ErrorMarkers _errorMarkers;
+	std::shared_ptr<FoldTree> _foldTree; // Folds by their headers, moved along with the lines in logarithmic time.
+	mutable Folds _folds; // Filled from the fold tree when asked for.
+	int _foldsStaleFrom = 0, _foldsStaleTo = -1; // Lines colorized again since the folds were checked.
 	Coordinates _interactiveStart, _interactiveEnd;
 
-	LanguageDefinition _langDef;
+	LanguagePtr _language; // Shared with other editors and the background tasks.
 	Palette _palette;
 	Vec2 _characterSize = Vec2(8, 8);
-	RegexList _regexes;
+	const void* _font = nullptr;
+	std::shared_ptr<DrawRecorder> _drawRecorder; // Sorts what `render` draws into layers.
+	DrawList _drawList;
+	RenderStats _renderStats;
+	std::shared_ptr<DrawBackend> _drawBackend; // The SDL one owns the glyph cache of this widget.
+	std::string _tokenBuffer;
+	LanguageDefinition::TokenSpans _tokenSpans;
+	std::shared_ptr<SDL_Texture> _minimapTexture; // Streaming, row `n` holds a line whose index modulo the height is `n`.
+	void* _minimapRenderer = nullptr;
+	std::vector<int> _minimapRowLines; // Line drawn on each row of the minimap texture, -1 for none.
+	int _minimapStaleFrom = 0; // Lines from here moved since the minimap was updated.
 
 	Vec2 _widgetPos;
 	Vec2 _widgetSize;
@@ -0,0 +1,214 @@
+/*
+** SDL Code Edit
+**
+** Copyright (C) 2018 Wang Renxin
+**
+** Benchmark of colorization: each built-in language definition with its
+** tokenizer and with the tokenizer cleared, which falls back to the regexes.
+** Then the time to load, replace and destroy a large text, and the peak RSS.
+**
+** For the latest info, see https://github.com/paladin-t/sdl_code_edit/
+*/
+
+#define NOMINMAX
+#include "../code_edit.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+#ifdef _WIN32
+#	include <Windows.h>
+#	include <psapi.h>
+#	ifdef _MSC_VER
+#		pragma comment(lib, "psapi.lib")
+#	endif /* _MSC_VER */
+#else /* _WIN32 */
+#	include <sys/resource.h>
+#endif /* _WIN32 */
+
+#ifndef BENCH_LINES
+#	define BENCH_LINES 15000 // Below the count colorized in parallel, so all work is timed here.
+#endif /* BENCH_LINES */
+
+#ifndef BENCH_LARGE_LINES
+#	define BENCH_LARGE_LINES 1000000
+#endif /* BENCH_LARGE_LINES */
+
+struct CodeEditBench : public CodeEdit {
+	void colorizeAll(void) {
+		colorizeVisible(0, getTotalLines()); // Checks comments and colorizes like the visible lines.
+	}
+};
+
+static const char* SAMPLE_C =
+	"#include <stdio.h>\n"
+	"/* Prints the sum of the arguments,\n"
+	"   one per line. */\n"
+	"int main(int argc, char* argv[]) {\n"
+	"\tfloat sum = 0.5e-1f + 0x1F; // Start value.\n"
+	"\tfor (int i = 1; i < argc; ++i) {\n"
+	"\t\tsum += (float)atof(argv[i]);\n"
+	"\t\tprintf(\"%d: \\\"%s\\\" %c\\n\", i, argv[i], '\\t');\n"
+	"\t}\n"
+	"\n"
+	"\treturn sizeof(sum) > 4 ? 1 : 0;\n"
+	"}\n";
+
+static const char* SAMPLE_LUA =
+	"-- Sums the fields of a table.\n"
+	"local t = { a = 1, b = 2.5e3, c = \"x\\\"y\" }\n"
+	"--[[ A long comment\n"
+	"     over lines ]] local s = [==[ long\n"
+	"string ]==]\n"
+	"function sum(tbl)\n"
+	"\tlocal n = 0\n"
+	"\tfor k, v in pairs(tbl) do\n"
+	"\t\tif type(v) == 'number' then n = n + v end\n"
+	"\tend\n"
+	"\treturn n\n"
+	"end\n";
+
+static const char* SAMPLE_SQL =
+	"-- Totals per customer.\n"
+	"SELECT c.name, SUM(o.amount) AS total\n"
+	"FROM customers c /* joined\n"
+	"   with orders */ INNER JOIN orders o ON o.customer = c.id\n"
+	"WHERE c.note <> 'it''s' AND o.amount > 2.5\n"
+	"GROUP BY c.name ORDER BY total DESC;\n"
+	"INSERT INTO log VALUES (1, 'done');\n";
+
+static const char* SAMPLE_BASIC8 =
+	"' Sums a list.\n"
+	"rem Another comment\n"
+	"'[ A comment\n"
+	"   over lines ']\n"
+	"let l = list(1, 2.5, 0x1f)\n"
+	"s = 0\n"
+	"for i = 0 to len(l) - 1\n"
+	"\ts = s + get(l, i)\n"
+	"next\n"
+	"if s > 3 then print \"sum: \", s else print \"none\" endif\n";
+
+static std::string repeat(const char* sample, int lines) {
+	std::string result;
+	int n = 0;
+	while (n < lines) {
+		result += sample;
+		for (const char* c = sample; *c; ++c) {
+			if (*c == '\n')
+				++n;
+		}
+	}
+
+	return result;
+}
+
+static double elapsed(std::chrono::steady_clock::time_point since) {
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - since).count();
+}
+
+static double peakRss(void) {
+	// In MB.
+#ifdef _WIN32
+	PROCESS_MEMORY_COUNTERS counters;
+	if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+		return 0.0;
+
+	return (double)counters.PeakWorkingSetSize / (1024.0 * 1024.0);
+#else /* _WIN32 */
+	struct rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage) != 0)
+		return 0.0;
+#	ifdef __APPLE__
+	return (double)usage.ru_maxrss / (1024.0 * 1024.0); // In bytes.
+#	else /* __APPLE__ */
+	return (double)usage.ru_maxrss / 1024.0; // In kilobytes.
+#	endif /* __APPLE__ */
+#endif /* _WIN32 */
+}
+
+static void printTiming(const char* path, size_t bytes, double ms) {
+	const double mb = (double)bytes / (1024.0 * 1024.0);
+	printf("%s %dk: %.1fms (%.2f MB/s)\n", path, (int)(bytes / 1024), ms, ms > 0.0 ? mb * 1000.0 / ms : 0.0);
+}
+
+static double benchColorize(const CodeEdit::LanguageDefinition &langDef, const std::string &text, const char* path) {
+	CodeEditBench edit;
+	edit.setLanguageDefinition(langDef);
+	edit.setText(text);
+
+	const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	edit.colorizeAll();
+	const double ms = elapsed(start);
+	printTiming(path, text.size(), ms);
+
+	return ms;
+}
+
+static void benchLoad(const std::string &text) {
+	// Run last, since the peak RSS only grows.
+	const double baseRss = peakRss();
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	CodeEdit* edit = new CodeEdit();
+	edit->setText(text);
+	printTiming("setText  ", text.size(), elapsed(start));
+	printf("peak RSS +%.0fMB for %dk lines\n", peakRss() - baseRss, edit->getTotalLines() / 1000);
+
+	start = std::chrono::steady_clock::now();
+	edit->setText(text);
+	printTiming("replace  ", text.size(), elapsed(start));
+
+	start = std::chrono::steady_clock::now();
+	delete edit;
+	printf("destroy: %.1fms\n", elapsed(start));
+}
+
+static void printLine(void) {
+	printf("------------------------------------------------------------------------\n\n");
+}
+
+int main(int argc, char* argv[]) {
+	const int lines = argc > 1 ? atoi(argv[1]) : BENCH_LINES;
+	const int largeLines = argc > 2 ? atoi(argv[2]) : BENCH_LARGE_LINES;
+
+	struct {
+		const char* name;
+		CodeEdit::LanguageDefinition langDef;
+		const char* sample;
+	} langs[] = {
+		{ "AngelScript", CodeEdit::LanguageDefinition::AngelScript(), SAMPLE_C },
+		{ "C", CodeEdit::LanguageDefinition::C(), SAMPLE_C },
+		{ "C++", CodeEdit::LanguageDefinition::CPlusPlus(), SAMPLE_C },
+		{ "GLSL", CodeEdit::LanguageDefinition::GLSL(), SAMPLE_C },
+		{ "HLSL", CodeEdit::LanguageDefinition::HLSL(), SAMPLE_C },
+		{ "Lua", CodeEdit::LanguageDefinition::Lua(), SAMPLE_LUA },
+		{ "SQL", CodeEdit::LanguageDefinition::SQL(), SAMPLE_SQL },
+		{ "BASIC8", CodeEdit::LanguageDefinition::BASIC8(), SAMPLE_BASIC8 }
+	};
+
+	printf("BenchCodeEdit\n\n");
+	printf("Colorizing %d lines of each language, with its tokenizer and with\n", lines);
+	printf("the tokenizer cleared so that the regexes are used.\n\n");
+
+	printLine();
+
+	for (auto &lang : langs) {
+		const std::string text = repeat(lang.sample, lines);
+		printf("%s\n", lang.name);
+
+		const double lexed = benchColorize(lang.langDef, text, "tokenizer");
+
+		CodeEdit::LanguageDefinition regexDef = lang.langDef;
+		regexDef.tokenizer = nullptr;
+		const double matched = benchColorize(regexDef, text, "regex    ");
+
+		printf("tokenizer x%.1f\n", lexed > 0.0 ? matched / lexed : 0.0);
+		printLine();
+	}
+
+	printf("Loading %d lines of C\n", largeLines);
+	benchLoad(repeat(SAMPLE_C, largeLines));
+	printLine();
+
+	return 0;
+}
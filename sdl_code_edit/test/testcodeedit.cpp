@@ -0,0 +1,221 @@
+/*
+** SDL Code Edit
+**
+** Test of the folds, rows and bracket pairs kept along with edits: after
+** random inserts, removes and folds, the editor must agree with an editor
+** built from scratch with the same text and folds.
+**
+** For the latest info, see https://github.com/paladin-t/sdl_code_edit/
+*/
+
+#define NOMINMAX
+#include "../code_edit.h"
+#include <SDL.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+
+#ifndef TEST_ITERATIONS
+#	define TEST_ITERATIONS 3000
+#endif /* TEST_ITERATIONS */
+
+#ifndef TEST_CHECK_INTERVAL
+#	define TEST_CHECK_INTERVAL 10 // Edits between the comparisons.
+#endif /* TEST_CHECK_INTERVAL */
+
+struct CodeEditTest : public CodeEdit {
+	void type(const char* text) {
+		// Undoable, unlike `insertText`.
+		for (const char* c = text; *c; ++c)
+			enterCharacter(*c);
+	}
+
+	void settle(void* rnd) {
+		// Finishes the work amortized over frames, the folds are checked again in a frame
+		// after the colors changed.
+		colorizeVisible(0, getTotalLines());
+		unsigned frame = getFrameCount();
+		do {
+			setFrameCount(++frame);
+			render(rnd);
+		} while (_wrapLayoutNext >= 0 || _foldsStaleFrom <= _foldsStaleTo);
+	}
+};
+
+static const char* PIECES[] = {
+	"void f(int x) {\n",
+	"\tif (x[0]) {\n",
+	"}\n",
+	"\t}\n",
+	"\tcall(a, (b + c) * [d]);\n",
+	"\t/* { ( */\n",
+	"/*\n",
+	"*/\n",
+	"\ts = \"{(\"; // }\n",
+	"\tc = '}';\n",
+	"\tthe quick brown fox jumps over the lazy dog, again and again\n",
+	"{",
+	"}",
+	"(",
+	")",
+	"[",
+	"]",
+	"\n",
+	"x"
+};
+
+static const int PIECE_COUNT = sizeof(PIECES) / sizeof(PIECES[0]);
+
+static int total_count = 0;
+static int ok_count = 0;
+
+static CodeEdit::Coordinates randomPosition(const std::vector<int> &lengths) {
+	const int ln = rand() % (int)lengths.size();
+
+	return CodeEdit::Coordinates(ln, rand() % (lengths[ln] + 1));
+}
+
+static void edit(CodeEditTest &test) {
+	// The pieces are ASCII, so the bytes of a line are its columns.
+	std::vector<int> lengths(1, 0);
+	for (char c : test.getText()) {
+		if (c == '\n')
+			lengths.push_back(0);
+		else
+			++lengths.back();
+	}
+	CodeEdit::Coordinates pos = randomPosition(lengths);
+	switch (rand() % 10) {
+	case 0:
+	case 1:
+	case 2:
+		test.setCursorPosition(pos);
+		test.setSelection(pos, pos);
+		test.type(PIECES[rand() % PIECE_COUNT]);
+
+		break;
+	case 3:
+	case 4: {
+			// Up to the same column a few lines below, so that about as much is removed as inserted.
+			const int ln = std::min(pos.line + rand() % 3, (int)lengths.size() - 1);
+			const CodeEdit::Coordinates end(ln, std::min(pos.column + rand() % 4, lengths[ln]));
+			test.setSelection(std::min(pos, end), std::max(pos, end));
+			test.remove();
+		}
+
+		break;
+	case 5:
+	case 6:
+		test.foldAt(pos.line);
+
+		break;
+	case 7:
+		if (rand() % 4 == 0)
+			test.unfoldAll();
+		else
+			test.unfoldAt(pos.line);
+
+		break;
+	case 8:
+		test.undo();
+
+		break;
+	default:
+		test.redo();
+
+		break;
+	}
+}
+
+static void check(const char* label, bool ok, int iteration) {
+	++total_count;
+	if (ok)
+		++ok_count;
+	else
+		printf("ERROR %s after %d edits\n", label, iteration);
+}
+
+static void compare(CodeEditTest &test, void* rnd, int iteration) {
+	test.settle(rnd); // The folds are final once the pending checks ran.
+
+	CodeEditTest built;
+	built.setFont(nullptr, test.getCharacterSize());
+	built.setWidgetSize(test.getWidgetSize());
+	built.setWordWrapEnabled(test.isWordWrapEnabled());
+	built.setText(test.getText());
+	built.settle(rnd);
+	for (const std::pair<const int, int> &fold : test.getFolds())
+		built.foldAt(fold.first);
+	built.settle(rnd);
+
+	check("folds", test.getFolds() == built.getFolds(), iteration);
+	check("content height", test.getContentSize().y == built.getContentSize().y, iteration);
+
+	bool brackets = true;
+	const std::string text = test.getText();
+	CodeEdit::Coordinates pos;
+	for (size_t i = 0; i < text.size(); ++i) {
+		if (text[i] == '\n') {
+			++pos.line;
+			pos.column = 0;
+
+			continue;
+		}
+		if (strchr("{}()[]", text[i])) {
+			CodeEdit::Coordinates testBracket, testMatch, builtBracket, builtMatch;
+			const bool testFound = test.findMatchingBracket(pos, testBracket, testMatch);
+			const bool builtFound = built.findMatchingBracket(pos, builtBracket, builtMatch);
+			if (testFound != builtFound || (testFound && (!(testBracket == builtBracket) || !(testMatch == builtMatch))))
+				brackets = false;
+		}
+		++pos.column;
+	}
+	check("matching brackets", brackets, iteration);
+}
+
+int main(int argc, char* argv[]) {
+	const unsigned seed = argc > 1 ? (unsigned)atoi(argv[1]) : 1;
+	const int iterations = argc > 2 ? atoi(argv[2]) : TEST_ITERATIONS;
+	srand(seed);
+
+	SDL_Surface* surface = SDL_CreateRGBSurfaceWithFormat(0, 320, 240, 32, SDL_PIXELFORMAT_ARGB8888);
+	SDL_Renderer* rnd = surface ? SDL_CreateSoftwareRenderer(surface) : nullptr;
+	if (!rnd) {
+		printf("Cannot create a renderer: %s\n", SDL_GetError());
+
+		return 1;
+	}
+
+	printf("TestCodeEdit\n\n");
+	printf("%d random edits with seed %u, compared every %d edits with an\n", iterations, seed, TEST_CHECK_INTERVAL);
+	printf("editor built from scratch.\n\n");
+
+	CodeEditTest test;
+	test.setFont(nullptr, CodeEdit::Vec2(8, 8));
+	test.setWidgetSize(CodeEdit::Vec2(320, 240));
+	std::string text;
+	for (int i = 0; i < 200; ++i)
+		text += PIECES[rand() % 11];
+	test.setText(text);
+
+	for (int i = 1; i <= iterations; ++i) {
+		edit(test);
+		test.setFrameCount(test.getFrameCount() + 1);
+		test.render(rnd); // Lets some of the amortized work run between edits.
+		if (i % 500 == 0) {
+			test.setWordWrapEnabled(!test.isWordWrapEnabled());
+			test.setWidgetSize(CodeEdit::Vec2((float)(160 + rand() % 320), 240));
+		}
+		if (i % TEST_CHECK_INTERVAL == 0)
+			compare(test, rnd, i);
+	}
+
+	SDL_DestroyRenderer(rnd);
+	SDL_FreeSurface(surface);
+
+	printf("%d lines, %d folds\n", test.getTotalLines(), (int)test.getFolds().size());
+	printf("%d of %d comparisons OK\n", ok_count, total_count);
+
+	return ok_count == total_count ? 0 : 1;
+}
@@ -3476,49 +3476,128 @@ int texturedPolygon2(SDL_Renderer *renderer, const Sint16 * vx, const Sint16 * v
 /* ---- Character */
 
 /*!
-\brief Global cache for NxM pixel font textures created at runtime.
+\brief Number of glyphs held by one atlas page of the character cache.
 */
-static SDL_Texture *gfxPrimitivesFont[256];
+#define GFX_FONT_PAGE_GLYPHS 256
 
 /*!
-\brief Pointer to the current font data. Default is a 8x8 pixel internal font. 
+\brief Number of glyph columns in one atlas page. Pages are square.
 */
-static const unsigned char *currentFontdata = gfxPrimitivesFontdata;
+#define GFX_FONT_PAGE_COLUMNS 16
 
 /*!
-\brief Width of the current font. Default is 8. 
+\brief Number of pages needed to cover all Unicode codepoints.
 */
-static Uint32 charWidth = 8;
+#define GFX_FONT_PAGE_COUNT (0x110000 / GFX_FONT_PAGE_GLYPHS)
 
 /*!
-\brief Height of the current font. Default is 8. 
+\brief One atlas page of the character cache, holding the glyphs of 256 consecutive codepoints.
 */
-static Uint32 charHeight = 8;
+typedef struct {
+	/*! \brief Texture with GFX_FONT_PAGE_COLUMNS x GFX_FONT_PAGE_COLUMNS glyph cells. */
+	SDL_Texture *texture;
+	/*! \brief One bit per cell, set when the glyph was rasterized into the texture. */
+	Uint32 loaded[GFX_FONT_PAGE_GLYPHS / 32];
+} gfxPrimitivesFontPage;
 
 /*!
-\brief Width for rendering. Autocalculated.
-*/
-static Uint32 charWidthLocal = 8;
+\brief A font bound to a renderer, with its own character cache.
 
-/*!
-\brief Height for rendering. Autocalculated.
+Contexts share no state, so each renderer (or thread) can draw with its own context.
 */
-static Uint32 charHeightLocal = 8;
+struct gfxFontContext {
+	/*! \brief The renderer the cached textures belong to. */
+	SDL_Renderer *renderer;
+	/*! \brief Pointer to the font data. Default is a 8x8 pixel internal font. */
+	const unsigned char *fontdata;
+	/*! \brief Optional glyph lookup for codepoints beyond the font data. Default is NULL. */
+	gfxPrimitivesGlyphFunc glyphFunc;
+	/*! \brief User data passed to the glyph lookup. */
+	void *glyphUserdata;
+	/*! \brief Width of the font. Default is 8. */
+	Uint32 charWidth;
+	/*! \brief Height of the font. Default is 8. */
+	Uint32 charHeight;
+	/*! \brief Width for rendering. Autocalculated. */
+	Uint32 charWidthLocal;
+	/*! \brief Height for rendering. Autocalculated. */
+	Uint32 charHeightLocal;
+	/*! \brief Pitch of the font in bytes. Default is 1. */
+	Uint32 charPitch;
+	/*! \brief Characters 90deg clockwise rotations. Default is 0. Max is 3. */
+	Uint32 charRotation;
+	/*! \brief Character data size in bytes of the font. Default is 8. */
+	Uint32 charSize;
+	/*! \brief Atlas cache indexed by codepoint / 256; pages are allocated lazily when a codepoint of the page is drawn for the first time. */
+	gfxPrimitivesFontPage *pages[GFX_FONT_PAGE_COUNT];
+	/*! \brief Scratch array of codepoints used while drawing strings. */
+	Uint32 *codepoints;
+	/*! \brief Number of codepoints allocated in the scratch array. */
+	int codepointsAllocated;
+	/*! \brief Scratch array of pixels used while rasterizing glyphs. */
+	Uint32 *pixels;
+	/*! \brief Number of pixels allocated in the glyph scratch array. */
+	Uint32 pixelsAllocated;
+};
 
 /*!
-\brief Pitch of the current font in bytes. Default is 1. 
+\brief Global font context used by the gfxPrimitivesSetFont... and string/character functions.
+
+It is bound to the renderer of the latest draw call, drawing to another renderer resets its cache.
 */
-static Uint32 charPitch = 1;
+static gfxFontContext gfxPrimitivesFontGlobal = { NULL, gfxPrimitivesFontdata, NULL, NULL, 8, 8, 8, 8, 1, 0, 8, { NULL }, NULL, 0, NULL, 0 };
 
 /*!
-\brief Characters 90deg clockwise rotations. Default is 0. Max is 3. 
+\brief Internal function to destroy all pages of the character cache of a font context.
 */
-static Uint32 charRotation = 0;
+static void _gfxFontContextClearCache(gfxFontContext *ctx)
+{
+	int i;
+
+	for (i = 0; i < GFX_FONT_PAGE_COUNT; i++) {
+		if (ctx->pages[i]) {
+			if (ctx->pages[i]->texture) {
+				SDL_DestroyTexture(ctx->pages[i]->texture);
+			}
+			free(ctx->pages[i]);
+			ctx->pages[i] = NULL;
+		}
+	}
+}
 
 /*!
-\brief Character data size in bytes of the current font. Default is 8. 
+\brief Internal function to set the font data of a font context, and to reset its cache.
 */
-static Uint32 charSize = 8;
+static void _gfxFontContextSetFont(gfxFontContext *ctx, const void *fontdata, Uint32 cw, Uint32 ch)
+{
+	if ((fontdata) && (cw) && (ch)) {
+		ctx->fontdata = (unsigned char *)fontdata;
+		ctx->charWidth = cw;
+		ctx->charHeight = ch;
+	} else {
+		ctx->fontdata = gfxPrimitivesFontdata;
+		ctx->charWidth = 8;
+		ctx->charHeight = 8;
+	}
+
+	ctx->charPitch = (ctx->charWidth+7)/8;
+	ctx->charSize = ctx->charPitch * ctx->charHeight;
+
+	/* Maybe flip width/height for rendering */
+	if ((ctx->charRotation==1) || (ctx->charRotation==3))
+	{
+		ctx->charWidthLocal = ctx->charHeight;
+		ctx->charHeightLocal = ctx->charWidth;
+	}
+	else
+	{
+		ctx->charWidthLocal = ctx->charWidth;
+		ctx->charHeightLocal = ctx->charHeight;
+	}
+
+	/* Clear character cache */
+	_gfxFontContextClearCache(ctx);
+}
 
 /*!
 \brief Sets or resets the current global font data.
@@ -3535,40 +3614,22 @@ The font data array is organized in follows:
 */
 void gfxPrimitivesSetFont(const void *fontdata, Uint32 cw, Uint32 ch)
 {
-	int i;
+	_gfxFontContextSetFont(&gfxPrimitivesFontGlobal, fontdata, cw, ch);
+}
 
-	if ((fontdata) && (cw) && (ch)) {
-		currentFontdata = (unsigned char *)fontdata;
-		charWidth = cw;
-		charHeight = ch;
-	} else {
-		currentFontdata = gfxPrimitivesFontdata;
-		charWidth = 8;
-		charHeight = 8;
-	}
+/*!
+\brief Sets the glyph lookup used for codepoints beyond the 256 characters of the global font data.
 
-	charPitch = (charWidth+7)/8;
-	charSize = charPitch * charHeight;
+The lookup returns the glyph of a codepoint in the layout of one [character n] entry of the
+font data set by gfxPrimitivesSetFont, or NULL if the font has no such glyph, in which case
+'?' is drawn. Changing the lookup will reset the character cache.
 
-	/* Maybe flip width/height for rendering */
-	if ((charRotation==1) || (charRotation==3))
-	{
-		charWidthLocal = charHeight;
-		charHeightLocal = charWidth;
-	}
-	else
-	{
-		charWidthLocal = charWidth;
-		charHeightLocal = charHeight;
-	}
-
-	/* Clear character cache */
-	for (i = 0; i < 256; i++) {
-		if (gfxPrimitivesFont[i]) {
-			SDL_DestroyTexture(gfxPrimitivesFont[i]);
-			gfxPrimitivesFont[i] = NULL;
-		}
-	}
+\param func The glyph lookup. Set to NULL to draw '?' for all codepoints above 255.
+\param userdata User data passed to the lookup.
+*/
+void gfxPrimitivesSetFontGlyphFunc(gfxPrimitivesGlyphFunc func, void *userdata)
+{
+	gfxFontContextSetGlyphFunc(&gfxPrimitivesFontGlobal, func, userdata);
 }
 
 /*!
@@ -3581,161 +3642,609 @@ Changing the rotation, will reset the character cache.
 */
 void gfxPrimitivesSetFontRotation(Uint32 rotation)
 {
-	int i;
+	gfxFontContextSetRotation(&gfxPrimitivesFontGlobal, rotation);
+}
+
+/*!
+\brief Returns the data of the default 8x8 font.
+
+The glyphs are 8 bytes each, one per row, in character order; see gfxPrimitivesSetFont for the layout.
+
+\returns Pointer to the font data.
+*/
+const unsigned char *gfxPrimitivesGetDefaultFont(void)
+{
+	return (gfxPrimitivesFontdata);
+}
+
+/*!
+\brief Creates a font context bound to a renderer.
+
+The context caches the glyphs it draws independently of the global font and of other contexts.
+See gfxPrimitivesSetFont for the layout of the font data.
+
+\param renderer The renderer the context draws on.
+\param fontdata Pointer to array of font data. Set to NULL, to use the default 8x8 font.
+\param cw Width of character in bytes. Ignored if fontdata==NULL.
+\param ch Height of character in bytes. Ignored if fontdata==NULL.
+
+\returns The new context, or NULL on failure.
+*/
+gfxFontContext *gfxFontContextCreate(SDL_Renderer *renderer, const void *fontdata, Uint32 cw, Uint32 ch)
+{
+	gfxFontContext *ctx = (gfxFontContext *)calloc(1, sizeof(gfxFontContext));
+	if (ctx == NULL) {
+		return (NULL);
+	}
+	ctx->renderer = renderer;
+	_gfxFontContextSetFont(ctx, fontdata, cw, ch);
+
+	return (ctx);
+}
+
+/*!
+\brief Destroys a font context and its cached glyphs.
+
+\param ctx The context to destroy; can be NULL.
+*/
+void gfxFontContextDestroy(gfxFontContext *ctx)
+{
+	if (ctx == NULL) {
+		return;
+	}
+	_gfxFontContextClearCache(ctx);
+	if (ctx->codepoints) {
+		free(ctx->codepoints);
+	}
+	if (ctx->pixels) {
+		free(ctx->pixels);
+	}
+	free(ctx);
+}
+
+/*!
+\brief Sets the glyph lookup of a font context used for codepoints above 255.
+
+See gfxPrimitivesSetFontGlyphFunc. Changing the lookup will reset the character cache.
+
+\param ctx The context.
+\param func The glyph lookup. Set to NULL to draw '?' for all codepoints above 255.
+\param userdata User data passed to the lookup.
+*/
+void gfxFontContextSetGlyphFunc(gfxFontContext *ctx, gfxPrimitivesGlyphFunc func, void *userdata)
+{
+	ctx->glyphFunc = func;
+	ctx->glyphUserdata = userdata;
 
+	/* Clear character cache */
+	_gfxFontContextClearCache(ctx);
+}
+
+/*!
+\brief Sets character rotation steps of a font context.
+
+See gfxPrimitivesSetFontRotation. Changing the rotation, will reset the character cache.
+
+\param ctx The context.
+\param rotation Number of 90deg clockwise steps to rotate
+*/
+void gfxFontContextSetRotation(gfxFontContext *ctx, Uint32 rotation)
+{
 	rotation = rotation & 3;
-	if (charRotation != rotation)
+	if (ctx->charRotation != rotation)
 	{
 		/* Store rotation */
-		charRotation = rotation;
+		ctx->charRotation = rotation;
 
-		/* Maybe flip width/height for rendering */
-		if ((charRotation==1) || (charRotation==3))
-		{
-			charWidthLocal = charHeight;
-			charHeightLocal = charWidth;
-		}
-		else
-		{
-			charWidthLocal = charWidth;
-			charHeightLocal = charHeight;
-		}
+		/* Recalculates rendering size, and clears character cache */
+		_gfxFontContextSetFont(ctx, ctx->fontdata, ctx->charWidth, ctx->charHeight);
+	}
+}
 
-		/* Clear character cache */
-		for (i = 0; i < 256; i++) {
-			if (gfxPrimitivesFont[i]) {
-				SDL_DestroyTexture(gfxPrimitivesFont[i]);
-				gfxPrimitivesFont[i] = NULL;
-			}
-		}
+/*!
+\brief Internal function to look up the bitmap of a codepoint in the font of a context.
+
+\param ctx The context.
+\param cp The codepoint.
+
+\returns Pointer to the glyph bitmap; the bitmap of '?' if the font has no glyph for the codepoint.
+*/
+static const unsigned char *_gfxFontContextGlyphData(gfxFontContext *ctx, Uint32 cp)
+{
+	const unsigned char *data = NULL;
+
+	if (cp < 256) {
+		return (ctx->fontdata + cp * ctx->charSize);
 	}
+	if (ctx->glyphFunc) {
+		data = (const unsigned char *)ctx->glyphFunc(cp, ctx->glyphUserdata);
+	}
+	if (data == NULL) {
+		data = ctx->fontdata + '?' * ctx->charSize;
+	}
+
+	return (data);
 }
 
 /*!
-\brief Draw a character of the currently set font.
+\brief Internal function to get the atlas page holding a codepoint, rasterizing the glyph if not already present.
 
-\param renderer The Renderer to draw on.
-\param x X (horizontal) coordinate of the upper left corner of the character.
-\param y Y (vertical) coordinate of the upper left corner of the character.
-\param c The character to draw.
-\param r The red value of the character to draw. 
-\param g The green value of the character to draw. 
-\param b The blue value of the character to draw. 
-\param a The alpha value of the character to draw.
+\param ctx The context.
+\param cp The codepoint, must be below 0x110000.
 
-\returns Returns 0 on success, -1 on failure.
+\returns The page, or NULL on failure.
 */
-int characterRGBA(SDL_Renderer *renderer, Sint16 x, Sint16 y, char c, Uint8 r, Uint8 g, Uint8 b, Uint8 a)
+static gfxPrimitivesFontPage *_gfxFontContextCacheGlyph(gfxFontContext *ctx, Uint32 cp)
 {
-	SDL_Rect srect;
-	SDL_Rect drect;
-	int result;
-	Uint32 ix, iy;
+	gfxPrimitivesFontPage *page;
+	Uint32 ci = cp % GFX_FONT_PAGE_GLYPHS;
+	Uint32 count = ctx->charWidth * ctx->charHeight;
+	Uint32 ix, iy, dx, dy;
 	const unsigned char *charpos;
-	Uint8 *curpos;
 	Uint8 patt, mask;
-	Uint8 *linepos;
-	Uint32 pitch;
-	SDL_Surface *character;
-	SDL_Surface *rotatedCharacter;
-	Uint32 ci;
+	SDL_Rect crect;
+
+	page = ctx->pages[cp / GFX_FONT_PAGE_GLYPHS];
+	if (page && (page->loaded[ci / 32] & (1u << (ci % 32)))) {
+		return (page);
+	}
 
 	/*
-	* Setup source rectangle
+	* Make sure the glyph scratch array is large enough, for a whole page if it must be cleared
 	*/
-	srect.x = 0;
-	srect.y = 0;
-	srect.w = charWidthLocal;
-	srect.h = charHeightLocal;
+	if (page == NULL) {
+		count *= GFX_FONT_PAGE_GLYPHS;
+	}
+	if (ctx->pixelsAllocated < count) {
+		Uint32 *pixels = (Uint32 *)realloc(ctx->pixels, sizeof(Uint32) * count);
+		if (pixels == NULL) {
+			return (NULL);
+		}
+		ctx->pixels = pixels;
+		ctx->pixelsAllocated = count;
+	}
+
+	/*
+	* Create the page texture if not already present, with all cells cleared
+	*/
+	if (page == NULL) {
+		page = (gfxPrimitivesFontPage *)calloc(1, sizeof(gfxPrimitivesFontPage));
+		if (page == NULL) {
+			return (NULL);
+		}
+		page->texture = SDL_CreateTexture(ctx->renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_STATIC,
+			ctx->charWidthLocal * GFX_FONT_PAGE_COLUMNS, ctx->charHeightLocal * GFX_FONT_PAGE_COLUMNS);
+		if (page->texture == NULL) {
+			free(page);
+			return (NULL);
+		}
+		SDL_SetTextureBlendMode(page->texture, SDL_BLENDMODE_BLEND);
+		memset(ctx->pixels, 0, sizeof(Uint32) * count);
+		if (SDL_UpdateTexture(page->texture, NULL, ctx->pixels, ctx->charWidthLocal * GFX_FONT_PAGE_COLUMNS * 4) != 0) {
+			SDL_DestroyTexture(page->texture);
+			free(page);
+			return (NULL);
+		}
+		ctx->pages[cp / GFX_FONT_PAGE_GLYPHS] = page;
+	}
+
+	/*
+	* Redraw character into scratch pixels, rotated as needed
+	*/
+	charpos = _gfxFontContextGlyphData(ctx, cp);
+	patt = 0;
+	for (iy = 0; iy < ctx->charHeight; iy++) {
+		mask = 0x00;
+		for (ix = 0; ix < ctx->charWidth; ix++) {
+			if (!(mask >>= 1)) {
+				patt = *charpos++;
+				mask = 0x80;
+			}
+			switch (ctx->charRotation)
+			{
+			case 1:
+				dx = ctx->charHeight - iy - 1;
+				dy = ix;
+				break;
+			case 2:
+				dx = ctx->charWidth - ix - 1;
+				dy = ctx->charHeight - iy - 1;
+				break;
+			case 3:
+				dx = iy;
+				dy = ctx->charWidth - ix - 1;
+				break;
+			default:
+				dx = ix;
+				dy = iy;
+				break;
+			}
+			ctx->pixels[dy * ctx->charWidthLocal + dx] = (patt & mask) ? 0xffffffff : 0;
+		}
+	}
 
 	/*
-	* Setup destination rectangle
+	* Upload into the cell of the page
 	*/
-	drect.x = x;
-	drect.y = y;
-	drect.w = charWidthLocal;
-	drect.h = charHeightLocal;
+	crect.x = (ci % GFX_FONT_PAGE_COLUMNS) * ctx->charWidthLocal;
+	crect.y = (ci / GFX_FONT_PAGE_COLUMNS) * ctx->charHeightLocal;
+	crect.w = ctx->charWidthLocal;
+	crect.h = ctx->charHeightLocal;
+	if (SDL_UpdateTexture(page->texture, &crect, ctx->pixels, ctx->charWidthLocal * 4) != 0) {
+		return (NULL);
+	}
+	page->loaded[ci / 32] |= 1u << (ci % 32);
+
+	return (page);
+}
+
+/*!
+\brief Internal function to draw a run of codepoints, batched per atlas page.
+
+All glyphs of one page are set up with a single color modulation, and submitted with a
+single SDL_RenderGeometry call where available.
+
+\param ctx The context to draw with.
+\param x X (horizontal) coordinate of the upper left corner of the first character.
+\param y Y (vertical) coordinate of the upper left corner of the first character.
+\param cps The codepoints to draw; entries are overwritten.
+\param n Number of codepoints.
+\param r The red value of the characters to draw. 
+\param g The green value of the characters to draw. 
+\param b The blue value of the characters to draw. 
+\param a The alpha value of the characters to draw.
+
+\returns Returns 0 on success, -1 on failure.
+*/
+static int _gfxFontContextDrawCodepoints(gfxFontContext *ctx, Sint16 x, Sint16 y, Uint32 *cps, int n, Uint8 r, Uint8 g, Uint8 b, Uint8 a)
+{
+	int result = 0;
+	int i, j, dx = 0, dy = 0;
+	Uint32 pi, ci;
+	gfxPrimitivesFontPage *page;
+	SDL_Rect srect;
+	SDL_Rect drect;
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+	SDL_Vertex vertices[4 * 64];
+	int indices[6 * 64];
+	int k, count;
+	float tw, th;
+	SDL_Color color;
+	color.r = r;
+	color.g = g;
+	color.b = b;
+	color.a = a;
+#endif
 
-	/* Character index in cache */
-	ci = (unsigned char) c;
+	switch (ctx->charRotation)
+	{
+	case 0:
+		dx = ctx->charWidthLocal;
+		break;
+	case 2:
+		dx = -(int)ctx->charWidthLocal;
+		break;
+	case 1:
+		dy = ctx->charHeightLocal;
+		break;
+	case 3:
+		dy = -(int)ctx->charHeightLocal;
+		break;
+	}
 
 	/*
-	* Create new charWidth x charHeight bitmap surface if not already present.
-	* Might get rotated later.
+	* Rasterize missing glyphs first; unknown codepoints become '?'
 	*/
-	if (gfxPrimitivesFont[ci] == NULL) {
-		/*
-		* Redraw character into surface
-		*/
-		character =	SDL_CreateRGBSurface(SDL_SWSURFACE,
-			charWidth, charHeight, 32,
-			0xFF000000, 0x00FF0000, 0x0000FF00, 0x000000FF);
-		if (SDL_MUSTLOCK(character)) {
-			assert(0);
+	for (i = 0; i < n; i++) {
+		if (cps[i] >= 0x110000) {
+			cps[i] = '?';
 		}
-		if (character == NULL) {
+		if (_gfxFontContextCacheGlyph(ctx, cps[i]) == NULL) {
 			return (-1);
 		}
+	}
 
-		charpos = currentFontdata + ci * charSize;
-				linepos = (Uint8 *)character->pixels;
-		pitch = character->pitch;
+	srect.w = drect.w = ctx->charWidthLocal;
+	srect.h = drect.h = ctx->charHeightLocal;
 
-		/*
-		* Drawing loop 
-		*/
-		patt = 0;
-		for (iy = 0; iy < charHeight; iy++) {
-			mask = 0x00;
-			curpos = linepos;
-			for (ix = 0; ix < charWidth; ix++) {
-				if (!(mask >>= 1)) {
-					patt = *charpos++;
-					mask = 0x80;
-				}
-				if (patt & mask) {
-					*(Uint32 *)curpos = 0xffffffff;
-				} else {
-					*(Uint32 *)curpos = 0;
-				}
-				curpos += 4;
+	/*
+	* Draw page by page; drawn entries are marked with 0xffffffff
+	*/
+	for (i = 0; i < n && !result; i++) {
+		if (cps[i] == 0xffffffff) {
+			continue;
+		}
+		pi = cps[i] / GFX_FONT_PAGE_GLYPHS;
+		page = ctx->pages[pi];
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+		tw = 1.0f / (float)(ctx->charWidthLocal * GFX_FONT_PAGE_COLUMNS);
+		th = 1.0f / (float)(ctx->charHeightLocal * GFX_FONT_PAGE_COLUMNS);
+		result |= SDL_SetTextureColorMod(page->texture, 255, 255, 255);
+		result |= SDL_SetTextureAlphaMod(page->texture, 255);
+		count = 0;
+		for (j = i; j < n && !result; j++) {
+			if (cps[j] == 0xffffffff || cps[j] / GFX_FONT_PAGE_GLYPHS != pi) {
+				continue;
+			}
+			ci = cps[j] % GFX_FONT_PAGE_GLYPHS;
+			srect.x = (ci % GFX_FONT_PAGE_COLUMNS) * ctx->charWidthLocal;
+			srect.y = (ci / GFX_FONT_PAGE_COLUMNS) * ctx->charHeightLocal;
+			drect.x = x + j * dx;
+			drect.y = y + j * dy;
+			for (k = 0; k < 4; k++) {
+				SDL_Vertex *v = &vertices[count * 4 + k];
+				v->position.x = (float)(drect.x + ((k & 1) ? drect.w : 0));
+				v->position.y = (float)(drect.y + ((k & 2) ? drect.h : 0));
+				v->color = color;
+				v->tex_coord.x = (srect.x + ((k & 1) ? srect.w : 0)) * tw;
+				v->tex_coord.y = (srect.y + ((k & 2) ? srect.h : 0)) * th;
+			}
+			indices[count * 6 + 0] = count * 4 + 0;
+			indices[count * 6 + 1] = count * 4 + 1;
+			indices[count * 6 + 2] = count * 4 + 2;
+			indices[count * 6 + 3] = count * 4 + 1;
+			indices[count * 6 + 4] = count * 4 + 3;
+			indices[count * 6 + 5] = count * 4 + 2;
+			cps[j] = 0xffffffff;
+			if (++count == 64) {
+				result |= SDL_RenderGeometry(ctx->renderer, page->texture, vertices, count * 4, indices, count * 6);
+				count = 0;
 			}
-			linepos += pitch;
 		}
-
-		/* Maybe rotate and replace cached image */
-		if (charRotation>0)
-		{
-			rotatedCharacter = rotateSurface90Degrees(character, charRotation);
-			SDL_FreeSurface(character);
-			character = rotatedCharacter;
+		if (count) {
+			result |= SDL_RenderGeometry(ctx->renderer, page->texture, vertices, count * 4, indices, count * 6);
+		}
+#else
+		result |= SDL_SetTextureColorMod(page->texture, r, g, b);
+		result |= SDL_SetTextureAlphaMod(page->texture, a);
+		for (j = i; j < n && !result; j++) {
+			if (cps[j] == 0xffffffff || cps[j] / GFX_FONT_PAGE_GLYPHS != pi) {
+				continue;
+			}
+			ci = cps[j] % GFX_FONT_PAGE_GLYPHS;
+			srect.x = (ci % GFX_FONT_PAGE_COLUMNS) * ctx->charWidthLocal;
+			srect.y = (ci / GFX_FONT_PAGE_COLUMNS) * ctx->charHeightLocal;
+			drect.x = x + j * dx;
+			drect.y = y + j * dy;
+			result |= SDL_RenderCopy(ctx->renderer, page->texture, &srect, &drect);
+			cps[j] = 0xffffffff;
 		}
+#endif
+	}
 
-		/* Convert temp surface into texture */
-		gfxPrimitivesFont[ci] = SDL_CreateTextureFromSurface(renderer, character);
-		SDL_FreeSurface(character);
+	return (result);
+}
 
-		/*
-		* Check pointer 
-		*/
-		if (gfxPrimitivesFont[ci] == NULL) {
-			return (-1);
+/*!
+\brief Internal function to make sure the codepoint scratch array of a context holds at least n entries.
+
+\returns The array, or NULL on failure.
+*/
+static Uint32 *_gfxFontContextCodepoints(gfxFontContext *ctx, int n)
+{
+	if (ctx->codepointsAllocated < n) {
+		Uint32 *cps = (Uint32 *)realloc(ctx->codepoints, sizeof(Uint32) * n);
+		if (cps == NULL) {
+			return (NULL);
 		}
+		ctx->codepoints = cps;
+		ctx->codepointsAllocated = n;
 	}
 
-	/*
-	* Set color 
-	*/
-	result = 0;
-	result |= SDL_SetTextureColorMod(gfxPrimitivesFont[ci], r, g, b);
-	result |= SDL_SetTextureAlphaMod(gfxPrimitivesFont[ci], a);
+	return (ctx->codepoints);
+}
+
+/*!
+\brief Internal function to get the global font context bound to a renderer.
+
+\param renderer The renderer to draw on; the cache is reset if it differs from the previous one.
+
+\returns The global context.
+*/
+static gfxFontContext *_gfxPrimitivesFontContext(SDL_Renderer *renderer)
+{
+	gfxFontContext *ctx = &gfxPrimitivesFontGlobal;
+	if (ctx->renderer != renderer) {
+		_gfxFontContextClearCache(ctx);
+		ctx->renderer = renderer;
+	}
+
+	return (ctx);
+}
+
+/*!
+\brief Draw a character with a font context.
+
+\param ctx The context to draw with.
+\param x X (horizontal) coordinate of the upper left corner of the character.
+\param y Y (vertical) coordinate of the upper left corner of the character.
+\param c The character to draw.
+\param r The red value of the character to draw. 
+\param g The green value of the character to draw. 
+\param b The blue value of the character to draw. 
+\param a The alpha value of the character to draw.
+
+\returns Returns 0 on success, -1 on failure.
+*/
+int fontCharacterRGBA(gfxFontContext *ctx, Sint16 x, Sint16 y, char c, Uint8 r, Uint8 g, Uint8 b, Uint8 a)
+{
+	Uint32 cp = (unsigned char) c;
+
+	return (_gfxFontContextDrawCodepoints(ctx, x, y, &cp, 1, r, g, b, a));
+}
+
+/*!
+\brief Draw a character with a font context.
+
+\param ctx The context to draw with.
+\param x X (horizontal) coordinate of the upper left corner of the character.
+\param y Y (vertical) coordinate of the upper left corner of the character.
+\param c The character to draw.
+\param color The color value of the character to draw (0xRRGGBBAA). 
+
+\returns Returns 0 on success, -1 on failure.
+*/
+int fontCharacterColor(gfxFontContext *ctx, Sint16 x, Sint16 y, char c, Uint32 color)
+{
+	Uint8 *co = (Uint8 *)&color; 
+	return fontCharacterRGBA(ctx, x, y, c, co[0], co[1], co[2], co[3]);
+}
+
+/*!
+\brief Draw a string with a font context.
+
+\param ctx The context to draw with.
+\param x X (horizontal) coordinate of the upper left corner of the string.
+\param y Y (vertical) coordinate of the upper left corner of the string.
+\param s The string to draw.
+\param r The red value of the string to draw. 
+\param g The green value of the string to draw. 
+\param b The blue value of the string to draw. 
+\param a The alpha value of the string to draw.
+
+\returns Returns 0 on success, -1 on failure.
+*/
+int fontStringRGBA(gfxFontContext *ctx, Sint16 x, Sint16 y, const char *s, Uint8 r, Uint8 g, Uint8 b, Uint8 a)
+{
+	int i;
+	int n = (int)strlen(s);
+	Uint32 *cps;
+
+	if (n == 0) {
+		return (0);
+	}
+	cps = _gfxFontContextCodepoints(ctx, n);
+	if (cps == NULL) {
+		return (-1);
+	}
+	for (i = 0; i < n; i++) {
+		cps[i] = (unsigned char) s[i];
+	}
+
+	return (_gfxFontContextDrawCodepoints(ctx, x, y, cps, n, r, g, b, a));
+}
+
+/*!
+\brief Draw a string with a font context.
+
+\param ctx The context to draw with.
+\param x X (horizontal) coordinate of the upper left corner of the string.
+\param y Y (vertical) coordinate of the upper left corner of the string.
+\param s The string to draw.
+\param color The color value of the string to draw (0xRRGGBBAA). 
+
+\returns Returns 0 on success, -1 on failure.
+*/
+int fontStringColor(gfxFontContext *ctx, Sint16 x, Sint16 y, const char *s, Uint32 color)
+{
+	Uint8 *c = (Uint8 *)&color; 
+	return fontStringRGBA(ctx, x, y, s, c[0], c[1], c[2], c[3]);
+}
+
+/*!
+\brief Draw an UTF-8 encoded string with a font context.
+
+Each codepoint advances by one character cell. Codepoints above 255 are drawn with the glyph
+lookup of the context; malformed sequences are drawn as '?'.
+
+\param ctx The context to draw with.
+\param x X (horizontal) coordinate of the upper left corner of the string.
+\param y Y (vertical) coordinate of the upper left corner of the string.
+\param s The string to draw.
+\param r The red value of the string to draw. 
+\param g The green value of the string to draw. 
+\param b The blue value of the string to draw. 
+\param a The alpha value of the string to draw.
+
+\returns Returns 0 on success, -1 on failure.
+*/
+int fontUtf8StringRGBA(gfxFontContext *ctx, Sint16 x, Sint16 y, const char *s, Uint8 r, Uint8 g, Uint8 b, Uint8 a)
+{
+	int n = 0;
+	int len, k;
+	const unsigned char *p = (const unsigned char *)s;
+	Uint32 *cps;
+	Uint32 cp;
+
+	if (*p == '\0') {
+		return (0);
+	}
+	cps = _gfxFontContextCodepoints(ctx, (int)strlen(s));
+	if (cps == NULL) {
+		return (-1);
+	}
 
 	/*
-	* Draw texture onto destination 
-	*/
-	result |= SDL_RenderCopy(renderer, gfxPrimitivesFont[ci], &srect, &drect);
+	* Decode; there are never more codepoints than bytes
+	*/
+	while (*p) {
+		if (*p < 0x80) {
+			cp = *p;
+			len = 1;
+		} else if ((*p & 0xe0) == 0xc0) {
+			cp = *p & 0x1f;
+			len = 2;
+		} else if ((*p & 0xf0) == 0xe0) {
+			cp = *p & 0x0f;
+			len = 3;
+		} else if ((*p & 0xf8) == 0xf0) {
+			cp = *p & 0x07;
+			len = 4;
+		} else {
+			cp = '?';
+			len = 1;
+		}
+		for (k = 1; k < len; k++) {
+			if ((p[k] & 0xc0) != 0x80) {
+				break;
+			}
+			cp = (cp << 6) | (p[k] & 0x3f);
+		}
+		if (k < len) {
+			cp = '?';
+			len = k;
+		}
+		cps[n++] = cp;
+		p += len;
+	}
 
-	return (result);
+	return (_gfxFontContextDrawCodepoints(ctx, x, y, cps, n, r, g, b, a));
+}
+
+/*!
+\brief Draw an UTF-8 encoded string with a font context.
+
+\param ctx The context to draw with.
+\param x X (horizontal) coordinate of the upper left corner of the string.
+\param y Y (vertical) coordinate of the upper left corner of the string.
+\param s The string to draw.
+\param color The color value of the string to draw (0xRRGGBBAA). 
+
+\returns Returns 0 on success, -1 on failure.
+*/
+int fontUtf8StringColor(gfxFontContext *ctx, Sint16 x, Sint16 y, const char *s, Uint32 color)
+{
+	Uint8 *c = (Uint8 *)&color; 
+	return fontUtf8StringRGBA(ctx, x, y, s, c[0], c[1], c[2], c[3]);
+}
+
+/*!
+\brief Draw a character of the currently set font.
+
+\param renderer The Renderer to draw on.
+\param x X (horizontal) coordinate of the upper left corner of the character.
+\param y Y (vertical) coordinate of the upper left corner of the character.
+\param c The character to draw.
+\param r The red value of the character to draw. 
+\param g The green value of the character to draw. 
+\param b The blue value of the character to draw. 
+\param a The alpha value of the character to draw.
+
+\returns Returns 0 on success, -1 on failure.
+*/
+int characterRGBA(SDL_Renderer *renderer, Sint16 x, Sint16 y, char c, Uint8 r, Uint8 g, Uint8 b, Uint8 a)
+{
+	return fontCharacterRGBA(_gfxPrimitivesFontContext(renderer), x, y, c, r, g, b, a);
 }
 
 
@@ -3793,32 +4302,46 @@ int stringColor(SDL_Renderer * renderer, Sint16 x, Sint16 y, const char *s, Uint
 */
 int stringRGBA(SDL_Renderer * renderer, Sint16 x, Sint16 y, const char *s, Uint8 r, Uint8 g, Uint8 b, Uint8 a)
 {
-	int result = 0;
-	Sint16 curx = x;
-	Sint16 cury = y;
-	const char *curchar = s;
+	return fontStringRGBA(_gfxPrimitivesFontContext(renderer), x, y, s, r, g, b, a);
+}
 
-	while (*curchar && !result) {
-		result |= characterRGBA(renderer, curx, cury, *curchar, r, g, b, a);
-		switch (charRotation)
-		{
-		case 0:
-			curx += charWidthLocal;
-			break;
-		case 2:
-			curx -= charWidthLocal;
-			break;
-		case 1:
-			cury += charHeightLocal;
-			break;
-		case 3:
-			cury -= charHeightLocal;
-			break;
-		}
-		curchar++;
-	}
+/*!
+\brief Draw an UTF-8 encoded string in the currently set font.
 
-	return (result);
+Each codepoint advances by one character cell. Codepoints above 255 are drawn with the glyph
+lookup set by gfxPrimitivesSetFontGlyphFunc; malformed sequences are drawn as '?'.
+
+\param renderer The renderer to draw on.
+\param x X (horizontal) coordinate of the upper left corner of the string.
+\param y Y (vertical) coordinate of the upper left corner of the string.
+\param s The string to draw.
+\param color The color value of the string to draw (0xRRGGBBAA). 
+
+\returns Returns 0 on success, -1 on failure.
+*/
+int utf8StringColor(SDL_Renderer * renderer, Sint16 x, Sint16 y, const char *s, Uint32 color)
+{
+	Uint8 *c = (Uint8 *)&color; 
+	return utf8StringRGBA(renderer, x, y, s, c[0], c[1], c[2], c[3]);
+}
+
+/*!
+\brief Draw an UTF-8 encoded string in the currently set font.
+
+\param renderer The renderer to draw on.
+\param x X (horizontal) coordinate of the upper left corner of the string.
+\param y Y (vertical) coordinate of the upper left corner of the string.
+\param s The string to draw.
+\param r The red value of the string to draw. 
+\param g The green value of the string to draw. 
+\param b The blue value of the string to draw. 
+\param a The alpha value of the string to draw.
+
+\returns Returns 0 on success, -1 on failure.
+*/
+int utf8StringRGBA(SDL_Renderer * renderer, Sint16 x, Sint16 y, const char *s, Uint8 r, Uint8 g, Uint8 b, Uint8 a)
+{
+	return fontUtf8StringRGBA(_gfxPrimitivesFontContext(renderer), x, y, s, r, g, b, a);
 }
 
 int primitivePurge(void) {
@@ -3828,6 +4351,16 @@ int primitivePurge(void) {
 	}
 	int ret = gfxPrimitivesPolyAllocatedGlobal;
 	gfxPrimitivesPolyAllocatedGlobal = 0;
+	if (gfxPrimitivesFontGlobal.codepoints) {
+		free(gfxPrimitivesFontGlobal.codepoints);
+		gfxPrimitivesFontGlobal.codepoints = NULL;
+	}
+	gfxPrimitivesFontGlobal.codepointsAllocated = 0;
+	if (gfxPrimitivesFontGlobal.pixels) {
+		free(gfxPrimitivesFontGlobal.pixels);
+		gfxPrimitivesFontGlobal.pixels = NULL;
+	}
+	gfxPrimitivesFontGlobal.pixelsAllocated = 0;
 
 	return ret;
 }
@@ -227,12 +227,33 @@ extern "C" {
 
 	/* Characters/Strings */
 
+	typedef const void *(*gfxPrimitivesGlyphFunc)(Uint32 codepoint, void *userdata);
+
 	SDL2_GFXPRIMITIVES_SCOPE void gfxPrimitivesSetFont(const void *fontdata, Uint32 cw, Uint32 ch);
+	SDL2_GFXPRIMITIVES_SCOPE void gfxPrimitivesSetFontGlyphFunc(gfxPrimitivesGlyphFunc func, void *userdata);
 	SDL2_GFXPRIMITIVES_SCOPE void gfxPrimitivesSetFontRotation(Uint32 rotation);
 	SDL2_GFXPRIMITIVES_SCOPE int characterColor(SDL_Renderer * renderer, Sint16 x, Sint16 y, char c, Uint32 color);
 	SDL2_GFXPRIMITIVES_SCOPE int characterRGBA(SDL_Renderer * renderer, Sint16 x, Sint16 y, char c, Uint8 r, Uint8 g, Uint8 b, Uint8 a);
 	SDL2_GFXPRIMITIVES_SCOPE int stringColor(SDL_Renderer * renderer, Sint16 x, Sint16 y, const char *s, Uint32 color);
 	SDL2_GFXPRIMITIVES_SCOPE int stringRGBA(SDL_Renderer * renderer, Sint16 x, Sint16 y, const char *s, Uint8 r, Uint8 g, Uint8 b, Uint8 a);
+	SDL2_GFXPRIMITIVES_SCOPE int utf8StringColor(SDL_Renderer * renderer, Sint16 x, Sint16 y, const char *s, Uint32 color);
+	SDL2_GFXPRIMITIVES_SCOPE int utf8StringRGBA(SDL_Renderer * renderer, Sint16 x, Sint16 y, const char *s, Uint8 r, Uint8 g, Uint8 b, Uint8 a);
+
+	/* Font contexts; one per renderer and font, independent of the global font above */
+
+	typedef struct gfxFontContext gfxFontContext;
+
+	SDL2_GFXPRIMITIVES_SCOPE const unsigned char *gfxPrimitivesGetDefaultFont(void);
+	SDL2_GFXPRIMITIVES_SCOPE gfxFontContext *gfxFontContextCreate(SDL_Renderer * renderer, const void *fontdata, Uint32 cw, Uint32 ch);
+	SDL2_GFXPRIMITIVES_SCOPE void gfxFontContextDestroy(gfxFontContext * ctx);
+	SDL2_GFXPRIMITIVES_SCOPE void gfxFontContextSetGlyphFunc(gfxFontContext * ctx, gfxPrimitivesGlyphFunc func, void *userdata);
+	SDL2_GFXPRIMITIVES_SCOPE void gfxFontContextSetRotation(gfxFontContext * ctx, Uint32 rotation);
+	SDL2_GFXPRIMITIVES_SCOPE int fontCharacterColor(gfxFontContext * ctx, Sint16 x, Sint16 y, char c, Uint32 color);
+	SDL2_GFXPRIMITIVES_SCOPE int fontCharacterRGBA(gfxFontContext * ctx, Sint16 x, Sint16 y, char c, Uint8 r, Uint8 g, Uint8 b, Uint8 a);
+	SDL2_GFXPRIMITIVES_SCOPE int fontStringColor(gfxFontContext * ctx, Sint16 x, Sint16 y, const char *s, Uint32 color);
+	SDL2_GFXPRIMITIVES_SCOPE int fontStringRGBA(gfxFontContext * ctx, Sint16 x, Sint16 y, const char *s, Uint8 r, Uint8 g, Uint8 b, Uint8 a);
+	SDL2_GFXPRIMITIVES_SCOPE int fontUtf8StringColor(gfxFontContext * ctx, Sint16 x, Sint16 y, const char *s, Uint32 color);
+	SDL2_GFXPRIMITIVES_SCOPE int fontUtf8StringRGBA(gfxFontContext * ctx, Sint16 x, Sint16 y, const char *s, Uint8 r, Uint8 g, Uint8 b, Uint8 a);
 
 	/* Purging */
 
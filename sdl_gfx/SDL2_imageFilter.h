@@ -51,14 +51,17 @@ extern "C" {
 #endif
 
 	/* Comments:                                                                           */
-	/*  1.) MMX functions work best if all data blocks are aligned on a 32 bytes boundary. */
-	/*  2.) Data that is not within an 8 byte boundary is processed using the C routine.   */
-	/*  3.) Convolution routines do not have C routines at this time.                      */
-
-	// Detect MMX capability in CPU
+	/*  1.) SIMD functions use SSE2, or AVX2 when the CPU supports it (runtime detection). */
+	/*      The MMX names of the detection functions below are historical.                 */
+	/*  2.) Data past the last whole 16 (SSE2) or 32 (AVX2) byte block is processed using  */
+	/*      the C routine. Data blocks need no particular alignment.                       */
+	/*  3.) Convolution kernels are arrays of signed shorts with rows padded to 4 words   */
+	/*      (3x3), 8 words (5x5, 7x7) or 12 words (9x9). Border pixels are not written.    */
+
+	// Detect SIMD (SSE2 or AVX2) capability in CPU
 	SDL2_IMAGEFILTER_SCOPE int SDL_imageFilterMMXdetect(void);
 
-	// Force use of MMX off (or turn possible use back on)
+	// Force use of SIMD off (or turn possible use back on)
 	SDL2_IMAGEFILTER_SCOPE void SDL_imageFilterMMXoff(void);
 	SDL2_IMAGEFILTER_SCOPE void SDL_imageFilterMMXon(void);
 
@@ -83,7 +86,7 @@ extern "C" {
 	//  SDL_imageFilterMult: D = saturation(S1 * S2)
 	SDL2_IMAGEFILTER_SCOPE int SDL_imageFilterMult(unsigned char *Src1, unsigned char *Src2, unsigned char *Dest, unsigned int length);
 
-	//  SDL_imageFilterMultNor: D = S1 * S2   (non-MMX)
+	//  SDL_imageFilterMultNor: D = S1 * S2
 	SDL2_IMAGEFILTER_SCOPE int SDL_imageFilterMultNor(unsigned char *Src1, unsigned char *Src2, unsigned char *Dest, unsigned int length);
 
 	//  SDL_imageFilterMultDivby2: D = saturation255(S1/2 * S2)
@@ -100,7 +103,7 @@ extern "C" {
 	//  SDL_imageFilterBitOr: D = S1 | S2
 	SDL2_IMAGEFILTER_SCOPE int SDL_imageFilterBitOr(unsigned char *Src1, unsigned char *Src2, unsigned char *Dest, unsigned int length);
 
-	//  SDL_imageFilterDiv: D = S1 / S2   (non-MMX)
+	//  SDL_imageFilterDiv: D = S1 / S2
 	SDL2_IMAGEFILTER_SCOPE int SDL_imageFilterDiv(unsigned char *Src1, unsigned char *Src2, unsigned char *Dest, unsigned int length);
 
 	//  SDL_imageFilterBitNegation: D = !S
@@ -158,6 +161,45 @@ extern "C" {
 	SDL2_IMAGEFILTER_SCOPE int SDL_imageFilterNormalizeLinear(unsigned char *Src, unsigned char *Dest, unsigned int length, int Cmin,
 		int Cmax, int Nmin, int Nmax);
 
+	//  SDL_imageFilterConvolveKernel3x3Divide: Dij = saturation0and255( sum(Kkl * Si+k,j+l) / Divisor )
+	SDL2_IMAGEFILTER_SCOPE int SDL_imageFilterConvolveKernel3x3Divide(unsigned char *Src, unsigned char *Dest, int rows,
+		int columns, signed short *Kernel, unsigned char Divisor);
+
+	//  SDL_imageFilterConvolveKernel5x5Divide: Dij = saturation0and255( sum(Kkl * Si+k,j+l) / Divisor )
+	SDL2_IMAGEFILTER_SCOPE int SDL_imageFilterConvolveKernel5x5Divide(unsigned char *Src, unsigned char *Dest, int rows,
+		int columns, signed short *Kernel, unsigned char Divisor);
+
+	//  SDL_imageFilterConvolveKernel7x7Divide: Dij = saturation0and255( sum(Kkl * Si+k,j+l) / Divisor )
+	SDL2_IMAGEFILTER_SCOPE int SDL_imageFilterConvolveKernel7x7Divide(unsigned char *Src, unsigned char *Dest, int rows,
+		int columns, signed short *Kernel, unsigned char Divisor);
+
+	//  SDL_imageFilterConvolveKernel9x9Divide: Dij = saturation0and255( sum(Kkl * Si+k,j+l) / Divisor )
+	SDL2_IMAGEFILTER_SCOPE int SDL_imageFilterConvolveKernel9x9Divide(unsigned char *Src, unsigned char *Dest, int rows,
+		int columns, signed short *Kernel, unsigned char Divisor);
+
+	//  SDL_imageFilterConvolveKernel3x3ShiftRight: Dij = saturation0and255( sum(Kkl * (Si+k,j+l >> N)) )
+	SDL2_IMAGEFILTER_SCOPE int SDL_imageFilterConvolveKernel3x3ShiftRight(unsigned char *Src, unsigned char *Dest, int rows,
+		int columns, signed short *Kernel, unsigned char NRightShift);
+
+	//  SDL_imageFilterConvolveKernel5x5ShiftRight: Dij = saturation0and255( sum(Kkl * (Si+k,j+l >> N)) )
+	SDL2_IMAGEFILTER_SCOPE int SDL_imageFilterConvolveKernel5x5ShiftRight(unsigned char *Src, unsigned char *Dest, int rows,
+		int columns, signed short *Kernel, unsigned char NRightShift);
+
+	//  SDL_imageFilterConvolveKernel7x7ShiftRight: Dij = saturation0and255( sum(Kkl * (Si+k,j+l >> N)) )
+	SDL2_IMAGEFILTER_SCOPE int SDL_imageFilterConvolveKernel7x7ShiftRight(unsigned char *Src, unsigned char *Dest, int rows,
+		int columns, signed short *Kernel, unsigned char NRightShift);
+
+	//  SDL_imageFilterConvolveKernel9x9ShiftRight: Dij = saturation0and255( sum(Kkl * (Si+k,j+l >> N)) )
+	SDL2_IMAGEFILTER_SCOPE int SDL_imageFilterConvolveKernel9x9ShiftRight(unsigned char *Src, unsigned char *Dest, int rows,
+		int columns, signed short *Kernel, unsigned char NRightShift);
+
+	//  SDL_imageFilterSobelX: Dij = saturation255( | horizontal Sobel sum | )
+	SDL2_IMAGEFILTER_SCOPE int SDL_imageFilterSobelX(unsigned char *Src, unsigned char *Dest, int rows, int columns);
+
+	//  SDL_imageFilterSobelXShiftRight: Dij = saturation255( | horizontal Sobel sum | >> N )
+	SDL2_IMAGEFILTER_SCOPE int SDL_imageFilterSobelXShiftRight(unsigned char *Src, unsigned char *Dest, int rows, int columns,
+		unsigned char NRightShift);
+
 	/* Ends C function definitions when using C++ */
 #ifdef __cplusplus
 }
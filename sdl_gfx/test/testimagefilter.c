@@ -1,6 +1,6 @@
 /* 
 
-TestImageFilter.c: test program for MMX filter routines
+TestImageFilter.c: test program for SIMD filter routines
 
 (C) A. Schiffler, 2006, zlib license
 (C) Sylvain Beucler, 2013, zlib license
@@ -75,7 +75,7 @@ void print_result(int mmx, char *label, unsigned char *src1, unsigned char *src2
 	}
         printf("\n");
 
-	printf ("%s %s   dest  ",mmx?"MMX":" C ",label);
+	printf ("%s %s   dest  ",mmx?"SIMD":" C  ",label);
         for (i = 0; i < SRC_SIZE; i++)
             printf("%02x ", dst[i]);
         printf("\n");
@@ -92,6 +92,23 @@ void print_compare(unsigned char *dst1, unsigned char *dst2)
 	}
 }
 
+void print_compare_large(unsigned char *dst1, unsigned char *dst2, int n)
+{
+	total_count++;
+	if (bcmp(dst1,dst2,n)==0) {
+		printf ("OK (%d bytes)\n", n);
+		ok_count++;
+	} else {
+		printf ("ERROR (%d bytes)\n", n);
+	}
+}
+
+void print_timing(int mmx, int count, int n, Uint32 ms)
+{
+	double mb = (double)count * n / (1024.0 * 1024.0);
+	printf ("%s %dx%dk: %dms (%.0f MB/s)\n", mmx?"SIMD":" C  ", count, n/1024, ms, ms ? mb * 1000.0 / ms : 0.0);
+}
+
 void print_line() 
 {
 	printf ("------------------------------------------------------------------------\n\n\n");
@@ -102,8 +119,10 @@ void print_line()
 int main(int argc, char *argv[])
 {
 	unsigned char src1[SRC_SIZE], src2[SRC_SIZE], dstm[SRC_SIZE], dstc[SRC_SIZE];
-    int size = 2*1024*1024;
+    /* Odd size, so that the C routines also process the bytes past the last SIMD block */
+    int size = 2*1024*1024 + 13;
     unsigned char *t1 = (unsigned char *)SDL_malloc(size), *t2 = (unsigned char *)SDL_malloc(size), *d = (unsigned char *)SDL_malloc(size);
+    unsigned char *dm = (unsigned char *)SDL_malloc(size);
     int i;
 
 	/* Initialize to make valgrind happy */
@@ -119,7 +138,8 @@ int main(int argc, char *argv[])
 
 	printf ("TestImageFilter\n\n");
 	printf ("Testing an array of 23 bytes - first 16 bytes should be processed\n");
-	printf ("by MMX or C code, the last 7 bytes only by C code.\n\n");
+	printf ("by SSE2 or C code, the last 7 bytes only by C code. AVX2 processes\n");
+	printf ("32 byte blocks and is covered by the comparison of the large buffers.\n\n");
 	
 	print_line();
 	
@@ -160,7 +180,8 @@ int main(int argc, char *argv[])
 			for (i = 0; i < 50; i++) {
 				funcs[k].f(t1, t2, d, size);
 			}
-			printf("MMX %dx%dk: %dms\n", i, size/1024, SDL_GetTicks() - start);
+			print_timing(TEST_MMX, i, size, SDL_GetTicks() - start);
+			memcpy(dm, d, size);
 			
 			SDL_imageFilterMMXoff();
 			funcs[k].f(src1, src2, dstc, SRC_SIZE);
@@ -169,9 +190,10 @@ int main(int argc, char *argv[])
 			for (i = 0; i < 50; i++) {
 				funcs[k].f(t1, t2, d, size);
 			}
-			printf(" C  %dx%dk: %dms\n", i, size/1024, SDL_GetTicks() - start);
+			print_timing(TEST_C, i, size, SDL_GetTicks() - start);
 			
 			print_compare(dstm,dstc);
+			print_compare_large(dm, d, size);
 			print_line();
 		}
         }
@@ -209,7 +231,8 @@ int main(int argc, char *argv[])
 		for (i = 0; i < 50; i++) {
 			SDL_imageFilterBitNegation(t1, d, size);
 		}
-		printf("MMX %dx%dk: %dms\n", i, size/1024, SDL_GetTicks() - start);
+		print_timing(TEST_MMX, i, size, SDL_GetTicks() - start);
+		memcpy(dm, d, size);
 		
 		SDL_imageFilterMMXoff();
 		SDL_imageFilterBitNegation(src1, dstc, SRC_SIZE);
@@ -218,9 +241,10 @@ int main(int argc, char *argv[])
 		for (i = 0; i < 50; i++) {
 			SDL_imageFilterBitNegation(t1, d, size);
 		}
-		printf(" C  %dx%dk: %dms\n", i, size/1024, SDL_GetTicks() - start);
+		print_timing(TEST_C, i, size, SDL_GetTicks() - start);
 		
 		print_compare(dstm,dstc);
+		print_compare_large(dm, d, size);
 		print_line();
         }
 
@@ -262,7 +286,8 @@ int main(int argc, char *argv[])
 			for (i = 0; i < 50; i++) {
 				funcs[k].f(t1, d, size, funcs[k].arg);
 			}
-			printf("MMX %dx%dk: %dms\n", i, size/1024, SDL_GetTicks() - start);
+			print_timing(TEST_MMX, i, size, SDL_GetTicks() - start);
+			memcpy(dm, d, size);
 			
 			SDL_imageFilterMMXoff();
 			funcs[k].f(src1, dstc, SRC_SIZE, funcs[k].arg);
@@ -271,9 +296,10 @@ int main(int argc, char *argv[])
 			for (i = 0; i < 50; i++) {
 				funcs[k].f(t1, d, size, funcs[k].arg);
 			}
-			printf(" C  %dx%dk: %dms\n", i, size/1024, SDL_GetTicks() - start);
+			print_timing(TEST_C, i, size, SDL_GetTicks() - start);
 			
 			print_compare(dstm,dstc);
+			print_compare_large(dm, d, size);
 			print_line();
 		}
         }
@@ -308,7 +334,8 @@ int main(int argc, char *argv[])
 			for (i = 0; i < 50; i++) {
 				funcs[k].f(t1, d, size, funcs[k].arg1, funcs[k].arg2);
 			}
-			printf("MMX %dx%dk: %dms\n", i, size/1024, SDL_GetTicks() - start);
+			print_timing(TEST_MMX, i, size, SDL_GetTicks() - start);
+			memcpy(dm, d, size);
 			
 			SDL_imageFilterMMXoff();
 			funcs[k].f(src1, dstc, SRC_SIZE, funcs[k].arg1, funcs[k].arg2);
@@ -317,9 +344,10 @@ int main(int argc, char *argv[])
 			for (i = 0; i < 50; i++) {
 				funcs[k].f(t1, d, size, funcs[k].arg1, funcs[k].arg2);
 			}
-			printf(" C  %dx%dk: %dms\n", i, size/1024, SDL_GetTicks() - start);
+			print_timing(TEST_C, i, size, SDL_GetTicks() - start);
 			
 			print_compare(dstm,dstc);
+			print_compare_large(dm, d, size);
 			print_line();
 		}
         }
@@ -340,7 +368,8 @@ int main(int argc, char *argv[])
 		for (i = 0; i < 50; i++) {
 			SDL_imageFilterNormalizeLinear(t1, d, size, 0,33, 0,255);
 		}
-		printf("MMX %dx%dk: %dms\n", i, size/1024, SDL_GetTicks() - start);
+		print_timing(TEST_MMX, i, size, SDL_GetTicks() - start);
+		memcpy(dm, d, size);
 		
 		SDL_imageFilterMMXoff();
 		SDL_imageFilterNormalizeLinear(src1, dstc, SRC_SIZE, 0,33, 0,255);
@@ -349,9 +378,10 @@ int main(int argc, char *argv[])
 		for (i = 0; i < 50; i++) {
 			SDL_imageFilterNormalizeLinear(t1, d, size, 0,33, 0,255);
 		}
-		printf(" C  %dx%dk: %dms\n", i, size/1024, SDL_GetTicks() - start);
+		print_timing(TEST_C, i, size, SDL_GetTicks() - start);
 		
 		print_compare(dstm,dstc);
+		print_compare_large(dm, d, size);
 		print_line();
         }
 
@@ -387,7 +417,8 @@ int main(int argc, char *argv[])
 			for (i = 0; i < 50; i++) {
 				funcs[k].f(t1, d, size, funcs[k].arg);
 			}
-			printf("MMX %dx%dk: %dms\n", i, size/1024, SDL_GetTicks() - start);
+			print_timing(TEST_MMX, i, size, SDL_GetTicks() - start);
+			memcpy(dm, d, size);
 			
 			SDL_imageFilterMMXoff();
 			funcs[k].f(src1, dstc, SRC_SIZE, funcs[k].arg);
@@ -396,9 +427,98 @@ int main(int argc, char *argv[])
 			for (i = 0; i < 50; i++) {
 				funcs[k].f(t1, d, size, funcs[k].arg);
 			}
-			printf(" C  %dx%dk: %dms\n", i, size/1024, SDL_GetTicks() - start);
+			print_timing(TEST_C, i, size, SDL_GetTicks() - start);
 			
 			print_compare(dstm,dstc);
+			print_compare_large(dm, d, size);
+			print_line();
+		}
+        }
+
+
+	/* Convolution functions, on the large buffers seen as a 2D image */
+        {
+#undef FUNC
+#define FUNC(f, c) { #f, SDL_imageFilter ## f, c }
+		struct func {
+			char* name;
+			int (*f)(unsigned char*, unsigned char*, int, int, signed short*, unsigned char);
+			unsigned char arg;
+		};
+		struct func funcs[] = {
+			FUNC(ConvolveKernel3x3Divide,     16),
+			FUNC(ConvolveKernel5x5Divide,     32),
+			FUNC(ConvolveKernel7x7Divide,     64),
+			FUNC(ConvolveKernel9x9Divide,    128),
+			FUNC(ConvolveKernel3x3ShiftRight,  1),
+			FUNC(ConvolveKernel5x5ShiftRight,  2),
+			FUNC(ConvolveKernel7x7ShiftRight,  3),
+			FUNC(ConvolveKernel9x9ShiftRight,  4),
+		};
+		/* Odd width, so that every row ends with pixels for the C routine */
+		int columns = 1021, rows = size / columns;
+		signed short kernel[9*12];
+		
+		int k;
+		for (i = 0; i < 9*12; i++) {
+			kernel[i] = (rand() % 19) - 6;
+		}
+		for (k = 0; k < sizeof(funcs)/sizeof(struct func); k++) {
+			Uint32 start;
+			int i;
+			char call[1024];
+			SDL_snprintf(call, 1024, "%s(%u)", funcs[k].name, funcs[k].arg);
+			printf ("%s\n", call);
+			
+			SDL_imageFilterMMXon();
+			memset(d, 0, size);
+			start = SDL_GetTicks();
+			for (i = 0; i < 10; i++) {
+				funcs[k].f(t1, d, rows, columns, kernel, funcs[k].arg);
+			}
+			print_timing(TEST_MMX, i, size, SDL_GetTicks() - start);
+			memcpy(dm, d, size);
+			
+			SDL_imageFilterMMXoff();
+			memset(d, 0, size);
+			start = SDL_GetTicks();
+			for (i = 0; i < 10; i++) {
+				funcs[k].f(t1, d, rows, columns, kernel, funcs[k].arg);
+			}
+			print_timing(TEST_C, i, size, SDL_GetTicks() - start);
+			
+			print_compare_large(dm, d, size);
+			print_line();
+		}
+        }
+
+        {
+		int columns = 1021, rows = size / columns;
+		unsigned char n;
+		
+		for (n = 0; n < 3; n++) {
+			Uint32 start;
+			int i;
+			printf ("SobelXShiftRight(%u)\n", n);
+			
+			SDL_imageFilterMMXon();
+			memset(d, 0, size);
+			start = SDL_GetTicks();
+			for (i = 0; i < 10; i++) {
+				SDL_imageFilterSobelXShiftRight(t1, d, rows, columns, n);
+			}
+			print_timing(TEST_MMX, i, size, SDL_GetTicks() - start);
+			memcpy(dm, d, size);
+			
+			SDL_imageFilterMMXoff();
+			memset(d, 0, size);
+			start = SDL_GetTicks();
+			for (i = 0; i < 10; i++) {
+				SDL_imageFilterSobelXShiftRight(t1, d, rows, columns, n);
+			}
+			print_timing(TEST_C, i, size, SDL_GetTicks() - start);
+			
+			print_compare_large(dm, d, size);
 			print_line();
 		}
         }
@@ -407,16 +527,17 @@ int main(int argc, char *argv[])
 	SDL_imageFilterMMXon();
 	if (SDL_imageFilterMMXdetect())
 	{
-		printf("MMX was detected\n\n");
+		printf("SIMD (SSE2 or AVX2) was detected\n\n");
 	}
 	else
 	{
-		printf("MMX was NOT detected\n\n");
+		printf("SIMD (SSE2 or AVX2) was NOT detected\n\n");
 	}
 
 	printf ("Result: %i of %i passed OK.\n", ok_count, total_count);
 
 	SDL_Quit();
+	free(dm);
 	free(d);
 	free(t2);
 	free(t1);